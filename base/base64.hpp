@@ -0,0 +1,44 @@
+﻿
+#pragma once
+
+#include <cstdint>
+
+#include "base/array.hpp"
+
+namespace principia {
+namespace base {
+
+// The base64 encoding with the URL and filename safe alphabet of RFC 4648,
+// section 5, without padding: the result contains neither '/' nor '=', which
+// are significant in KSP config files.  Unlike the hexadecimal encoding, which
+// doubles the size of the data, it only expands it by a factor 4/3.
+
+// The number of characters needed to encode |byte_count| bytes.
+inline std::int64_t Base64EncodedSize(std::int64_t byte_count);
+
+// The number of bytes encoded by |input|, taking the padding into account.
+inline std::int64_t Base64DecodedSize(Array<std::uint8_t const> input);
+
+// Either |input.data <= &output.data[1]| or
+// |&output.data[Base64EncodedSize(input.size)] <= input.data| must hold, in
+// particular, |input.data == output.data| is valid.  |output.size| must be at
+// least |Base64EncodedSize(input.size)|.  The range
+// [&output.data[Base64EncodedSize(input.size)], &output.data[output.size][ is
+// left unmodified.
+inline void Base64Encode(Array<std::uint8_t const> input,
+                         Array<std::uint8_t> output);
+
+// Invalid characters are read as 0.  Trailing padding characters are
+// ignored.  Either |output.data <= &input.data[1]| or
+// |&input.data[input.size] <= output.data| must hold, in particular,
+// |input.data == output.data| is valid.  |output.size| must be at least
+// |Base64DecodedSize(input)|.  The range
+// [&output.data[Base64DecodedSize(input)], &output.data[output.size][ is left
+// unmodified.
+inline void Base64Decode(Array<std::uint8_t const> input,
+                         Array<std::uint8_t> output);
+
+}  // namespace base
+}  // namespace principia
+
+#include "base/base64_body.hpp"
@@ -0,0 +1,134 @@
+﻿
+#pragma once
+
+#include <cstdint>
+
+#include "base/base64.hpp"
+#include "glog/logging.h"
+
+namespace principia {
+namespace base {
+
+static char const sextet_to_base64_digit[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// Only accepted by the decoder.
+static std::uint8_t const base64_padding = '=';
+
+// Maps invalid digits to 0.
+class Base64DigitsToSextet {
+ public:
+  Base64DigitsToSextet() {
+    for (std::uint8_t& sextet : sextets_) {
+      sextet = 0;
+    }
+    for (std::uint8_t i = 0; i < 64; ++i) {
+      sextets_[static_cast<std::uint8_t>(sextet_to_base64_digit[i])] = i;
+    }
+  }
+
+  std::uint8_t operator[](std::uint8_t const digit) const {
+    return sextets_[digit];
+  }
+
+ private:
+  std::uint8_t sextets_[256];
+};
+
+static Base64DigitsToSextet const base64_digit_to_sextet;
+
+std::int64_t Base64EncodedSize(std::int64_t const byte_count) {
+  return ((byte_count << 2) + 2) / 3;
+}
+
+std::int64_t Base64DecodedSize(Array<std::uint8_t const> input) {
+  while (input.size > 0 && input.data[input.size - 1] == base64_padding) {
+    --input.size;
+  }
+  // A trailing digit which does not encode a complete byte is ignored.
+  return (input.size * 3) >> 2;
+}
+
+void Base64Encode(Array<std::uint8_t const> input,
+                  Array<std::uint8_t> output) {
+  CHECK_NOTNULL(input.data);
+  CHECK_NOTNULL(output.data);
+  std::int64_t const encoded_size = Base64EncodedSize(input.size);
+  // We iterate backward.
+  // |input <= &output[1]| is still valid because we write four bytes of output
+  // from reading three bytes of input, so output[4k - 1] and above are written
+  // after reading input[3k - 1] and above.  Greater values of |output| would
+  // overwrite input data before it is read, unless there is no overlap, i.e.,
+  // |&output[encoded_size] <= input|.
+  CHECK(input.data <= &output.data[1] ||
+        &output.data[encoded_size] <= input.data) << "bad overlap";
+  CHECK_GE(output.size, encoded_size) << "output too small";
+  std::int64_t const complete_groups = input.size / 3;
+  // The last, incomplete group, if any.  It is encoded by 2 or 3 digits.
+  std::int64_t const remaining = input.size - 3 * complete_groups;
+  if (remaining > 0) {
+    std::uint8_t const* const last_input = &input.data[3 * complete_groups];
+    std::uint8_t* const last_output = &output.data[4 * complete_groups];
+    std::uint32_t const group =
+        (last_input[0] << 16) | (remaining == 2 ? last_input[1] << 8 : 0);
+    last_output[0] = sextet_to_base64_digit[group >> 18];
+    last_output[1] = sextet_to_base64_digit[(group >> 12) & 0x3F];
+    if (remaining == 2) {
+      last_output[2] = sextet_to_base64_digit[(group >> 6) & 0x3F];
+    }
+  }
+  // The complete groups of 3 bytes.
+  for (std::int64_t k = complete_groups - 1; k >= 0; --k) {
+    std::uint8_t const* const group_input = &input.data[3 * k];
+    std::uint8_t* const group_output = &output.data[4 * k];
+    std::uint32_t const group = (group_input[0] << 16) |
+                                (group_input[1] << 8) |
+                                group_input[2];
+    group_output[0] = sextet_to_base64_digit[group >> 18];
+    group_output[1] = sextet_to_base64_digit[(group >> 12) & 0x3F];
+    group_output[2] = sextet_to_base64_digit[(group >> 6) & 0x3F];
+    group_output[3] = sextet_to_base64_digit[group & 0x3F];
+  }
+}
+
+void Base64Decode(Array<std::uint8_t const> input,
+                  Array<std::uint8_t> output) {
+  CHECK_NOTNULL(input.data);
+  CHECK_NOTNULL(output.data);
+  std::int64_t const decoded_size = Base64DecodedSize(input);
+  // |output <= &input[1]| is still valid because we write three bytes of output
+  // from reading four bytes of input, so output[3k + 2] is written after
+  // reading input[4k + 3], and it doesn't reach the next group, which starts
+  // at input[4k + 4].  Greater values of |output| would overwrite input data
+  // before it is read, unless there is no overlap, i.e.,
+  // |&input[input_size] <= output|.
+  CHECK(output.data <= &input.data[1] ||
+        &input.data[input.size] <= output.data) << "bad overlap";
+  CHECK_GE(output.size, decoded_size) << "output too small";
+  std::uint8_t* const output_end = output.data + decoded_size;
+  // The complete groups of 3 bytes.
+  for (; output_end - output.data >= 3; input.data += 4, output.data += 3) {
+    std::uint32_t const group = (base64_digit_to_sextet[input.data[0]] << 18) |
+                                (base64_digit_to_sextet[input.data[1]] << 12) |
+                                (base64_digit_to_sextet[input.data[2]] << 6) |
+                                base64_digit_to_sextet[input.data[3]];
+    output.data[0] = static_cast<std::uint8_t>(group >> 16);
+    output.data[1] = static_cast<std::uint8_t>(group >> 8);
+    output.data[2] = static_cast<std::uint8_t>(group);
+  }
+  // The last, incomplete group, if any.  It is encoded by 2 or 3 digits.
+  std::int64_t const remaining = output_end - output.data;
+  if (remaining > 0) {
+    std::uint32_t const group =
+        (base64_digit_to_sextet[input.data[0]] << 18) |
+        (base64_digit_to_sextet[input.data[1]] << 12) |
+        (remaining == 2 ? base64_digit_to_sextet[input.data[2]] << 6 : 0);
+    output.data[0] = static_cast<std::uint8_t>(group >> 16);
+    if (remaining == 2) {
+      output.data[1] = static_cast<std::uint8_t>(group >> 8);
+    }
+  }
+}
+
+}  // namespace base
+}  // namespace principia
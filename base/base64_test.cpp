@@ -0,0 +1,143 @@
+﻿
+#include "base/base64.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "base/array.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Each;
+using testing::ElementsAre;
+
+namespace principia {
+namespace base {
+
+class Base64Test : public testing::Test {
+ protected:
+  // Encodes |bytes| and checks that the result is |digits|, then decodes the
+  // result and checks that the bytes are recovered.
+  void CheckEncodeAndDecode(std::string const& bytes,
+                            std::string const& digits) {
+    std::vector<uint8_t> const input(bytes.begin(), bytes.end());
+    std::vector<uint8_t> encoded(Base64EncodedSize(input.size()));
+    Base64Encode({input.data(), input.size()},
+                 {encoded.data(), encoded.size()});
+    EXPECT_EQ(digits, std::string(encoded.begin(), encoded.end()));
+
+    std::vector<uint8_t> decoded(
+        Base64DecodedSize({encoded.data(), encoded.size()}));
+    Base64Decode({encoded.data(), encoded.size()},
+                 {decoded.data(), decoded.size()});
+    EXPECT_EQ(bytes, std::string(decoded.begin(), decoded.end()));
+  }
+};
+
+using Base64DeathTest = Base64Test;
+
+// The test vectors from RFC 4648, section 10, without the padding.
+TEST_F(Base64Test, Rfc4648) {
+  CheckEncodeAndDecode("", "");
+  CheckEncodeAndDecode("f", "Zg");
+  CheckEncodeAndDecode("fo", "Zm8");
+  CheckEncodeAndDecode("foo", "Zm9v");
+  CheckEncodeAndDecode("foob", "Zm9vYg");
+  CheckEncodeAndDecode("fooba", "Zm9vYmE");
+  CheckEncodeAndDecode("foobar", "Zm9vYmFy");
+}
+
+TEST_F(Base64Test, AllBytes) {
+  std::string bytes;
+  for (int i = 0; i < 256; ++i) {
+    bytes.push_back(static_cast<char>(255 - i));
+  }
+  std::vector<uint8_t> const input(bytes.begin(), bytes.end());
+  std::vector<uint8_t> encoded(Base64EncodedSize(input.size()));
+  EXPECT_EQ(342, encoded.size());
+  Base64Encode({input.data(), input.size()}, {encoded.data(), encoded.size()});
+  std::vector<uint8_t> decoded(
+      Base64DecodedSize({encoded.data(), encoded.size()}));
+  EXPECT_EQ(256, decoded.size());
+  Base64Decode({encoded.data(), encoded.size()},
+               {decoded.data(), decoded.size()});
+  EXPECT_EQ(input, decoded);
+}
+
+TEST_F(Base64Test, LargeOutput) {
+  std::vector<uint8_t> const input = {'f', 'o', 'o', 'b'};
+  std::vector<uint8_t> digits(6 + 42, 'X');
+  Base64Encode({input.data(), input.size()}, {digits.data(), digits.size()});
+  EXPECT_EQ("Zm9vYg", std::string(&digits[0], &digits[6]));
+  EXPECT_THAT(std::vector<uint8_t>(&digits[6], &digits[digits.size()]),
+              Each('X'));
+  std::vector<uint8_t> bytes(4 + 42, 'Y');
+  Base64Decode({digits.data(), 6}, {bytes.data(), bytes.size()});
+  EXPECT_EQ(input, std::vector<uint8_t>(&bytes[0], &bytes[4]));
+  EXPECT_THAT(std::vector<uint8_t>(&bytes[4], &bytes[bytes.size()]),
+              Each('Y'));
+}
+
+TEST_F(Base64Test, Alphabet) {
+  CheckEncodeAndDecode("\xFB\xFF\xBF", "-_-_");
+}
+
+TEST_F(Base64Test, Padded) {
+  std::vector<uint8_t> digits = {'Z', 'm', '9', 'v', 'Y', 'g', '=', '='};
+  EXPECT_EQ(4, Base64DecodedSize({digits.data(), digits.size()}));
+  std::vector<uint8_t> bytes(4);
+  Base64Decode({digits.data(), digits.size()}, {bytes.data(), bytes.size()});
+  EXPECT_THAT(bytes, ElementsAre('f', 'o', 'o', 'b'));
+}
+
+TEST_F(Base64Test, Invalid) {
+  std::vector<uint8_t> digits = {'Z', '!', '9', 'v'};
+  std::vector<uint8_t> bytes(3);
+  Base64Decode({digits.data(), digits.size()}, {bytes.data(), bytes.size()});
+  EXPECT_THAT(bytes, ElementsAre('\x64', '\x0F', '\x6F'));
+}
+
+TEST_F(Base64DeathTest, Size) {
+  std::vector<uint8_t> bytes = {'f', 'o', 'o', 'b'};
+  std::vector<uint8_t> digits(6);
+  EXPECT_DEATH({
+    Base64Encode({bytes.data(), bytes.size()},
+                 {digits.data(), digits.size() - 1});
+  }, "too small");
+  Base64Encode({bytes.data(), bytes.size()}, {digits.data(), digits.size()});
+  EXPECT_DEATH({
+    Base64Decode({digits.data(), digits.size()},
+                 {bytes.data(), bytes.size() - 1});
+  }, "too small");
+}
+
+TEST_F(Base64Test, InPlace) {
+  std::string const bytes = "foobar!";
+  std::string const digits = "Zm9vYmFyIQ";
+  std::vector<uint8_t> buffer(digits.size() + 1);
+  std::memcpy(&buffer[1], bytes.data(), bytes.size());
+  Base64Encode({&buffer[1], bytes.size()}, {&buffer[0], digits.size()});
+  EXPECT_EQ(digits, std::string(&buffer[0], &buffer[digits.size()]));
+  std::memcpy(&buffer[0], bytes.data(), bytes.size());
+  Base64Encode({&buffer[0], bytes.size()}, {&buffer[0], digits.size()});
+  EXPECT_EQ(digits, std::string(&buffer[0], &buffer[digits.size()]));
+  Base64Decode({&buffer[0], digits.size()}, {&buffer[1], bytes.size()});
+  EXPECT_EQ(bytes, std::string(&buffer[1], &buffer[bytes.size() + 1]));
+  std::memcpy(&buffer[0], digits.data(), digits.size());
+  Base64Decode({&buffer[0], digits.size()}, {&buffer[0], bytes.size()});
+  EXPECT_EQ(bytes, std::string(&buffer[0], &buffer[bytes.size()]));
+}
+
+TEST_F(Base64DeathTest, Overlap) {
+  std::vector<uint8_t> buffer(8);
+  EXPECT_DEATH({
+    Base64Encode({&buffer[2], 3}, {&buffer[0], 4});
+  }, "bad overlap");
+  EXPECT_DEATH({
+    Base64Decode({&buffer[0], 4}, {&buffer[2], 3});
+  }, "bad overlap");
+}
+
+}  // namespace base
+}  // namespace principia
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -57,6 +58,11 @@ class DelegatingArrayOutputStream
 // irrespective of the size of the message to serialize.
 class PullSerializer {
  public:
+  // Called with each piece of a message which is produced in pieces, see
+  // |Start|.
+  using PieceWriter =
+      std::function<void(google::protobuf::Message const& piece)>;
+
   // The |size| of the data objects returned by |Pull| are never greater than
   // |chunk_size|.  At most |number_of_chunks| chunks are held in the internal
   // queue.  This class uses at most
@@ -69,6 +75,15 @@ class PullSerializer {
   void Start(
       not_null<std::unique_ptr<google::protobuf::Message const>> message);
 
+  // Same as above, but the message is produced in pieces by |write_pieces|,
+  // which is called on the serialization thread and must call its argument
+  // with each piece in turn.  The pieces need not be initialized.  The data
+  // returned by |Pull| is the concatenation of the serializations of the
+  // pieces, which protocol buffers parse as the message obtained by merging the
+  // pieces in order.  The serialization never needs the whole message, only
+  // the piece being written.
+  void Start(std::function<void(PieceWriter const& write_piece)> write_pieces);
+
   // Obtain the next chunk of data from the serializer.  Blocks if no data is
   // available.  Returns a |Bytes| object of |size| 0 at the end of the
   // serialization.  The returned object may become invalid the next time |Pull|
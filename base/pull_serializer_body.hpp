@@ -5,6 +5,8 @@
 
 #include <algorithm>
 
+#include "google/protobuf/io/coded_stream.h"
+
 namespace principia {
 
 using std::placeholders::_1;
@@ -90,8 +92,23 @@ inline void PullSerializer::Start(
     not_null<std::unique_ptr<google::protobuf::Message const>> message) {
   CHECK(thread_ == nullptr);
   message_ = std::move(message);
-  thread_ = std::make_unique<std::thread>([this](){
-    CHECK(message_->SerializeToZeroCopyStream(&stream_));
+  Start([this](PieceWriter const& write_piece) {
+    write_piece(*message_);
+  });
+}
+
+inline void PullSerializer::Start(
+    std::function<void(PieceWriter const& write_piece)> write_pieces) {
+  CHECK(thread_ == nullptr);
+  thread_ = std::make_unique<std::thread>([this, write_pieces]() {
+    {
+      // A single coded stream is used for all the pieces so that the stream
+      // isn't flushed, yielding a short chunk, after each piece.
+      google::protobuf::io::CodedOutputStream coded_stream(&stream_);
+      write_pieces([&coded_stream](google::protobuf::Message const& piece) {
+        CHECK(piece.SerializePartialToCodedStream(&coded_stream));
+      });
+    }
     // Put a sentinel at the end of the serialized stream so that the client
     // knows that this is the end.
     Bytes bytes;
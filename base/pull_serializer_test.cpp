@@ -117,6 +117,43 @@ TEST_F(PullSerializerTest, SerializationSizes) {
   EXPECT_THAT(actual_sizes, ElementsAreArray(expected_sizes));
 }
 
+TEST_F(PullSerializerTest, SerializationPieces) {
+  auto const trajectory = BuildTrajectory();
+  std::string const expected_serialized_trajectory =
+      trajectory->SerializePartialAsString();
+
+  // Each piece has 10 points of the trajectory.  Since the |timeline| is a
+  // repeated field the concatenation of the pieces is byte-for-byte the
+  // serialization of the entire trajectory.
+  pull_serializer_->Start(
+      [&trajectory](PullSerializer::PieceWriter const& write_piece) {
+        for (int i = 0; i < trajectory->timeline_size(); i += 10) {
+          DiscreteTrajectory piece;
+          for (int j = i; j < i + 10; ++j) {
+            *piece.add_timeline() = trajectory->timeline(j);
+          }
+          write_piece(piece);
+        }
+      });
+  std::string actual_serialized_trajectory;
+  std::vector<std::int64_t> actual_sizes;
+  for (;;) {
+    Bytes const bytes = pull_serializer_->Pull();
+    if (bytes.size == 0) {
+      break;
+    }
+    actual_sizes.push_back(bytes.size);
+    actual_serialized_trajectory.append(
+        reinterpret_cast<char const*>(bytes.data),
+        static_cast<size_t>(bytes.size));
+  }
+  EXPECT_EQ(expected_serialized_trajectory, actual_serialized_trajectory);
+  // The pieces don't cause short chunks.
+  std::vector<std::int64_t> expected_sizes(53, chunk_size);
+  expected_sizes.push_back(53);
+  EXPECT_THAT(actual_sizes, ElementsAreArray(expected_sizes));
+}
+
 TEST_F(PullSerializerTest, SerializationThreading) {
   DiscreteTrajectory read_trajectory;
   auto const trajectory = BuildTrajectory();
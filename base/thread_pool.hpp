@@ -0,0 +1,66 @@
+﻿
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "base/macros.hpp"
+
+namespace principia {
+namespace base {
+namespace internal_thread_pool {
+
+// A pool of threads that execute the functions passed to |Add| in the order in
+// which they were added.  The results are made available through futures.
+// Note that the functions run concurrently, so it is the responsibility of the
+// client to ensure that they do not race.
+template<typename T>
+class ThreadPool {
+ public:
+  // Constructs a pool with |pool_size| threads, which must be positive.
+  explicit ThreadPool(std::int64_t pool_size);
+
+  // Executes the functions that were added but have not started yet, and waits
+  // for all the threads to terminate.
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+
+  // Schedules |function| for execution on one of the threads of the pool.  The
+  // returned future becomes ready when |function| has completed.
+  std::future<T> Add(std::function<T()> function);
+
+  std::int64_t size() const;
+
+ private:
+  // The loop executed by each thread of the pool.
+  void DequeueCallAndExecute();
+
+  std::mutex lock_;
+  std::condition_variable has_calls_or_shutdown_;
+
+  // Set by the destructor to ask the threads to terminate once |calls_| is
+  // empty.
+  bool shutdown_ GUARDED_BY(lock_) = false;
+  std::queue<std::packaged_task<T()>> calls_ GUARDED_BY(lock_);
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace internal_thread_pool
+
+using internal_thread_pool::ThreadPool;
+
+}  // namespace base
+}  // namespace principia
+
+#include "base/thread_pool_body.hpp"
@@ -0,0 +1,73 @@
+﻿
+#pragma once
+
+#include "base/thread_pool.hpp"
+
+#include <utility>
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace base {
+namespace internal_thread_pool {
+
+template<typename T>
+ThreadPool<T>::ThreadPool(std::int64_t const pool_size) {
+  CHECK_LT(0, pool_size);
+  for (std::int64_t i = 0; i < pool_size; ++i) {
+    threads_.emplace_back(&ThreadPool::DequeueCallAndExecute, this);
+  }
+}
+
+template<typename T>
+ThreadPool<T>::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    shutdown_ = true;
+  }
+  has_calls_or_shutdown_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+template<typename T>
+std::future<T> ThreadPool<T>::Add(std::function<T()> function) {
+  std::future<T> result;
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    CHECK(!shutdown_);
+    calls_.emplace(std::move(function));
+    result = calls_.back().get_future();
+  }
+  has_calls_or_shutdown_.notify_one();
+  return result;
+}
+
+template<typename T>
+std::int64_t ThreadPool<T>::size() const {
+  return threads_.size();
+}
+
+template<typename T>
+void ThreadPool<T>::DequeueCallAndExecute() {
+  for (;;) {
+    std::packaged_task<T()> call;
+    {
+      std::unique_lock<std::mutex> l(lock_);
+      has_calls_or_shutdown_.wait(
+          l, [this] { return shutdown_ || !calls_.empty(); });
+      if (calls_.empty()) {
+        // Shutting down and nothing left to execute.
+        return;
+      }
+      call = std::move(calls_.front());
+      calls_.pop();
+    }
+    call();
+  }
+}
+
+}  // namespace internal_thread_pool
+}  // namespace base
+}  // namespace principia
@@ -0,0 +1,68 @@
+﻿
+#include "base/thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace principia {
+namespace base {
+
+class ThreadPoolTest : public ::testing::Test {
+ protected:
+  ThreadPoolTest() : pool_(std::thread::hardware_concurrency() + 1) {}
+
+  ThreadPool<void> pool_;
+};
+
+// Check that execution occurs in parallel and that all the calls are executed.
+TEST_F(ThreadPoolTest, ParallelExecution) {
+  std::mutex lock;
+  std::set<std::thread::id> thread_ids;
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 1000; ++i) {
+    futures.push_back(pool_.Add([&lock, &thread_ids]() {
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+      std::lock_guard<std::mutex> l(lock);
+      thread_ids.insert(std::this_thread::get_id());
+    }));
+  }
+  for (auto const& future : futures) {
+    future.wait();
+  }
+  EXPECT_LT(1, thread_ids.size());
+  EXPECT_GE(pool_.size(), thread_ids.size());
+}
+
+TEST_F(ThreadPoolTest, Results) {
+  ThreadPool<int> pool(3);
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool.Add([i]() { return i * i; }));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i * i, futures[i].get());
+  }
+}
+
+// Check that the destructor executes the calls that are still queued.
+TEST_F(ThreadPoolTest, Destruction) {
+  std::atomic<int> count(0);
+  {
+    ThreadPool<void> pool(2);
+    for (int i = 0; i < 100; ++i) {
+      pool.Add([&count]() { ++count; });
+    }
+  }
+  EXPECT_EQ(100, count);
+}
+
+}  // namespace base
+}  // namespace principia
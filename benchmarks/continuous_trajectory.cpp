@@ -0,0 +1,147 @@
+﻿// .\Release\x64\benchmarks.exe --benchmark_repetitions=5 --benchmark_filter=ContinuousTrajectory  // NOLINT(whitespace/line_length)
+// Benchmarking on 1 X 2000 MHz CPU
+// 2026/10/16-03:31:42
+// Benchmark                                                   Time(ns)    CPU(ns) Iterations  // NOLINT(whitespace/line_length)
+// -------------------------------------------------------------------------------------------  // NOLINT(whitespace/line_length)
+// BM_EvaluateContinuousTrajectoryRandomTime/100_mean             24807      24606          5  // NOLINT(whitespace/line_length)
+// BM_EvaluateContinuousTrajectoryRandomTime/10000_mean           30486      29948          5  // NOLINT(whitespace/line_length)
+// BM_EvaluateContinuousTrajectoryRandomTime/100000_mean          31174      30688          5  // NOLINT(whitespace/line_length)
+// BM_EvaluateContinuousTrajectoryIncreasingTime/100_mean         14040      13922          5  // NOLINT(whitespace/line_length)
+// BM_EvaluateContinuousTrajectoryIncreasingTime/10000_mean       32943      32520          5  // NOLINT(whitespace/line_length)
+// BM_EvaluateContinuousTrajectoryIncreasingTime/100000_mean      44976      44626          5  // NOLINT(whitespace/line_length)
+
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "geometry/frame.hpp"
+#include "geometry/named_quantities.hpp"
+#include "physics/continuous_trajectory.hpp"
+#include "physics/degrees_of_freedom.hpp"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/named_quantities.hpp"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+#include "serialization/geometry.pb.h"
+
+// Must come last to avoid conflicts when defining the CHECK macros.
+#include "benchmark/benchmark.h"
+
+namespace principia {
+
+using geometry::Displacement;
+using geometry::Frame;
+using geometry::Position;
+using geometry::Velocity;
+using quantities::AngularFrequency;
+using quantities::Cos;
+using quantities::Length;
+using quantities::Sin;
+using quantities::Time;
+using quantities::si::Kilo;
+using quantities::si::Metre;
+using quantities::si::Radian;
+using quantities::si::Second;
+
+namespace physics {
+
+namespace {
+
+using World = Frame<serialization::Frame::TestTag,
+                    serialization::Frame::TEST, true>;
+
+int const evaluations_per_iteration = 1000;
+
+// Returns a trajectory made of |number_of_series| series for a body on a
+// circular orbit.
+std::unique_ptr<ContinuousTrajectory<World>> MakeCircularTrajectory(
+    int const number_of_series) {
+  Time const step = 10 * Second;
+  Length const radius = 7000 * Kilo(Metre);
+  AngularFrequency const ω = 2 * Radian / (5000 * Second);
+  auto trajectory = std::make_unique<ContinuousTrajectory<World>>(
+                        step, /*tolerance=*/1 * Metre);
+  Instant const t0;
+  for (int i = 0; i <= 8 * number_of_series; ++i) {
+    Instant const t = t0 + i * step;
+    auto const angle = ω * (t - t0);
+    trajectory->Append(
+        t,
+        DegreesOfFreedom<World>(
+            World::origin + Displacement<World>({radius * Cos(angle),
+                                                 radius * Sin(angle),
+                                                 0 * Metre}),
+            Velocity<World>({-radius * ω * Sin(angle) / Radian,
+                             radius * ω * Cos(angle) / Radian,
+                             0 * Metre / Second})));
+  }
+  return trajectory;
+}
+
+}  // namespace
+
+// Evaluates the trajectory at random times without a hint, which is what
+// happens e.g. when computing apsides or rendering in a dynamic frame.
+void BM_EvaluateContinuousTrajectoryRandomTime(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  auto const trajectory = MakeCircularTrajectory(state.range_x());
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<> fraction(0.0, 1.0);
+  std::vector<Instant> times;
+  for (int i = 0; i < evaluations_per_iteration; ++i) {
+    times.push_back(trajectory->t_min() +
+                    fraction(random) *
+                        (trajectory->t_max() - trajectory->t_min()));
+  }
+
+  Displacement<World> result;
+  while (state.KeepRunning()) {
+    for (Instant const& time : times) {
+      result += trajectory->EvaluatePosition(time, /*hint=*/nullptr) -
+                World::origin;
+    }
+  }
+
+  // This weird call to |SetLabel| has no effect except that it uses |result|
+  // and therefore prevents the loop from being optimized away.
+  std::stringstream ss;
+  ss << result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
+BENCHMARK(BM_EvaluateContinuousTrajectoryRandomTime)->
+    Arg(100)->Arg(10000)->Arg(100000);
+
+// Evaluates the trajectory at increasing times with a hint, which is what
+// happens when integrating the massless bodies.
+void BM_EvaluateContinuousTrajectoryIncreasingTime(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  auto const trajectory = MakeCircularTrajectory(state.range_x());
+  std::vector<Instant> times;
+  for (int i = 0; i < evaluations_per_iteration; ++i) {
+    times.push_back(trajectory->t_min() +
+                    (i + 0.5) / evaluations_per_iteration *
+                        (trajectory->t_max() - trajectory->t_min()));
+  }
+
+  ContinuousTrajectory<World>::Hint hint;
+  Displacement<World> result;
+  while (state.KeepRunning()) {
+    for (Instant const& time : times) {
+      result += trajectory->EvaluatePosition(time, &hint) - World::origin;
+    }
+  }
+
+  // This weird call to |SetLabel| has no effect except that it uses |result|
+  // and therefore prevents the loop from being optimized away.
+  std::stringstream ss;
+  ss << result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
+BENCHMARK(BM_EvaluateContinuousTrajectoryIncreasingTime)->
+    Arg(100)->Arg(10000)->Arg(100000);
+
+}  // namespace physics
+}  // namespace principia
@@ -0,0 +1,218 @@
+﻿// .\Release\x64\benchmarks.exe --benchmark_filter=DiscreteTrajectory  // NOLINT(whitespace/line_length)
+
+#include <cmath>
+#include <memory>
+#include <sstream>
+
+#include "geometry/frame.hpp"
+#include "geometry/named_quantities.hpp"
+#include "physics/degrees_of_freedom.hpp"
+#include "physics/discrete_trajectory.hpp"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+#include "serialization/geometry.pb.h"
+
+// Must come last to avoid conflicts when defining the CHECK macros.
+#include "benchmark/benchmark.h"
+
+namespace principia {
+
+using geometry::Displacement;
+using geometry::Frame;
+using geometry::Instant;
+using geometry::Position;
+using geometry::Velocity;
+using quantities::si::Metre;
+using quantities::si::Second;
+
+namespace physics {
+
+namespace {
+
+using World = Frame<serialization::Frame::TestTag,
+                    serialization::Frame::TEST, true>;
+
+// Appends |number_of_points| points, one second apart, to |trajectory|.
+void AppendPoints(int const number_of_points,
+                  not_null<DiscreteTrajectory<World>*> const trajectory) {
+  Instant const t0;
+  for (int i = 0; i < number_of_points; ++i) {
+    trajectory->Append(
+        t0 + i * Second,
+        DegreesOfFreedom<World>(
+            World::origin + Displacement<World>({i * Metre,
+                                                 2 * i * Metre,
+                                                 3 * i * Metre}),
+            Velocity<World>({1 * Metre / Second,
+                             2 * Metre / Second,
+                             3 * Metre / Second})));
+  }
+}
+
+// Appends |number_of_points| points, ten seconds apart, on a low circular orbit
+// to |trajectory|.  Unlike the points of |AppendPoints|, the coordinates are
+// not exactly representable with few bits, which matters for serialization.
+void AppendCircularOrbitPoints(
+    int const number_of_points,
+    not_null<DiscreteTrajectory<World>*> const trajectory) {
+  Instant const t0;
+  double const radius = 6.7e6;  // Metres.
+  double const angular_frequency = 1.16e-3;  // Radians per second.
+  for (int i = 0; i < number_of_points; ++i) {
+    double const t = 10.0 * i;
+    double const c = std::cos(angular_frequency * t);
+    double const s = std::sin(angular_frequency * t);
+    trajectory->Append(
+        t0 + t * Second,
+        DegreesOfFreedom<World>(
+            World::origin + Displacement<World>({radius * c * Metre,
+                                                 radius * s * Metre,
+                                                 0 * Metre}),
+            Velocity<World>(
+                {-radius * angular_frequency * s * Metre / Second,
+                 radius * angular_frequency * c * Metre / Second,
+                 0 * Metre / Second})));
+  }
+}
+
+// The serialization of |trajectory| in the format that predates the packed
+// timeline.
+void WriteLegacyMessage(
+    DiscreteTrajectory<World> const& trajectory,
+    not_null<serialization::DiscreteTrajectory*> const message) {
+  for (auto it = trajectory.Begin(); it != trajectory.End(); ++it) {
+    auto const instantaneous_degrees_of_freedom = message->add_timeline();
+    it.time().WriteToMessage(
+        instantaneous_degrees_of_freedom->mutable_instant());
+    it.degrees_of_freedom().WriteToMessage(
+        instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
+  }
+}
+
+void SetSizeLabel(serialization::DiscreteTrajectory const& message,
+                  not_null<benchmark::State*> const state) {
+  std::stringstream ss;
+  ss << message.ByteSize() << " bytes";
+  state->SetLabel(ss.str());
+}
+
+}  // namespace
+
+void BM_DiscreteTrajectoryAppend(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  while (state.KeepRunning()) {
+    DiscreteTrajectory<World> trajectory;
+    AppendPoints(state.range_x(), &trajectory);
+  }
+}
+
+// This is the access pattern of the rendering of trajectories.
+void BM_DiscreteTrajectoryIterate(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  DiscreteTrajectory<World> trajectory;
+  AppendPoints(state.range_x(), &trajectory);
+  Displacement<World> result;
+  auto const end = trajectory.End();
+  while (state.KeepRunning()) {
+    for (auto it = trajectory.Begin(); it != end; ++it) {
+      result += it.degrees_of_freedom().position() - World::origin;
+    }
+  }
+
+  // This weird call to |SetLabel| has no effect except that it uses |result|
+  // and therefore prevents the loop from being optimized away.
+  std::stringstream ss;
+  ss << result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
+void BM_DiscreteTrajectoryFind(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  DiscreteTrajectory<World> trajectory;
+  AppendPoints(state.range_x(), &trajectory);
+  Instant const t0;
+  Displacement<World> result;
+  while (state.KeepRunning()) {
+    for (int i = 0; i < state.range_x(); i += 7) {
+      result += trajectory.Find(t0 + i * Second).degrees_of_freedom().
+                    position() - World::origin;
+    }
+  }
+
+  std::stringstream ss;
+  ss << result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
+// Forks at the first point, which copies the entire trajectory.
+void BM_DiscreteTrajectoryNewForkWithCopy(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  DiscreteTrajectory<World> trajectory;
+  AppendPoints(state.range_x(), &trajectory);
+  Instant const t0;
+  while (state.KeepRunning()) {
+    DiscreteTrajectory<World>* fork = trajectory.NewForkWithCopy(t0);
+    trajectory.DeleteFork(&fork);
+  }
+}
+
+void BM_DiscreteTrajectorySerialize(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  DiscreteTrajectory<World> trajectory;
+  AppendCircularOrbitPoints(state.range_x(), &trajectory);
+  serialization::DiscreteTrajectory message;
+  while (state.KeepRunning()) {
+    message.Clear();
+    trajectory.WriteToMessage(&message, /*forks=*/{});
+  }
+  SetSizeLabel(message, &state);
+}
+
+void BM_DiscreteTrajectoryDeserialize(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  DiscreteTrajectory<World> trajectory;
+  AppendCircularOrbitPoints(state.range_x(), &trajectory);
+  serialization::DiscreteTrajectory message;
+  trajectory.WriteToMessage(&message, /*forks=*/{});
+  while (state.KeepRunning()) {
+    DiscreteTrajectory<World>::ReadFromMessage(message, /*forks=*/{});
+  }
+  SetSizeLabel(message, &state);
+}
+
+// For comparison with the above benchmarks.
+void BM_DiscreteTrajectorySerializeLegacy(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  DiscreteTrajectory<World> trajectory;
+  AppendCircularOrbitPoints(state.range_x(), &trajectory);
+  serialization::DiscreteTrajectory message;
+  while (state.KeepRunning()) {
+    message.Clear();
+    WriteLegacyMessage(trajectory, &message);
+  }
+  SetSizeLabel(message, &state);
+}
+
+void BM_DiscreteTrajectoryDeserializeLegacy(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  DiscreteTrajectory<World> trajectory;
+  AppendCircularOrbitPoints(state.range_x(), &trajectory);
+  serialization::DiscreteTrajectory message;
+  WriteLegacyMessage(trajectory, &message);
+  while (state.KeepRunning()) {
+    DiscreteTrajectory<World>::ReadFromMessage(message, /*forks=*/{});
+  }
+  SetSizeLabel(message, &state);
+}
+
+BENCHMARK(BM_DiscreteTrajectoryAppend)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectoryIterate)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectoryFind)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectoryNewForkWithCopy)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectorySerialize)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectoryDeserialize)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectorySerializeLegacy)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectoryDeserializeLegacy)->Arg(1000)->Arg(100000);
+
+}  // namespace physics
+}  // namespace principia
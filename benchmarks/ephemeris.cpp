@@ -50,6 +50,30 @@
 // BM_EphemerisLEOProbeAllBodiesAndOblateness_mean      10180320715 10176465233          1                                 750001 steps, +9.99958277683878570e-01 ua, +9.99468831450655270e+01 nmi  // NOLINT(whitespace/line_length)
 // BM_EphemerisLEOProbeAllBodiesAndOblateness_stddev        4477703    14707915          0                                 750001 steps, +9.99958277683878570e-01 ua, +9.99468831450655270e+01 nmi  // NOLINT(whitespace/line_length)
 
+// ./benchmarks --benchmark_repetitions=3 --benchmark_filter=BM_EphemerisSolarSystemAllBodiesAndOblateness                                                 // NOLINT(whitespace/line_length)
+// Benchmarking on 1 X 2000 MHz CPU
+// 2026/10/16-02:37:45
+// With the scalar kernel for the massive bodies:
+// Benchmark                                                     Time             CPU   Iterations                                                         // NOLINT(whitespace/line_length)
+// -----------------------------------------------------------------------------------------------                                                         // NOLINT(whitespace/line_length)
+// BM_EphemerisSolarSystemAllBodiesAndOblateness        3.6826e+10 ns   3.6096e+10 ns            1 +1.00027593208741417e+00 ua                             // NOLINT(whitespace/line_length)
+// BM_EphemerisSolarSystemAllBodiesAndOblateness        3.6787e+10 ns   3.5235e+10 ns            1 +1.00027593208741417e+00 ua                             // NOLINT(whitespace/line_length)
+// BM_EphemerisSolarSystemAllBodiesAndOblateness        3.4691e+10 ns   3.3246e+10 ns            1 +1.00027593208741417e+00 ua                             // NOLINT(whitespace/line_length)
+// BM_EphemerisSolarSystemAllBodiesAndOblateness_mean   3.6101e+10 ns   3.4859e+10 ns            3 +1.00027593208741417e+00 ua                             // NOLINT(whitespace/line_length)
+// BM_EphemerisSolarSystemAllBodiesAndOblateness_stddev 1221332994 ns   1462088845 ns            3 +1.00027593208741417e+00 ua                             // NOLINT(whitespace/line_length)
+
+// ./benchmarks --benchmark_repetitions=3 --benchmark_filter=BM_EphemerisSolarSystemAllBodiesAndOblateness                                                 // NOLINT(whitespace/line_length)
+// Benchmarking on 1 X 2000 MHz CPU
+// 2026/10/16-02:39:46
+// With the packed kernel for the massive bodies:
+// Benchmark                                                     Time             CPU   Iterations                                                         // NOLINT(whitespace/line_length)
+// -----------------------------------------------------------------------------------------------                                                         // NOLINT(whitespace/line_length)
+// BM_EphemerisSolarSystemAllBodiesAndOblateness        3.3612e+10 ns   3.3196e+10 ns            1 +1.00027593208737198e+00 ua                             // NOLINT(whitespace/line_length)
+// BM_EphemerisSolarSystemAllBodiesAndOblateness        2.9626e+10 ns   2.9251e+10 ns            1 +1.00027593208737198e+00 ua                             // NOLINT(whitespace/line_length)
+// BM_EphemerisSolarSystemAllBodiesAndOblateness        3.0393e+10 ns   3.0039e+10 ns            1 +1.00027593208737198e+00 ua                             // NOLINT(whitespace/line_length)
+// BM_EphemerisSolarSystemAllBodiesAndOblateness_mean   3.1210e+10 ns   3.0829e+10 ns            3 +1.00027593208737198e+00 ua                             // NOLINT(whitespace/line_length)
+// BM_EphemerisSolarSystemAllBodiesAndOblateness_stddev 2114888117 ns   2087972899 ns            3 +1.00027593208737198e+00 ua                             // NOLINT(whitespace/line_length)
+
 #include <limits>
 #include <memory>
 #include <vector>
@@ -43,6 +43,7 @@ namespace principia {
 
 using astronomy::ICRFJ2000Ecliptic;
 using geometry::Displacement;
+using geometry::Velocity;
 using quantities::Length;
 using quantities::si::Metre;
 using quantities::si::Second;
@@ -217,6 +218,165 @@ void BM_EvaluateDisplacement(
   state.SetLabel(ss.str().substr(0, 0));
 }
 
+// Evaluates a series and its derivative at many times, one time at a time.
+void BM_EvaluateDisplacementAndDerivative(
+  benchmark::State& state) {  // NOLINT(runtime/references)
+  int const degree = state.range_x();
+  std::mt19937_64 random(42);
+  std::vector<Displacement<ICRFJ2000Ecliptic>> coefficients;
+  for (int i = 0; i <= degree; ++i) {
+    coefficients.push_back(
+        Displacement<ICRFJ2000Ecliptic>(
+            {static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre}));
+  }
+  Instant const t0;
+  Instant const t_min = t0 + static_cast<double>(random()) * Second;
+  Instant const t_max = t_min + static_cast<double>(random()) * Second;
+  ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>> const series(
+    coefficients, t_min, t_max);
+
+  std::vector<Instant> times;
+  for (int i = 0; i < evaluations_per_iteration; ++i) {
+    times.push_back(t_min + (t_max - t_min) * i / evaluations_per_iteration);
+  }
+  Displacement<ICRFJ2000Ecliptic> result{};
+  Velocity<ICRFJ2000Ecliptic> derivative_result{};
+
+  while (state.KeepRunning()) {
+    for (Instant const& t : times) {
+      result += series.Evaluate(t);
+      derivative_result += series.EvaluateDerivative(t);
+    }
+  }
+
+  // This weird call to |SetLabel| has no effect except that it uses |result|
+  // and therefore prevents the loop from being optimized away.
+  std::stringstream ss;
+  ss << result << derivative_result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
+// Same as above, but evaluates all the times in one call.
+void BM_EvaluateDisplacementWithDerivative(
+  benchmark::State& state) {  // NOLINT(runtime/references)
+  int const degree = state.range_x();
+  std::mt19937_64 random(42);
+  std::vector<Displacement<ICRFJ2000Ecliptic>> coefficients;
+  for (int i = 0; i <= degree; ++i) {
+    coefficients.push_back(
+        Displacement<ICRFJ2000Ecliptic>(
+            {static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre}));
+  }
+  Instant const t0;
+  Instant const t_min = t0 + static_cast<double>(random()) * Second;
+  Instant const t_max = t_min + static_cast<double>(random()) * Second;
+  ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>> const series(
+    coefficients, t_min, t_max);
+
+  std::vector<Instant> times;
+  for (int i = 0; i < evaluations_per_iteration; ++i) {
+    times.push_back(t_min + (t_max - t_min) * i / evaluations_per_iteration);
+  }
+  std::vector<Displacement<ICRFJ2000Ecliptic>> values;
+  std::vector<Velocity<ICRFJ2000Ecliptic>> derivatives;
+  Displacement<ICRFJ2000Ecliptic> result{};
+  Velocity<ICRFJ2000Ecliptic> derivative_result{};
+
+  while (state.KeepRunning()) {
+    series.EvaluateWithDerivative(times, &values, &derivatives);
+    result += values.back();
+    derivative_result += derivatives.back();
+  }
+
+  // This weird call to |SetLabel| has no effect except that it uses |result|
+  // and therefore prevents the loop from being optimized away.
+  std::stringstream ss;
+  ss << result << derivative_result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
+// Evaluates a sequence of series, each allocated separately, as was done by
+// |ContinuousTrajectory| when it owned a vector of |ЧебышёвSeries|.
+void BM_EvaluateDisplacementScattered(
+  benchmark::State& state) {  // NOLINT(runtime/references)
+  int const degree = state.range_x();
+  std::mt19937_64 random(42);
+  Instant const t0;
+  Time const duration = 1000 * Second;
+  std::vector<ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>>> series;
+  for (int s = 0; s < evaluations_per_iteration; ++s) {
+    std::vector<Displacement<ICRFJ2000Ecliptic>> coefficients;
+    for (int i = 0; i <= degree; ++i) {
+      coefficients.push_back(
+          Displacement<ICRFJ2000Ecliptic>(
+              {static_cast<double>(random()) * Metre,
+               static_cast<double>(random()) * Metre,
+               static_cast<double>(random()) * Metre}));
+    }
+    series.emplace_back(coefficients,
+                        t0 + s * duration,
+                        t0 + (s + 1) * duration);
+  }
+
+  Displacement<ICRFJ2000Ecliptic> result{};
+
+  while (state.KeepRunning()) {
+    for (int i = 0; i < evaluations_per_iteration; ++i) {
+      result += series[i].Evaluate(t0 + (i + 0.5) * duration);
+    }
+  }
+
+  // This weird call to |SetLabel| has no effect except that it uses |result|
+  // and therefore prevents the loop from being optimized away.
+  std::stringstream ss;
+  ss << result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
+// Same as above, but with the coefficients of all the series stored in a single
+// buffer, as done by |ContinuousTrajectory|.
+void BM_EvaluateDisplacementContiguous(
+  benchmark::State& state) {  // NOLINT(runtime/references)
+  int const degree = state.range_x();
+  std::mt19937_64 random(42);
+  Instant const t0;
+  Time const duration = 1000 * Second;
+  Time::Inverse const one_over_duration = 1 / duration;
+  std::vector<R3Element<double>> coefficients;
+  for (int s = 0; s < evaluations_per_iteration; ++s) {
+    for (int i = 0; i <= degree; ++i) {
+      coefficients.push_back({static_cast<double>(random()),
+                              static_cast<double>(random()),
+                              static_cast<double>(random())});
+    }
+  }
+
+  Displacement<ICRFJ2000Ecliptic> result{};
+
+  while (state.KeepRunning()) {
+    for (int i = 0; i < evaluations_per_iteration; ++i) {
+      Instant const t_min = t0 + i * duration;
+      Instant const t_max = t0 + (i + 1) * duration;
+      Instant const t = t0 + (i + 0.5) * duration;
+      double const scaled_t = ((t - t_max) + (t - t_min)) * one_over_duration;
+      result += Displacement<ICRFJ2000Ecliptic>(
+                    EvaluateЧебышёвSeries(&coefficients[i * (degree + 1)],
+                                          degree,
+                                          scaled_t) * Metre);
+    }
+  }
+
+  // This weird call to |SetLabel| has no effect except that it uses |result|
+  // and therefore prevents the loop from being optimized away.
+  std::stringstream ss;
+  ss << result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
 void BM_NewhallApproximation(
     benchmark::State& state) {  // NOLINT(runtime/references)
   int const degree = state.range_x();
@@ -251,6 +411,14 @@ BENCHMARK(BM_EvaluateVectorDouble)->
     Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
 BENCHMARK(BM_EvaluateDisplacement)->
     Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
+BENCHMARK(BM_EvaluateDisplacementAndDerivative)->
+    Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
+BENCHMARK(BM_EvaluateDisplacementWithDerivative)->
+    Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
+BENCHMARK(BM_EvaluateDisplacementScattered)->
+    Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
+BENCHMARK(BM_EvaluateDisplacementContiguous)->
+    Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
 BENCHMARK(BM_NewhallApproximation)->
     Arg(4)->Arg(8)->Arg(16);
 
@@ -109,6 +109,11 @@ EmbeddedExplicitRungeKuttaNyströmIntegrator<Position,
   }
   CHECK_GT(adaptive_step_size.safety_factor, 0);
   CHECK_LT(adaptive_step_size.safety_factor, 1);
+  // The dense output uses the acceleration at the end of the step, which is
+  // only computed by FSAL methods.
+  bool const has_dense_output =
+      problem.append_dense_output || !problem.events.empty();
+  CHECK(first_same_as_last || !has_dense_output);
 
   typename ODE::SystemState current_state = *problem.initial_state;
 
@@ -143,6 +148,20 @@ EmbeddedExplicitRungeKuttaNyströmIntegrator<Position,
     g_stage.resize(dimension);
   }
 
+  // The positions and velocities at the beginning and end of the step, for the
+  // dense output.
+  std::vector<Position> q_initial;
+  std::vector<Velocity> v_initial;
+  std::vector<Position> q_final;
+  std::vector<Velocity> v_final;
+  if (has_dense_output) {
+    q_initial.resize(dimension);
+    v_initial.resize(dimension);
+    q_final.resize(dimension);
+    v_final.resize(dimension);
+  }
+  EventLocator<ODE> event_locator(problem.events, current_state);
+
   bool at_end = false;
   double tolerance_to_error_ratio;
 
@@ -224,6 +243,14 @@ EmbeddedExplicitRungeKuttaNyströmIntegrator<Position,
           adaptive_step_size.tolerance_to_error_ratio(h, error_estimate);
     } while (tolerance_to_error_ratio < 1.0);
 
+    Instant const t_initial = t.value;
+    if (has_dense_output) {
+      for (int k = 0; k < dimension; ++k) {
+        q_initial[k] = q_hat[k].value;
+        v_initial[k] = v_hat[k].value;
+      }
+    }
+
     if (first_same_as_last) {
       using std::swap;
       swap(g.front(), g.back());
@@ -236,6 +263,21 @@ EmbeddedExplicitRungeKuttaNyströmIntegrator<Position,
       q_hat[k].Increment(Δq_hat[k]);
       v_hat[k].Increment(Δv_hat[k]);
     }
+    if (has_dense_output) {
+      for (int k = 0; k < dimension; ++k) {
+        q_final[k] = q_hat[k].value;
+        v_final[k] = v_hat[k].value;
+      }
+      // Because of FSAL, the last stage was evaluated at the end of the step,
+      // and the accelerations were swapped above.
+      typename ODE::DenseOutput const dense_output(
+          t_initial, q_initial, v_initial, g.back(),
+          t.value, q_final, v_final, g.front());
+      if (problem.append_dense_output) {
+        problem.append_dense_output(dense_output);
+      }
+      event_locator.LocateEvents(dense_output);
+    }
     problem.append_state(current_state);
     ++step_count;
     if (step_count == adaptive_step_size.max_steps && !at_end) {
@@ -8,6 +8,7 @@
 #include "glog/logging.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "numerics/hermite3.hpp"
 #include "quantities/si.hpp"
 #include "testing_utilities/almost_equals.hpp"
 #include "testing_utilities/integration.hpp"
@@ -15,6 +16,7 @@
 
 namespace principia {
 
+using numerics::Hermite3;
 using quantities::Abs;
 using quantities::AngularFrequency;
 using quantities::Length;
@@ -234,6 +236,152 @@ TEST_F(EmbeddedExplicitRungeKuttaNyströmIntegratorTest,
   }
 }
 
+TEST_F(EmbeddedExplicitRungeKuttaNyströmIntegratorTest, DenseOutput) {
+  AdaptiveStepSizeIntegrator<ODE> const& integrator =
+      DormandElMikkawyPrince1986RKN434FM<Length>();
+  Length const x_initial = 1 * Metre;
+  Speed const v_initial = 0 * Metre / Second;
+  Time const period = 2 * π * Second;
+  Instant const t_initial;
+  Instant const t_final = t_initial + 10 * period;
+  Length const length_tolerance = 1 * Milli(Metre);
+  Speed const speed_tolerance = 1 * Milli(Metre) / Second;
+
+  int evaluations = 0;
+  auto const step_size_callback = [](bool tolerable) {};
+
+  // The largest difference between the interpolated solution and the exact
+  // solution starting from the beginning of the step, and the same for a cubic
+  // Hermite interpolation, which doesn't use the accelerations.
+  Length max_error;
+  Length max_cubic_error;
+  int dense_outputs = 0;
+  ODE harmonic_oscillator;
+  harmonic_oscillator.compute_acceleration =
+      std::bind(ComputeHarmonicOscillatorAcceleration,
+                _1, _2, _3, &evaluations);
+  IntegrationProblem<ODE> problem;
+  problem.equation = harmonic_oscillator;
+  ODE::SystemState const initial_state = {{x_initial}, {v_initial}, t_initial};
+  problem.initial_state = &initial_state;
+  problem.t_final = t_final;
+  problem.append_state = [](ODE::SystemState const& state) {};
+  problem.append_dense_output = [&dense_outputs, &max_error, &max_cubic_error](
+                                    ODE::DenseOutput const& dense_output) {
+    ++dense_outputs;
+    std::vector<Length> q0;
+    std::vector<Length> q1;
+    std::vector<Speed> v0;
+    std::vector<Speed> v1;
+    dense_output.Evaluate(dense_output.t0(), &q0, &v0);
+    dense_output.Evaluate(dense_output.t1(), &q1, &v1);
+    Hermite3<Instant, Length> const cubic({dense_output.t0(), dense_output.t1()},
+                                          {q0[0], q1[0]},
+                                          {v0[0], v1[0]});
+    std::vector<Length> positions;
+    std::vector<Speed> velocities;
+    for (double λ = 0.125; λ < 1; λ += 0.125) {
+      Time const τ = λ * (dense_output.t1() - dense_output.t0());
+      Instant const t = dense_output.t0() + τ;
+      Length const x = q0[0] * Cos(τ * Radian / Second) +
+                       v0[0] * Sin(τ * Radian / Second) * Second;
+      dense_output.Evaluate(t, &positions, &velocities);
+      max_error = std::max(max_error, AbsoluteError(x, positions[0]));
+      max_cubic_error =
+          std::max(max_cubic_error, AbsoluteError(x, cubic.Evaluate(t)));
+    }
+  };
+  AdaptiveStepSize<ODE> adaptive_step_size;
+  adaptive_step_size.first_time_step = t_final - t_initial;
+  adaptive_step_size.safety_factor = 0.9;
+  adaptive_step_size.tolerance_to_error_ratio =
+      std::bind(HarmonicOscillatorToleranceRatio,
+                _1, _2, length_tolerance, speed_tolerance, step_size_callback);
+
+  auto outcome = integrator.Solve(problem, adaptive_step_size);
+  EXPECT_EQ(TerminationCondition::Done, outcome);
+  // One dense output per step, and no additional evaluations.
+  EXPECT_EQ(132, dense_outputs);
+  EXPECT_EQ(2 * 4 + (132 - 1 + 3) * 3, evaluations);
+  // The quintic interpolation is much better than the tolerance, and than a
+  // cubic interpolation.
+  EXPECT_THAT(max_error, AllOf(Ge(1e-5 * Metre), Le(2e-5 * Metre)));
+  EXPECT_THAT(max_cubic_error, AllOf(Ge(1e-4 * Metre), Le(2e-4 * Metre)));
+}
+
+TEST_F(EmbeddedExplicitRungeKuttaNyströmIntegratorTest, Events) {
+  AdaptiveStepSizeIntegrator<ODE> const& integrator =
+      DormandElMikkawyPrince1986RKN434FM<Length>();
+  Length const x_initial = 1 * Metre;
+  Speed const v_initial = 0 * Metre / Second;
+  Time const period = 2 * π * Second;
+  Instant const t_initial;
+  Instant const t_final = t_initial + 10 * period;
+  Length const length_tolerance = 1 * Milli(Metre);
+  Speed const speed_tolerance = 1 * Milli(Metre) / Second;
+
+  int evaluations = 0;
+  auto const step_size_callback = [](bool tolerable) {};
+
+  // The zeros of the position, which occur at π/2 + kπ, and the time of the
+  // last appended state, which must precede them.
+  std::vector<Instant> zeros;
+  Instant last_appended_time = t_initial;
+  Length max_residual;
+  Time max_error;
+  ODE harmonic_oscillator;
+  harmonic_oscillator.compute_acceleration =
+      std::bind(ComputeHarmonicOscillatorAcceleration,
+                _1, _2, _3, &evaluations);
+  IntegrationProblem<ODE> problem;
+  problem.equation = harmonic_oscillator;
+  ODE::SystemState const initial_state = {{x_initial}, {v_initial}, t_initial};
+  problem.initial_state = &initial_state;
+  problem.t_final = t_final;
+  problem.append_state = [&last_appended_time](ODE::SystemState const& state) {
+    last_appended_time = state.time.value;
+  };
+  ODE::Event zero;
+  zero.function = [](Instant const& t,
+                     std::vector<Length> const& positions,
+                     std::vector<Speed> const& velocities) {
+    return positions[0] / Metre;
+  };
+  zero.on_event = [&last_appended_time, &max_error, &max_residual, &zeros,
+                   t_initial](
+                      Instant const& t,
+                      std::vector<Length> const& positions,
+                      std::vector<Speed> const& velocities,
+                      Sign const& sign) {
+    EXPECT_LT(last_appended_time, t);
+    // The position decreases through its even-numbered zeros.
+    EXPECT_EQ(zeros.size() % 2 == 0, sign.Negative());
+    EXPECT_EQ(sign, Sign(velocities[0]));
+    max_residual = std::max(max_residual, Abs(positions[0]));
+    Instant const expected_time =
+        t_initial + (π / 2 + zeros.size() * π) * Second;
+    max_error = std::max(max_error, AbsoluteError(expected_time, t));
+    zeros.push_back(t);
+  };
+  problem.events = {zero};
+  AdaptiveStepSize<ODE> adaptive_step_size;
+  adaptive_step_size.first_time_step = t_final - t_initial;
+  adaptive_step_size.safety_factor = 0.9;
+  adaptive_step_size.tolerance_to_error_ratio =
+      std::bind(HarmonicOscillatorToleranceRatio,
+                _1, _2, length_tolerance, speed_tolerance, step_size_callback);
+
+  auto outcome = integrator.Solve(problem, adaptive_step_size);
+  EXPECT_EQ(TerminationCondition::Done, outcome);
+  EXPECT_EQ(20, zeros.size());
+  // The events don't require any additional evaluations.
+  EXPECT_EQ(2 * 4 + (132 - 1 + 3) * 3, evaluations);
+  // The events are zeros of the dense output to within one ULP of the time,
+  // so their accuracy is limited by that of the solution.
+  EXPECT_THAT(max_residual, Lt(1e-13 * Metre));
+  EXPECT_THAT(max_error, AllOf(Ge(2e-3 * Second), Le(3e-3 * Second)));
+}
+
 TEST_F(EmbeddedExplicitRungeKuttaNyströmIntegratorTest, Singularity) {
   // Integrating the position of an ideal rocket,
   //   x"(t) = m' I_sp / m(t),
@@ -9,6 +9,7 @@
 
 #include "base/not_null.hpp"
 #include "geometry/named_quantities.hpp"
+#include "geometry/sign.hpp"
 #include "numerics/double_precision.hpp"
 #include "quantities/named_quantities.hpp"
 #include "serialization/integrators.pb.h"
@@ -17,6 +18,7 @@ namespace principia {
 
 using base::not_null;
 using geometry::Instant;
+using geometry::Sign;
 using numerics::DoublePrecision;
 using quantities::Time;
 using quantities::Variation;
@@ -56,6 +58,62 @@ struct SpecialSecondOrderDifferentialEquation {
     std::vector<Velocity> velocity_error;
   };
 
+  // An interpolant of the solution over an accepted step from t₀ to t₁ (with
+  // t₁ < t₀ when integrating backward), built from the positions, velocities
+  // and accelerations at both ends of the step: each coordinate is approximated
+  // by the quintic Hermite polynomial matching these values.  Its local error
+  // is O(h⁶), so it doesn't degrade the solution of integrators of order at
+  // most 5.  It is exact at t₀ and t₁.  The vectors are not owned and must
+  // outlive this object.
+  class DenseOutput {
+   public:
+    DenseOutput(Instant const& t0,
+                std::vector<Position> const& positions0,
+                std::vector<Velocity> const& velocities0,
+                std::vector<Acceleration> const& accelerations0,
+                Instant const& t1,
+                std::vector<Position> const& positions1,
+                std::vector<Velocity> const& velocities1,
+                std::vector<Acceleration> const& accelerations1);
+
+    Instant const& t0() const;
+    Instant const& t1() const;
+
+    // The accelerations at t₀ and t₁.
+    std::vector<Acceleration> const& accelerations0() const;
+    std::vector<Acceleration> const& accelerations1() const;
+
+    // Sets |*positions| and |*velocities| to the interpolated solution at |t|,
+    // which must be between t₀ and t₁.
+    void Evaluate(Instant const& t,
+                  not_null<std::vector<Position>*> const positions,
+                  not_null<std::vector<Velocity>*> const velocities) const;
+
+   private:
+    Instant const t0_;
+    not_null<std::vector<Position> const*> const positions0_;
+    not_null<std::vector<Velocity> const*> const velocities0_;
+    not_null<std::vector<Acceleration> const*> const accelerations0_;
+    Instant const t1_;
+    not_null<std::vector<Position> const*> const positions1_;
+    not_null<std::vector<Velocity> const*> const velocities1_;
+    not_null<std::vector<Acceleration> const*> const accelerations1_;
+  };
+
+  // An event occurs when the value of |function| along the solution changes
+  // sign.  Only the sign of |function| matters.  When an event occurs,
+  // |on_event| is called with the (interpolated) solution at the time of the
+  // event and with the sign of |function| after the event.
+  struct Event {
+    std::function<double(Instant const& t,
+                         std::vector<Position> const& positions,
+                         std::vector<Velocity> const& velocities)> function;
+    std::function<void(Instant const& t,
+                       std::vector<Position> const& positions,
+                       std::vector<Velocity> const& velocities,
+                       Sign const& sign)> on_event;
+  };
+
   // A functor that computes f(q, t) and stores it in |*accelerations|.
   // This functor must be called with |accelerations->size()| equal to
   // |positions->size()|, but there is no requirement on the values in
@@ -71,6 +129,40 @@ struct IntegrationProblem {
   typename ODE::SystemState const* initial_state;
   Instant t_final;
   std::function<void(typename ODE::SystemState const& state)> append_state;
+  // Optional.  If set, integrators that support dense output call it for each
+  // accepted step, just before calling |append_state| for the end of that
+  // step.  The |dense_output| is only valid during the call.
+  std::function<void(typename ODE::DenseOutput const& dense_output)>
+      append_dense_output;
+  // Optional.  Integrators that support dense output locate these events in
+  // each accepted step, see |EventLocator|, after calling
+  // |append_dense_output| and before calling |append_state| for the end of
+  // that step.
+  std::vector<typename ODE::Event> events;
+};
+
+// A helper for the integrators that support dense output.  The events are
+// located by bisection on the dense output, so the times of the events are
+// accurate to the order of the dense output; within a step, only an odd number
+// of sign changes of a function is detected.
+template<typename ODE>
+class EventLocator {
+ public:
+  // |events| must outlive this object.
+  EventLocator(std::vector<typename ODE::Event> const& events,
+               typename ODE::SystemState const& initial_state);
+
+  // Calls the |on_event| of the events that occur in the step described by
+  // |dense_output|, in the order of their times along the integration.
+  void LocateEvents(typename ODE::DenseOutput const& dense_output);
+
+ private:
+  std::vector<typename ODE::Event> const& events_;
+  // The signs of the functions of the |events_| at the end of the last step.
+  std::vector<Sign> signs_;
+  // Scratch space for the evaluation of the dense output.
+  std::vector<typename ODE::Position> positions_;
+  std::vector<typename ODE::Velocity> velocities_;
 };
 
 // Settings for for adaptive step size integration.
@@ -1,14 +1,103 @@
 ﻿
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
 #include "base/macros.hpp"
 #include "integrators/embedded_explicit_runge_kutta_nyström_integrator.hpp"
 #include "integrators/ordinary_differential_equations.hpp"
 #include "integrators/symplectic_runge_kutta_nyström_integrator.hpp"
+#include "numerics/hermite5.hpp"
+#include "numerics/root_finders.hpp"
 
 namespace principia {
+
+using numerics::Bisect;
+using numerics::Hermite5;
+
 namespace integrators {
 
+template<typename Position>
+SpecialSecondOrderDifferentialEquation<Position>::DenseOutput::DenseOutput(
+    Instant const& t0,
+    std::vector<Position> const& positions0,
+    std::vector<Velocity> const& velocities0,
+    std::vector<Acceleration> const& accelerations0,
+    Instant const& t1,
+    std::vector<Position> const& positions1,
+    std::vector<Velocity> const& velocities1,
+    std::vector<Acceleration> const& accelerations1)
+    : t0_(t0),
+      positions0_(&positions0),
+      velocities0_(&velocities0),
+      accelerations0_(&accelerations0),
+      t1_(t1),
+      positions1_(&positions1),
+      velocities1_(&velocities1),
+      accelerations1_(&accelerations1) {
+  CHECK_NE(t0_, t1_);
+}
+
+template<typename Position>
+Instant const&
+SpecialSecondOrderDifferentialEquation<Position>::DenseOutput::t0() const {
+  return t0_;
+}
+
+template<typename Position>
+Instant const&
+SpecialSecondOrderDifferentialEquation<Position>::DenseOutput::t1() const {
+  return t1_;
+}
+
+template<typename Position>
+std::vector<typename SpecialSecondOrderDifferentialEquation<
+    Position>::Acceleration> const&
+SpecialSecondOrderDifferentialEquation<Position>::DenseOutput::accelerations0()
+    const {
+  return *accelerations0_;
+}
+
+template<typename Position>
+std::vector<typename SpecialSecondOrderDifferentialEquation<
+    Position>::Acceleration> const&
+SpecialSecondOrderDifferentialEquation<Position>::DenseOutput::accelerations1()
+    const {
+  return *accelerations1_;
+}
+
+template<typename Position>
+void SpecialSecondOrderDifferentialEquation<Position>::DenseOutput::Evaluate(
+    Instant const& t,
+    not_null<std::vector<Position>*> const positions,
+    not_null<std::vector<Velocity>*> const velocities) const {
+  CHECK_LE(std::min(t0_, t1_), t);
+  CHECK_LE(t, std::max(t0_, t1_));
+  if (t == t0_) {
+    *positions = *positions0_;
+    *velocities = *velocities0_;
+    return;
+  }
+  if (t == t1_) {
+    *positions = *positions1_;
+    *velocities = *velocities1_;
+    return;
+  }
+  int const dimension = positions0_->size();
+  positions->resize(dimension);
+  velocities->resize(dimension);
+  for (int k = 0; k < dimension; ++k) {
+    Hermite5<Instant, Position> const interpolant(
+        {t0_, t1_},
+        {(*positions0_)[k], (*positions1_)[k]},
+        {(*velocities0_)[k], (*velocities1_)[k]},
+        {(*accelerations0_)[k], (*accelerations1_)[k]});
+    (*positions)[k] = interpolant.Evaluate(t);
+    (*velocities)[k] = interpolant.EvaluateDerivative(t);
+  }
+}
+
 template<typename Position>
 void
 SpecialSecondOrderDifferentialEquation<Position>::SystemState::WriteToMessage(
@@ -39,6 +128,73 @@ SpecialSecondOrderDifferentialEquation<Position>::SystemState::ReadFromMessage(
   return system_state;
 }
 
+template<typename ODE>
+EventLocator<ODE>::EventLocator(
+    std::vector<typename ODE::Event> const& events,
+    typename ODE::SystemState const& initial_state)
+    : events_(events) {
+  Instant const& t = initial_state.time.value;
+  int const dimension = initial_state.positions.size();
+  positions_.resize(dimension);
+  velocities_.resize(dimension);
+  for (int k = 0; k < dimension; ++k) {
+    positions_[k] = initial_state.positions[k].value;
+    velocities_[k] = initial_state.velocities[k].value;
+  }
+  for (auto const& event : events_) {
+    signs_.push_back(Sign(event.function(t, positions_, velocities_)));
+  }
+}
+
+template<typename ODE>
+void EventLocator<ODE>::LocateEvents(
+    typename ODE::DenseOutput const& dense_output) {
+  Instant const& t0 = dense_output.t0();
+  Instant const& t1 = dense_output.t1();
+  dense_output.Evaluate(t1, &positions_, &velocities_);
+
+  // The events that occur in this step, with their times and the signs of their
+  // functions after them.
+  struct Occurrence {
+    Instant time;
+    int index;
+    Sign sign;
+  };
+  std::vector<Occurrence> occurrences;
+  for (int i = 0; i < events_.size(); ++i) {
+    auto const& function = events_[i].function;
+    Sign const sign0 = signs_[i];
+    Sign const sign1 = Sign(function(t1, positions_, velocities_));
+    if (sign0 == sign1) {
+      continue;
+    }
+    // Bisect on the signs rather than on the values, so that a zero value is
+    // treated consistently with the computation of |sign1|.
+    auto const signed_function = [&dense_output, &function, this](
+                                     Instant const& t) -> double {
+      dense_output.Evaluate(t, &positions_, &velocities_);
+      return Sign(function(t, positions_, velocities_)) * 1.0;
+    };
+    occurrences.push_back({Bisect(signed_function, t0, t1), i, sign1});
+    signs_[i] = sign1;
+    dense_output.Evaluate(t1, &positions_, &velocities_);
+  }
+
+  Sign const integration_direction = Sign(t1 - t0);
+  std::sort(occurrences.begin(),
+            occurrences.end(),
+            [integration_direction](Occurrence const& left,
+                                    Occurrence const& right) {
+              return integration_direction * (left.time - right.time) <
+                     Time();
+            });
+  for (auto const& occurrence : occurrences) {
+    dense_output.Evaluate(occurrence.time, &positions_, &velocities_);
+    events_[occurrence.index].on_event(
+        occurrence.time, positions_, velocities_, occurrence.sign);
+  }
+}
+
 template<typename DifferentialEquation>
 FixedStepSizeIntegrator<DifferentialEquation>::FixedStepSizeIntegrator(
     serialization::FixedStepSizeIntegrator::Kind const kind) : kind_(kind) {}
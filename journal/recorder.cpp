@@ -23,12 +23,14 @@ Recorder::~Recorder() {
 
 void Recorder::Write(serialization::Method const& method) {
   CHECK_LT(0, method.ByteSize()) << method.DebugString();
-  UniqueBytes bytes(method.ByteSize());
-  method.SerializeToArray(bytes.data.get(), static_cast<int>(bytes.size));
+  std::int64_t const byte_size = method.ByteSize();
 
-  std::int64_t const hexadecimal_size = (bytes.size << 1) + 2;
+  // The method is serialized at the beginning of the buffer and encoded in
+  // place, to avoid allocating and copying a second buffer.
+  std::int64_t const hexadecimal_size = (byte_size << 1) + 2;
   UniqueBytes hexadecimal(hexadecimal_size);
-  HexadecimalEncode({bytes.data.get(), bytes.size}, hexadecimal.get());
+  method.SerializeToArray(hexadecimal.data.get(), static_cast<int>(byte_size));
+  HexadecimalEncode({hexadecimal.data.get(), byte_size}, hexadecimal.get());
   hexadecimal.data.get()[hexadecimal_size - 2] = '\n';
   hexadecimal.data.get()[hexadecimal_size - 1] = '\0';
   stream_ << hexadecimal.data.get();
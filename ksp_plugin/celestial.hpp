@@ -38,6 +38,9 @@ class Celestial {
   void set_trajectory(
       not_null<ContinuousTrajectory<Barycentric> const*> const trajectory);
   ContinuousTrajectory<Barycentric> const& trajectory() const;
+  // The returned hint is meant for evaluations at the current time.  It may be
+  // used from several threads, but threads evaluating the trajectory at other
+  // times should use their own hint.
   not_null<ContinuousTrajectory<Barycentric>::Hint*> current_time_hint() const;
   DegreesOfFreedom<Barycentric> current_degrees_of_freedom(
       Instant const& current_time) const;
@@ -1,15 +1,23 @@
 ﻿
 #include "ksp_plugin/flight_plan.hpp"
 
+#include <algorithm>
 #include <experimental/optional>
+#include <future>
+#include <iterator>
+#include <thread>
 #include <vector>
 
+#include "base/map_util.hpp"
+#include "base/thread_pool.hpp"
 #include "integrators/embedded_explicit_runge_kutta_nyström_integrator.hpp"
 #include "testing_utilities/make_not_null.hpp"
 
 namespace principia {
 
+using base::FindOrDie;
 using base::make_not_null_unique;
+using base::ThreadPool;
 using integrators::DormandElMikkawyPrince1986RKN434FM;
 using quantities::si::Metre;
 using quantities::si::Second;
@@ -38,6 +46,7 @@ FlightPlan::FlightPlan(
 
   // Create a fork for the first coasting trajectory.
   segments_.emplace_back(root_->NewForkWithoutCopy(initial_time_));
+  segments_events_.push_back(NewSegmentEvents());
   CoastLastSegment(desired_final_time_);
 }
 
@@ -70,10 +79,14 @@ bool FlightPlan::Append(Burn burn) {
           manœuvres_.empty() ? initial_mass_ : manœuvres_.back().final_mass());
   if (manœuvre.FitsBetween(start_of_last_coast(), desired_final_time_) &&
       !manœuvre.IsSingular()) {
+    SegmentEvents recomputed_last_coast_events;
     DiscreteTrajectory<Barycentric>* recomputed_last_coast =
-        CoastIfReachesManœuvreInitialTime(last_coast(), manœuvre);
+        CoastIfReachesManœuvreInitialTime(last_coast(),
+                                          manœuvre,
+                                          &recomputed_last_coast_events);
     if (recomputed_last_coast != nullptr) {
-      ReplaceLastSegment(recomputed_last_coast);
+      ReplaceLastSegment(recomputed_last_coast,
+                         std::move(recomputed_last_coast_events));
       Append(std::move(manœuvre));
       return true;
     }
@@ -110,6 +123,11 @@ void FlightPlan::ForgetBefore(Instant const& time,
   // to keep.
   segments_.erase(segments_.cbegin(),
                   segments_.cbegin() + *first_to_keep);
+  segments_events_.erase(segments_events_.begin(),
+                         segments_events_.begin() + *first_to_keep);
+  for (auto const& pair : segments_events_.front()) {
+    pair.second->ForgetBefore(time);
+  }
   // For some reason manœuvres_.erase() doesn't work because it wants to
   // copy, hence this dance.
   std::vector<NavigationManœuvre> m;
@@ -134,22 +152,132 @@ void FlightPlan::RemoveLast() {
 
 bool FlightPlan::ReplaceLast(Burn burn) {
   CHECK(!manœuvres_.empty());
-  auto manœuvre = MakeNavigationManœuvre(std::move(burn),
-                                         manœuvres_.back().initial_mass());
-  if (manœuvre.FitsBetween(start_of_penultimate_coast(), desired_final_time_) &&
-      !manœuvre.IsSingular()) {
-    DiscreteTrajectory<Barycentric>* recomputed_penultimate_coast =
-        CoastIfReachesManœuvreInitialTime(penultimate_coast(), manœuvre);
-    if (recomputed_penultimate_coast != nullptr) {
-      manœuvres_.pop_back();
-      PopLastSegment();  // Last coast.
-      PopLastSegment();  // Last burn.
-      ReplaceLastSegment(recomputed_penultimate_coast);
-      Append(std::move(manœuvre));
-      return true;
+  return Replace(std::move(burn), manœuvres_.size() - 1);
+}
+
+std::vector<std::experimental::optional<FlightPlan::FinalState>>
+FlightPlan::EvaluateReplacementsOfLast(std::vector<Burn> burns) const {
+  CHECK(!manœuvres_.empty());
+  if (burns.empty()) {
+    return {};
+  }
+  // The penultimate coast is the antepenultimate segment.
+  auto const penultimate_coast_fork = segments_[segments_.size() - 3]->Fork();
+  Instant const start_of_penultimate_coast = this->start_of_penultimate_coast();
+  Mass const initial_mass = manœuvres_.back().initial_mass();
+
+  // Same as |ReplaceLast| followed by |actual_final_time|, but the segments are
+  // not forks of |segments_|, so that the evaluations don't race.
+  auto const evaluate = [this,
+                         &penultimate_coast_fork,
+                         &start_of_penultimate_coast,
+                         &initial_mass](
+      Burn& burn) -> std::experimental::optional<FinalState> {
+    auto manœuvre = MakeNavigationManœuvre(std::move(burn), initial_mass);
+    if (!manœuvre.FitsBetween(start_of_penultimate_coast,
+                              desired_final_time_) ||
+        manœuvre.IsSingular()) {
+      return std::experimental::nullopt;
+    }
+    DiscreteTrajectory<Barycentric> trajectory;
+    trajectory.Append(penultimate_coast_fork.time(),
+                      penultimate_coast_fork.degrees_of_freedom());
+    if (!ephemeris_->FlowWithAdaptiveStep(
+             &trajectory,
+             Ephemeris<Barycentric>::NoIntrinsicAcceleration,
+             manœuvre.initial_time(),
+             adaptive_step_parameters_,
+             max_ephemeris_steps_per_frame)) {
+      return std::experimental::nullopt;
+    }
+    manœuvre.set_coasting_trajectory(&trajectory);
+    bool reached_final_time = true;
+    if (manœuvre.initial_time() < manœuvre.final_time()) {
+      reached_final_time = ephemeris_->FlowWithAdaptiveStep(
+                               &trajectory,
+                               manœuvre.IntrinsicAcceleration(),
+                               manœuvre.final_time(),
+                               adaptive_step_parameters_,
+                               max_ephemeris_steps_per_frame);
     }
+    if (reached_final_time) {
+      ephemeris_->FlowWithAdaptiveStep(
+          &trajectory,
+          Ephemeris<Barycentric>::NoIntrinsicAcceleration,
+          desired_final_time_,
+          adaptive_step_parameters_,
+          max_ephemeris_steps_per_frame);
+    }
+    auto const last = trajectory.last();
+    return FinalState{last.time(),
+                      last.degrees_of_freedom(),
+                      manœuvre.final_mass()};
+  };
+
+  if (evaluation_pool_ == nullptr) {
+    evaluation_pool_ =
+        std::make_unique<ThreadPool<std::experimental::optional<FinalState>>>(
+            std::max<std::int64_t>(1, std::thread::hardware_concurrency()));
+  }
+  std::vector<std::future<std::experimental::optional<FinalState>>> futures;
+  for (auto& burn : burns) {
+    futures.push_back(evaluation_pool_->Add([&evaluate, &burn]() {
+      return evaluate(burn);
+    }));
+  }
+  std::vector<std::experimental::optional<FinalState>> final_states;
+  for (auto& future : futures) {
+    final_states.push_back(future.get());
+  }
+  return final_states;
+}
+
+bool FlightPlan::Replace(Burn burn, int const index) {
+  CHECK_LE(0, index);
+  CHECK_LT(index, number_of_manœuvres());
+
+  // Build the new manœuvres, propagating the change of mass to the ones that
+  // follow |index|.
+  std::vector<NavigationManœuvre> manœuvres;
+  manœuvres.push_back(MakeNavigationManœuvre(std::move(burn),
+                                             manœuvres_[index].initial_mass()));
+  for (int i = index + 1; i < manœuvres_.size(); ++i) {
+    manœuvres.emplace_back(manœuvres_[i], manœuvres.back().final_mass());
+  }
+  Instant start_of_coast = index == 0 ? initial_time_
+                                      : manœuvres_[index - 1].final_time();
+  for (auto const& manœuvre : manœuvres) {
+    if (!manœuvre.FitsBetween(start_of_coast, desired_final_time_) ||
+        manœuvre.IsSingular()) {
+      return false;
+    }
+    start_of_coast = manœuvre.final_time();
+  }
+
+  // Exchanges |manœuvres| with the manœuvres of |manœuvres_| starting at
+  // |index|.  Manœuvres are not assignable, hence this dance.
+  auto const exchange = [this, index, &manœuvres]() {
+    std::vector<NavigationManœuvre> m;
+    std::move(manœuvres_.begin(),
+              manœuvres_.begin() + index,
+              std::back_inserter(m));
+    std::move(manœuvres.begin(), manœuvres.end(), std::back_inserter(m));
+    manœuvres.clear();
+    std::move(manœuvres_.begin() + index,
+              manœuvres_.end(),
+              std::back_inserter(manœuvres));
+    manœuvres_.swap(m);
+  };
+
+  exchange();
+  if (RecomputeSegments(index)) {
+    return true;
+  } else {
+    // If the recomputation fails, leave this place as clean as we found it.
+    exchange();
+    CHECK(RecomputeSegments(index));
+    return false;
   }
-  return false;
 }
 
 bool FlightPlan::SetDesiredFinalTime(Instant const& desired_final_time) {
@@ -171,6 +299,11 @@ FlightPlan::adaptive_step_parameters() const {
 bool FlightPlan::SetAdaptiveStepParameters(
     Ephemeris<Barycentric>::AdaptiveStepParameters const&
         adaptive_step_parameters) {
+  // The adapter sets the parameters whenever the user touches them, so don't
+  // recompute the trajectories if nothing changed.
+  if (adaptive_step_parameters == adaptive_step_parameters_) {
+    return true;
+  }
   auto const original_adaptive_step_parameters = adaptive_step_parameters_;
   adaptive_step_parameters_ = adaptive_step_parameters;
   if (RecomputeSegments()) {
@@ -205,6 +338,19 @@ void FlightPlan::GetAllSegments(
   CHECK(*begin != *end);
 }
 
+Ephemeris<Barycentric>::Events const& FlightPlan::GetSegmentEvents(
+    int const index,
+    not_null<MassiveBody const*> const body) {
+  CHECK_LE(0, index);
+  CHECK_LT(index, number_of_segments());
+  if (events_bodies_.insert(body).second) {
+    // The events relative to |body| are only found by recomputing the
+    // segments, which yields the same segments as before.
+    CHECK(RecomputeSegments());
+  }
+  return *FindOrDie(segments_events_[index], body);
+}
+
 void FlightPlan::WriteToMessage(
     not_null<serialization::FlightPlan*> const message) const {
   initial_mass_.WriteToMessage(message->mutable_initial_mass());
@@ -273,6 +419,8 @@ std::unique_ptr<FlightPlan> FlightPlan::ReadFromMessage(
       flight_plan->segments_.emplace_back(
           DiscreteTrajectory<Barycentric>::ReadPointerFromMessage(
               segment, root));
+      flight_plan->segments_events_.push_back(
+          flight_plan->NewSegmentEvents());
     }
     for (int i = 0; i < message.manoeuvre_size(); ++i) {
       auto const& manoeuvre = message.manoeuvre(i);
@@ -326,14 +474,17 @@ void FlightPlan::Append(NavigationManœuvre manœuvre) {
   }
 }
 
-bool FlightPlan::RecomputeSegments() {
+bool FlightPlan::RecomputeSegments(int const first_manœuvre) {
+  CHECK_LE(0, first_manœuvre);
+  CHECK_LE(first_manœuvre, number_of_manœuvres());
   // It is important that the segments be destroyed in (reverse chronological)
   // order of the forks.
-  while (segments_.size() > 1) {
+  while (segments_.size() > 2 * first_manœuvre + 1) {
     PopLastSegment();
   }
   ResetLastSegment();
-  for (auto& manœuvre : manœuvres_) {
+  for (int i = first_manœuvre; i < manœuvres_.size(); ++i) {
+    NavigationManœuvre& manœuvre = manœuvres_[i];
     CoastLastSegment(manœuvre.initial_time());
     manœuvre.set_coasting_trajectory(segments_.back());
     AddSegment();
@@ -353,7 +504,8 @@ void FlightPlan::BurnLastSegment(NavigationManœuvre const& manœuvre) {
                                          manœuvre.IntrinsicAcceleration(),
                                          manœuvre.final_time(),
                                          adaptive_step_parameters_,
-                                         max_ephemeris_steps_per_frame);
+                                         max_ephemeris_steps_per_frame,
+                                         LastSegmentEvents());
     if (!reached_desired_final_time) {
       anomalous_segments_ = 1;
     }
@@ -370,7 +522,8 @@ void FlightPlan::CoastLastSegment(Instant const& desired_final_time) {
                         Ephemeris<Barycentric>::NoIntrinsicAcceleration,
                         desired_final_time,
                         adaptive_step_parameters_,
-                        max_ephemeris_steps_per_frame);
+                        max_ephemeris_steps_per_frame,
+                        LastSegmentEvents());
     if (!reached_desired_final_time) {
       anomalous_segments_ = 1;
     }
@@ -378,7 +531,8 @@ void FlightPlan::CoastLastSegment(Instant const& desired_final_time) {
 }
 
 void FlightPlan::ReplaceLastSegment(
-    not_null<DiscreteTrajectory<Barycentric>*> const segment) {
+    not_null<DiscreteTrajectory<Barycentric>*> const segment,
+    SegmentEvents events) {
   CHECK_EQ(segment->parent(), segments_.back()->parent());
   CHECK_EQ(segment->Fork().time(), segments_.back()->Fork().time());
   PopLastSegment();
@@ -386,10 +540,12 @@ void FlightPlan::ReplaceLastSegment(
   // segment.
   CHECK_EQ(0, anomalous_segments_);
   segments_.emplace_back(segment);
+  segments_events_.push_back(std::move(events));
 }
 
 void FlightPlan::AddSegment() {
   segments_.emplace_back(segments_.back()->NewForkAtLast());
+  segments_events_.push_back(NewSegmentEvents());
   if (anomalous_segments_ > 0) {
     ++anomalous_segments_;
   }
@@ -397,6 +553,7 @@ void FlightPlan::AddSegment() {
 
 void FlightPlan::ResetLastSegment() {
   segments_.back()->ForgetAfter(segments_.back()->Fork().time());
+  segments_events_.back() = NewSegmentEvents();
   if (anomalous_segments_ == 1) {
     // If there was one anomalous segment, it was the last one, which was
     // anomalous because it ended early.  It is no longer anomalous.
@@ -409,6 +566,7 @@ void FlightPlan::PopLastSegment() {
   CHECK(!trajectory->is_root());
   trajectory->parent()->DeleteFork(&trajectory);
   segments_.pop_back();
+  segments_events_.pop_back();
   if (anomalous_segments_ > 0) {
     --anomalous_segments_;
   }
@@ -416,22 +574,47 @@ void FlightPlan::PopLastSegment() {
 
 DiscreteTrajectory<Barycentric>* FlightPlan::CoastIfReachesManœuvreInitialTime(
     DiscreteTrajectory<Barycentric>& coast,
-    NavigationManœuvre const& manœuvre) {
+    NavigationManœuvre const& manœuvre,
+    not_null<SegmentEvents*> const events) {
   DiscreteTrajectory<Barycentric>* recomputed_coast =
       coast.parent()->NewForkWithoutCopy(coast.Fork().time());
+  *events = NewSegmentEvents();
+  std::vector<not_null<Ephemeris<Barycentric>::Events*>> events_to_record;
+  for (auto const& pair : *events) {
+    events_to_record.push_back(pair.second.get());
+  }
   bool const reached_manœuvre_initial_time =
       ephemeris_->FlowWithAdaptiveStep(
           recomputed_coast,
           Ephemeris<Barycentric>::NoIntrinsicAcceleration,
           manœuvre.initial_time(),
           adaptive_step_parameters_,
-          max_ephemeris_steps_per_frame);
+          max_ephemeris_steps_per_frame,
+          events_to_record);
   if (!reached_manœuvre_initial_time) {
     recomputed_coast->parent()->DeleteFork(&recomputed_coast);
   }
   return recomputed_coast;
 }
 
+FlightPlan::SegmentEvents FlightPlan::NewSegmentEvents() const {
+  SegmentEvents events;
+  for (not_null<MassiveBody const*> const body : events_bodies_) {
+    events.emplace(
+        body, make_not_null_unique<Ephemeris<Barycentric>::Events>(body));
+  }
+  return events;
+}
+
+std::vector<not_null<Ephemeris<Barycentric>::Events*>>
+FlightPlan::LastSegmentEvents() {
+  std::vector<not_null<Ephemeris<Barycentric>::Events*>> events;
+  for (auto const& pair : segments_events_.back()) {
+    events.push_back(pair.second.get());
+  }
+  return events;
+}
+
 Instant FlightPlan::start_of_last_coast() const {
   return manœuvres_.empty() ? initial_time_ : manœuvres_.back().final_time();
 }
@@ -447,10 +630,5 @@ DiscreteTrajectory<Barycentric>& FlightPlan::last_coast() {
   return *segments_.back();
 }
 
-DiscreteTrajectory<Barycentric>& FlightPlan::penultimate_coast() {
-  // The penultimate coast is the antepenultimate segment.
-  return *segments_[segments_.size() - 3];
-}
-
 }  // namespace ksp_plugin
 }  // namespace principia
@@ -1,9 +1,14 @@
 ﻿
 #pragma once
 
+#include <experimental/optional>
+#include <map>
+#include <memory>
+#include <set>
 #include <vector>
 
 #include "base/not_null.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/named_quantities.hpp"
 #include "integrators/ordinary_differential_equations.hpp"
 #include "ksp_plugin/burn.hpp"
@@ -12,6 +17,7 @@
 #include "physics/degrees_of_freedom.hpp"
 #include "physics/discrete_trajectory.hpp"
 #include "physics/ephemeris.hpp"
+#include "physics/massive_body.hpp"
 #include "quantities/named_quantities.hpp"
 #include "quantities/quantities.hpp"
 #include "serialization/ksp_plugin.pb.h"
@@ -24,6 +30,7 @@ using integrators::AdaptiveStepSizeIntegrator;
 using physics::DegreesOfFreedom;
 using physics::DiscreteTrajectory;
 using physics::Ephemeris;
+using physics::MassiveBody;
 using quantities::Length;
 using quantities::Mass;
 using quantities::Speed;
@@ -34,6 +41,14 @@ namespace ksp_plugin {
 // the corresponding |NavigationManœuvre|s.
 class FlightPlan {
  public:
+  // The end of the flight plan that would result from replacing the last
+  // manœuvre, see |EvaluateReplacementsOfLast|.
+  struct FinalState {
+    Instant time;
+    DegreesOfFreedom<Barycentric> degrees_of_freedom;
+    Mass mass;
+  };
+
   // Creates a |FlightPlan| with no burns starting at |initial_time| with
   // |initial_degrees_of_freedom| and with the given |initial_mass|.  The
   // trajectories are computed using the given |integrator| in the given
@@ -73,6 +88,23 @@ class FlightPlan {
   // |size()| must be greater than 0.
   virtual bool ReplaceLast(Burn burn);
 
+  // |size()| must be greater than 0.  Returns, for each of the |burns|, the
+  // final state that |ReplaceLast| would produce, or nothing if it would
+  // return false; the |time| of the final state is |actual_final_time()|.  The
+  // candidates are integrated concurrently on separate trajectories starting at
+  // the beginning of the penultimate coast.  This object is not modified.
+  virtual std::vector<std::experimental::optional<FinalState>>
+  EvaluateReplacementsOfLast(std::vector<Burn> burns) const;
+
+  // Replaces the manœuvre at |index| with one built from |burn|.  The
+  // manœuvres that follow keep their timing and Δv, but their masses are
+  // updated.  Only the segments starting with the coast before the replaced
+  // manœuvre are recomputed.  Returns false and has no effect if a manœuvre
+  // would not fit or would be singular, or if the recomputation would result
+  // in anomalous segments other than the last burn and coast.  |index| must be
+  // in [0, number_of_manœuvres()[.
+  virtual bool Replace(Burn burn, int const index);
+
   // Returns false and has no effect if |desired_final_time| is before the end
   // of the last manœuvre or before |initial_time_|.
   virtual bool SetDesiredFinalTime(Instant const& desired_final_time);
@@ -100,6 +132,16 @@ class FlightPlan {
       not_null<DiscreteTrajectory<Barycentric>::Iterator*> begin,
       not_null<DiscreteTrajectory<Barycentric>::Iterator*> end) const;
 
+  // |index| must be in [0, number_of_segments()[.  Returns the events of the
+  // given trajectory segment relative to |body|, see |Ephemeris::Events|.  They
+  // are recorded as the segment is computed, so they are not looked for in the
+  // segment after the fact.  The events relative to a |body| are recorded from
+  // the first call to this function with that |body| on, which recomputes all
+  // the segments.
+  virtual Ephemeris<Barycentric>::Events const& GetSegmentEvents(
+      int const index,
+      not_null<MassiveBody const*> const body);
+
   void WriteToMessage(not_null<serialization::FlightPlan*> const message) const;
 
   // This may return a null pointer if the flight plan contained in the
@@ -116,15 +158,24 @@ class FlightPlan {
   FlightPlan();
 
  private:
+  // The events of a segment, indexed by the body relative to which they are
+  // recorded.
+  using SegmentEvents =
+      std::map<not_null<MassiveBody const*>,
+               not_null<std::unique_ptr<Ephemeris<Barycentric>::Events>>>;
+
   // Appends |manœuvre| to |manœuvres_|, adds a burn and a coast segment.
   // |manœuvre| must fit between |start_of_last_coast()| and
   // |desired_final_time_|, the last coast segment must end at
   // |manœuvre.initial_time()|.
   void Append(NavigationManœuvre manœuvre);
 
-  // Recomputes all trajectories in |segments_|.  Returns false if the
+  // Recomputes the trajectories in |segments_| starting with the coast that
+  // precedes |manœuvres_[first_manœuvre]|, or the last coast if
+  // |first_manœuvre| is |number_of_manœuvres()|.  The earlier segments don't
+  // depend on the later manœuvres and are kept.  Returns false if the
   // recomputation resulted in more than 2 anomalous segments.
-  bool RecomputeSegments();
+  bool RecomputeSegments(int const first_manœuvre = 0);
 
   // Flows the last segment for the duration of |manœuvre| using its intrinsic
   // acceleration.
@@ -133,11 +184,12 @@ class FlightPlan {
   // acceleration.
   void CoastLastSegment(Instant const& desired_final_time);
 
-  // Replaces the last segment with |segment|.  |segment| must be forked from
-  // the same trajectory as the last segment, and at the same time.  |segment|
-  // must not be anomalous.
+  // Replaces the last segment with |segment|, whose events are |events|.
+  // |segment| must be forked from the same trajectory as the last segment, and
+  // at the same time.  |segment| must not be anomalous.
   void ReplaceLastSegment(
-      not_null<DiscreteTrajectory<Barycentric>*> const segment);
+      not_null<DiscreteTrajectory<Barycentric>*> const segment,
+      SegmentEvents events);
 
   // Adds a trajectory to |segments_|, forked at the end of the last one.
   void AddSegment();
@@ -149,16 +201,21 @@ class FlightPlan {
 
   // If the integration of a coast from the fork of |coast| until
   // |manœuvre.initial_time()| reaches the end, returns the integrated
-  // trajectory.  Otherwise, returns null.
+  // trajectory and records its events in |events|.  Otherwise, returns null.
   DiscreteTrajectory<Barycentric>* CoastIfReachesManœuvreInitialTime(
       DiscreteTrajectory<Barycentric>& coast,
-      NavigationManœuvre const& manœuvre);
+      NavigationManœuvre const& manœuvre,
+      not_null<SegmentEvents*> const events);
+
+  // Returns empty events relative to the bodies of |events_bodies_|.
+  SegmentEvents NewSegmentEvents() const;
+  // Returns pointers to the events of the last segment, for recording them.
+  std::vector<not_null<Ephemeris<Barycentric>::Events*>> LastSegmentEvents();
 
   Instant start_of_last_coast() const;
   Instant start_of_penultimate_coast() const;
 
   DiscreteTrajectory<Barycentric>& last_coast();
-  DiscreteTrajectory<Barycentric>& penultimate_coast();
 
   Mass const initial_mass_;
   Instant initial_time_;
@@ -171,6 +228,10 @@ class FlightPlan {
   // alternate.  This simulates a stack.  Each segment is a fork of the previous
   // one.
   std::vector<not_null<DiscreteTrajectory<Barycentric>*>> segments_;
+  // The events of the |segments_|, in the same order.
+  std::vector<SegmentEvents> segments_events_;
+  // The bodies relative to which the events are recorded.
+  std::set<not_null<MassiveBody const*>> events_bodies_;
   std::vector<NavigationManœuvre> manœuvres_;
   not_null<Ephemeris<Barycentric>*> ephemeris_;
   Ephemeris<Barycentric>::AdaptiveStepParameters adaptive_step_parameters_;
@@ -181,6 +242,12 @@ class FlightPlan {
   // |anomalous_segments_| is at most 2: the penultimate coast is never
   // anomalous.
   int anomalous_segments_ = 0;
+  // Used by |EvaluateReplacementsOfLast|, which is called repeatedly while the
+  // user edits the last manœuvre.  Created on first use, so that the flight
+  // plans that are never edited don't hold threads.
+  mutable std::unique_ptr<
+      base::ThreadPool<std::experimental::optional<FinalState>>>
+      evaluation_pool_;
 };
 
 }  // namespace ksp_plugin
@@ -13,6 +13,7 @@
 #endif
 
 #include "base/array.hpp"
+#include "base/base64.hpp"
 #include "base/hexadecimal.hpp"
 #include "base/macros.hpp"
 #include "base/not_null.hpp"
@@ -32,6 +33,11 @@
 
 namespace principia {
 
+using base::Array;
+using base::Base64Decode;
+using base::Base64DecodedSize;
+using base::Base64Encode;
+using base::Base64EncodedSize;
 using base::Bytes;
 using base::HexadecimalDecode;
 using base::HexadecimalEncode;
@@ -67,6 +73,48 @@ namespace {
 int const chunk_size = 64 << 10;
 int const number_of_chunks = 8;
 
+// The encodings of the serializations exchanged with the adapter, which must
+// be text.
+char const hexadecimal_encoder[] = "hexadecimal";
+char const base64_encoder[] = "base64";
+
+// Returns the null-terminated encoding of |bytes| using |encoder|.
+UniqueBytes Encode(Bytes const bytes, std::string const& encoder) {
+  if (encoder == hexadecimal_encoder) {
+    std::int64_t const hexadecimal_size = bytes.size << 1;
+    UniqueBytes hexadecimal(hexadecimal_size + 1);
+    HexadecimalEncode(bytes, hexadecimal.get());
+    hexadecimal.data[hexadecimal_size] = '\0';
+    return hexadecimal;
+  } else if (encoder == base64_encoder) {
+    std::int64_t const base64_size = Base64EncodedSize(bytes.size);
+    UniqueBytes base64(base64_size + 1);
+    Base64Encode(bytes, base64.get());
+    base64.data[base64_size] = '\0';
+    return base64;
+  } else {
+    LOG(FATAL) << "Unknown encoder " << encoder;
+    base::noreturn();
+  }
+}
+
+// Returns the bytes encoded by |encoded| using |encoder|.
+UniqueBytes Decode(Array<std::uint8_t const> const encoded,
+                   std::string const& encoder) {
+  if (encoder == hexadecimal_encoder) {
+    UniqueBytes bytes(encoded.size >> 1);
+    HexadecimalDecode(encoded, bytes.get());
+    return bytes;
+  } else if (encoder == base64_encoder) {
+    UniqueBytes bytes(Base64DecodedSize(encoded));
+    Base64Decode(encoded, bytes.get());
+    return bytes;
+  } else {
+    LOG(FATAL) << "Unknown encoder " << encoder;
+    base::noreturn();
+  }
+}
+
 base::not_null<std::unique_ptr<MassiveBody>> MakeMassiveBody(
     BodyParameters const& body_parameters) {
   // Logging operators would dereference a null C string.
@@ -431,6 +479,21 @@ void principia__AdvanceTime(Plugin* const plugin,
   return m.Return();
 }
 
+void principia__SetNumberOfVesselThreads(Plugin* const plugin,
+                                         int const number_of_threads) {
+  journal::Method<journal::SetNumberOfVesselThreads> m({plugin,
+                                                        number_of_threads});
+  CHECK_NOTNULL(plugin)->SetNumberOfVesselThreads(number_of_threads);
+  return m.Return();
+}
+
+void principia__SetEphemerisHorizon(Plugin* const plugin,
+                                    double const horizon) {
+  journal::Method<journal::SetEphemerisHorizon> m({plugin, horizon});
+  CHECK_NOTNULL(plugin)->SetEphemerisHorizon(horizon * Second);
+  return m.Return();
+}
+
 void principia__ForgetAllHistoriesBefore(Plugin* const plugin,
                                          double const t) {
   journal::Method<journal::ForgetAllHistoriesBefore> m({plugin, t});
@@ -519,6 +582,14 @@ void principia__UpdatePrediction(Plugin const* const plugin,
   return m.Return();
 }
 
+void principia__UpdatePredictionAsynchronously(Plugin const* const plugin,
+                                               char const* const vessel_guid) {
+  journal::Method<journal::UpdatePredictionAsynchronously> m(
+      {plugin, vessel_guid});
+  CHECK_NOTNULL(plugin)->UpdatePredictionAsynchronously(vessel_guid);
+  return m.Return();
+}
+
 // Returns the result of |plugin->RenderedVesselTrajectory| called with the
 // arguments given, together with an iterator to its beginning.
 // |plugin| must not be null.  No transfer of ownership of |plugin|.  The caller
@@ -564,18 +635,16 @@ void principia__RenderedPredictionApsides(Plugin const* const plugin,
       {plugin, vessel_guid, celestial_index, sun_world_position},
       {apoapsides, periapsides});
   CHECK_NOTNULL(plugin);
-  auto const& prediction = plugin->GetVessel(vessel_guid)->prediction();
   Position<World> q_sun =
       World::origin +
       Displacement<World>(FromXYZ(sun_world_position) * Metre);
   std::unique_ptr<DiscreteTrajectory<World>> rendered_apoapsides;
   std::unique_ptr<DiscreteTrajectory<World>> rendered_periapsides;
-  plugin->ComputeAndRenderApsides(celestial_index,
-                                  prediction.Fork(),
-                                  prediction.End(),
-                                  q_sun,
-                                  rendered_apoapsides,
-                                  rendered_periapsides);
+  plugin->RenderedPredictionApsides(vessel_guid,
+                                    celestial_index,
+                                    q_sun,
+                                    rendered_apoapsides,
+                                    rendered_periapsides);
   *apoapsides = new TypedIterator<DiscreteTrajectory<World>>(
       check_not_null(std::move(rendered_apoapsides)));
   *periapsides = new TypedIterator<DiscreteTrajectory<World>>(
@@ -681,9 +750,13 @@ double principia__CurrentTime(Plugin const* const plugin) {
 // when it is null (at the end of the stream).  No transfer of ownership of
 // |*plugin|.  |*serializer| must be null on the first call and must be passed
 // unchanged to the successive calls; its ownership is not transferred.
+// |encoder| is "hexadecimal" or "base64" and must be the same for all calls;
+// base64 produces 2/3 of the characters produced by hexadecimal.  A null
+// |encoder| stands for "hexadecimal", as in the journals that predate it.
 char const* principia__SerializePlugin(Plugin const* const plugin,
-                                       PullSerializer** const serializer) {
-  journal::Method<journal::SerializePlugin> m({plugin, serializer},
+                                       PullSerializer** const serializer,
+                                       char const* const encoder) {
+  journal::Method<journal::SerializePlugin> m({plugin, serializer, encoder},
                                               {serializer});
   LOG(INFO) << __FUNCTION__;
   CHECK_NOTNULL(plugin);
@@ -692,9 +765,15 @@ char const* principia__SerializePlugin(Plugin const* const plugin,
   // Create and start a serializer if the caller didn't provide one.
   if (*serializer == nullptr) {
     *serializer = new PullSerializer(chunk_size, number_of_chunks);
-    auto message = make_not_null_unique<serialization::Plugin>();
-    plugin->WriteToMessage(message.get());
-    (*serializer)->Start(std::move(message));
+    // The message is built piece by piece on the serialization thread while
+    // the previous pieces are pulled, so it is never entirely in memory.
+    (*serializer)->Start(
+        [plugin](PullSerializer::PieceWriter const& write_piece) {
+          plugin->WriteToMessageInPieces(
+              [&write_piece](not_null<serialization::Plugin*> const piece) {
+                write_piece(*piece);
+              });
+        });
   }
 
   // Pull a chunk.
@@ -708,12 +787,10 @@ char const* principia__SerializePlugin(Plugin const* const plugin,
     return m.Return(nullptr);
   }
 
-  // Convert to hexadecimal and return to the client.
-  std::int64_t const hexadecimal_size = (bytes.size << 1) + 1;
-  UniqueBytes hexadecimal(hexadecimal_size);
-  HexadecimalEncode(bytes, hexadecimal.get());
-  hexadecimal.data.get()[hexadecimal_size - 1] = '\0';
-  return m.Return(reinterpret_cast<char const*>(hexadecimal.data.release()));
+  // Encode and return to the client.
+  UniqueBytes encoded =
+      Encode(bytes, encoder == nullptr ? hexadecimal_encoder : encoder);
+  return m.Return(reinterpret_cast<char const*>(encoded.data.release()));
 }
 
 // Deletes and nulls |*serialization|.
@@ -733,14 +810,18 @@ void principia__DeletePluginSerialization(char const** const serialization) {
 // successive calls.  The caller must perform an extra call with
 // |serialization_size| set to 0 to indicate the end of the input stream.  When
 // this last call returns, |*plugin| is not null and may be used by the caller.
+// |encoder| must be the one that was used to produce the serialization.  A null
+// |encoder| stands for "hexadecimal", as in the journals that predate it.
 void principia__DeserializePlugin(char const* const serialization,
                                   int const serialization_size,
                                   PushDeserializer** const deserializer,
-                                  Plugin const** const plugin) {
+                                  Plugin const** const plugin,
+                                  char const* const encoder) {
   journal::Method<journal::DeserializePlugin> m({serialization,
                                                  serialization_size,
                                                  deserializer,
-                                                 plugin},
+                                                 plugin,
+                                                 encoder},
                                                 {deserializer, plugin});
   LOG(INFO) << __FUNCTION__;
   CHECK_NOTNULL(serialization);
@@ -759,15 +840,15 @@ void principia__DeserializePlugin(char const* const serialization,
         });
   }
 
-  // Decode the hexadecimal representation.
-  uint8_t const* const hexadecimal =
-      reinterpret_cast<uint8_t const*>(serialization);
-  int const hexadecimal_size = serialization_size;
-  int const byte_size = hexadecimal_size >> 1;
+  // Decode the serialization.
+  UniqueBytes decoded = Decode(
+      Array<std::uint8_t const>(
+          reinterpret_cast<uint8_t const*>(serialization), serialization_size),
+      encoder == nullptr ? hexadecimal_encoder : encoder);
+  std::int64_t const byte_size = decoded.size;
   // Ownership of the following pointer is transfered to the deserializer using
   // the callback to |Push|.
-  std::uint8_t* bytes = new uint8_t[byte_size];
-  HexadecimalDecode({hexadecimal, hexadecimal_size}, {bytes, byte_size});
+  std::uint8_t* bytes = decoded.data.release();
 
   // Push the data, taking ownership of it.
   (*deserializer)->Push(Bytes(&bytes[0], byte_size),
@@ -259,20 +259,17 @@ void principia__FlightPlanRenderedApsides(Plugin const* const plugin,
   journal::Method<journal::FlightPlanRenderedApsides> m(
       {plugin, vessel_guid, celestial_index, sun_world_position},
       {apoapsides, periapsides});
-  DiscreteTrajectory<Barycentric>::Iterator begin;
-  DiscreteTrajectory<Barycentric>::Iterator end;
   CHECK_NOTNULL(plugin);
-  GetFlightPlan(plugin, vessel_guid).GetAllSegments(&begin, &end);
   Position<World> q_sun =
       World::origin +
       Displacement<World>(FromXYZ(sun_world_position) * Metre);
   std::unique_ptr<DiscreteTrajectory<World>> rendered_apoapsides;
   std::unique_ptr<DiscreteTrajectory<World>> rendered_periapsides;
-  plugin->ComputeAndRenderApsides(celestial_index,
-                                  begin, end,
-                                  q_sun,
-                                  rendered_apoapsides,
-                                  rendered_periapsides);
+  plugin->RenderedFlightPlanApsides(vessel_guid,
+                                    celestial_index,
+                                    q_sun,
+                                    rendered_apoapsides,
+                                    rendered_periapsides);
   *apoapsides = new TypedIterator<DiscreteTrajectory<World>>(
       check_not_null(std::move(rendered_apoapsides)));
   *periapsides = new TypedIterator<DiscreteTrajectory<World>>(
@@ -301,6 +298,18 @@ Iterator* principia__FlightPlanRenderedSegment(
       std::move(rendered_trajectory)));
 }
 
+bool principia__FlightPlanReplace(Plugin const* const plugin,
+                                  char const* const vessel_guid,
+                                  Burn const burn,
+                                  int const index) {
+  journal::Method<journal::FlightPlanReplace> m({plugin,
+                                                 vessel_guid,
+                                                 burn,
+                                                 index});
+  return m.Return(GetFlightPlan(plugin, vessel_guid).
+                      Replace(FromInterfaceBurn(plugin, burn), index));
+}
+
 bool principia__FlightPlanReplaceLast(Plugin const* const plugin,
                                       char const* const vessel_guid,
                                       Burn const burn) {
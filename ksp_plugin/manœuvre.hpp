@@ -43,6 +43,10 @@ class Manœuvre {
            Vector<double, Frenet<Frame>> const& direction,
            not_null<std::unique_ptr<DynamicFrame<InertialFrame, Frame> const>>
                frame);
+  // A manœuvre with the same thrust, specific impulse, direction, frame, Δv
+  // and timing as |manœuvre|, but with the given |initial_mass|.  The frame is
+  // shared, not copied.  The intensity of |manœuvre| must have been set.
+  Manœuvre(Manœuvre const& manœuvre, Mass const& initial_mass);
   Manœuvre(Manœuvre&&) = default;
   Manœuvre& operator=(Manœuvre&&) = default;
   virtual ~Manœuvre() = default;
@@ -122,7 +126,8 @@ class Manœuvre {
   Vector<double, Frenet<Frame>> const direction_;
   std::experimental::optional<Time> duration_;
   std::experimental::optional<Instant> initial_time_;
-  not_null<std::unique_ptr<DynamicFrame<InertialFrame, Frame> const>> frame_;
+  // Shared by the manœuvres built by the constructor that changes the mass.
+  not_null<std::shared_ptr<DynamicFrame<InertialFrame, Frame> const>> frame_;
   DiscreteTrajectory<InertialFrame> const* coasting_trajectory_ = nullptr;
 };
 
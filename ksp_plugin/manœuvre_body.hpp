@@ -31,6 +31,18 @@ Manœuvre<InertialFrame, Frame>::Manœuvre(
       direction_(NormalizeOrZero(direction)),
       frame_(std::move(frame)) {}
 
+template<typename InertialFrame, typename Frame>
+Manœuvre<InertialFrame, Frame>::Manœuvre(Manœuvre const& manœuvre,
+                                         Mass const& initial_mass)
+    : thrust_(manœuvre.thrust_),
+      initial_mass_(initial_mass),
+      specific_impulse_(manœuvre.specific_impulse_),
+      direction_(manœuvre.direction_),
+      initial_time_(manœuvre.initial_time_),
+      frame_(manœuvre.frame_) {
+  set_Δv(manœuvre.Δv());
+}
+
 template<typename InertialFrame, typename Frame>
 Force const& Manœuvre<InertialFrame, Frame>::thrust() const {
   return thrust_;
@@ -2,7 +2,9 @@
 #include "ksp_plugin/plugin.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <future>
 #include <ios>
 #include <limits>
 #include <map>
@@ -29,6 +31,7 @@
 #include "physics/body_centered_non_rotating_dynamic_frame.hpp"
 #include "physics/dynamic_frame.hpp"
 #include "physics/rotating_body.hpp"
+#include "quantities/elementary_functions.hpp"
 
 namespace principia {
 
@@ -51,8 +54,12 @@ using physics::BodyCentredNonRotatingDynamicFrame;
 using physics::DynamicFrame;
 using physics::Frenet;
 using physics::KeplerianElements;
+using physics::MassiveBody;
+using physics::RigidMotion;
 using physics::RotatingBody;
+using quantities::Acceleration;
 using quantities::Force;
+using quantities::Pow;
 using quantities::si::Milli;
 using quantities::si::Minute;
 using quantities::si::Radian;
@@ -65,6 +72,16 @@ namespace {
 
 Length const fitting_tolerance = 1 * Milli(Metre);
 
+// The bound on the error made on the accelerations of the vessels by seeing
+// the distant planetary systems as point masses.  Over a day, its effect on
+// the position of a vessel is below half a metre.
+Acceleration const subsystems_approximation_tolerance =
+    1e-10 * Metre / Pow<2>(Second);
+
+// The increments in which |Plugin::ProlongEphemerisAhead| prolongs the
+// ephemeris, i.e., 8 steps of the default parameters.
+Time const ephemeris_prolongation_increment = 6 * Hour;
+
 std::uint64_t const ksp_stock_system_fingerprint = 0xB0C5DF211A8E6008u;
 std::uint64_t const ksp_fixed_system_fingerprint = 0x2491936A92E3111Eu;
 
@@ -89,6 +106,14 @@ Plugin::Plugin(Instant const& initial_time,
       planetarium_rotation_(planetarium_rotation),
       current_time_(initial_time) {}
 
+Plugin::~Plugin() {
+  CancelEphemerisProlongation();
+  // The vessels may be computing their predictions using |ephemeris_|, which
+  // would otherwise be destroyed before them.  Destroying a vessel abandons its
+  // prediction, which stops at the end of its current chunk of steps.
+  vessels_.clear();
+}
+
 void Plugin::InsertCelestialAbsoluteCartesian(
     Index const celestial_index,
     std::experimental::optional<Index> const& parent_index,
@@ -288,10 +313,29 @@ void Plugin::AdvanceTime(Instant const& t, Angle const& planetarium_rotation) {
   bubble_->Prepare(BarycentricToWorldSun(), current_time_, t);
 
   EvolveBubble(t);
-  for (auto const& pair : vessels_) {
-    not_null<std::unique_ptr<Vessel>> const& vessel = pair.second;
-    if (!bubble_->contains(vessel.get())) {
-      vessel->AdvanceTimeNotInBubble(t);
+  if (vessel_thread_pool_ == nullptr) {
+    for (auto const& pair : vessels_) {
+      not_null<std::unique_ptr<Vessel>> const& vessel = pair.second;
+      if (!bubble_->contains(vessel.get())) {
+        vessel->AdvanceTimeNotInBubble(t);
+      }
+    }
+  } else {
+    // The ephemeris has been prolonged to |t| above, so flowing the vessels
+    // only reads it.  The trajectories of distinct vessels are disjoint, so the
+    // vessels may be flowed concurrently, and the result is the same as in the
+    // sequential case.
+    std::vector<std::future<void>> futures;
+    for (auto const& pair : vessels_) {
+      not_null<Vessel*> const vessel = pair.second.get();
+      if (!bubble_->contains(vessel)) {
+        futures.push_back(vessel_thread_pool_->Add([vessel, t]() {
+          vessel->AdvanceTimeNotInBubble(t);
+        }));
+      }
+    }
+    for (auto const& future : futures) {
+      future.wait();
     }
   }
 
@@ -300,11 +344,31 @@ void Plugin::AdvanceTime(Instant const& t, Angle const& planetarium_rotation) {
           << "to   : " << t;
   current_time_ = t;
   planetarium_rotation_ = planetarium_rotation;
+  ProlongEphemerisAhead();
+}
+
+void Plugin::SetNumberOfVesselThreads(int const number_of_threads) {
+  CHECK_LE(0, number_of_threads);
+  if (number_of_threads <= 1) {
+    vessel_thread_pool_.reset();
+  } else if (vessel_thread_pool_ == nullptr ||
+             vessel_thread_pool_->size() != number_of_threads) {
+    vessel_thread_pool_ =
+        std::make_unique<base::ThreadPool<void>>(number_of_threads);
+  }
+}
+
+void Plugin::SetEphemerisHorizon(Time const& horizon) {
+  CHECK_LE(Time(), horizon);
+  ephemeris_horizon_ = horizon;
 }
 
 void Plugin::ForgetAllHistoriesBefore(Instant const& t) const {
   CHECK(!initializing_);
   CHECK_LT(t, current_time_);
+  // Forgetting takes the lock of the ephemeris, which the background
+  // prolongation holds for an entire increment.
+  CancelEphemerisProlongation();
   ephemeris_->ForgetBefore(t);
   for (auto const& pair : vessels_) {
     not_null<std::unique_ptr<Vessel>> const& vessel = pair.second;
@@ -354,6 +418,12 @@ void Plugin::UpdatePrediction(GUID const& vessel_guid) const {
       current_time_ + prediction_length_);
 }
 
+void Plugin::UpdatePredictionAsynchronously(GUID const& vessel_guid) const {
+  CHECK(!initializing_);
+  find_vessel_by_guid_or_die(vessel_guid)->UpdatePredictionAsynchronously(
+      current_time_ + prediction_length_);
+}
+
 void Plugin::CreateFlightPlan(GUID const& vessel_guid,
                               Instant const& final_time,
                               Mass const& initial_mass) const {
@@ -373,9 +443,50 @@ Plugin::RenderedVesselTrajectory(
       find_vessel_by_guid_or_die(vessel_guid);
   CHECK(vessel->is_initialized());
   VLOG(1) << "Rendering a trajectory for the vessel with GUID " << vessel_guid;
-  return RenderedTrajectoryFromIterators(vessel->history().Begin(),
-                                         vessel->history().End(),
-                                         sun_world_position);
+  auto const& history = vessel->history();
+  DiscreteTrajectory<Navigation>& plotted_history =
+      plotted_histories_[vessel.get()];
+
+  // The points of the history don't change once they have been appended, so
+  // the points of |plotted_history| remain valid until the plotting frame
+  // changes.  Remove the points that were forgotten by the history and only
+  // transform the ones that were appended since the last call.
+  plotted_history.ForgetBefore(history.Begin().time());
+  auto history_it = history.Begin();
+  if (plotted_history.Begin() != plotted_history.End()) {
+    history_it = history.Find(plotted_history.last().time());
+    CHECK(history_it != history.End()) << plotted_history.last().time();
+    ++history_it;
+  }
+  std::vector<Instant> times;
+  for (auto it = history_it; it != history.End(); ++it) {
+    times.push_back(it.time());
+  }
+  std::vector<RigidMotion<Barycentric, Navigation>> to_plotting_frame;
+  plotting_frame_->ToThisFrameAtTimes(times, &to_plotting_frame);
+  for (auto const& to_plotting_frame_at_time : to_plotting_frame) {
+    plotted_history.Append(
+        history_it.time(),
+        to_plotting_frame_at_time(history_it.degrees_of_freedom()));
+    ++history_it;
+  }
+
+  auto result = make_not_null_unique<DiscreteTrajectory<World>>();
+  auto const navigation_frame_to_world_at_current_time =
+      NavigationFrameToWorldAtCurrentTime(sun_world_position);
+  for (auto it = plotted_history.Begin(); it != plotted_history.End(); ++it) {
+    DegreesOfFreedom<Navigation> const& navigation_degrees_of_freedom =
+        it.degrees_of_freedom();
+    result->Append(
+        it.time(),
+        DegreesOfFreedom<World>(
+            navigation_frame_to_world_at_current_time(
+                navigation_degrees_of_freedom.position()),
+            navigation_frame_to_world_at_current_time.linear_map()(
+                navigation_degrees_of_freedom.velocity())));
+  }
+  VLOG(1) << "Returning a " << result->Size() << "-point trajectory";
+  return result;
 }
 
 not_null<std::unique_ptr<DiscreteTrajectory<World>>> Plugin::RenderedPrediction(
@@ -394,58 +505,76 @@ Plugin::RenderedTrajectoryFromIterators(
     DiscreteTrajectory<Barycentric>::Iterator const& end,
     Position<World> const& sun_world_position) const {
   auto result = make_not_null_unique<DiscreteTrajectory<World>>();
-  auto const to_world =
-      AffineMap<Barycentric, World, Length, OrthogonalMap>(
-          sun_->current_position(current_time_),
-          sun_world_position,
-          OrthogonalMap<WorldSun, World>::Identity() * BarycentricToWorldSun());
-
-  // Compute the trajectory in the navigation frame.
-  DiscreteTrajectory<Navigation> intermediate_trajectory;
+  auto const navigation_frame_to_world_at_current_time =
+      NavigationFrameToWorldAtCurrentTime(sun_world_position);
+  std::vector<Instant> times;
   for (auto it = begin; it != end; ++it) {
-    intermediate_trajectory.Append(
-        it.time(),
-        plotting_frame_->ToThisFrameAtTime(it.time())(
-            it.degrees_of_freedom()));
-  }
-
-  // Render the trajectory at current time in |World|.
-  DiscreteTrajectory<Navigation>::Iterator const intermediate_end =
-      intermediate_trajectory.End();
-  auto from_navigation_frame_to_world_at_current_time =
-      to_world *
-          plotting_frame_->
-              FromThisFrameAtTime(current_time_).rigid_transformation();
-  for (auto intermediate_it = intermediate_trajectory.Begin();
-       intermediate_it != intermediate_end;
-       ++intermediate_it) {
+    times.push_back(it.time());
+  }
+  std::vector<RigidMotion<Barycentric, Navigation>> to_plotting_frame;
+  plotting_frame_->ToThisFrameAtTimes(times, &to_plotting_frame);
+  auto it = begin;
+  for (auto const& to_plotting_frame_at_time : to_plotting_frame) {
     DegreesOfFreedom<Navigation> const navigation_degrees_of_freedom =
-        intermediate_it.degrees_of_freedom();
-    DegreesOfFreedom<World> const world_degrees_of_freedom =
+        to_plotting_frame_at_time(it.degrees_of_freedom());
+    result->Append(
+        it.time(),
         DegreesOfFreedom<World>(
-            from_navigation_frame_to_world_at_current_time(
+            navigation_frame_to_world_at_current_time(
                 navigation_degrees_of_freedom.position()),
-            from_navigation_frame_to_world_at_current_time.linear_map()(
-                navigation_degrees_of_freedom.velocity()));
-    result->Append(intermediate_it.time(), world_degrees_of_freedom);
+            navigation_frame_to_world_at_current_time.linear_map()(
+                navigation_degrees_of_freedom.velocity())));
+    ++it;
   }
   VLOG(1) << "Returning a " << result->Size() << "-point trajectory";
   return result;
 }
 
-void Plugin::ComputeAndRenderApsides(
+void Plugin::RenderedPredictionApsides(
+    GUID const& vessel_guid,
     Index const celestial_index,
-    DiscreteTrajectory<Barycentric>::Iterator const& begin,
-    DiscreteTrajectory<Barycentric>::Iterator const& end,
     Position<World> const& sun_world_position,
     std::unique_ptr<DiscreteTrajectory<World>>& apoapsides,
     std::unique_ptr<DiscreteTrajectory<World>>& periapsides) const {
+  CHECK(!initializing_);
+  Ephemeris<Barycentric>::Events const& events =
+      find_vessel_by_guid_or_die(vessel_guid)->prediction_events(
+          FindOrDie(celestials_, celestial_index)->body());
+  apoapsides = RenderedTrajectoryFromIterators(events.apoapsides.Begin(),
+                                               events.apoapsides.End(),
+                                               sun_world_position);
+  periapsides = RenderedTrajectoryFromIterators(events.periapsides.Begin(),
+                                                events.periapsides.End(),
+                                                sun_world_position);
+}
+
+void Plugin::RenderedFlightPlanApsides(
+    GUID const& vessel_guid,
+    Index const celestial_index,
+    Position<World> const& sun_world_position,
+    std::unique_ptr<DiscreteTrajectory<World>>& apoapsides,
+    std::unique_ptr<DiscreteTrajectory<World>>& periapsides) const {
+  CHECK(!initializing_);
+  not_null<MassiveBody const*> const body =
+      FindOrDie(celestials_, celestial_index)->body();
+  FlightPlan& flight_plan =
+      find_vessel_by_guid_or_die(vessel_guid)->flight_plan();
+  // The apsides of the segments are concatenated, which is cheap since there
+  // are few of them.
   DiscreteTrajectory<Barycentric> apoapsides_trajectory;
   DiscreteTrajectory<Barycentric> periapsides_trajectory;
-  ephemeris_->ComputeApsides(FindOrDie(celestials_, celestial_index)->body(),
-                             begin, end,
-                             apoapsides_trajectory,
-                             periapsides_trajectory);
+  auto const append = [](DiscreteTrajectory<Barycentric> const& from,
+                         DiscreteTrajectory<Barycentric>& to) {
+    for (auto it = from.Begin(); it != from.End(); ++it) {
+      to.Append(it.time(), it.degrees_of_freedom());
+    }
+  };
+  for (int i = 0; i < flight_plan.number_of_segments(); ++i) {
+    Ephemeris<Barycentric>::Events const& events =
+        flight_plan.GetSegmentEvents(i, body);
+    append(events.apoapsides, apoapsides_trajectory);
+    append(events.periapsides, periapsides_trajectory);
+  }
   apoapsides = RenderedTrajectoryFromIterators(apoapsides_trajectory.Begin(),
                                                apoapsides_trajectory.End(),
                                                sun_world_position);
@@ -507,6 +636,7 @@ Plugin::NewBarycentricRotatingNavigationFrame(
 void Plugin::SetPlottingFrame(
     not_null<std::unique_ptr<NavigationFrame>> plotting_frame) {
   plotting_frame_ = std::move(plotting_frame);
+  plotted_histories_.clear();
 }
 
 not_null<NavigationFrame const*> Plugin::GetPlottingFrame() const {
@@ -517,17 +647,10 @@ Position<World> Plugin::PlotBarycentricPosition(
     Instant const& t,
     Position<Barycentric> const& position,
     Position<World> const& sun_world_position) const {
-  auto const barycentric_to_world =
-      AffineMap<Barycentric, World, Length, OrthogonalMap>(
-          sun_->current_position(current_time_),
-          sun_world_position,
-          OrthogonalMap<WorldSun, World>::Identity() * BarycentricToWorldSun());
   auto const barycentric_to_navigation_at_t =
       plotting_frame_->ToThisFrameAtTime(t).rigid_transformation();
   auto const navigation_frame_to_world_at_current_time =
-      barycentric_to_world *
-          plotting_frame_->
-              FromThisFrameAtTime(current_time_).rigid_transformation();
+      NavigationFrameToWorldAtCurrentTime(sun_world_position);
   return navigation_frame_to_world_at_current_time(
              barycentric_to_navigation_at_t(position));
 }
@@ -628,8 +751,24 @@ Instant Plugin::CurrentTime() const {
 void Plugin::WriteToMessage(
     not_null<serialization::Plugin*> const message) const {
   LOG(INFO) << __FUNCTION__;
+  WriteToMessageInPieces(
+      [message](not_null<serialization::Plugin*> const piece) {
+        message->MergeFrom(*piece);
+      });
+  LOG(INFO) << NAMED(message->SpaceUsed());
+  LOG(INFO) << NAMED(message->ByteSize());
+}
+
+void Plugin::WriteToMessageInPieces(
+    std::function<void(not_null<serialization::Plugin*> const piece)> const&
+        write_piece) const {
+  LOG(INFO) << __FUNCTION__;
   CHECK(!initializing_);
+  // Serializing takes the lock of the ephemeris, which the background
+  // prolongation holds for an entire increment.
+  CancelEphemerisProlongation();
   ephemeris_->Prolong(current_time_);
+  serialization::Plugin piece;
   std::map<not_null<Celestial const*>, Index const> celestial_to_index;
   for (auto const& pair : celestials_) {
     Index const index = pair.first;
@@ -639,7 +778,7 @@ void Plugin::WriteToMessage(
   for (auto const& pair : celestials_) {
     Index const index = pair.first;
     auto const& owned_celestial = pair.second.get();
-    auto* const celestial_message = message->add_celestial();
+    auto* const celestial_message = piece.add_celestial();
     celestial_message->set_index(index);
     if (owned_celestial->has_parent()) {
       Index const parent_index =
@@ -647,40 +786,56 @@ void Plugin::WriteToMessage(
       celestial_message->set_parent_index(parent_index);
     }
   }
+  write_piece(&piece);
   std::map<not_null<Vessel const*>, GUID const> vessel_to_guid;
   for (auto const& pair : vessels_) {
     std::string const& guid = pair.first;
     not_null<Vessel*> const vessel = pair.second.get();
     vessel_to_guid.emplace(vessel, guid);
-    auto* const vessel_message = message->add_vessel();
+    piece.Clear();
+    auto* const vessel_message = piece.add_vessel();
     vessel_message->set_guid(guid);
     vessel->WriteToMessage(vessel_message->mutable_vessel());
     Index const parent_index = FindOrDie(celestial_to_index, vessel->parent());
     vessel_message->set_parent_index(parent_index);
     vessel_message->set_dirty(vessel->is_dirty());
+    write_piece(&piece);
   }
 
-  ephemeris_->WriteToMessage(message->mutable_ephemeris());
-
-  history_parameters_.WriteToMessage(message->mutable_history_parameters());
+  // The ephemeris is only saved up to |current_time_|, so that the saves don't
+  // grow with |ephemeris_horizon_|.  The part computed ahead of time is
+  // recomputed in the background after reading, see |ProlongEphemerisAhead|.
+  ephemeris_->WriteToMessageInPieces(
+      [this, &piece, &write_piece](
+          not_null<serialization::Ephemeris*> const ephemeris_piece) {
+        if (ephemeris_piece->has_t_max() &&
+            Instant::ReadFromMessage(ephemeris_piece->t_max()) >
+                current_time_) {
+          current_time_.WriteToMessage(ephemeris_piece->mutable_t_max());
+        }
+        piece.Clear();
+        piece.mutable_ephemeris()->Swap(ephemeris_piece);
+        write_piece(&piece);
+      });
+
+  piece.Clear();
+  history_parameters_.WriteToMessage(piece.mutable_history_parameters());
   prolongation_parameters_.WriteToMessage(
-      message->mutable_prolongation_parameters());
-  prediction_parameters_.WriteToMessage(
-      message->mutable_prediction_parameters());
+      piece.mutable_prolongation_parameters());
+  prediction_parameters_.WriteToMessage(piece.mutable_prediction_parameters());
 
   bubble_->WriteToMessage(
       [&vessel_to_guid](not_null<Vessel const*> const vessel) -> GUID {
         return FindOrDie(vessel_to_guid, vessel);
       },
-      message->mutable_bubble());
+      piece.mutable_bubble());
 
-  planetarium_rotation_.WriteToMessage(message->mutable_planetarium_rotation());
-  current_time_.WriteToMessage(message->mutable_current_time());
+  planetarium_rotation_.WriteToMessage(piece.mutable_planetarium_rotation());
+  current_time_.WriteToMessage(piece.mutable_current_time());
   Index const sun_index = FindOrDie(celestial_to_index, sun_);
-  message->set_sun_index(sun_index);
-  plotting_frame_->WriteToMessage(message->mutable_plotting_frame());
-  LOG(INFO) << NAMED(message->SpaceUsed());
-  LOG(INFO) << NAMED(message->ByteSize());
+  piece.set_sun_index(sun_index);
+  plotting_frame_->WriteToMessage(piece.mutable_plotting_frame());
+  write_piece(&piece);
 }
 
 not_null<std::unique_ptr<Plugin>> Plugin::ReadFromMessage(
@@ -760,6 +915,7 @@ not_null<std::unique_ptr<Plugin>> Plugin::ReadFromMessage(
                  Angle::ReadFromMessage(message.planetarium_rotation()),
                  current_time,
                  message.sun_index()));
+  plugin->EnableSubsystemsApproximation();
   std::unique_ptr<NavigationFrame> plotting_frame =
       NavigationFrame::ReadFromMessage(plugin->ephemeris_.get(),
                                        message.plotting_frame());
@@ -827,6 +983,7 @@ void Plugin::InitializeEphemerisAndSetCelestialTrajectories() {
     auto& celestial = *pair.second;
     celestial.set_trajectory(ephemeris_->trajectory(celestial.body()));
   }
+  EnableSubsystemsApproximation();
 
   // This would use NewBodyCentredNonRotatingNavigationFrame, but we don't have
   // the sun's index at hand.
@@ -839,6 +996,19 @@ void Plugin::InitializeEphemerisAndSetCelestialTrajectories() {
           sun_->body()));
 }
 
+void Plugin::EnableSubsystemsApproximation() {
+  std::map<not_null<MassiveBody const*>, not_null<MassiveBody const*>>
+      parents;
+  for (auto const& pair : celestials_) {
+    Celestial const& celestial = *pair.second;
+    if (celestial.has_parent()) {
+      parents.emplace(celestial.body(), celestial.parent()->body());
+    }
+  }
+  ephemeris_->EnableSubsystemsApproximation(
+      parents, subsystems_approximation_tolerance);
+}
+
 not_null<std::unique_ptr<Vessel>> const& Plugin::find_vessel_by_guid_or_die(
     GUID const& vessel_guid) const {
   VLOG(1) << __FUNCTION__ << '\n' << NAMED(vessel_guid);
@@ -853,6 +1023,46 @@ Rotation<Barycentric, AliceSun> Plugin::PlanetariumRotation() const {
       Bivector<double, Barycentric>({0, 0, -1}));
 }
 
+void Plugin::ProlongEphemerisAhead() {
+  if (ephemeris_horizon_ == Time()) {
+    return;
+  }
+  if (ephemeris_prolongation_.valid() &&
+      ephemeris_prolongation_.wait_for(std::chrono::seconds(0)) !=
+          std::future_status::ready) {
+    return;
+  }
+  Instant const horizon_time = current_time_ + ephemeris_horizon_;
+  if (ephemeris_->t_max() >= horizon_time) {
+    return;
+  }
+  // The new series become visible to the game thread as soon as they are
+  // appended, since the trajectories of the ephemeris are thread-safe.  The
+  // lock of the ephemeris is released after each increment so that the game
+  // thread doesn't wait long if it needs to prolong the ephemeris itself.
+  not_null<Ephemeris<Barycentric>*> const ephemeris = ephemeris_.get();
+  not_null<std::atomic<bool> const*> const cancelled =
+      &ephemeris_prolongation_cancelled_;
+  ephemeris_prolongation_ = std::async(
+      std::launch::async, [ephemeris, cancelled, horizon_time]() {
+        for (Instant t = ephemeris->t_max();
+             t < horizon_time && !*cancelled;
+             t = ephemeris->t_max()) {
+          ephemeris->Prolong(
+              std::min(t + ephemeris_prolongation_increment, horizon_time));
+        }
+      });
+}
+
+void Plugin::CancelEphemerisProlongation() const {
+  if (ephemeris_prolongation_.valid()) {
+    ephemeris_prolongation_cancelled_ = true;
+    ephemeris_prolongation_.wait();
+    ephemeris_prolongation_ = std::future<void>();
+    ephemeris_prolongation_cancelled_ = false;
+  }
+}
+
 void Plugin::FreeVessels() {
   VLOG(1) <<  __FUNCTION__;
   // Remove the vessels which were not updated since last time.
@@ -864,6 +1074,7 @@ void Plugin::FreeVessels() {
       ++it;
     } else {
       LOG(INFO) << "Removing vessel with GUID " << it->first;
+      plotted_histories_.erase(vessel);
       it = vessels_.erase(it);
     }
   }
@@ -900,6 +1111,19 @@ void Plugin::EvolveBubble(Instant const& t) {
   }
 }
 
+AffineMap<Navigation, World, Length, OrthogonalMap>
+Plugin::NavigationFrameToWorldAtCurrentTime(
+    Position<World> const& sun_world_position) const {
+  auto const barycentric_to_world =
+      AffineMap<Barycentric, World, Length, OrthogonalMap>(
+          sun_->current_position(current_time_),
+          sun_world_position,
+          OrthogonalMap<WorldSun, World>::Identity() * BarycentricToWorldSun());
+  return barycentric_to_world *
+         plotting_frame_->
+             FromThisFrameAtTime(current_time_).rigid_transformation();
+}
+
 Vector<double, World> Plugin::FromVesselFrenetFrame(
     Vessel const& vessel,
     Vector<double, Frenet<Navigation>> const& vector) const {
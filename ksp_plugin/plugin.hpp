@@ -1,6 +1,8 @@
 ﻿
 #pragma once
 
+#include <atomic>
+#include <future>
 #include <limits>
 #include <map>
 #include <memory>
@@ -10,6 +12,8 @@
 #include <vector>
 
 #include "base/monostable.hpp"
+#include "base/thread_pool.hpp"
+#include "geometry/affine_map.hpp"
 #include "geometry/named_quantities.hpp"
 #include "geometry/point.hpp"
 #include "gtest/gtest.h"
@@ -35,6 +39,7 @@
 namespace principia {
 
 using base::not_null;
+using geometry::AffineMap;
 using geometry::Displacement;
 using geometry::Instant;
 using geometry::Point;
@@ -50,6 +55,7 @@ using physics::Frenet;
 using physics::HierarchicalSystem;
 using physics::RelativeDegreesOfFreedom;
 using quantities::Angle;
+using quantities::Length;
 using quantities::si::Hour;
 using quantities::si::Metre;
 using quantities::si::Milli;
@@ -71,7 +77,7 @@ class Plugin {
   Plugin(Plugin&&) = delete;
   Plugin& operator=(Plugin const&) = delete;
   Plugin& operator=(Plugin&&) = delete;
-  virtual ~Plugin() = default;
+  virtual ~Plugin();
 
   // Constructs a |Plugin|. The current time of that instance is |initial_time|.
   // The angle between the axes of |World| and |Barycentric| at |initial_time|
@@ -152,6 +158,19 @@ class Plugin {
   // degrees.
   virtual void AdvanceTime(Instant const& t, Angle const& planetarium_rotation);
 
+  // Sets the number of threads used by |AdvanceTime| to flow the vessels that
+  // are not in the physics bubble.  If |number_of_threads| is 0 or 1 the
+  // vessels are flowed sequentially on the calling thread; this is the default.
+  // The trajectories of the vessels do not depend on the number of threads.
+  virtual void SetNumberOfVesselThreads(int number_of_threads);
+
+  // Sets how far ahead of the current time the ephemeris is prolonged on a
+  // background thread after each call to |AdvanceTime|, so that the
+  // prolongation done by |AdvanceTime| itself is normally a no-op.  A zero
+  // |horizon|, the default, disables the background prolongation.  The
+  // ephemeris does not depend on the horizon.
+  virtual void SetEphemerisHorizon(Time const& horizon);
+
   // Forgets the histories of the |celestials_| and of the vessels before |t|.
   virtual void ForgetAllHistoriesBefore(Instant const& t) const;
 
@@ -176,6 +195,11 @@ class Plugin {
   // Updates the prediction for the vessel with guid |vessel_guid|.
   void UpdatePrediction(GUID const& vessel_guid) const;
 
+  // Same as above, but the prediction is computed on another thread and
+  // replaced at a subsequent call once that computation has completed.  See
+  // |Vessel::UpdatePredictionAsynchronously|.
+  void UpdatePredictionAsynchronously(GUID const& vessel_guid) const;
+
   virtual void CreateFlightPlan(GUID const& vessel_guid,
                                 Instant const& final_time,
                                 Mass const& initial_mass) const;
@@ -214,10 +238,24 @@ class Plugin {
       DiscreteTrajectory<Barycentric>::Iterator const& end,
       Position<World> const& sun_world_position) const;
 
-  virtual void ComputeAndRenderApsides(
+  // Returns the apsides of the prediction of the vessel with the given |GUID|
+  // relative to the celestial with index |celestial_index|, rendered in
+  // |World|.  The apsides are recorded as the prediction is computed, see
+  // |Vessel::prediction_events|, instead of being computed from the
+  // prediction.
+  virtual void RenderedPredictionApsides(
+      GUID const& vessel_guid,
+      Index const celestial_index,
+      Position<World> const& sun_world_position,
+      std::unique_ptr<DiscreteTrajectory<World>>& apoapsides,
+      std::unique_ptr<DiscreteTrajectory<World>>& periapsides) const;
+
+  // Same as above, for the flight plan of the vessel with the given |GUID|,
+  // which must have one.  The apsides are recorded segment by segment, see
+  // |FlightPlan::GetSegmentEvents|.
+  virtual void RenderedFlightPlanApsides(
+      GUID const& vessel_guid,
       Index const celestial_index,
-      DiscreteTrajectory<Barycentric>::Iterator const& begin,
-      DiscreteTrajectory<Barycentric>::Iterator const& end,
       Position<World> const& sun_world_position,
       std::unique_ptr<DiscreteTrajectory<World>>& apoapsides,
       std::unique_ptr<DiscreteTrajectory<World>>& periapsides) const;
@@ -294,6 +332,14 @@ class Plugin {
   // Must be called after initialization.
   virtual void WriteToMessage(
       not_null<serialization::Plugin*> const message) const;
+  // Same as |WriteToMessage|, but the message is produced in pieces, so that it
+  // never needs to be entirely in memory: each vessel and each trajectory of
+  // the ephemeris is in a piece of its own.  |write_piece| is called with each
+  // piece in turn and may modify it.  Merging the pieces in order yields the
+  // message written by |WriteToMessage|.
+  virtual void WriteToMessageInPieces(
+      std::function<void(not_null<serialization::Plugin*> const piece)> const&
+          write_piece) const;
   static not_null<std::unique_ptr<Plugin>> ReadFromMessage(
       serialization::Plugin const& message);
 
@@ -330,6 +376,10 @@ class Plugin {
   // Requires |absolute_initialization_| and consumes it.
   virtual void InitializeEphemerisAndSetCelestialTrajectories();
 
+  // Approximates the distant planetary systems by point masses in the flows of
+  // the vessels, based on the hierarchy of |celestials_|.
+  void EnableSubsystemsApproximation();
+
   not_null<std::unique_ptr<Vessel>> const& find_vessel_by_guid_or_die(
       GUID const& vessel_guid) const;
 
@@ -341,11 +391,25 @@ class Plugin {
 
   // Utilities for |AdvanceTime|.
 
+  // Starts prolonging |ephemeris_| to |current_time_ + ephemeris_horizon_| on
+  // another thread, unless that is already in progress or done.
+  void ProlongEphemerisAhead();
+  // Stops the prolongation started by |ProlongEphemerisAhead|, if any, at the
+  // end of its current increment and waits for it.  The next call to
+  // |ProlongEphemerisAhead| starts a new one.
+  void CancelEphemerisProlongation() const;
+
   // Remove vessels not in |kept_vessels_|, and clears |kept_vessels_|.
   void FreeVessels();
   // Evolves the trajectory of the |current_physics_bubble_|.
   void EvolveBubble(Instant const& t);
 
+  // The map from the current |plotting_frame_| to |World| used for rendering
+  // at |current_time_|.  |sun_world_position| is as for |RenderedPrediction|.
+  AffineMap<Navigation, World, Length, OrthogonalMap>
+  NavigationFrameToWorldAtCurrentTime(
+      Position<World> const& sun_world_position) const;
+
   Vector<double, World> FromVesselFrenetFrame(
       Vessel const& vessel,
       Vector<double, Frenet<Navigation>> const& vector) const;
@@ -403,6 +467,17 @@ class Plugin {
   Ephemeris<Barycentric>::AdaptiveStepParameters prediction_parameters_;
   Time prediction_length_ = 1 * Hour;
 
+  // Used by |AdvanceTime| to flow the vessels concurrently.  Null if the
+  // vessels are flowed sequentially.
+  std::unique_ptr<base::ThreadPool<void>> vessel_thread_pool_;
+
+  // Used by |ProlongEphemerisAhead|.  The future is invalid if no prolongation
+  // was ever started.  Mutable because the prolongation must be cancelled by
+  // the const functions that forget or serialize the ephemeris.
+  Time ephemeris_horizon_;
+  mutable std::future<void> ephemeris_prolongation_;
+  mutable std::atomic<bool> ephemeris_prolongation_cancelled_{false};
+
   // Whether initialization is ongoing.
   base::Monostable initializing_;
 
@@ -415,6 +490,11 @@ class Plugin {
   // Not null after initialization. |EndInitialization| sets it to the
   // heliocentric frame.
   std::unique_ptr<NavigationFrame> plotting_frame_;
+  // The histories of the vessels, as seen in |plotting_frame_|.  They are
+  // extended and truncated by |RenderedVesselTrajectory| to follow the
+  // histories, and cleared when the plotting frame changes.
+  mutable std::map<not_null<Vessel const*>, DiscreteTrajectory<Navigation>>
+      plotted_histories_;
 
   // Used for detecting and patching the stock system.
   std::set<std::uint64_t> celestial_jacobi_keplerian_fingerprints_;
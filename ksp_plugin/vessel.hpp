@@ -1,6 +1,9 @@
 ﻿
 #pragma once
 
+#include <atomic>
+#include <future>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -17,6 +20,7 @@ namespace principia {
 
 using physics::DiscreteTrajectory;
 using physics::Ephemeris;
+using physics::MassiveBody;
 using physics::MasslessBody;
 using quantities::GravitationalParameter;
 
@@ -33,7 +37,7 @@ class Vessel {
   Vessel(Vessel&&) = delete;
   Vessel& operator=(Vessel const&) = delete;
   Vessel& operator=(Vessel&&) = delete;
-  ~Vessel() = default;
+  ~Vessel();
 
   // Constructs a vessel whose parent is initially |*parent|.  No transfer of
   // ownership.
@@ -72,6 +76,8 @@ class Vessel {
   virtual void set_dirty();
   virtual bool is_dirty() const;
 
+  // Abandons any prediction being computed by |UpdatePredictionAsynchronously|
+  // if the parameters change.
   virtual void set_prediction_adaptive_step_parameters(
       Ephemeris<Barycentric>::AdaptiveStepParameters const&
           prediction_adaptive_step_parameters);
@@ -110,8 +116,34 @@ class Vessel {
   // Deletes the |flight_plan_|.  Performs no action unless |has_flight_plan()|.
   virtual void DeleteFlightPlan();
 
+  // Recomputes the prediction from the last point of the prolongation up to
+  // |last_time|.  If the previous prediction was computed with the same
+  // parameters and still agrees with the new starting point, its points are
+  // reused and only its tail is extended.
   virtual void UpdatePrediction(Instant const& last_time);
 
+  // Same as |UpdatePrediction|, but the prediction is computed on another
+  // thread and this function never waits for it.  The prediction is replaced
+  // by a subsequent call once the computation has completed, provided that the
+  // computed trajectory agrees with the prolongation at that time; until then
+  // |prediction()| is unchanged.  The other thread only uses the parts of the
+  // ephemeris after the last point of the prolongation, which are not modified
+  // by the game thread.  The flight plan is still computed synchronously, see
+  // |FlightPlan|.
+  virtual void UpdatePredictionAsynchronously(Instant const& last_time);
+
+  // Returns the events of the prediction relative to |body|, see
+  // |Ephemeris::Events|.  They are recorded as the prediction is computed, so
+  // they are not looked for in the prediction after the fact.  The events
+  // relative to a |body| are recorded from the first call to this function
+  // with that |body| on; until the next call to |UpdatePrediction| or
+  // |UpdatePredictionAsynchronously|, which then recomputes the prediction
+  // entirely, they are empty.  The events relative to a |body| for which this
+  // function is not called between two updates of the prediction stop being
+  // recorded.
+  virtual Ephemeris<Barycentric>::Events const& prediction_events(
+      not_null<MassiveBody const*> const body);
+
   // The vessel must satisfy |is_initialized()|.
   virtual void WriteToMessage(
       not_null<serialization::Vessel*> const message) const;
@@ -125,11 +157,56 @@ class Vessel {
   Vessel();
 
  private:
+  // The events of a prediction, indexed by the body relative to which they are
+  // recorded.
+  using PredictionEvents =
+      std::map<not_null<MassiveBody const*>,
+               not_null<std::unique_ptr<Ephemeris<Barycentric>::Events>>>;
+
   void AdvanceHistoryIfNeeded(Instant const& time);
   void FlowHistory(Instant const& time);
   void FlowProlongation(Instant const& time);
   void FlowPrediction(Instant const& time);
 
+  // Flows |prediction| to |time| in the given |ephemeris|, recording its
+  // |events|.  Doesn't touch the vessel, so it may be called on any thread.
+  // If |abandoned| is not null, the flow is split in chunks of at most
+  // |prediction_steps_per_chunk| steps and stops before the next chunk once
+  // |*abandoned| is set.
+  static void FlowPrediction(
+      not_null<Ephemeris<Barycentric>*> const ephemeris,
+      Ephemeris<Barycentric>::AdaptiveStepParameters const& parameters,
+      Instant const& time,
+      not_null<DiscreteTrajectory<Barycentric>*> const prediction,
+      PredictionEvents const& events,
+      std::atomic<bool> const* const abandoned);
+
+  // Flows |prediction_| to the first point of |old_prediction| after its last
+  // point.  If the two trajectories agree there within the tolerances of
+  // |prediction_adaptive_step_parameters_|, appends to |prediction_| the
+  // points of |old_prediction| up to |last_time|, and to
+  // |prediction_events_| the corresponding |old_events|, and returns true.
+  // |old_events| must be relative to all the bodies of |prediction_events_|.
+  bool ReusePrediction(DiscreteTrajectory<Barycentric> const& old_prediction,
+                       PredictionEvents const& old_events,
+                       Instant const& last_time);
+
+  // Returns empty events relative to the bodies whose events were requested
+  // since the last call to this function, for use with a new prediction.
+  PredictionEvents NewPredictionEvents();
+
+  // Replaces |prediction_| with a fork at the end of |history_| containing the
+  // last point of |prolongation_|, and returns the previous |prediction_|,
+  // which is still a fork of |history_|.
+  DiscreteTrajectory<Barycentric>* ForkPrediction();
+
+  // Starts the computation of a prediction up to |last_time| on another
+  // thread.  There must be no computation in progress.
+  void StartAsynchronousPrediction(Instant const& last_time);
+
+  // Waits for the computation in progress, if any, and drops its result.
+  void WaitForAsynchronousPrediction();
+
   MasslessBody const body_;
   Ephemeris<Barycentric>::FixedStepParameters const
       history_fixed_step_parameters_;
@@ -153,6 +230,39 @@ class Vessel {
 
   // Child trajectory of |*history_|.
   DiscreteTrajectory<Barycentric>* prediction_ = nullptr;
+  // True if |prediction_| was computed by |UpdatePrediction| with the current
+  // |prediction_adaptive_step_parameters_| and a finite |last_time|, so that
+  // it may be reused by the next call.
+  bool prediction_is_reusable_ = false;
+  // The events of |prediction_|.
+  PredictionEvents prediction_events_;
+  // The bodies whose events are recorded in the prediction, and whether their
+  // events were requested since the last call to |NewPredictionEvents|.
+  std::map<not_null<MassiveBody const*>, bool> prediction_events_requested_;
+
+  // A prediction computed on another thread by
+  // |UpdatePredictionAsynchronously|.
+  struct AsynchronousPrediction {
+    AsynchronousPrediction(
+        Ephemeris<Barycentric>::AdaptiveStepParameters const& parameters,
+        Instant const& last_time);
+
+    Ephemeris<Barycentric>::AdaptiveStepParameters const parameters;
+    Instant const last_time;
+    // Set by the game thread if the result will not be used.  The computation
+    // stops at the end of the current chunk of steps when it sees this flag,
+    // see |FlowPrediction|.
+    std::atomic<bool> abandoned;
+    // Starts at the last point of the prolongation.  Only accessed by the
+    // other thread until |done| is ready.
+    DiscreteTrajectory<Barycentric> trajectory;
+    // The events of |trajectory|, with the same constraints.
+    PredictionEvents events;
+    std::future<void> done;
+  };
+  // Null if there is no computation in progress or completed but not yet
+  // installed.
+  std::unique_ptr<AsynchronousPrediction> asynchronous_prediction_;
 
   std::unique_ptr<FlightPlan> flight_plan_;
   bool is_dirty_ = false;
@@ -4,15 +4,19 @@
 #include "ksp_plugin/vessel.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <limits>
+#include <utility>
 #include <vector>
 
+#include "base/map_util.hpp"
 #include "integrators/embedded_explicit_runge_kutta_nyström_integrator.hpp"
 #include "quantities/si.hpp"
 #include "testing_utilities/make_not_null.hpp"
 
 namespace principia {
 
+using base::FindOrDie;
 using integrators::DormandElMikkawyPrince1986RKN434FM;
 using integrators::McLachlanAtela1992Order5Optimal;
 using quantities::IsFinite;
@@ -23,6 +27,15 @@ using quantities::si::Second;
 
 namespace ksp_plugin {
 
+namespace internal_vessel {
+
+// The number of steps after which an asynchronous prediction checks whether it
+// was abandoned.  Small enough that destroying a vessel doesn't wait long for
+// its prediction, large enough that the integration is rarely restarted.
+std::int64_t constexpr prediction_steps_per_chunk = 100;
+
+}  // namespace internal_vessel
+
 inline Vessel::Vessel(not_null<Celestial const*> const parent,
                       not_null<Ephemeris<Barycentric>*> const ephemeris,
                       Ephemeris<Barycentric>::FixedStepParameters const&
@@ -40,6 +53,12 @@ inline Vessel::Vessel(not_null<Celestial const*> const parent,
       parent_(parent),
       ephemeris_(ephemeris) {}
 
+inline Vessel::~Vessel() {
+  // The computation uses |ephemeris_|, which may be destroyed after us.  It is
+  // abandoned, so this only waits for the end of its current chunk of steps.
+  WaitForAsynchronousPrediction();
+}
+
 inline not_null<MasslessBody const*> Vessel::body() const {
   return &body_;
 }
@@ -93,7 +112,17 @@ inline bool Vessel::is_dirty() const {
 inline void Vessel::set_prediction_adaptive_step_parameters(
     Ephemeris<Barycentric>::AdaptiveStepParameters const&
         prediction_adaptive_step_parameters) {
+  // The adapter sets the parameters at every frame, so don't throw away the
+  // work done if they didn't change.
+  if (prediction_adaptive_step_parameters ==
+          prediction_adaptive_step_parameters_) {
+    return;
+  }
   prediction_adaptive_step_parameters_ = prediction_adaptive_step_parameters;
+  prediction_is_reusable_ = false;
+  if (asynchronous_prediction_ != nullptr) {
+    asynchronous_prediction_->abandoned = true;
+  }
 }
 
 inline Ephemeris<Barycentric>::AdaptiveStepParameters const&
@@ -131,6 +160,10 @@ inline void Vessel::ForgetBefore(Instant const& time) {
   if (prediction_->Fork().time() < time) {
     history_->DeleteFork(&prediction_);
     prediction_ = history_->NewForkAtLast();
+    for (auto& pair : prediction_events_) {
+      pair.second =
+          make_not_null_unique<Ephemeris<Barycentric>::Events>(pair.first);
+    }
   }
   if (flight_plan_ != nullptr) {
     flight_plan_->ForgetBefore(time, [this]() { flight_plan_.reset(); });
@@ -159,14 +192,79 @@ inline void Vessel::DeleteFlightPlan() {
 
 inline void Vessel::UpdatePrediction(Instant const& last_time) {
   CHECK(is_initialized());
-  history_->DeleteFork(&prediction_);
-  prediction_ = history_->NewForkAtLast();
-  auto const prolongation_last = prolongation_->last();
-  if (history_->last().time() != prolongation_last.time()) {
-    prediction_->Append(prolongation_last.time(),
-                        prolongation_last.degrees_of_freedom());
+  DiscreteTrajectory<Barycentric>* old_prediction = ForkPrediction();
+  PredictionEvents old_events = NewPredictionEvents();
+  std::swap(old_events, prediction_events_);
+  // When predicting to an infinite time the length of the prediction is
+  // limited by |max_steps|, so it must be recomputed from scratch.
+  bool const finite_time =
+      IsFinite(last_time - prediction_->last().time());
+  if (prediction_is_reusable_ && finite_time) {
+    ReusePrediction(*old_prediction, old_events, last_time);
   }
+  history_->DeleteFork(&old_prediction);
   FlowPrediction(last_time);
+  prediction_is_reusable_ = finite_time;
+}
+
+inline void Vessel::UpdatePredictionAsynchronously(Instant const& last_time) {
+  CHECK(is_initialized());
+  if (asynchronous_prediction_ != nullptr) {
+    if (asynchronous_prediction_->done.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+      return;
+    }
+    asynchronous_prediction_->done.get();
+    if (!asynchronous_prediction_->abandoned) {
+      // The prolongation has moved since the computation started, so the
+      // computed trajectory is only used if it is still where the vessel is
+      // going.
+      DiscreteTrajectory<Barycentric>* old_prediction = ForkPrediction();
+      PredictionEvents old_events;
+      for (auto const& pair : asynchronous_prediction_->events) {
+        old_events.emplace(
+            pair.first,
+            make_not_null_unique<Ephemeris<Barycentric>::Events>(pair.first));
+      }
+      std::swap(old_events, prediction_events_);
+      if (ReusePrediction(asynchronous_prediction_->trajectory,
+                          asynchronous_prediction_->events,
+                          asynchronous_prediction_->last_time)) {
+        history_->DeleteFork(&old_prediction);
+        prediction_is_reusable_ =
+            IsFinite(asynchronous_prediction_->last_time -
+                     prediction_->Fork().time());
+      } else {
+        history_->DeleteFork(&prediction_);
+        prediction_ = old_prediction;
+        std::swap(old_events, prediction_events_);
+      }
+    }
+    asynchronous_prediction_.reset();
+  }
+  StartAsynchronousPrediction(last_time);
+}
+
+inline Ephemeris<Barycentric>::Events const& Vessel::prediction_events(
+    not_null<MassiveBody const*> const body) {
+  auto const requested = prediction_events_requested_.emplace(body, true);
+  if (requested.second) {
+    // The events relative to |body| are only found by recomputing the
+    // prediction.
+    prediction_is_reusable_ = false;
+    if (asynchronous_prediction_ != nullptr) {
+      asynchronous_prediction_->abandoned = true;
+    }
+  } else {
+    requested.first->second = true;
+  }
+  auto it = prediction_events_.find(body);
+  if (it == prediction_events_.end()) {
+    it = prediction_events_.emplace(
+        body,
+        make_not_null_unique<Ephemeris<Barycentric>::Events>(body)).first;
+  }
+  return *it->second;
 }
 
 inline void Vessel::WriteToMessage(
@@ -315,29 +413,226 @@ inline void Vessel::FlowProlongation(Instant const& time) {
 }
 
 inline void Vessel::FlowPrediction(Instant const& time) {
-  if (time > prediction_->last().time()) {
-    bool const finite_time = IsFinite(time - prediction_->last().time());
-    Instant const t = finite_time ? time : ephemeris_->t_max();
+  FlowPrediction(ephemeris_,
+                 prediction_adaptive_step_parameters_,
+                 time,
+                 prediction_,
+                 prediction_events_,
+                 /*abandoned=*/nullptr);
+}
+
+inline void Vessel::FlowPrediction(
+    not_null<Ephemeris<Barycentric>*> const ephemeris,
+    Ephemeris<Barycentric>::AdaptiveStepParameters const& parameters,
+    Instant const& time,
+    not_null<DiscreteTrajectory<Barycentric>*> const prediction,
+    PredictionEvents const& events,
+    std::atomic<bool> const* const abandoned) {
+  std::vector<not_null<Ephemeris<Barycentric>::Events*>> events_to_record;
+  for (auto const& pair : events) {
+    events_to_record.push_back(pair.second.get());
+  }
+  auto const flow = [ephemeris,
+                     &parameters,
+                     prediction,
+                     &events_to_record,
+                     abandoned](Instant const& t) {
+    if (abandoned == nullptr) {
+      return ephemeris->FlowWithAdaptiveStep(
+          prediction,
+          Ephemeris<Barycentric>::NoIntrinsicAcceleration,
+          t,
+          parameters,
+          FlightPlan::max_ephemeris_steps_per_frame,
+          events_to_record);
+    }
+    // Each chunk appends one point per step.  A chunk that appends fewer
+    // points than allowed stopped for another reason than its step count,
+    // e.g., because it reached |t|.
+    std::int64_t remaining_steps = parameters.max_steps();
+    Ephemeris<Barycentric>::AdaptiveStepParameters chunk_parameters =
+        parameters;
+    while (!*abandoned) {
+      std::int64_t const chunk_steps =
+          remaining_steps < internal_vessel::prediction_steps_per_chunk
+              ? remaining_steps
+              : internal_vessel::prediction_steps_per_chunk;
+      chunk_parameters.set_max_steps(chunk_steps);
+      int const size = prediction->Size();
+      bool const reached_t = ephemeris->FlowWithAdaptiveStep(
+          prediction,
+          Ephemeris<Barycentric>::NoIntrinsicAcceleration,
+          t,
+          chunk_parameters,
+          FlightPlan::max_ephemeris_steps_per_frame,
+          events_to_record);
+      remaining_steps -= chunk_steps;
+      if (reached_t || prediction->Size() - size < chunk_steps ||
+          remaining_steps == 0) {
+        return reached_t;
+      }
+    }
+    return false;
+  };
+
+  if (time > prediction->last().time()) {
+    bool const finite_time = IsFinite(time - prediction->last().time());
+    Instant const t = finite_time ? time : ephemeris->t_max();
     // This will not prolong the ephemeris if |time| is infinite (but it may do
     // so if it is finite).
-    bool const reached_t = ephemeris_->FlowWithAdaptiveStep(
-        prediction_,
-        Ephemeris<Barycentric>::NoIntrinsicAcceleration,
-        t,
-        prediction_adaptive_step_parameters_,
-        FlightPlan::max_ephemeris_steps_per_frame);
+    bool const reached_t = flow(t);
     if (!finite_time && reached_t) {
       // This will prolong the ephemeris by |max_ephemeris_steps_per_frame|.
-      ephemeris_->FlowWithAdaptiveStep(
-        prediction_,
-        Ephemeris<Barycentric>::NoIntrinsicAcceleration,
-        time,
-        prediction_adaptive_step_parameters_,
-        FlightPlan::max_ephemeris_steps_per_frame);
+      flow(time);
+    }
+  }
+}
+
+inline bool Vessel::ReusePrediction(
+    DiscreteTrajectory<Barycentric> const& old_prediction,
+    PredictionEvents const& old_events,
+    Instant const& last_time) {
+  Instant const start_time = prediction_->last().time();
+  auto it = old_prediction.LowerBound(start_time);
+  if (it != old_prediction.End() && it.time() == start_time) {
+    ++it;
+  }
+  if (it == old_prediction.End() || it.time() > last_time) {
+    return false;
+  }
+
+  // Check that the new starting point leads to the old trajectory.  If it
+  // doesn't, nothing is lost since |prediction_| is flowed anyway.
+  Instant const& first_time = it.time();
+  std::vector<not_null<Ephemeris<Barycentric>::Events*>> events_to_record;
+  for (auto const& pair : prediction_events_) {
+    events_to_record.push_back(pair.second.get());
+  }
+  ephemeris_->FlowWithAdaptiveStep(
+      prediction_,
+      Ephemeris<Barycentric>::NoIntrinsicAcceleration,
+      first_time,
+      prediction_adaptive_step_parameters_,
+      FlightPlan::max_ephemeris_steps_per_frame,
+      events_to_record);
+  auto const prediction_last = prediction_->last();
+  if (prediction_last.time() != first_time) {
+    return false;
+  }
+  DegreesOfFreedom<Barycentric> const& old_degrees_of_freedom =
+      it.degrees_of_freedom();
+  DegreesOfFreedom<Barycentric> const& new_degrees_of_freedom =
+      prediction_last.degrees_of_freedom();
+  if ((new_degrees_of_freedom.position() -
+       old_degrees_of_freedom.position()).Norm() >
+          prediction_adaptive_step_parameters_.length_integration_tolerance() ||
+      (new_degrees_of_freedom.velocity() -
+       old_degrees_of_freedom.velocity()).Norm() >
+          prediction_adaptive_step_parameters_.speed_integration_tolerance()) {
+    return false;
+  }
+
+  // The points are appended with their accelerations so that |prediction_| is
+  // interpolated as if it had been flowed.
+  for (++it; it != old_prediction.End() && it.time() <= last_time; ++it) {
+    prediction_->Append(it);
+  }
+
+  // The events of |old_prediction| in the steps that were appended.
+  Instant const& reused_last_time = prediction_->last().time();
+  auto const append_events =
+      [first_time, &reused_last_time](
+          DiscreteTrajectory<Barycentric> const& old_events,
+          DiscreteTrajectory<Barycentric>& new_events) {
+        for (auto it = old_events.LowerBound(first_time);
+             it != old_events.End() && it.time() <= reused_last_time;
+             ++it) {
+          if (it.time() > first_time) {
+            new_events.Append(it.time(), it.degrees_of_freedom());
+          }
+        }
+      };
+  for (auto const& pair : prediction_events_) {
+    Ephemeris<Barycentric>::Events const& from =
+        *FindOrDie(old_events, pair.first);
+    Ephemeris<Barycentric>::Events& to = *pair.second;
+    append_events(from.apoapsides, to.apoapsides);
+    append_events(from.periapsides, to.periapsides);
+    append_events(from.ascending_nodes, to.ascending_nodes);
+    append_events(from.descending_nodes, to.descending_nodes);
+    append_events(from.impacts, to.impacts);
+    append_events(from.singularities, to.singularities);
+  }
+  return true;
+}
+
+inline DiscreteTrajectory<Barycentric>* Vessel::ForkPrediction() {
+  DiscreteTrajectory<Barycentric>* const old_prediction = prediction_;
+  prediction_ = history_->NewForkAtLast();
+  auto const prolongation_last = prolongation_->last();
+  if (history_->last().time() != prolongation_last.time()) {
+    prediction_->Append(prolongation_last.time(),
+                        prolongation_last.degrees_of_freedom());
+  }
+  return old_prediction;
+}
+
+inline void Vessel::StartAsynchronousPrediction(Instant const& last_time) {
+  CHECK(asynchronous_prediction_ == nullptr);
+  asynchronous_prediction_ = std::make_unique<AsynchronousPrediction>(
+      prediction_adaptive_step_parameters_, last_time);
+  asynchronous_prediction_->events = NewPredictionEvents();
+  auto const prolongation_last = prolongation_->last();
+  asynchronous_prediction_->trajectory.Append(
+      prolongation_last.time(), prolongation_last.degrees_of_freedom());
+  not_null<AsynchronousPrediction*> const prediction =
+      asynchronous_prediction_.get();
+  not_null<Ephemeris<Barycentric>*> const ephemeris = ephemeris_;
+  prediction->done = std::async(std::launch::async, [ephemeris, prediction]() {
+    if (!prediction->abandoned) {
+      FlowPrediction(ephemeris,
+                     prediction->parameters,
+                     prediction->last_time,
+                     &prediction->trajectory,
+                     prediction->events,
+                     &prediction->abandoned);
     }
+  });
+}
+
+inline void Vessel::WaitForAsynchronousPrediction() {
+  if (asynchronous_prediction_ != nullptr) {
+    asynchronous_prediction_->abandoned = true;
+    asynchronous_prediction_->done.wait();
+    asynchronous_prediction_.reset();
   }
 }
 
+inline Vessel::PredictionEvents Vessel::NewPredictionEvents() {
+  PredictionEvents events;
+  for (auto it = prediction_events_requested_.begin();
+       it != prediction_events_requested_.end();) {
+    not_null<MassiveBody const*> const body = it->first;
+    bool& requested = it->second;
+    if (requested) {
+      events.emplace(
+          body, make_not_null_unique<Ephemeris<Barycentric>::Events>(body));
+      requested = false;
+      ++it;
+    } else {
+      it = prediction_events_requested_.erase(it);
+    }
+  }
+  return events;
+}
+
+inline Vessel::AsynchronousPrediction::AsynchronousPrediction(
+    Ephemeris<Barycentric>::AdaptiveStepParameters const& parameters,
+    Instant const& last_time)
+    : parameters(parameters),
+      last_time(last_time),
+      abandoned(false) {}
+
 inline Ephemeris<Barycentric>::FixedStepParameters DefaultHistoryParameters() {
   return Ephemeris<Barycentric>::FixedStepParameters(
              McLachlanAtela1992Order5Optimal<Position<Barycentric>>(),
@@ -172,20 +172,21 @@ class FlightPlanner : WindowRenderer {
           if (burn_editors_.Count > 0) {
             RenderUpcomingEvents();
           }
-          for (int i = 0; i < burn_editors_.Count - 1; ++i) {
-            UnityEngine.GUILayout.TextArea("Manœuvre #" + (i + 1) + ":");
-            burn_editors_[i].Render(enabled : false);
+          for (int i = 0; i < burn_editors_.Count; ++i) {
+            UnityEngine.GUILayout.TextArea("Editing manœuvre #" + (i + 1) +
+                                           ":");
+            if (burn_editors_[i].Render(enabled : true)) {
+              plugin_.FlightPlanReplace(vessel_guid,
+                                        burn_editors_[i].Burn(),
+                                        i);
+              // The masses of the subsequent manœuvres may have changed.
+              for (int j = i; j < burn_editors_.Count; ++j) {
+                burn_editors_[j].Reset(
+                    plugin_.FlightPlanGetManoeuvre(vessel_guid, j));
+              }
+            }
           }
           if (burn_editors_.Count > 0) {
-            BurnEditor last_burn = burn_editors_.Last();
-            UnityEngine.GUILayout.TextArea("Editing manœuvre #" +
-                                           (burn_editors_.Count) + ":");
-            if (last_burn.Render(enabled : true)) {
-              plugin_.FlightPlanReplaceLast(vessel_guid, last_burn.Burn());
-              last_burn.Reset(
-                  plugin_.FlightPlanGetManoeuvre(vessel_guid,
-                                                 burn_editors_.Count - 1));
-            }
             if (UnityEngine.GUILayout.Button(
                     "Delete last manœuvre",
                     UnityEngine.GUILayout.ExpandWidth(true))) {
@@ -17,11 +17,19 @@ public partial class PrincipiaPluginAdapter
       WindowRenderer.ManagerInterface {
 
   private const String principia_key = "serialized_plugin";
+  // The encoding of the values of |principia_key|.  Saves that don't have it
+  // predate the base64 encoding and are hexadecimal.
+  private const String principia_encoder_key = "serialization_encoder";
+  private const String serialization_encoder = "base64";
+  private const String legacy_serialization_encoder = "hexadecimal";
   private const String principia_initial_state_config_name =
       "principia_initial_state";
   private const String principia_gravity_model_config_name =
       "principia_gravity_model";
   private const double Δt = 10;
+  // How far ahead of the current time the plugin prolongs the ephemeris in the
+  // background.
+  private const double ephemeris_horizon = 86400;
 
   private KSP.UI.Screens.ApplicationLauncherButton toolbar_button_;
   private bool hide_all_gui_ = false;
@@ -409,9 +417,11 @@ where is_in_physics_bubble(vessel)
     if (PluginRunning()) {
       IntPtr serialization = IntPtr.Zero;
       IntPtr serializer = IntPtr.Zero;
+      node.AddValue(principia_encoder_key, serialization_encoder);
       for (;;) {
         try {
-          serialization = plugin_.SerializePlugin(ref serializer);
+          serialization = plugin_.SerializePlugin(ref serializer,
+                                                  serialization_encoder);
           if (serialization == IntPtr.Zero) {
             break;
           }
@@ -438,6 +448,9 @@ where is_in_physics_bubble(vessel)
       Log.SetVerboseLogging(verbose_logging_);
 
       IntPtr deserializer = IntPtr.Zero;
+      String encoder = node.HasValue(principia_encoder_key)
+                           ? node.GetValue(principia_encoder_key)
+                           : legacy_serialization_encoder;
       String[] serializations = node.GetValues(principia_key);
       Log.Info("Serialization has " + serializations.Length + " chunks");
       foreach (String serialization in serializations) {
@@ -446,9 +459,14 @@ where is_in_physics_bubble(vessel)
         Interface.DeserializePlugin(serialization,
                                     serialization.Length,
                                     ref deserializer,
-                                    ref plugin_);
+                                    ref plugin_,
+                                    encoder);
       }
-      Interface.DeserializePlugin("", 0, ref deserializer, ref plugin_);
+      Interface.DeserializePlugin("",
+                                  0,
+                                  ref deserializer,
+                                  ref plugin_,
+                                  encoder);
 
       plotting_frame_selector_.reset(
           new ReferenceFrameSelector(this, 
@@ -703,9 +721,10 @@ where is_in_physics_bubble(vessel)
             active_vessel.id.ToString(), adaptive_step_parameters);
         plugin_.SetPredictionLength(double.PositiveInfinity);
       }
+      plugin_.SetEphemerisHorizon(ephemeris_horizon);
       plugin_.AdvanceTime(universal_time, Planetarium.InverseRotAngle);
       if (ready_to_draw_active_vessel_trajectory) {
-        plugin_.UpdatePrediction(active_vessel.id.ToString());
+        plugin_.UpdatePredictionAsynchronously(active_vessel.id.ToString());
       }
       plugin_.ForgetAllHistoriesBefore(
           universal_time - history_lengths_[history_length_index_]);
@@ -338,6 +338,103 @@ TEST_F(FlightPlanTest, ReplaceLast) {
   EXPECT_EQ(1, flight_plan_->number_of_manœuvres());
 }
 
+TEST_F(FlightPlanTest, Replace) {
+  flight_plan_->SetDesiredFinalTime(t0_ + 42 * Second);
+  EXPECT_TRUE(flight_plan_->Append(MakeFirstBurn()));
+  EXPECT_TRUE(flight_plan_->Append(MakeSecondBurn()));
+  Mass const old_second_initial_mass =
+      flight_plan_->GetManœuvre(1).initial_mass();
+  DiscreteTrajectory<Barycentric>::Iterator old_begin;
+  DiscreteTrajectory<Barycentric>::Iterator old_end;
+  flight_plan_->GetSegment(0, &old_begin, &old_end);
+
+  // The first burn would end after the beginning of the second one.
+  auto overlapping_burn = MakeThirdBurn();
+  overlapping_burn.initial_time += 0.5 * Second;
+  EXPECT_FALSE(flight_plan_->Replace(std::move(overlapping_burn), 0));
+  EXPECT_EQ(2, flight_plan_->number_of_manœuvres());
+  EXPECT_EQ(old_second_initial_mass,
+            flight_plan_->GetManœuvre(1).initial_mass());
+
+  auto smaller_burn = MakeFirstBurn();
+  smaller_burn.Δv /= 2;
+  EXPECT_TRUE(flight_plan_->Replace(std::move(smaller_burn), 0));
+  EXPECT_EQ(2, flight_plan_->number_of_manœuvres());
+  EXPECT_EQ(5, flight_plan_->number_of_segments());
+  EXPECT_EQ(flight_plan_->GetManœuvre(0).final_mass(),
+            flight_plan_->GetManœuvre(1).initial_mass());
+  EXPECT_LT(old_second_initial_mass,
+            flight_plan_->GetManœuvre(1).initial_mass());
+  EXPECT_EQ(1 * Metre / Second, flight_plan_->GetManœuvre(1).Δv());
+  EXPECT_EQ(t0_ + 2 * Second, flight_plan_->GetManœuvre(1).initial_time());
+
+  // The first coast was reintegrated up to the same time.
+  DiscreteTrajectory<Barycentric>::Iterator begin;
+  DiscreteTrajectory<Barycentric>::Iterator end;
+  flight_plan_->GetSegment(0, &begin, &end);
+  EXPECT_EQ(old_begin, begin);
+  EXPECT_EQ(t0_ + 1 * Second, (--end).time());
+
+  // The result is the same as when building the flight plan from scratch.
+  FlightPlan flight_plan(
+      /*initial_mass=*/1 * Kilogram,
+      /*initial_time=*/root_.Begin().time(),
+      /*initial_degrees_of_freedom=*/root_.Begin().degrees_of_freedom(),
+      /*final_time=*/t0_ + 42 * Second,
+      ephemeris_.get(),
+      flight_plan_->adaptive_step_parameters());
+  smaller_burn = MakeFirstBurn();
+  smaller_burn.Δv /= 2;
+  EXPECT_TRUE(flight_plan.Append(std::move(smaller_burn)));
+  EXPECT_TRUE(flight_plan.Append(MakeSecondBurn()));
+  DiscreteTrajectory<Barycentric>::Iterator expected_begin;
+  DiscreteTrajectory<Barycentric>::Iterator expected_end;
+  flight_plan.GetSegment(4, &expected_begin, &expected_end);
+  flight_plan_->GetSegment(4, &begin, &end);
+  --expected_end;
+  --end;
+  EXPECT_EQ(expected_end.time(), end.time());
+  EXPECT_THAT(end.degrees_of_freedom().position(),
+              AlmostEquals(expected_end.degrees_of_freedom().position(),
+                           0, 10));
+}
+
+TEST_F(FlightPlanTest, EvaluateReplacementsOfLast) {
+  flight_plan_->SetDesiredFinalTime(t0_ + 42 * Second);
+  EXPECT_TRUE(flight_plan_->Append(MakeFirstBurn()));
+  EXPECT_TRUE(flight_plan_->Append(MakeSecondBurn()));
+
+  std::vector<Burn> burns;
+  for (int i = 0; i < 10; ++i) {
+    burns.push_back(MakeSecondBurn());
+    burns.back().Δv *= i + 1;
+  }
+  // Starts before the end of the first burn.
+  burns.push_back(MakeFirstBurn());
+  auto const final_states =
+      flight_plan_->EvaluateReplacementsOfLast(std::move(burns));
+  ASSERT_EQ(11, final_states.size());
+  EXPECT_FALSE(final_states.back());
+  EXPECT_EQ(2, flight_plan_->number_of_manœuvres());
+
+  // The final states are those that |ReplaceLast| produces.
+  for (int i = 0; i < 10; ++i) {
+    auto burn = MakeSecondBurn();
+    burn.Δv *= i + 1;
+    EXPECT_TRUE(flight_plan_->ReplaceLast(std::move(burn)));
+    ASSERT_TRUE(final_states[i]);
+    DiscreteTrajectory<Barycentric>::Iterator begin;
+    DiscreteTrajectory<Barycentric>::Iterator end;
+    flight_plan_->GetAllSegments(&begin, &end);
+    --end;
+    EXPECT_EQ(flight_plan_->actual_final_time(), final_states[i]->time);
+    EXPECT_EQ(end.degrees_of_freedom(),
+              final_states[i]->degrees_of_freedom);
+    EXPECT_EQ(flight_plan_->GetManœuvre(1).final_mass(),
+              final_states[i]->mass);
+  }
+}
+
 TEST_F(FlightPlanTest, Segments) {
   flight_plan_->SetDesiredFinalTime(t0_ + 42 * Second);
   EXPECT_TRUE(flight_plan_->Append(MakeFirstBurn()));
@@ -364,6 +461,80 @@ TEST_F(FlightPlanTest, Segments) {
   }
 }
 
+TEST_F(FlightPlanTest, GetSegmentEvents) {
+  not_null<MassiveBody const*> const body = ephemeris_->bodies().back();
+  flight_plan_->SetDesiredFinalTime(t0_ + 42 * Second);
+  EXPECT_TRUE(flight_plan_->Append(
+      MakeTangentBurn(/*thrust=*/1 * Newton,
+                      /*specific_impulse=*/1 * Newton * Second / Kilogram,
+                      /*initial_time=*/t0_ + 1 * Second,
+                      /*Δv=*/0.1 * Metre / Second)));
+  EXPECT_EQ(3, flight_plan_->number_of_segments());
+
+  DiscreteTrajectory<Barycentric>::Iterator begin;
+  DiscreteTrajectory<Barycentric>::Iterator end;
+  flight_plan_->GetAllSegments(&begin, &end);
+  auto const final_degrees_of_freedom = (--end).degrees_of_freedom();
+
+  // The first request for |body| recomputes the segments, which doesn't change
+  // them.
+  Ephemeris<Barycentric>::Events const& events =
+      flight_plan_->GetSegmentEvents(2, body);
+  flight_plan_->GetAllSegments(&begin, &end);
+  EXPECT_EQ(final_degrees_of_freedom, (--end).degrees_of_freedom());
+
+  // The apsides of the last coast agree with those computed after the fact.
+  flight_plan_->GetSegment(2, &begin, &end);
+  DiscreteTrajectory<Barycentric> apoapsides;
+  DiscreteTrajectory<Barycentric> periapsides;
+  ephemeris_->ComputeApsides(body, begin, end, apoapsides, periapsides);
+  EXPECT_LT(0, events.apoapsides.Size());
+  EXPECT_LT(0, events.periapsides.Size());
+  EXPECT_EQ(apoapsides.Size(), events.apoapsides.Size());
+  EXPECT_EQ(periapsides.Size(), events.periapsides.Size());
+  for (auto it1 = apoapsides.Begin(), it2 = events.apoapsides.Begin();
+       it1 != apoapsides.End();
+       ++it1, ++it2) {
+    EXPECT_THAT(AbsoluteError(it1.time(), it2.time()),
+                Lt(10 * Milli(Second)));
+  }
+  for (auto it1 = periapsides.Begin(), it2 = events.periapsides.Begin();
+       it1 != periapsides.End();
+       ++it1, ++it2) {
+    EXPECT_THAT(AbsoluteError(it1.time(), it2.time()),
+                Lt(10 * Milli(Second)));
+  }
+
+  // The events follow the segments when they are recomputed.
+  EXPECT_TRUE(flight_plan_->SetDesiredFinalTime(t0_ + 21 * Second));
+  Ephemeris<Barycentric>::Events const& shortened_events =
+      flight_plan_->GetSegmentEvents(2, body);
+  EXPECT_LT(0, shortened_events.apoapsides.Size());
+  EXPECT_LT(shortened_events.apoapsides.Size(), apoapsides.Size());
+  EXPECT_GE(t0_ + 21 * Second, shortened_events.apoapsides.last().time());
+  Instant const first_apoapsis_time =
+      shortened_events.apoapsides.Begin().time();
+
+  // A larger Δv gives a longer period, so the first apoapsis is later.
+  EXPECT_TRUE(flight_plan_->ReplaceLast(
+      MakeTangentBurn(/*thrust=*/1 * Newton,
+                      /*specific_impulse=*/1 * Newton * Second / Kilogram,
+                      /*initial_time=*/t0_ + 1 * Second,
+                      /*Δv=*/0.2 * Metre / Second)));
+  Ephemeris<Barycentric>::Events const& replaced_events =
+      flight_plan_->GetSegmentEvents(2, body);
+  EXPECT_LT(0, replaced_events.apoapsides.Size());
+  EXPECT_LT(first_apoapsis_time, replaced_events.apoapsides.Begin().time());
+
+  // The events before the beginning of the flight plan are forgotten.
+  flight_plan_->ForgetBefore(t0_ + 5 * Second, [] {});
+  EXPECT_EQ(1, flight_plan_->number_of_segments());
+  Ephemeris<Barycentric>::Events const& remaining_events =
+      flight_plan_->GetSegmentEvents(0, body);
+  EXPECT_LT(0, remaining_events.apoapsides.Size());
+  EXPECT_LE(t0_ + 5 * Second, remaining_events.apoapsides.Begin().time());
+}
+
 TEST_F(FlightPlanTest, SetAdaptiveStepParameter) {
   DiscreteTrajectory<Barycentric>::Iterator begin;
   DiscreteTrajectory<Barycentric>::Iterator end;
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "astronomy/epoch.hpp"
+#include "base/base64.hpp"
 #include "base/not_null.hpp"
 #include "base/pull_serializer.hpp"
 #include "base/push_deserializer.hpp"
@@ -24,6 +25,7 @@
 namespace principia {
 
 using astronomy::UnixEpoch;
+using base::Base64EncodedSize;
 using base::check_not_null;
 using base::PullSerializer;
 using base::PushDeserializer;
@@ -64,6 +66,7 @@ using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::Property;
 using ::testing::ExitedWithCode;
+using ::testing::Invoke;
 using ::testing::IsNull;
 using ::testing::NotNull;
 using ::testing::Pointee;
@@ -374,6 +377,16 @@ TEST_F(InterfaceTest, AdvanceTime) {
   principia__AdvanceTime(plugin_.get(), time, planetarium_rotation);
 }
 
+TEST_F(InterfaceTest, SetNumberOfVesselThreads) {
+  EXPECT_CALL(*plugin_, SetNumberOfVesselThreads(4));
+  principia__SetNumberOfVesselThreads(plugin_.get(), 4);
+}
+
+TEST_F(InterfaceTest, SetEphemerisHorizon) {
+  EXPECT_CALL(*plugin_, SetEphemerisHorizon(86400 * Second));
+  principia__SetEphemerisHorizon(plugin_.get(), 86400);
+}
+
 TEST_F(InterfaceTest, ForgetAllHistoriesBefore) {
   EXPECT_CALL(*plugin_,
               ForgetAllHistoriesBefore(t0_ + time * SIUnit<Time>()));
@@ -792,11 +805,18 @@ TEST_F(InterfaceTest, SerializePlugin) {
   principia::serialization::Plugin message;
   message.ParseFromString(message_bytes);
 
-  EXPECT_CALL(*plugin_, WriteToMessage(_)).WillOnce(SetArgPointee<0>(message));
+  EXPECT_CALL(*plugin_, WriteToMessageInPieces(_))
+      .WillOnce(Invoke(
+          [&message](std::function<void(
+                         not_null<serialization::Plugin*> const piece)> const&
+                         write_piece) { write_piece(&message); }));
   char const* serialization =
-      principia__SerializePlugin(plugin_.get(), &serializer);
+      principia__SerializePlugin(plugin_.get(), &serializer, "hexadecimal");
   EXPECT_STREQ(hexadecimal_boring_plugin, serialization);
-  EXPECT_EQ(nullptr, principia__SerializePlugin(plugin_.get(), &serializer));
+  EXPECT_EQ(nullptr,
+            principia__SerializePlugin(plugin_.get(),
+                                       &serializer,
+                                       "hexadecimal"));
   principia__DeletePluginSerialization(&serialization);
   EXPECT_THAT(serialization, IsNull());
 }
@@ -808,11 +828,72 @@ TEST_F(InterfaceTest, DeserializePlugin) {
           hexadecimal_boring_plugin,
           (sizeof(hexadecimal_boring_plugin) - 1) / sizeof(char),
           &deserializer,
-          &plugin);
+          &plugin,
+          "hexadecimal");
+  principia__DeserializePlugin(hexadecimal_boring_plugin,
+                               0,
+                               &deserializer,
+                               &plugin,
+                               "hexadecimal");
+  EXPECT_THAT(plugin, NotNull());
+  EXPECT_EQ(Instant(), plugin->CurrentTime());
+  principia__DeletePlugin(&plugin);
+}
+
+// The journals that predate the base64 encoding have no encoder, which is
+// replayed as a null pointer.
+TEST_F(InterfaceTest, DeserializePluginWithoutEncoder) {
+  PushDeserializer* deserializer = nullptr;
+  Plugin const* plugin = nullptr;
+  principia__DeserializePlugin(
+          hexadecimal_boring_plugin,
+          (sizeof(hexadecimal_boring_plugin) - 1) / sizeof(char),
+          &deserializer,
+          &plugin,
+          /*encoder=*/nullptr);
   principia__DeserializePlugin(hexadecimal_boring_plugin,
                                0,
                                &deserializer,
-                               &plugin);
+                               &plugin,
+                               /*encoder=*/nullptr);
+  EXPECT_THAT(plugin, NotNull());
+  EXPECT_EQ(Instant(), plugin->CurrentTime());
+  principia__DeletePlugin(&plugin);
+}
+
+TEST_F(InterfaceTest, Base64Serialization) {
+  PullSerializer* serializer = nullptr;
+  std::string const message_bytes =
+      std::string(serialized_boring_plugin,
+                  (sizeof(serialized_boring_plugin) - 1) / sizeof(char));
+  principia::serialization::Plugin message;
+  message.ParseFromString(message_bytes);
+
+  EXPECT_CALL(*plugin_, WriteToMessageInPieces(_))
+      .WillOnce(Invoke(
+          [&message](std::function<void(
+                         not_null<serialization::Plugin*> const piece)> const&
+                         write_piece) { write_piece(&message); }));
+  char const* serialization =
+      principia__SerializePlugin(plugin_.get(), &serializer, "base64");
+  std::string const base64 = serialization;
+  EXPECT_EQ(Base64EncodedSize(message_bytes.size()), base64.size());
+  EXPECT_EQ(nullptr,
+            principia__SerializePlugin(plugin_.get(), &serializer, "base64"));
+  principia__DeletePluginSerialization(&serialization);
+
+  PushDeserializer* deserializer = nullptr;
+  Plugin const* plugin = nullptr;
+  principia__DeserializePlugin(base64.c_str(),
+                               base64.size(),
+                               &deserializer,
+                               &plugin,
+                               "base64");
+  principia__DeserializePlugin(base64.c_str(),
+                               0,
+                               &deserializer,
+                               &plugin,
+                               "base64");
   EXPECT_THAT(plugin, NotNull());
   EXPECT_EQ(Instant(), plugin->CurrentTime());
   principia__DeletePlugin(&plugin);
@@ -1061,6 +1142,26 @@ TEST_F(InterfaceTest, FlightPlan) {
                                                vessel_guid,
                                                burn));
 
+  EXPECT_CALL(*plugin_,
+              FillBodyCentredNonRotatingNavigationFrame(celestial_index, _))
+      .WillOnce(FillUniquePtr<1>(
+                    new StrictMock<MockDynamicFrame<Barycentric, Navigation>>));
+  EXPECT_CALL(flight_plan,
+              ReplaceConstRef(
+                  BurnMatches(10 * Kilo(Newton),
+                              2 * Second * StandardGravity,
+                              Instant() + 3 * Second,
+                              Velocity<Frenet<Navigation>>(
+                                  {4 * (Metre / Second),
+                                   5 * (Metre / Second),
+                                   6 * (Metre / Second)})),
+                  1))
+      .WillOnce(Return(true));
+  EXPECT_TRUE(principia__FlightPlanReplace(plugin_.get(),
+                                           vessel_guid,
+                                           burn,
+                                           1));
+
   EXPECT_CALL(flight_plan, RemoveLast());
   principia__FlightPlanRemoveLast(plugin_.get(), vessel_guid);
 
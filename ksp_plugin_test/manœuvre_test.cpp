@@ -187,6 +187,30 @@ TEST_F(ManœuvreTest, TargetΔv) {
             acceleration(manœuvre.final_time() + 1 * Second).Norm());
 }
 
+TEST_F(ManœuvreTest, InitialMass) {
+  Vector<double, Frenet<Rendering>> e_y({0, 1, 0});
+
+  Manœuvre<World, Rendering> manœuvre(
+      /*thrust=*/1 * Newton,
+      /*initial_mass=*/2 * Kilogram,
+      /*specific_impulse=*/1 * Newton * Second / Kilogram,
+      /*direction=*/e_y,
+      MakeMockDynamicFrame());
+  manœuvre.set_Δv(1 * Metre / Second);
+  manœuvre.set_initial_time(t0_);
+
+  // Only the mass and the quantities that depend on it change.
+  Manœuvre<World, Rendering> const lighter(manœuvre, 1 * Kilogram);
+  EXPECT_EQ(1 * Newton, lighter.thrust());
+  EXPECT_EQ(1 * Kilogram, lighter.initial_mass());
+  EXPECT_EQ(1 * Metre / Second, lighter.specific_impulse());
+  EXPECT_EQ(e_y, lighter.direction());
+  EXPECT_EQ(manœuvre.frame(), lighter.frame());
+  EXPECT_EQ(t0_, lighter.initial_time());
+  EXPECT_THAT(lighter.Δv(), AlmostEquals(1 * Metre / Second, 0, 1));
+  EXPECT_EQ(manœuvre.duration() / 2, lighter.duration());
+}
+
 TEST_F(ManœuvreTest, Apollo8SIVB) {
   // Data from NASA's Saturn V Launch Vehicle, Flight Evaluation Report AS-503,
   // Apollo 8 Mission (1969),
@@ -12,5 +12,9 @@ bool MockFlightPlan::ReplaceLast(Burn burn) {
   return ReplaceLastConstRef(burn);
 }
 
+bool MockFlightPlan::Replace(Burn burn, int const index) {
+  return ReplaceConstRef(burn, index);
+}
+
 }  // namespace ksp_plugin
 }  // namespace principia
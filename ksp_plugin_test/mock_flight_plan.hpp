@@ -21,9 +21,11 @@ class MockFlightPlan : public FlightPlan {
 
   MOCK_CONST_METHOD1(AppendConstRef, bool(Burn const& burn));
   MOCK_CONST_METHOD1(ReplaceLastConstRef, bool(Burn const& burn));
+  MOCK_CONST_METHOD2(ReplaceConstRef, bool(Burn const& burn, int const index));
 
   bool Append(Burn burn);
   bool ReplaceLast(Burn burn);
+  bool Replace(Burn burn, int const index);
 
   MOCK_METHOD1(SetDesiredFinalTime, bool(Instant const& final_time));
 
@@ -44,6 +46,11 @@ class MockFlightPlan : public FlightPlan {
       void(int const index,
            not_null<DiscreteTrajectory<Barycentric>::Iterator*> begin,
            not_null<DiscreteTrajectory<Barycentric>::Iterator*> end));
+
+  MOCK_METHOD2(GetSegmentEvents,
+               Ephemeris<Barycentric>::Events const&(
+                   int const index,
+                   not_null<MassiveBody const*> const body));
 };
 
 }  // namespace ksp_plugin
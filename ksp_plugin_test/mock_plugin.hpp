@@ -50,6 +50,10 @@ class MockPlugin : public Plugin {
   MOCK_METHOD2(AdvanceTime,
                void(Instant const& t, Angle const& planetarium_rotation));
 
+  MOCK_METHOD1(SetNumberOfVesselThreads, void(int number_of_threads));
+
+  MOCK_METHOD1(SetEphemerisHorizon, void(Time const& horizon));
+
   MOCK_CONST_METHOD1(ForgetAllHistoriesBefore, void(Instant const& t));
 
   MOCK_CONST_METHOD1(VesselFromParent,
@@ -184,6 +188,10 @@ class MockPlugin : public Plugin {
 
   MOCK_CONST_METHOD1(WriteToMessage,
                      void(not_null<serialization::Plugin*> const message));
+  MOCK_CONST_METHOD1(
+      WriteToMessageInPieces,
+      void(std::function<void(not_null<serialization::Plugin*> const piece)>
+               const& write_piece));
 };
 
 }  // namespace ksp_plugin
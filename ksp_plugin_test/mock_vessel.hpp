@@ -44,6 +44,8 @@ class MockVessel : public Vessel {
   MOCK_METHOD0(DeleteFlightPlan, void());
 
   MOCK_METHOD1(UpdatePrediction, void(Instant const& last_time));
+  MOCK_METHOD1(UpdatePredictionAsynchronously,
+               void(Instant const& last_time));
 
   MOCK_CONST_METHOD1(WriteToMessage, void(
       not_null<serialization::Vessel*> const message));
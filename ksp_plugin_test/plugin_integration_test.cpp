@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <string>
 #include <vector>
 
 #include "astronomy/frames.hpp"
@@ -224,6 +225,93 @@ TEST_F(PluginIntegrationTest, BodyCentredNonrotatingNavigationIntegration) {
   }
 }
 
+// Checks that flowing the vessels on several threads yields the same
+// trajectories as flowing them sequentially.
+TEST_F(PluginIntegrationTest, ParallelVessels) {
+  int const number_of_vessels = 10;
+  auto const advance_vessels = [this](int const number_of_threads) {
+    plugin_ = make_not_null_unique<Plugin>(initial_time_,
+                                           planetarium_rotation_);
+    InsertAllSolarSystemBodies();
+    plugin_->EndInitialization();
+    plugin_->SetNumberOfVesselThreads(number_of_threads);
+    for (int i = 0; i < number_of_vessels; ++i) {
+      GUID const satellite = "satellite" + std::to_string(i);
+      plugin_->InsertOrKeepVessel(satellite, SolarSystemFactory::Earth);
+      plugin_->SetVesselStateOffset(
+          satellite,
+          RelativeDegreesOfFreedom<AliceSun>(
+              (1 + 0.1 * i) * satellite_initial_displacement_,
+              satellite_initial_velocity_ / Sqrt(1 + 0.1 * i)));
+    }
+    for (Instant t = initial_time_ + 10 * Minute;
+         t < initial_time_ + 2 * Hour;
+         t += 10 * Minute) {
+      plugin_->AdvanceTime(t, planetarium_rotation_);
+      for (int i = 0; i < number_of_vessels; ++i) {
+        plugin_->InsertOrKeepVessel("satellite" + std::to_string(i),
+                                    SolarSystemFactory::Earth);
+      }
+    }
+    std::vector<RelativeDegreesOfFreedom<AliceSun>> result;
+    for (int i = 0; i < number_of_vessels; ++i) {
+      result.push_back(
+          plugin_->VesselFromParent("satellite" + std::to_string(i)));
+    }
+    return result;
+  };
+
+  auto const sequential = advance_vessels(/*number_of_threads=*/1);
+  auto const parallel = advance_vessels(/*number_of_threads=*/4);
+  for (int i = 0; i < number_of_vessels; ++i) {
+    EXPECT_EQ(sequential[i].displacement(), parallel[i].displacement()) << i;
+    EXPECT_EQ(sequential[i].velocity(), parallel[i].velocity()) << i;
+  }
+}
+
+// Checks that prolonging the ephemeris ahead of time on another thread doesn't
+// change the trajectories.
+TEST_F(PluginIntegrationTest, EphemerisHorizon) {
+  GUID const satellite = "satellite";
+  auto const advance_vessel = [this, &satellite](Time const& horizon) {
+    plugin_ = make_not_null_unique<Plugin>(initial_time_,
+                                           planetarium_rotation_);
+    InsertAllSolarSystemBodies();
+    plugin_->EndInitialization();
+    plugin_->SetEphemerisHorizon(horizon);
+    plugin_->InsertOrKeepVessel(satellite, SolarSystemFactory::Earth);
+    plugin_->SetVesselStateOffset(satellite,
+                                  RelativeDegreesOfFreedom<AliceSun>(
+                                      satellite_initial_displacement_,
+                                      satellite_initial_velocity_));
+    for (Instant t = initial_time_ + 10 * Minute;
+         t < initial_time_ + 6 * Hour;
+         t += 10 * Minute) {
+      plugin_->AdvanceTime(t, planetarium_rotation_);
+      plugin_->InsertOrKeepVessel(satellite, SolarSystemFactory::Earth);
+    }
+    return plugin_->VesselFromParent(satellite);
+  };
+
+  auto const synchronous = advance_vessel(/*horizon=*/Time());
+  auto const ahead = advance_vessel(/*horizon=*/1 * Day);
+  EXPECT_EQ(synchronous.displacement(), ahead.displacement());
+  EXPECT_EQ(synchronous.velocity(), ahead.velocity());
+}
+
+// Checks that the part of the ephemeris computed ahead of time is not saved.
+TEST_F(PluginIntegrationTest, EphemerisHorizonSerialization) {
+  InsertAllSolarSystemBodies();
+  plugin_->EndInitialization();
+  plugin_->SetEphemerisHorizon(1 * Day);
+  Instant const t = initial_time_ + 1 * Hour;
+  plugin_->AdvanceTime(t, planetarium_rotation_);
+  serialization::Plugin message;
+  plugin_->WriteToMessage(&message);
+  ASSERT_TRUE(message.ephemeris().has_t_max());
+  EXPECT_EQ(t, Instant::ReadFromMessage(message.ephemeris().t_max()));
+}
+
 TEST_F(PluginIntegrationTest, BarycentricRotatingNavigationIntegration) {
   InsertAllSolarSystemBodies();
   plugin_->EndInitialization();
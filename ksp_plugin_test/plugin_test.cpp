@@ -40,6 +40,7 @@ using geometry::Permutation;
 using geometry::Trivector;
 using integrators::McLachlanAtela1992Order5Optimal;
 using physics::ContinuousTrajectory;
+using physics::DiscreteTrajectory;
 using physics::KeplerianElements;
 using physics::KeplerOrbit;
 using physics::MockDynamicFrame;
@@ -391,17 +392,21 @@ TEST_F(PluginTest, Serialization) {
   EXPECT_EQ(SolarSystemFactory::Earth, message.vessel(0).parent_index());
   EXPECT_TRUE(message.vessel(0).vessel().has_flight_plan());
   EXPECT_TRUE(message.vessel(0).vessel().has_history());
-  auto const& vessel_0_history = message.vessel(0).vessel().history();
+  // The points of the history, without its forks.
+  serialization::DiscreteTrajectory vessel_0_history_message =
+      message.vessel(0).vessel().history();
+  vessel_0_history_message.clear_children();
+  vessel_0_history_message.clear_fork_position();
+  auto const vessel_0_history =
+      DiscreteTrajectory<Barycentric>::ReadFromMessage(vessel_0_history_message,
+                                                       /*forks=*/{});
 #if defined(WE_LOVE_228)
-  EXPECT_EQ(2, vessel_0_history.timeline_size());
-  EXPECT_EQ((HistoryTime(time, 3) - shift - Instant()) / (1 * Second),
-            vessel_0_history.timeline(0).instant().scalar().magnitude());
-  EXPECT_EQ((HistoryTime(time, 6) - shift - Instant()) / (1 * Second),
-            vessel_0_history.timeline(1).instant().scalar().magnitude());
+  EXPECT_EQ(2, vessel_0_history->Size());
+  EXPECT_EQ(HistoryTime(time, 3) - shift, vessel_0_history->Begin().time());
+  EXPECT_EQ(HistoryTime(time, 6) - shift, vessel_0_history->last().time());
 #else
-  EXPECT_EQ(3, vessel_0_history.timeline_size());
-  EXPECT_EQ((HistoryTime(time, 4) - Instant()) / (1 * Second),
-            vessel_0_history.timeline(0).instant().scalar().magnitude());
+  EXPECT_EQ(3, vessel_0_history->Size());
+  EXPECT_EQ(HistoryTime(time, 4), vessel_0_history->Begin().time());
 #endif
   EXPECT_FALSE(message.bubble().has_current());
   EXPECT_TRUE(message.has_plotting_frame());
@@ -603,6 +608,8 @@ TEST_F(PluginTest, ForgetAllHistoriesBeforeWithFlightPlan) {
   EXPECT_CALL(*mock_ephemeris_, Prolong(_)).Times(AnyNumber());
   EXPECT_CALL(*mock_ephemeris_, FlowWithAdaptiveStep(_, _, _, _, _))
       .WillRepeatedly(DoAll(AppendToDiscreteTrajectory(), Return(true)));
+  EXPECT_CALL(*mock_ephemeris_, FlowWithAdaptiveStep(_, _, _, _, _, _))
+      .WillRepeatedly(DoAll(AppendToDiscreteTrajectory(), Return(true)));
   EXPECT_CALL(*mock_ephemeris_, FlowWithFixedStep(_, _, _, _))
       .WillRepeatedly(AppendToDiscreteTrajectories());
   EXPECT_CALL(*mock_ephemeris_, planetary_integrator())
@@ -678,6 +685,8 @@ TEST_F(PluginTest, ForgetAllHistoriesBeforeAfterPredictionFork) {
   EXPECT_CALL(*mock_ephemeris_, Prolong(_)).Times(AnyNumber());
   EXPECT_CALL(*mock_ephemeris_, FlowWithAdaptiveStep(_, _, _, _, _))
       .WillRepeatedly(DoAll(AppendToDiscreteTrajectory(), Return(true)));
+  EXPECT_CALL(*mock_ephemeris_, FlowWithAdaptiveStep(_, _, _, _, _, _))
+      .WillRepeatedly(DoAll(AppendToDiscreteTrajectory(), Return(true)));
   EXPECT_CALL(*mock_ephemeris_, FlowWithFixedStep(_, _, _, _))
       .WillRepeatedly(AppendToDiscreteTrajectories());
   EXPECT_CALL(*mock_ephemeris_, planetary_integrator())
@@ -706,6 +715,72 @@ TEST_F(PluginTest, ForgetAllHistoriesBeforeAfterPredictionFork) {
       plugin_->RenderedPrediction(guid, World::origin);
 }
 
+TEST_F(PluginTest, RenderedVesselTrajectory) {
+  GUID const guid = "Test Satellite";
+
+  InsertAllSolarSystemBodies();
+  EXPECT_CALL(*mock_ephemeris_, WriteToMessage(_))
+      .WillOnce(SetArgPointee<0>(valid_ephemeris_message_));
+  plugin_->EndInitialization();
+
+  EXPECT_CALL(*mock_ephemeris_, t_max()).WillRepeatedly(Return(Instant()));
+  EXPECT_CALL(*mock_ephemeris_, empty()).WillRepeatedly(Return(false));
+  EXPECT_CALL(*mock_ephemeris_, trajectory(_))
+      .WillRepeatedly(Return(plugin_->trajectory(SolarSystemFactory::Sun)));
+  EXPECT_CALL(*mock_ephemeris_, Prolong(_)).Times(AnyNumber());
+  EXPECT_CALL(*mock_ephemeris_, ForgetBefore(_)).Times(AnyNumber());
+  EXPECT_CALL(*mock_ephemeris_, FlowWithAdaptiveStep(_, _, _, _, _))
+      .WillRepeatedly(DoAll(AppendToDiscreteTrajectory(), Return(true)));
+  EXPECT_CALL(*mock_ephemeris_, FlowWithAdaptiveStep(_, _, _, _, _, _))
+      .WillRepeatedly(DoAll(AppendToDiscreteTrajectory(), Return(true)));
+  EXPECT_CALL(*mock_ephemeris_, FlowWithFixedStep(_, _, _, _))
+      .WillRepeatedly(AppendToDiscreteTrajectories());
+  EXPECT_CALL(*mock_ephemeris_, planetary_integrator())
+      .WillRepeatedly(
+          ReturnRef(McLachlanAtela1992Order5Optimal<Position<Barycentric>>()));
+
+  plugin_->SetPlottingFrame(plugin_->NewBodyCentredNonRotatingNavigationFrame(
+      SolarSystemFactory::Sun));
+  plugin_->InsertOrKeepVessel(guid, SolarSystemFactory::Earth);
+  plugin_->SetVesselStateOffset(guid,
+                                RelativeDegreesOfFreedom<AliceSun>(
+                                    satellite_initial_displacement_,
+                                    satellite_initial_velocity_));
+  Vessel const& vessel = *plugin_->GetVessel(guid);
+
+  // The rendered history must be the same as if the points were transformed
+  // from scratch, whether or not they come from the cache.
+  auto const expect_rendered_history = [this, &guid, &vessel]() {
+    auto const rendered = plugin_->RenderedVesselTrajectory(guid,
+                                                            World::origin);
+    auto const expected =
+        plugin_->RenderedTrajectoryFromIterators(vessel.history().Begin(),
+                                                 vessel.history().End(),
+                                                 World::origin);
+    ASSERT_EQ(expected->Size(), rendered->Size());
+    for (auto it1 = expected->Begin(), it2 = rendered->Begin();
+         it1 != expected->End();
+         ++it1, ++it2) {
+      EXPECT_EQ(it1.time(), it2.time());
+      EXPECT_EQ(it1.degrees_of_freedom(), it2.degrees_of_freedom());
+    }
+  };
+
+  Instant const& time = initial_time_ + 1 * Second;
+  plugin_->AdvanceTime(time, Angle());
+  plugin_->InsertOrKeepVessel(guid, SolarSystemFactory::Earth);
+  plugin_->AdvanceTime(HistoryTime(time, 3), Angle());
+  expect_rendered_history();
+  plugin_->InsertOrKeepVessel(guid, SolarSystemFactory::Earth);
+  plugin_->AdvanceTime(HistoryTime(time, 6), Angle());
+  expect_rendered_history();
+  plugin_->ForgetAllHistoriesBefore(HistoryTime(time, 5));
+  expect_rendered_history();
+  plugin_->SetPlottingFrame(plugin_->NewBodyCentredNonRotatingNavigationFrame(
+      SolarSystemFactory::Sun));
+  expect_rendered_history();
+}
+
 TEST_F(PluginDeathTest, VesselFromParentError) {
   GUID const guid = "Test Satellite";
   EXPECT_DEATH({
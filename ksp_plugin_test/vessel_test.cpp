@@ -1,22 +1,29 @@
 ﻿
 #include "ksp_plugin/vessel.hpp"
 
+#include <chrono>
 #include <limits>
+#include <thread>
 
+#include "geometry/barycentre_calculator.hpp"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "physics/ephemeris.hpp"
 #include "physics/solar_system.hpp"
+#include "testing_utilities/numerics.hpp"
 
 namespace principia {
 
+using geometry::Barycentre;
 using geometry::Displacement;
 using physics::Ephemeris;
+using physics::MassiveBody;
 using physics::SolarSystem;
 using quantities::si::Kilo;
 using quantities::si::Kilogram;
 using quantities::si::Metre;
 using quantities::si::Second;
+using testing_utilities::AbsoluteError;
 using ::testing::AllOf;
 using ::testing::Eq;
 using ::testing::Gt;
@@ -156,6 +163,192 @@ TEST_F(VesselTest, Prediction) {
   EXPECT_LE(t3_, vessel_->prediction().last().time());
 }
 
+TEST_F(VesselTest, IncrementalPrediction) {
+  vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel_->AdvanceTimeNotInBubble(t2_);
+  vessel_->UpdatePrediction(t3_);
+  std::vector<Instant> old_times;
+  std::vector<DegreesOfFreedom<Barycentric>> old_degrees_of_freedom;
+  for (auto it = vessel_->prediction().Fork();
+       it != vessel_->prediction().End();
+       ++it) {
+    old_times.push_back(it.time());
+    old_degrees_of_freedom.push_back(it.degrees_of_freedom());
+  }
+  ASSERT_LT(4, old_times.size());
+
+  // Advancing a little reuses the points of the previous prediction.  The
+  // first point after the prolongation is recomputed.
+  Instant const t2_bis = t2_ + 0.1 * Second;
+  Instant const t3_bis = t3_ + 0.1 * Second;
+  vessel_->AdvanceTimeNotInBubble(t2_bis);
+  vessel_->UpdatePrediction(t3_bis);
+  EXPECT_EQ(t3_bis, vessel_->prediction().last().time());
+  for (int i = 3; i < old_times.size() - 1; ++i) {
+    auto const it = vessel_->prediction().Find(old_times[i]);
+    ASSERT_NE(it, vessel_->prediction().End());
+    EXPECT_EQ(old_degrees_of_freedom[i], it.degrees_of_freedom());
+  }
+
+  // The result is close to a prediction computed from scratch, which doesn't
+  // reuse the points since the parameters changed.
+  auto const last = vessel_->prediction().last().degrees_of_freedom();
+  vessel_->set_prediction_adaptive_step_parameters(
+      Ephemeris<Barycentric>::AdaptiveStepParameters(
+          DormandElMikkawyPrince1986RKN434FM<Position<Barycentric>>(),
+          /*max_steps=*/2000,
+          /*length_integration_tolerance=*/1 * Metre,
+          /*speed_integration_tolerance=*/1 * Metre / Second));
+  vessel_->UpdatePrediction(t3_bis);
+  EXPECT_EQ(t3_bis, vessel_->prediction().last().time());
+  EXPECT_THAT(
+      (vessel_->prediction().last().degrees_of_freedom().position() -
+       last.position()).Norm(),
+      Lt(1 * Metre));
+  EXPECT_EQ(vessel_->prediction().Find(old_times[3]),
+            vessel_->prediction().End());
+}
+
+TEST_F(VesselTest, IncrementalPredictionInterpolation) {
+  vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel_->AdvanceTimeNotInBubble(t2_);
+  Instant const t4 = t3_ + 1000 * Second;
+  vessel_->UpdatePrediction(t4);
+  std::vector<Instant> old_midpoints;
+  std::vector<DegreesOfFreedom<Barycentric>> old_degrees_of_freedom;
+  for (auto it = vessel_->prediction().Fork();
+       it != vessel_->prediction().last();
+       ++it) {
+    auto next = it;
+    ++next;
+    old_midpoints.push_back(
+        Barycentre<Instant, double>({it.time(), next.time()}, {1, 1}));
+    old_degrees_of_freedom.push_back(
+        vessel_->prediction().EvaluateDegreesOfFreedom(old_midpoints.back()));
+  }
+  ASSERT_LT(10, old_midpoints.size());
+
+  // The reused points keep the accelerations of their steps, so they are
+  // interpolated as before.  The first two steps after the prolongation are
+  // recomputed.
+  vessel_->AdvanceTimeNotInBubble(t2_ + 0.1 * Second);
+  vessel_->UpdatePrediction(t4 + 0.1 * Second);
+  for (int i = 3; i < old_midpoints.size() - 1; ++i) {
+    EXPECT_EQ(old_degrees_of_freedom[i],
+              vessel_->prediction().EvaluateDegreesOfFreedom(
+                  old_midpoints[i]));
+  }
+}
+
+TEST_F(VesselTest, AsynchronousPrediction) {
+  vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel_->AdvanceTimeNotInBubble(t2_);
+  vessel_->UpdatePredictionAsynchronously(t3_);
+  auto const deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (vessel_->prediction().last().time() != t3_) {
+    ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    vessel_->UpdatePredictionAsynchronously(t3_);
+  }
+
+  // Same as the synchronous computation.
+  Vessel synchronous_vessel(earth_.get(),
+                            ephemeris_.get(),
+                            history_fixed_parameters_,
+                            adaptive_parameters_,
+                            adaptive_parameters_);
+  synchronous_vessel.CreateHistoryAndForkProlongation(t1_, d1_);
+  synchronous_vessel.AdvanceTimeNotInBubble(t2_);
+  synchronous_vessel.UpdatePrediction(t3_);
+  EXPECT_EQ(synchronous_vessel.prediction().Size(),
+            vessel_->prediction().Size());
+  EXPECT_EQ(synchronous_vessel.prediction().last().degrees_of_freedom(),
+            vessel_->prediction().last().degrees_of_freedom());
+}
+
+TEST_F(VesselTest, PredictionEvents) {
+  // An eccentric orbit around the body of |earth_|, which is at the origin at
+  // |t0_|.
+  not_null<MassiveBody const*> const body = earth_->body();
+  DegreesOfFreedom<Barycentric> const d = {
+      Barycentric::origin +
+          Displacement<Barycentric>({1 * Kilo(Metre), 0 * Metre, 0 * Metre}),
+      Velocity<Barycentric>({-0.33806170189140663100 * Kilo(Metre) / Second,
+                             1.8 * Kilo(Metre) / Second,
+                             0 * Kilo(Metre) / Second})};
+  vessel_->CreateHistoryAndForkProlongation(t0_, d);
+  vessel_->AdvanceTimeNotInBubble(t0_ + 0.1 * Second);
+  Instant const t_final = t0_ + 10 * Second;
+  vessel_->UpdatePrediction(t_final);
+  EXPECT_EQ(0, vessel_->prediction_events(body).apoapsides.Size());
+
+  // Requesting the events of a new body causes the prediction to be
+  // recomputed.
+  vessel_->UpdatePrediction(t_final);
+  ASSERT_EQ(t_final, vessel_->prediction().last().time());
+  auto const& events = vessel_->prediction_events(body);
+  DiscreteTrajectory<Barycentric> apoapsides;
+  DiscreteTrajectory<Barycentric> periapsides;
+  ephemeris_->ComputeApsides(body,
+                             vessel_->prediction().Fork(),
+                             vessel_->prediction().End(),
+                             apoapsides,
+                             periapsides);
+  EXPECT_LT(2, apoapsides.Size());
+  EXPECT_LT(2, periapsides.Size());
+  EXPECT_EQ(apoapsides.Size(), events.apoapsides.Size());
+  EXPECT_EQ(periapsides.Size(), events.periapsides.Size());
+  for (auto it1 = periapsides.Begin(), it2 = events.periapsides.Begin();
+       it1 != periapsides.End() && it2 != events.periapsides.End();
+       ++it1, ++it2) {
+    EXPECT_THAT(AbsoluteError(it1.time(), it2.time()), Lt(1e-3 * Second));
+  }
+
+  // Advancing a little reuses or recomputes the events of the previous
+  // prediction.
+  std::vector<Instant> old_times;
+  for (auto it = events.periapsides.Begin(); it != events.periapsides.End();
+       ++it) {
+    old_times.push_back(it.time());
+  }
+  vessel_->AdvanceTimeNotInBubble(t0_ + 0.2 * Second);
+  vessel_->UpdatePrediction(t_final + 0.1 * Second);
+  auto const& new_events = vessel_->prediction_events(body);
+  auto it = new_events.periapsides.Begin();
+  for (Instant const& old_time : old_times) {
+    if (old_time > vessel_->prediction().Fork().time()) {
+      ASSERT_NE(it, new_events.periapsides.End());
+      EXPECT_THAT(AbsoluteError(old_time, it.time()), Lt(1e-3 * Second));
+      ++it;
+    }
+  }
+}
+
+TEST_F(VesselTest, AbandonedAsynchronousPrediction) {
+  vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel_->AdvanceTimeNotInBubble(t2_);
+  vessel_->UpdatePredictionAsynchronously(t3_);
+
+  // The computation in progress would reach |t3_|, but its result is dropped
+  // and the prediction is only replaced by the one computed with the new
+  // parameters.
+  vessel_->set_prediction_adaptive_step_parameters(
+      Ephemeris<Barycentric>::AdaptiveStepParameters(
+          DormandElMikkawyPrince1986RKN434FM<Position<Barycentric>>(),
+          /*max_steps=*/1,
+          /*length_integration_tolerance=*/1 * Metre,
+          /*speed_integration_tolerance=*/1 * Metre / Second));
+  auto const deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (vessel_->prediction().last().time() <= t2_) {
+    ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    vessel_->UpdatePredictionAsynchronously(t3_);
+  }
+  EXPECT_LT(vessel_->prediction().last().time(), t3_);
+}
+
 TEST_F(VesselTest, FlightPlan) {
   vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
   vessel_->AdvanceTimeNotInBubble(t2_);
@@ -53,6 +53,11 @@ class FixedMatrix {
   bool operator==(FixedMatrix const& right) const;
   FixedMatrix& operator=(std::initializer_list<Scalar> const& right);
 
+  // For  0 <= i < rows and 0 <= j < columns, the entry a_ij is accessed as
+  // |a[i][j]|.  If i and j do not satisfy these conditions, the expression
+  // |a[i][j]| is erroneous.
+  constexpr Scalar const* operator[](int const index) const;
+
  private:
   std::array<Scalar, rows * columns> data_;
 
@@ -0,0 +1,50 @@
+﻿
+#pragma once
+
+#include <utility>
+
+#include "quantities/quantities.hpp"
+
+namespace principia {
+
+using quantities::Derivative;
+
+namespace numerics {
+
+// A 5th degree Hermite polynomial defined by its values and its first and
+// second derivatives at the bounds of some interval.  When the values are those
+// of the solution of a second-order differential equation, the second
+// derivatives are given by the right-hand side, so this is the natural
+// interpolant for the states computed by an integrator.
+template<typename Argument, typename Value>
+class Hermite5 {
+ public:
+  using Derivative1 = Derivative<Value, Argument>;
+  using Derivative2 = Derivative<Derivative1, Argument>;
+
+  Hermite5(std::pair<Argument, Argument> const& arguments,
+           std::pair<Value, Value> const& values,
+           std::pair<Derivative1, Derivative1> const& derivatives,
+           std::pair<Derivative2, Derivative2> const& second_derivatives);
+
+  Value Evaluate(Argument const& argument) const;
+  Derivative1 EvaluateDerivative(Argument const& argument) const;
+
+ private:
+  using Derivative3 = Derivative<Derivative2, Argument>;
+  using Derivative4 = Derivative<Derivative3, Argument>;
+  using Derivative5 = Derivative<Derivative4, Argument>;
+
+  std::pair<Argument, Argument> const arguments_;
+  Value a0_;
+  Derivative1 a1_;
+  Derivative2 a2_;
+  Derivative3 a3_;
+  Derivative4 a4_;
+  Derivative5 a5_;
+};
+
+}  // namespace numerics
+}  // namespace principia
+
+#include "numerics/hermite5_body.hpp"
@@ -0,0 +1,68 @@
+﻿
+#pragma once
+
+#include "numerics/hermite5.hpp"
+
+#include <utility>
+
+namespace principia {
+
+using quantities::Difference;
+
+namespace numerics {
+
+template<typename Argument, typename Value>
+Hermite5<Argument, Value>::Hermite5(
+    std::pair<Argument, Argument> const& arguments,
+    std::pair<Value, Value> const& values,
+    std::pair<Derivative1, Derivative1> const& derivatives,
+    std::pair<Derivative2, Derivative2> const& second_derivatives)
+    : arguments_(arguments) {
+  a0_ = values.first;
+  a1_ = derivatives.first;
+  a2_ = 0.5 * second_derivatives.first;
+  Difference<Argument> const Δargument = arguments_.second - arguments_.first;
+  auto const one_over_Δargument = 1.0 / Δargument;
+  auto const one_over_Δargument_squared =
+      one_over_Δargument * one_over_Δargument;
+  auto const one_over_Δargument_cubed =
+      one_over_Δargument * one_over_Δargument_squared;
+  // The parts of the value and of the derivatives at the end of the interval
+  // that are not accounted for by the terms of degree at most 2.
+  Difference<Value> const Δvalue =
+      values.second - values.first -
+      (a1_ + a2_ * Δargument) * Δargument;
+  Derivative1 const Δderivative =
+      derivatives.second - derivatives.first -
+      second_derivatives.first * Δargument;
+  Derivative2 const Δsecond_derivative =
+      second_derivatives.second - second_derivatives.first;
+  a3_ = (10.0 * Δvalue * one_over_Δargument -
+         4.0 * Δderivative +
+         0.5 * Δsecond_derivative * Δargument) * one_over_Δargument_squared;
+  a4_ = (-15.0 * Δvalue * one_over_Δargument +
+         7.0 * Δderivative -
+         Δsecond_derivative * Δargument) * one_over_Δargument_cubed;
+  a5_ = (6.0 * Δvalue * one_over_Δargument -
+         3.0 * Δderivative +
+         0.5 * Δsecond_derivative * Δargument) *
+        one_over_Δargument_squared * one_over_Δargument_squared;
+}
+
+template<typename Argument, typename Value>
+Value Hermite5<Argument, Value>::Evaluate(Argument const& argument) const {
+  Difference<Argument> const Δargument = argument - arguments_.first;
+  return (((((a5_ * Δargument + a4_) * Δargument + a3_) * Δargument + a2_) *
+               Δargument + a1_) * Δargument) + a0_;
+}
+
+template<typename Argument, typename Value>
+typename Hermite5<Argument, Value>::Derivative1
+Hermite5<Argument, Value>::EvaluateDerivative(Argument const& argument) const {
+  Difference<Argument> const Δargument = argument - arguments_.first;
+  return ((((5.0 * a5_ * Δargument + 4.0 * a4_) * Δargument + 3.0 * a3_) *
+               Δargument + 2.0 * a2_) * Δargument) + a1_;
+}
+
+}  // namespace numerics
+}  // namespace principia
@@ -0,0 +1,75 @@
+﻿
+#include "numerics/hermite5.hpp"
+
+#include "geometry/frame.hpp"
+#include "geometry/named_quantities.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "quantities/si.hpp"
+#include "serialization/geometry.pb.h"
+#include "testing_utilities/almost_equals.hpp"
+
+namespace principia {
+
+using geometry::Frame;
+using geometry::Instant;
+using geometry::Position;
+using geometry::Vector;
+using geometry::Velocity;
+using quantities::Acceleration;
+using quantities::Length;
+using quantities::si::Metre;
+using quantities::si::Second;
+using testing_utilities::AlmostEquals;
+
+namespace numerics {
+
+class Hermite5Test : public ::testing::Test {
+ protected:
+  using World = Frame<serialization::Frame::TestTag,
+                      serialization::Frame::TEST1, true>;
+
+  Instant const t0_;
+};
+
+TEST_F(Hermite5Test, Quintic) {
+  // A polynomial of degree 5 is reproduced exactly.
+  auto const p = [this](Instant const& t) {
+    double const x = (t - t0_) / Second;
+    return (((((x - 2) * x + 3) * x - 4) * x + 5) * x - 6) * Metre;
+  };
+  auto const ṗ = [this](Instant const& t) {
+    double const x = (t - t0_) / Second;
+    return ((((5 * x - 8) * x + 9) * x - 8) * x + 5) * Metre / Second;
+  };
+  auto const p̈ = [this](Instant const& t) {
+    double const x = (t - t0_) / Second;
+    return (((20 * x - 24) * x + 18) * x - 8) * Metre / Second / Second;
+  };
+  Instant const t1 = t0_ + 1 * Second;
+  Instant const t2 = t0_ + 3 * Second;
+  Hermite5<Instant, Length> h({t1, t2},
+                              {p(t1), p(t2)},
+                              {ṗ(t1), ṗ(t2)},
+                              {p̈(t1), p̈(t2)});
+  for (double x = 1; x <= 3; x += 0.25) {
+    Instant const t = t0_ + x * Second;
+    EXPECT_THAT(h.Evaluate(t), AlmostEquals(p(t), 0, 32));
+    EXPECT_THAT(h.EvaluateDerivative(t), AlmostEquals(ṗ(t), 0, 32));
+  }
+}
+
+TEST_F(Hermite5Test, Typed) {
+  // Just here to check that the types work in the presence of affine spaces.
+  Hermite5<Instant, Position<World>> h(
+      {t0_ + 1 * Second, t0_ + 2 * Second},
+      {World::origin, World::origin},
+      {Velocity<World>(), Velocity<World>()},
+      {Vector<Acceleration, World>(), Vector<Acceleration, World>()});
+
+  EXPECT_EQ(World::origin, h.Evaluate(t0_ + 1.3 * Second));
+  EXPECT_EQ(Velocity<World>(), h.EvaluateDerivative(t0_ + 1.7 * Second));
+}
+
+}  // namespace numerics
+}  // namespace principia
@@ -1,9 +1,12 @@
 ﻿
 #pragma once
 
+#include <array>
 #include <vector>
 
 #include "geometry/named_quantities.hpp"
+#include "geometry/r3_element.hpp"
+#include "numerics/fixed_arrays.hpp"
 #include "quantities/quantities.hpp"
 #include "serialization/numerics.pb.h"
 
@@ -15,10 +18,40 @@ using ЧебышёвSeries = ChebyshevSeries;
 }  // namespace serialization
 
 using geometry::Instant;
+using geometry::R3Element;
 using quantities::Time;
 using quantities::Variation;
 
 namespace numerics {
+
+// Evaluates, using the Clenshaw algorithm, the Чебышёв series of the given
+// |degree| whose coefficients are the |degree + 1| elements starting at
+// |coefficients|, at |scaled_t|, which must be in [-1, 1].  The derivative is
+// with respect to |scaled_t|.  These are the algorithms used by |ЧебышёвSeries|
+// for 3-dimensional vectors, for clients that store the coefficients of many
+// series contiguously.
+R3Element<double> EvaluateЧебышёвSeries(
+    R3Element<double> const* const coefficients,
+    int const degree,
+    double const scaled_t);
+R3Element<double> EvaluateЧебышёвSeriesDerivative(
+    R3Element<double> const* const coefficients,
+    int const degree,
+    double const scaled_t);
+
+// Evaluates the same series and its derivative with respect to the scaled time
+// at the |count| points starting at |scaled_t|, and stores the results in the
+// |count| elements starting at |values| and |derivatives|.  The value and the
+// derivative are computed by the same recurrence, and the points are processed
+// two at a time when SSE2 is available.
+void EvaluateЧебышёвSeriesAndDerivative(
+    R3Element<double> const* const coefficients,
+    int const degree,
+    int const count,
+    double const* const scaled_t,
+    R3Element<double>* const values,
+    R3Element<double>* const derivatives);
+
 namespace internal {
 
 // A helper class for implementing |Evaluate| that can be specialized for speed.
@@ -31,6 +64,14 @@ class EvaluationHelper {
   EvaluationHelper& operator=(EvaluationHelper&& other) = default;
 
   Vector EvaluateImplementation(double const scaled_t) const;
+  // Evaluates the value and the derivative at the |count| points starting at
+  // |scaled_t|.  |scaled_t_derivative| is the derivative of the scaled time
+  // with respect to time.
+  void EvaluateImplementation(int const count,
+                              double const* const scaled_t,
+                              Time::Inverse const& scaled_t_derivative,
+                              Vector* const values,
+                              Variation<Vector>* const derivatives) const;
 
   Vector coefficients(int const index) const;
   int degree() const;
@@ -40,6 +81,11 @@ class EvaluationHelper {
   int degree_;
 };
 
+// A helper class for |NewhallApproximator| that converts a |Vector| to and
+// from its coordinates in SI units.
+template<typename Vector>
+struct CoordinatesHelper;
+
 }  // namespace internal
 
 // A Чебышёв series with values in the vector space |Vector|.  The argument is
@@ -66,10 +112,24 @@ class ЧебышёвSeries {
   // a better approximation.
   Vector last_coefficient() const;
 
+  int degree() const;
+  // The coefficient of Tᵢ, for 0 <= i <= degree().
+  Vector coefficient(int const index) const;
+
   // Uses the Clenshaw algorithm.  |t| must be in the range [t_min, t_max].
   Vector Evaluate(Instant const& t) const;
   Variation<Vector> EvaluateDerivative(Instant const& t) const;
 
+  // Evaluates the series and its derivative at each of the |times|, which must
+  // be in the range [t_min, t_max].  This is faster than calling |Evaluate| and
+  // |EvaluateDerivative| for each time.  The values are identical to those
+  // returned by |Evaluate|, the derivatives may differ in the last bits from
+  // those returned by |EvaluateDerivative|.
+  void EvaluateWithDerivative(
+      std::vector<Instant> const& times,
+      not_null<std::vector<Vector>*> const values,
+      not_null<std::vector<Variation<Vector>>*> const derivatives) const;
+
   void WriteToMessage(
       not_null<serialization::ЧебышёвSeries*> const message) const;
   static ЧебышёвSeries ReadFromMessage(
@@ -77,6 +137,7 @@ class ЧебышёвSeries {
 
   // Computes a Newhall approximation of the given |degree|.  |q| and |v| are
   // the positions and velocities over a constant division of [t_min, t_max].
+  // Use a |NewhallApproximator| to try several degrees on the same data.
   static ЧебышёвSeries NewhallApproximation(
       int const degree,
       std::vector<Vector> const& q,
@@ -91,6 +152,51 @@ class ЧебышёвSeries {
   internal::EvaluationHelper<Vector> helper_;
 };
 
+// Computes Newhall approximations of various degrees for the same positions
+// and velocities.  The data are scaled and laid out once, as arrays of doubles
+// for each coordinate, and each approximation is the product of one of the
+// matrices of newhall.mathematica.h, whose dimensions are known at compile
+// time, by these arrays.  The last coefficient of an approximation, which
+// estimates its error, only costs one row of that product, so the degree may
+// be chosen without computing the intermediate approximations.
+template<typename Vector>
+class NewhallApproximator {
+ public:
+  static int constexpr divisions = 8;
+  static int constexpr min_degree = 3;
+  static int constexpr max_degree = 17;
+
+  // |q| and |v| are the positions and velocities over a constant division of
+  // [t_min, t_max] in |divisions| intervals.
+  NewhallApproximator(std::vector<Vector> const& q,
+                      std::vector<Variation<Vector>> const& v,
+                      Instant const& t_min,
+                      Instant const& t_max);
+
+  // Returns the last coefficient of the approximation of the given |degree|,
+  // that is, the value of |last_coefficient()| for that approximation.
+  Vector LastCoefficient(int const degree) const;
+
+  // Returns the approximation of the given |degree|.
+  ЧебышёвSeries<Vector> Approximation(int const degree) const;
+
+ private:
+  using Helper = internal::CoordinatesHelper<Vector>;
+  static int constexpr columns = 2 * divisions + 2;
+
+  // Returns the coefficient of the given |row| of the product of |matrix| by
+  // |qv_|.
+  template<int rows>
+  Vector Coefficient(FixedMatrix<double, rows, columns> const& matrix,
+                     int const row) const;
+
+  // |qv_[c]| holds the coordinates of index |c| of the positions and scaled
+  // velocities, in the order expected by Newhall's matrices.
+  std::array<std::array<double, columns>, Helper::dimension> qv_;
+  Instant const t_min_;
+  Instant const t_max_;
+};
+
 }  // namespace numerics
 }  // namespace principia
 
@@ -1,8 +1,12 @@
 ﻿
 #include "numerics/чебышёв_series.hpp"
 
+#include <algorithm>
+#include <array>
+#include <utility>
 #include <vector>
 
+#include "base/macros.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/r3_element.hpp"
 #include "geometry/serialization.hpp"
@@ -10,11 +14,16 @@
 #include "numerics/fixed_arrays.hpp"
 #include "numerics/newhall.mathematica.h"
 
+#if PRINCIPIA_USE_SSE2_INTRINSICS
+#include <emmintrin.h>
+#endif
+
 namespace principia {
 
 using geometry::DoubleOrQuantityOrMultivectorSerializer;
 using geometry::Multivector;
 using geometry::R3Element;
+using quantities::Quantity;
 
 namespace numerics {
 namespace internal {
@@ -32,6 +41,12 @@ class EvaluationHelper<Multivector<Scalar, Frame, rank>> {
 
   Multivector<Scalar, Frame, rank> EvaluateImplementation(
       double const scaled_t) const;
+  void EvaluateImplementation(
+      int const count,
+      double const* const scaled_t,
+      Time::Inverse const& scaled_t_derivative,
+      Multivector<Scalar, Frame, rank>* const values,
+      Variation<Multivector<Scalar, Frame, rank>>* const derivatives) const;
 
   Multivector<Scalar, Frame, rank> coefficients(int const index) const;
   int degree() const;
@@ -41,6 +56,73 @@ class EvaluationHelper<Multivector<Scalar, Frame, rank>> {
   int degree_;
 };
 
+template<>
+struct CoordinatesHelper<double> {
+  static int constexpr dimension = 1;
+  static std::array<double, dimension> ToCoordinates(double const vector);
+  static double FromCoordinates(
+      std::array<double, dimension> const& coordinates);
+};
+
+template<typename Dimensions>
+struct CoordinatesHelper<Quantity<Dimensions>> {
+  static int constexpr dimension = 1;
+  static std::array<double, dimension> ToCoordinates(
+      Quantity<Dimensions> const& vector);
+  static Quantity<Dimensions> FromCoordinates(
+      std::array<double, dimension> const& coordinates);
+};
+
+template<typename Scalar, typename Frame, int rank>
+struct CoordinatesHelper<Multivector<Scalar, Frame, rank>> {
+  static int constexpr dimension = 3;
+  static std::array<double, dimension> ToCoordinates(
+      Multivector<Scalar, Frame, rank> const& vector);
+  static Multivector<Scalar, Frame, rank> FromCoordinates(
+      std::array<double, dimension> const& coordinates);
+};
+
+// Calls |function| with the Newhall matrix for the given |degree|.  This gives
+// |function| the dimensions of the matrix at compile time.
+template<typename Function>
+auto WithNewhallMatrix(int const degree, Function const& function) {
+  switch (degree) {
+    case 3:
+      return function(newhall_c_matrix_degree_3_divisions_8_w04);
+    case 4:
+      return function(newhall_c_matrix_degree_4_divisions_8_w04);
+    case 5:
+      return function(newhall_c_matrix_degree_5_divisions_8_w04);
+    case 6:
+      return function(newhall_c_matrix_degree_6_divisions_8_w04);
+    case 7:
+      return function(newhall_c_matrix_degree_7_divisions_8_w04);
+    case 8:
+      return function(newhall_c_matrix_degree_8_divisions_8_w04);
+    case 9:
+      return function(newhall_c_matrix_degree_9_divisions_8_w04);
+    case 10:
+      return function(newhall_c_matrix_degree_10_divisions_8_w04);
+    case 11:
+      return function(newhall_c_matrix_degree_11_divisions_8_w04);
+    case 12:
+      return function(newhall_c_matrix_degree_12_divisions_8_w04);
+    case 13:
+      return function(newhall_c_matrix_degree_13_divisions_8_w04);
+    case 14:
+      return function(newhall_c_matrix_degree_14_divisions_8_w04);
+    case 15:
+      return function(newhall_c_matrix_degree_15_divisions_8_w04);
+    case 16:
+      return function(newhall_c_matrix_degree_16_divisions_8_w04);
+    case 17:
+      return function(newhall_c_matrix_degree_17_divisions_8_w04);
+    default:
+      LOG(FATAL) << "Unexpected degree " << degree;
+      base::noreturn();
+  }
+}
+
 template<typename Vector>
 EvaluationHelper<Vector>::EvaluationHelper(
     std::vector<Vector> const& coefficients,
@@ -80,6 +162,34 @@ Vector EvaluationHelper<Vector>::EvaluateImplementation(
   }
 }
 
+template<typename Vector>
+void EvaluationHelper<Vector>::EvaluateImplementation(
+    int const count,
+    double const* const scaled_t,
+    Time::Inverse const& scaled_t_derivative,
+    Vector* const values,
+    Variation<Vector>* const derivatives) const {
+  for (int i = 0; i < count; ++i) {
+    double const two_scaled_t = scaled_t[i] + scaled_t[i];
+    // The derivative of b_k is d_k = 2 b_k+1 + 2 t d_k+1 - d_k+2.
+    Vector b_kplus1{};
+    Vector b_kplus2{};
+    Vector d_kplus1{};
+    Vector d_kplus2{};
+    for (int k = degree_; k >= 1; --k) {
+      Vector const d_k = 2 * b_kplus1 + two_scaled_t * d_kplus1 - d_kplus2;
+      Vector const b_k = coefficients_[k] + two_scaled_t * b_kplus1 - b_kplus2;
+      d_kplus2 = d_kplus1;
+      d_kplus1 = d_k;
+      b_kplus2 = b_kplus1;
+      b_kplus1 = b_k;
+    }
+    values[i] = coefficients_[0] + scaled_t[i] * b_kplus1 - b_kplus2;
+    derivatives[i] = (b_kplus1 + scaled_t[i] * d_kplus1 - d_kplus2) *
+                     scaled_t_derivative;
+  }
+}
+
 template<typename Vector>
 Vector EvaluationHelper<Vector>::coefficients(int const index) const {
   return coefficients_[index];
@@ -103,61 +213,300 @@ template<typename Scalar, typename Frame, int rank>
 Multivector<Scalar, Frame, rank>
 EvaluationHelper<Multivector<Scalar, Frame, rank>>::EvaluateImplementation(
     double const scaled_t) const {
+  return Multivector<double, Frame, rank>(
+             EvaluateЧебышёвSeries(coefficients_.data(), degree_, scaled_t)) *
+         SIUnit<Scalar>();
+}
+
+template<typename Scalar, typename Frame, int rank>
+void EvaluationHelper<Multivector<Scalar, Frame, rank>>::EvaluateImplementation(
+    int const count,
+    double const* const scaled_t,
+    Time::Inverse const& scaled_t_derivative,
+    Multivector<Scalar, Frame, rank>* const values,
+    Variation<Multivector<Scalar, Frame, rank>>* const derivatives) const {
+  // The points are processed in chunks so that the coordinates stay in the
+  // cache until they are converted.
+  int constexpr chunk_size = 16;
+  std::array<R3Element<double>, chunk_size> value_coordinates;
+  std::array<R3Element<double>, chunk_size> derivative_coordinates;
+  for (int begin = 0; begin < count; begin += chunk_size) {
+    int const size = std::min(chunk_size, count - begin);
+    EvaluateЧебышёвSeriesAndDerivative(coefficients_.data(),
+                                       degree_,
+                                       size,
+                                       &scaled_t[begin],
+                                       value_coordinates.data(),
+                                       derivative_coordinates.data());
+    for (int i = 0; i < size; ++i) {
+      values[begin + i] =
+          Multivector<double, Frame, rank>(value_coordinates[i]) *
+          SIUnit<Scalar>();
+      derivatives[begin + i] =
+          Multivector<double, Frame, rank>(derivative_coordinates[i]) *
+          SIUnit<Scalar>() * scaled_t_derivative;
+    }
+  }
+}
+
+template<typename Scalar, typename Frame, int rank>
+Multivector<Scalar, Frame, rank>
+EvaluationHelper<Multivector<Scalar, Frame, rank>>::coefficients(
+    int const index) const {
+  return Multivector<double, Frame, rank>(
+             coefficients_[index]) * SIUnit<Scalar>();
+}
+
+template<typename Scalar, typename Frame, int rank>
+int EvaluationHelper<Multivector<Scalar, Frame, rank>>::degree() const {
+  return degree_;
+}
+
+inline std::array<double, 1> CoordinatesHelper<double>::ToCoordinates(
+    double const vector) {
+  return {{vector}};
+}
+
+inline double CoordinatesHelper<double>::FromCoordinates(
+    std::array<double, dimension> const& coordinates) {
+  return coordinates[0];
+}
+
+template<typename Dimensions>
+std::array<double, 1> CoordinatesHelper<Quantity<Dimensions>>::ToCoordinates(
+    Quantity<Dimensions> const& vector) {
+  return {{vector / SIUnit<Quantity<Dimensions>>()}};
+}
+
+template<typename Dimensions>
+Quantity<Dimensions> CoordinatesHelper<Quantity<Dimensions>>::FromCoordinates(
+    std::array<double, dimension> const& coordinates) {
+  return coordinates[0] * SIUnit<Quantity<Dimensions>>();
+}
+
+template<typename Scalar, typename Frame, int rank>
+std::array<double, 3>
+CoordinatesHelper<Multivector<Scalar, Frame, rank>>::ToCoordinates(
+    Multivector<Scalar, Frame, rank> const& vector) {
+  R3Element<double> const coordinates =
+      vector.coordinates() / SIUnit<Scalar>();
+  return {{coordinates.x, coordinates.y, coordinates.z}};
+}
+
+template<typename Scalar, typename Frame, int rank>
+Multivector<Scalar, Frame, rank>
+CoordinatesHelper<Multivector<Scalar, Frame, rank>>::FromCoordinates(
+    std::array<double, dimension> const& coordinates) {
+  return Multivector<double, Frame, rank>(
+             {coordinates[0], coordinates[1], coordinates[2]}) *
+         SIUnit<Scalar>();
+}
+
+}  // namespace internal
+
+inline R3Element<double> EvaluateЧебышёвSeries(
+    R3Element<double> const* const coefficients,
+    int const degree,
+    double const scaled_t) {
   double const two_scaled_t = scaled_t + scaled_t;
-  R3Element<double> const c_0 = coefficients_[0];
-  switch (degree_) {
+  R3Element<double> const c_0 = coefficients[0];
+  switch (degree) {
     case 0:
-      return Multivector<double, Frame, rank>(c_0) * SIUnit<Scalar>();
+      return c_0;
     case 1:
-      return Multivector<double, Frame, rank>(
-                 c_0 + scaled_t * coefficients_[1]) * SIUnit<Scalar>();
+      return c_0 + scaled_t * coefficients[1];
     default:
       // b_degree   = c_degree.
-      R3Element<double> b_i = coefficients_[degree_];
+      R3Element<double> b_i = coefficients[degree];
       // b_degree-1 = c_degree-1 + 2 t b_degree.
-      R3Element<double> b_j = coefficients_[degree_ - 1] + two_scaled_t * b_i;
-      int k = degree_ - 3;
+      R3Element<double> b_j = coefficients[degree - 1] + two_scaled_t * b_i;
+      int k = degree - 3;
       for (; k >= 1; k -= 2) {
         // b_k+1 = c_k+1 + 2 t b_k+2 - b_k+3.
-        R3Element<double> const c_kplus1 = coefficients_[k + 1];
+        R3Element<double> const c_kplus1 = coefficients[k + 1];
         b_i.x = c_kplus1.x + two_scaled_t * b_j.x - b_i.x;
         b_i.y = c_kplus1.y + two_scaled_t * b_j.y - b_i.y;
         b_i.z = c_kplus1.z + two_scaled_t * b_j.z - b_i.z;
         // b_k   = c_k   + 2 t b_k+1 - b_k+2.
-        R3Element<double> const c_k = coefficients_[k];
+        R3Element<double> const c_k = coefficients[k];
         b_j.x = c_k.x + two_scaled_t * b_i.x - b_j.x;
         b_j.y = c_k.y + two_scaled_t * b_i.y - b_j.y;
         b_j.z = c_k.z + two_scaled_t * b_i.z - b_j.z;
       }
       if (k == 0) {
         // b_1 = c_1 + 2 t b_2 - b_3.
-        b_i = coefficients_[1] + two_scaled_t * b_j - b_i;
+        b_i = coefficients[1] + two_scaled_t * b_j - b_i;
         // c_0 + t b_1 - b_2.
-        return Multivector<double, Frame, rank>(
-                   c_0 + scaled_t * b_i - b_j) * SIUnit<Scalar>();
+        return c_0 + scaled_t * b_i - b_j;
       } else {
         // c_0 + t b_1 - b_2.
-        return Multivector<double, Frame, rank>(
-                   c_0 + scaled_t * b_j - b_i) * SIUnit<Scalar>();
+        return c_0 + scaled_t * b_j - b_i;
       }
-    }
+  }
 }
 
-template<typename Scalar, typename Frame, int rank>
-Multivector<Scalar, Frame, rank>
-EvaluationHelper<Multivector<Scalar, Frame, rank>>::coefficients(
-    int const index) const {
-  return Multivector<double, Frame, rank>(
-             coefficients_[index]) * SIUnit<Scalar>();
+inline R3Element<double> EvaluateЧебышёвSeriesDerivative(
+    R3Element<double> const* const coefficients,
+    int const degree,
+    double const scaled_t) {
+  if (degree == 0) {
+    return R3Element<double>();
+  }
+  double const two_scaled_t = scaled_t + scaled_t;
+  R3Element<double> b_kplus2;
+  R3Element<double> b_kplus1;
+  for (int k = degree - 1; k >= 1; --k) {
+    R3Element<double> const b_k =
+        coefficients[k + 1] * (k + 1) + two_scaled_t * b_kplus1 - b_kplus2;
+    b_kplus2 = b_kplus1;
+    b_kplus1 = b_k;
+  }
+  return coefficients[1] + two_scaled_t * b_kplus1 - b_kplus2;
 }
 
-template<typename Scalar, typename Frame, int rank>
-int EvaluationHelper<Multivector<Scalar, Frame, rank>>::degree() const {
-  return degree_;
+#if PRINCIPIA_USE_SSE2_INTRINSICS
+
+namespace internal {
+
+// One step of the Clenshaw recurrences for the value and the derivative of a
+// coordinate, for two values of t:
+//   b_k = c_k + 2 t b_k+1 - b_k+2,
+//   d_k = 2 b_k+1 + 2 t d_k+1 - d_k+2.
+// On input |b_k| and |d_k| contain b_k+2 and d_k+2.
+FORCE_INLINE void PackedClenshawStep(__m128d const c_k,
+                                     __m128d const two_scaled_t,
+                                     __m128d const b_kplus1,
+                                     __m128d const d_kplus1,
+                                     not_null<__m128d*> const b_k,
+                                     not_null<__m128d*> const d_k) {
+  *d_k = _mm_sub_pd(_mm_add_pd(_mm_add_pd(b_kplus1, b_kplus1),
+                               _mm_mul_pd(two_scaled_t, d_kplus1)),
+                    *d_k);
+  *b_k = _mm_sub_pd(_mm_add_pd(c_k, _mm_mul_pd(two_scaled_t, b_kplus1)),
+                    *b_k);
 }
 
 }  // namespace internal
 
+#endif
+
+inline void EvaluateЧебышёвSeriesAndDerivative(
+    R3Element<double> const* const coefficients,
+    int const degree,
+    int const count,
+    double const* const scaled_t,
+    R3Element<double>* const values,
+    R3Element<double>* const derivatives) {
+  int i = 0;
+#if PRINCIPIA_USE_SSE2_INTRINSICS
+  using internal::PackedClenshawStep;
+  for (; i + 1 < count; i += 2) {
+    __m128d const t = _mm_loadu_pd(&scaled_t[i]);
+    __m128d const two_t = _mm_add_pd(t, t);
+    // As in |EvaluateЧебышёвSeries|, the recurrence is unrolled twice and the
+    // variables |b_i|, |b_j| alternately hold the last two b_k (and similarly
+    // for d_k).
+    __m128d b_i_x = _mm_setzero_pd();
+    __m128d b_i_y = _mm_setzero_pd();
+    __m128d b_i_z = _mm_setzero_pd();
+    __m128d b_j_x = _mm_setzero_pd();
+    __m128d b_j_y = _mm_setzero_pd();
+    __m128d b_j_z = _mm_setzero_pd();
+    __m128d d_i_x = _mm_setzero_pd();
+    __m128d d_i_y = _mm_setzero_pd();
+    __m128d d_i_z = _mm_setzero_pd();
+    __m128d d_j_x = _mm_setzero_pd();
+    __m128d d_j_y = _mm_setzero_pd();
+    __m128d d_j_z = _mm_setzero_pd();
+    int k = degree;
+    for (; k >= 2; k -= 2) {
+      // b_k, d_k in |b_j|, |d_j|.
+      R3Element<double> const& c_k = coefficients[k];
+      PackedClenshawStep(_mm_set1_pd(c_k.x), two_t, b_i_x, d_i_x,
+                         &b_j_x, &d_j_x);
+      PackedClenshawStep(_mm_set1_pd(c_k.y), two_t, b_i_y, d_i_y,
+                         &b_j_y, &d_j_y);
+      PackedClenshawStep(_mm_set1_pd(c_k.z), two_t, b_i_z, d_i_z,
+                         &b_j_z, &d_j_z);
+      // b_k-1, d_k-1 in |b_i|, |d_i|.
+      R3Element<double> const& c_kminus1 = coefficients[k - 1];
+      PackedClenshawStep(_mm_set1_pd(c_kminus1.x), two_t, b_j_x, d_j_x,
+                         &b_i_x, &d_i_x);
+      PackedClenshawStep(_mm_set1_pd(c_kminus1.y), two_t, b_j_y, d_j_y,
+                         &b_i_y, &d_i_y);
+      PackedClenshawStep(_mm_set1_pd(c_kminus1.z), two_t, b_j_z, d_j_z,
+                         &b_i_z, &d_i_z);
+    }
+    if (k == 1) {
+      // b_1, d_1 in |b_j|, |d_j|; swap so that they end up in |b_i|, |d_i|.
+      R3Element<double> const& c_1 = coefficients[1];
+      PackedClenshawStep(_mm_set1_pd(c_1.x), two_t, b_i_x, d_i_x,
+                         &b_j_x, &d_j_x);
+      PackedClenshawStep(_mm_set1_pd(c_1.y), two_t, b_i_y, d_i_y,
+                         &b_j_y, &d_j_y);
+      PackedClenshawStep(_mm_set1_pd(c_1.z), two_t, b_i_z, d_i_z,
+                         &b_j_z, &d_j_z);
+      std::swap(b_i_x, b_j_x);
+      std::swap(b_i_y, b_j_y);
+      std::swap(b_i_z, b_j_z);
+      std::swap(d_i_x, d_j_x);
+      std::swap(d_i_y, d_j_y);
+      std::swap(d_i_z, d_j_z);
+    }
+    // The value is c_0 + t b_1 - b_2, the derivative is b_1 + t d_1 - d_2.
+    R3Element<double> const& c_0 = coefficients[0];
+    auto const value = [t](double const c_0,
+                           __m128d const b_1,
+                           __m128d const b_2) {
+      return _mm_sub_pd(_mm_add_pd(_mm_set1_pd(c_0), _mm_mul_pd(t, b_1)), b_2);
+    };
+    auto const derivative = [t](__m128d const b_1,
+                                __m128d const d_1,
+                                __m128d const d_2) {
+      return _mm_sub_pd(_mm_add_pd(b_1, _mm_mul_pd(t, d_1)), d_2);
+    };
+    __m128d const value_x = value(c_0.x, b_i_x, b_j_x);
+    __m128d const value_y = value(c_0.y, b_i_y, b_j_y);
+    __m128d const value_z = value(c_0.z, b_i_z, b_j_z);
+    __m128d const derivative_x = derivative(b_i_x, d_i_x, d_j_x);
+    __m128d const derivative_y = derivative(b_i_y, d_i_y, d_j_y);
+    __m128d const derivative_z = derivative(b_i_z, d_i_z, d_j_z);
+    _mm_storel_pd(&values[i].x, value_x);
+    _mm_storel_pd(&values[i].y, value_y);
+    _mm_storel_pd(&values[i].z, value_z);
+    _mm_storeh_pd(&values[i + 1].x, value_x);
+    _mm_storeh_pd(&values[i + 1].y, value_y);
+    _mm_storeh_pd(&values[i + 1].z, value_z);
+    _mm_storel_pd(&derivatives[i].x, derivative_x);
+    _mm_storel_pd(&derivatives[i].y, derivative_y);
+    _mm_storel_pd(&derivatives[i].z, derivative_z);
+    _mm_storeh_pd(&derivatives[i + 1].x, derivative_x);
+    _mm_storeh_pd(&derivatives[i + 1].y, derivative_y);
+    _mm_storeh_pd(&derivatives[i + 1].z, derivative_z);
+  }
+#endif
+  // The remaining point, or all the points if SSE2 is not available.
+  for (; i < count; ++i) {
+    double const two_scaled_t = scaled_t[i] + scaled_t[i];
+    R3Element<double> b_kplus1;
+    R3Element<double> b_kplus2;
+    R3Element<double> d_kplus1;
+    R3Element<double> d_kplus2;
+    for (int k = degree; k >= 1; --k) {
+      R3Element<double> const d_k =
+          (b_kplus1 + b_kplus1) + two_scaled_t * d_kplus1 - d_kplus2;
+      R3Element<double> const b_k =
+          coefficients[k] + two_scaled_t * b_kplus1 - b_kplus2;
+      d_kplus2 = d_kplus1;
+      d_kplus1 = d_k;
+      b_kplus2 = b_kplus1;
+      b_kplus1 = b_k;
+    }
+    values[i] = coefficients[0] + scaled_t[i] * b_kplus1 - b_kplus2;
+    derivatives[i] = b_kplus1 + scaled_t[i] * d_kplus1 - d_kplus2;
+  }
+}
+
 template<typename Vector>
 ЧебышёвSeries<Vector>::ЧебышёвSeries(std::vector<Vector> const& coefficients,
                                      Instant const& t_min,
@@ -208,6 +557,16 @@ Vector ЧебышёвSeries<Vector>::last_coefficient() const {
   return helper_.coefficients(helper_.degree());
 }
 
+template<typename Vector>
+int ЧебышёвSeries<Vector>::degree() const {
+  return helper_.degree();
+}
+
+template<typename Vector>
+Vector ЧебышёвSeries<Vector>::coefficient(int const index) const {
+  return helper_.coefficients(index);
+}
+
 template<typename Vector>
 Vector ЧебышёвSeries<Vector>::Evaluate(Instant const& t) const {
   // This formula ensures continuity at the edges by producing -1 or +1 within
@@ -252,6 +611,32 @@ Variation<Vector> ЧебышёвSeries<Vector>::EvaluateDerivative(
              (one_over_duration_ + one_over_duration_);
 }
 
+template<typename Vector>
+void ЧебышёвSeries<Vector>::EvaluateWithDerivative(
+    std::vector<Instant> const& times,
+    not_null<std::vector<Vector>*> const values,
+    not_null<std::vector<Variation<Vector>>*> const derivatives) const {
+  int const count = times.size();
+  std::vector<double> scaled_t;
+  scaled_t.reserve(count);
+  for (Instant const& t : times) {
+    // See comments in |Evaluate|.
+    scaled_t.push_back(((t - t_max_) + (t - t_min_)) * one_over_duration_);
+#ifdef _DEBUG
+    CHECK_LE(scaled_t.back(), 1.1);
+    CHECK_GE(scaled_t.back(), -1.1);
+#endif
+  }
+
+  values->resize(count);
+  derivatives->resize(count);
+  helper_.EvaluateImplementation(count,
+                                 scaled_t.data(),
+                                 one_over_duration_ + one_over_duration_,
+                                 values->data(),
+                                 derivatives->data());
+}
+
 template<typename Vector>
 void ЧебышёвSeries<Vector>::WriteToMessage(
     not_null<serialization::ЧебышёвSeries*> const message) const {
@@ -291,8 +676,26 @@ template<typename Vector>
     std::vector<Variation<Vector>> const& v,
     Instant const& t_min,
     Instant const& t_max) {
-  // Only supports 8 divisions for now.
-  int const divisions = 8;
+  return NewhallApproximator<Vector>(q, v, t_min, t_max).Approximation(degree);
+}
+
+template<typename Vector>
+int constexpr NewhallApproximator<Vector>::divisions;
+template<typename Vector>
+int constexpr NewhallApproximator<Vector>::min_degree;
+template<typename Vector>
+int constexpr NewhallApproximator<Vector>::max_degree;
+template<typename Vector>
+int constexpr NewhallApproximator<Vector>::columns;
+
+template<typename Vector>
+NewhallApproximator<Vector>::NewhallApproximator(
+    std::vector<Vector> const& q,
+    std::vector<Variation<Vector>> const& v,
+    Instant const& t_min,
+    Instant const& t_max)
+    : t_min_(t_min),
+      t_max_(t_max) {
   CHECK_EQ(divisions + 1, q.size());
   CHECK_EQ(divisions + 1, v.size());
 
@@ -300,68 +703,57 @@ template<typename Vector>
 
   // Tricky.  The order in Newhall's matrices is such that the entries for the
   // largest time occur first.
-  FixedVector<Vector, 2 * divisions + 2> qv;
   for (int i = 0, j = 2 * divisions;
        i < divisions + 1 && j >= 0;
        ++i, j -= 2) {
-    qv[j] = q[i];
-    qv[j + 1] = v[i] * duration_over_two;
+    auto const q_coordinates = Helper::ToCoordinates(q[i]);
+    auto const v_coordinates = Helper::ToCoordinates(v[i] * duration_over_two);
+    for (int c = 0; c < Helper::dimension; ++c) {
+      qv_[c][j] = q_coordinates[c];
+      qv_[c][j + 1] = v_coordinates[c];
+    }
   }
+}
+
+template<typename Vector>
+Vector NewhallApproximator<Vector>::LastCoefficient(int const degree) const {
+  return internal::WithNewhallMatrix(
+      degree,
+      [this, degree](auto const& matrix) {
+        return Coefficient(matrix, /*row=*/degree);
+      });
+}
 
+template<typename Vector>
+ЧебышёвSeries<Vector> NewhallApproximator<Vector>::Approximation(
+    int const degree) const {
   std::vector<Vector> coefficients;
-  coefficients.reserve(degree);
-  switch (degree) {
-    case 3:
-      coefficients = newhall_c_matrix_degree_3_divisions_8_w04 * qv;
-      break;
-    case 4:
-      coefficients = newhall_c_matrix_degree_4_divisions_8_w04 * qv;
-      break;
-    case 5:
-      coefficients = newhall_c_matrix_degree_5_divisions_8_w04 * qv;
-      break;
-    case 6:
-      coefficients = newhall_c_matrix_degree_6_divisions_8_w04 * qv;
-      break;
-    case 7:
-      coefficients = newhall_c_matrix_degree_7_divisions_8_w04 * qv;
-      break;
-    case 8:
-      coefficients = newhall_c_matrix_degree_8_divisions_8_w04 * qv;
-      break;
-    case 9:
-      coefficients = newhall_c_matrix_degree_9_divisions_8_w04 * qv;
-      break;
-    case 10:
-      coefficients = newhall_c_matrix_degree_10_divisions_8_w04 * qv;
-      break;
-    case 11:
-      coefficients = newhall_c_matrix_degree_11_divisions_8_w04 * qv;
-      break;
-    case 12:
-      coefficients = newhall_c_matrix_degree_12_divisions_8_w04 * qv;
-      break;
-    case 13:
-      coefficients = newhall_c_matrix_degree_13_divisions_8_w04 * qv;
-      break;
-    case 14:
-      coefficients = newhall_c_matrix_degree_14_divisions_8_w04 * qv;
-      break;
-    case 15:
-      coefficients = newhall_c_matrix_degree_15_divisions_8_w04 * qv;
-      break;
-    case 16:
-      coefficients = newhall_c_matrix_degree_16_divisions_8_w04 * qv;
-      break;
-    case 17:
-      coefficients = newhall_c_matrix_degree_17_divisions_8_w04 * qv;
-      break;
-    default:
-      LOG(FATAL) << "Unexpected degree " << degree;
-      break;
+  coefficients.reserve(degree + 1);
+  internal::WithNewhallMatrix(
+      degree,
+      [this, degree, &coefficients](auto const& matrix) {
+        for (int row = 0; row <= degree; ++row) {
+          coefficients.push_back(Coefficient(matrix, row));
+        }
+      });
+  return ЧебышёвSeries<Vector>(coefficients, t_min_, t_max_);
+}
+
+template<typename Vector>
+template<int rows>
+Vector NewhallApproximator<Vector>::Coefficient(
+    FixedMatrix<double, rows, columns> const& matrix,
+    int const row) const {
+  double const* const matrix_row = matrix[row];
+  std::array<double, Helper::dimension> coefficient;
+  for (int c = 0; c < Helper::dimension; ++c) {
+    double sum = 0;
+    for (int j = 0; j < columns; ++j) {
+      sum += matrix_row[j] * qv_[c][j];
+    }
+    coefficient[c] = sum;
   }
-  CHECK_EQ(degree + 1, coefficients.size());
-  return ЧебышёвSeries(coefficients, t_min, t_max);
+  return Helper::FromCoordinates(coefficient);
 }
 
 }  // namespace numerics
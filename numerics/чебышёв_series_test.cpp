@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <random>
 #include <vector>
 
 #include "astronomy/frames.hpp"
@@ -18,10 +19,13 @@
 namespace principia {
 
 using astronomy::ICRFJ2000Ecliptic;
+using geometry::Displacement;
 using geometry::Instant;
 using geometry::Vector;
+using geometry::Velocity;
 using quantities::Length;
 using quantities::Speed;
+using quantities::Time;
 using quantities::si::Metre;
 using quantities::si::Second;
 using testing_utilities::AbsoluteError;
@@ -210,6 +214,58 @@ TEST_F(ЧебышёвSeriesTest, X6Vector) {
             x6.Evaluate(t0_ + 3 * Second));
 }
 
+TEST_F(ЧебышёвSeriesTest, EvaluateWithDerivative) {
+  using V = Vector<Length, ICRFJ2000Ecliptic>;
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<> coefficient(-1.0, 1.0);
+  // An odd number of times to exercise both the packed and the scalar paths.
+  std::vector<Instant> times;
+  for (int i = 0; i <= 10; ++i) {
+    times.push_back(t_min_ + i * (t_max_ - t_min_) / 10);
+  }
+  for (int degree = 0; degree <= 17; ++degree) {
+    std::vector<double> double_coefficients;
+    std::vector<V> vector_coefficients;
+    for (int k = 0; k <= degree; ++k) {
+      double_coefficients.push_back(coefficient(random));
+      vector_coefficients.push_back(V({coefficient(random) * Metre,
+                                       coefficient(random) * Metre,
+                                       coefficient(random) * Metre}));
+    }
+    ЧебышёвSeries<double> const double_series(
+        double_coefficients, t_min_, t_max_);
+    ЧебышёвSeries<V> const vector_series(vector_coefficients, t_min_, t_max_);
+
+    std::vector<double> double_values;
+    std::vector<Variation<double>> double_derivatives;
+    double_series.EvaluateWithDerivative(
+        times, &double_values, &double_derivatives);
+    std::vector<V> vector_values;
+    std::vector<Variation<V>> vector_derivatives;
+    vector_series.EvaluateWithDerivative(
+        times, &vector_values, &vector_derivatives);
+    ASSERT_EQ(times.size(), double_values.size());
+    ASSERT_EQ(times.size(), double_derivatives.size());
+    ASSERT_EQ(times.size(), vector_values.size());
+    ASSERT_EQ(times.size(), vector_derivatives.size());
+    for (int i = 0; i < times.size(); ++i) {
+      EXPECT_EQ(double_series.Evaluate(times[i]), double_values[i]);
+      EXPECT_EQ(vector_series.Evaluate(times[i]), vector_values[i]);
+      if (degree == 0) {
+        EXPECT_EQ(Variation<double>(), double_derivatives[i]);
+        EXPECT_EQ(Variation<V>(), vector_derivatives[i]);
+      } else {
+        EXPECT_THAT(double_derivatives[i],
+                    AlmostEquals(double_series.EvaluateDerivative(times[i]),
+                                 0, 768)) << degree << " " << i;
+        EXPECT_THAT(vector_derivatives[i],
+                    AlmostEquals(vector_series.EvaluateDerivative(times[i]),
+                                 0, 768)) << degree << " " << i;
+      }
+    }
+  }
+}
+
 TEST_F(ЧебышёвSeriesDeathTest, SerializationError) {
   ЧебышёвSeries<Speed> v({1 * Metre / Second,
                           -2 * Metre / Second,
@@ -396,5 +452,42 @@ TEST_F(ЧебышёвSeriesTest, NewhallApproximation) {
                               near_speed(1.3e-12 * Metre / Second)));
 }
 
+// Checks that the approximator computes the same approximations as the matrix
+// products, and that its cheap last coefficients are those of the
+// approximations.
+TEST_F(ЧебышёвSeriesTest, NewhallApproximator) {
+  std::vector<Displacement<ICRFJ2000Ecliptic>> q;
+  std::vector<Velocity<ICRFJ2000Ecliptic>> v;
+  FixedVector<Displacement<ICRFJ2000Ecliptic>, 18> qv;
+  Time const duration_over_two = 0.5 * (t_max_ - t_min_);
+  for (int i = 0; i <= 8; ++i) {
+    double const x = i * i - 3 * i + 1;
+    q.push_back(Displacement<ICRFJ2000Ecliptic>(
+        {x * Metre, -2 * x * Metre, (x + 0.5) * Metre}));
+    v.push_back(Velocity<ICRFJ2000Ecliptic>(
+        {(3 - x) * Metre / Second, x * Metre / Second, 7 * Metre / Second}));
+    qv[16 - 2 * i] = q.back();
+    qv[17 - 2 * i] = v.back() * duration_over_two;
+  }
+
+  NewhallApproximator<Displacement<ICRFJ2000Ecliptic>> const approximator(
+      q, v, t_min_, t_max_);
+  for (int degree = 3; degree <= 17; ++degree) {
+    ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>> const approximation =
+        approximator.Approximation(degree);
+    EXPECT_EQ(approximation.last_coefficient(),
+              approximator.LastCoefficient(degree)) << degree;
+    EXPECT_EQ(approximation,
+              ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>>::
+                  NewhallApproximation(degree, q, v, t_min_, t_max_))
+        << degree;
+  }
+  std::vector<Displacement<ICRFJ2000Ecliptic>> const coefficients =
+      newhall_c_matrix_degree_5_divisions_8_w04 * qv;
+  EXPECT_EQ(ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>>(
+                coefficients, t_min_, t_max_),
+            approximator.Approximation(5));
+}
+
 }  // namespace numerics
 }  // namespace principia
@@ -44,6 +44,10 @@ class BarycentricRotatingDynamicFrame
 
   RigidMotion<InertialFrame, ThisFrame> ToThisFrameAtTime(
       Instant const& t) const override;
+  void ToThisFrameAtTimes(
+      std::vector<Instant> const& times,
+      not_null<std::vector<RigidMotion<InertialFrame, ThisFrame>>*> const
+          rigid_motions) const override;
 
   void WriteToMessage(
       not_null<serialization::DynamicFrame*> const message) const override;
@@ -60,6 +64,13 @@ class BarycentricRotatingDynamicFrame
   AcceleratedRigidMotion<InertialFrame, ThisFrame> MotionOfThisFrame(
       Instant const& t) const override;
 
+  // The motion of |ThisFrame| when the primary and the secondary have the
+  // given degrees of freedom.
+  RigidMotion<InertialFrame, ThisFrame> ToThisFrame(
+      DegreesOfFreedom<InertialFrame> const& primary_degrees_of_freedom,
+      DegreesOfFreedom<InertialFrame> const& secondary_degrees_of_freedom)
+      const;
+
   // Fills |*rotation| with the rotation that maps the basis of |InertialFrame|
   // to the basis of |ThisFrame|.  Fills |*angular_frequency| with the
   // corresponding angular velocity.
@@ -76,6 +87,8 @@ class BarycentricRotatingDynamicFrame
       primary_trajectory_;
   not_null<ContinuousTrajectory<InertialFrame> const*> const
       secondary_trajectory_;
+  // These hints are shared by all the callers, which is safe because a |Hint|
+  // tolerates concurrent use.
   mutable typename ContinuousTrajectory<InertialFrame>::Hint primary_hint_;
   mutable typename ContinuousTrajectory<InertialFrame>::Hint secondary_hint_;
 };
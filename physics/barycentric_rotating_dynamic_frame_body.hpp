@@ -42,10 +42,37 @@ template<typename InertialFrame, typename ThisFrame>
 RigidMotion<InertialFrame, ThisFrame>
 BarycentricRotatingDynamicFrame<InertialFrame, ThisFrame>::ToThisFrameAtTime(
     Instant const& t) const {
-  DegreesOfFreedom<InertialFrame> const primary_degrees_of_freedom =
-      primary_trajectory_->EvaluateDegreesOfFreedom(t, &primary_hint_);
-  DegreesOfFreedom<InertialFrame> const secondary_degrees_of_freedom =
-      secondary_trajectory_->EvaluateDegreesOfFreedom(t, &secondary_hint_);
+  return ToThisFrame(
+      primary_trajectory_->EvaluateDegreesOfFreedom(t, &primary_hint_),
+      secondary_trajectory_->EvaluateDegreesOfFreedom(t, &secondary_hint_));
+}
+
+template<typename InertialFrame, typename ThisFrame>
+void BarycentricRotatingDynamicFrame<InertialFrame, ThisFrame>::
+ToThisFrameAtTimes(
+    std::vector<Instant> const& times,
+    not_null<std::vector<RigidMotion<InertialFrame, ThisFrame>>*> const
+        rigid_motions) const {
+  std::vector<DegreesOfFreedom<InertialFrame>> primary_degrees_of_freedom;
+  std::vector<DegreesOfFreedom<InertialFrame>> secondary_degrees_of_freedom;
+  primary_trajectory_->EvaluateDegreesOfFreedomAtTimes(
+      times, &primary_degrees_of_freedom);
+  secondary_trajectory_->EvaluateDegreesOfFreedomAtTimes(
+      times, &secondary_degrees_of_freedom);
+  rigid_motions->clear();
+  rigid_motions->reserve(times.size());
+  for (int i = 0; i < times.size(); ++i) {
+    rigid_motions->push_back(ToThisFrame(primary_degrees_of_freedom[i],
+                                         secondary_degrees_of_freedom[i]));
+  }
+}
+
+template<typename InertialFrame, typename ThisFrame>
+RigidMotion<InertialFrame, ThisFrame>
+BarycentricRotatingDynamicFrame<InertialFrame, ThisFrame>::ToThisFrame(
+    DegreesOfFreedom<InertialFrame> const& primary_degrees_of_freedom,
+    DegreesOfFreedom<InertialFrame> const& secondary_degrees_of_freedom)
+    const {
   DegreesOfFreedom<InertialFrame> const barycentre_degrees_of_freedom =
       Barycentre<DegreesOfFreedom<InertialFrame>, GravitationalParameter>(
           {primary_degrees_of_freedom,
@@ -2,6 +2,7 @@
 #include "physics/barycentric_rotating_dynamic_frame.hpp"
 
 #include <memory>
+#include <vector>
 
 #include "astronomy/frames.hpp"
 #include "geometry/barycentre_calculator.hpp"
@@ -213,6 +214,27 @@ TEST_F(BarycentricRotatingDynamicFrameTest, Inverse) {
   }
 }
 
+TEST_F(BarycentricRotatingDynamicFrameTest, ToThisFrameAtTimes) {
+  int const steps = 100;
+  std::vector<Instant> times;
+  for (Instant t = t0_; t < t0_ + 1 * period_; t += period_ / steps) {
+    times.push_back(t);
+  }
+  std::vector<RigidMotion<ICRFJ2000Equator, BigSmallFrame>>
+      to_big_small_frame;
+  big_small_frame_->ToThisFrameAtTimes(times, &to_big_small_frame);
+  ASSERT_EQ(times.size(), to_big_small_frame.size());
+  for (int i = 0; i < times.size(); ++i) {
+    auto const expected =
+        big_small_frame_->ToThisFrameAtTime(times[i])(small_initial_state_);
+    auto const actual = to_big_small_frame[i](small_initial_state_);
+    EXPECT_THAT(AbsoluteError(expected.position(), actual.position()),
+                Lt(1.0e-11 * Metre));
+    EXPECT_THAT(AbsoluteError(expected.velocity(), actual.velocity()),
+                Lt(1.0e-11 * Metre / Second));
+  }
+}
+
 // Two bodies in rotation with their barycentre at rest.  The test point is at
 // the origin and in motion.  The acceleration is purely due to Coriolis.
 TEST_F(BarycentricRotatingDynamicFrameTest, CoriolisAcceleration) {
@@ -40,6 +40,10 @@ class BodyCentredNonRotatingDynamicFrame
 
   RigidMotion<InertialFrame, ThisFrame> ToThisFrameAtTime(
       Instant const& t) const override;
+  void ToThisFrameAtTimes(
+      std::vector<Instant> const& times,
+      not_null<std::vector<RigidMotion<InertialFrame, ThisFrame>>*> const
+          rigid_motions) const override;
 
   void WriteToMessage(
       not_null<serialization::DynamicFrame*> const message) const override;
@@ -56,9 +60,15 @@ class BodyCentredNonRotatingDynamicFrame
   AcceleratedRigidMotion<InertialFrame, ThisFrame> MotionOfThisFrame(
       Instant const& t) const override;
 
+  // The motion of |ThisFrame| when the centre has the given degrees of
+  // freedom.
+  static RigidMotion<InertialFrame, ThisFrame> ToThisFrame(
+      DegreesOfFreedom<InertialFrame> const& centre_degrees_of_freedom);
+
   not_null<Ephemeris<InertialFrame> const*> const ephemeris_;
   not_null<MassiveBody const*> const centre_;
   not_null<ContinuousTrajectory<InertialFrame> const*> const centre_trajectory_;
+  // Shared by all the callers, possibly on different threads.
   mutable typename ContinuousTrajectory<InertialFrame>::Hint hint_;
 };
 
@@ -25,16 +25,23 @@ template<typename InertialFrame, typename ThisFrame>
 RigidMotion<InertialFrame, ThisFrame>
 BodyCentredNonRotatingDynamicFrame<InertialFrame, ThisFrame>::ToThisFrameAtTime(
     Instant const& t) const {
-  DegreesOfFreedom<InertialFrame> const centre_degrees_of_freedom =
-      centre_trajectory_->EvaluateDegreesOfFreedom(t, &hint_);
-  RigidTransformation<InertialFrame, ThisFrame> const
-      rigid_transformation(centre_degrees_of_freedom.position(),
-                           ThisFrame::origin,
-                           Identity<InertialFrame, ThisFrame>().Forget());
-  return RigidMotion<InertialFrame, ThisFrame>(
-             rigid_transformation,
-             AngularVelocity<InertialFrame>(),
-             centre_degrees_of_freedom.velocity());
+  return ToThisFrame(centre_trajectory_->EvaluateDegreesOfFreedom(t, &hint_));
+}
+
+template<typename InertialFrame, typename ThisFrame>
+void BodyCentredNonRotatingDynamicFrame<InertialFrame, ThisFrame>::
+ToThisFrameAtTimes(
+    std::vector<Instant> const& times,
+    not_null<std::vector<RigidMotion<InertialFrame, ThisFrame>>*> const
+        rigid_motions) const {
+  std::vector<DegreesOfFreedom<InertialFrame>> centre_degrees_of_freedom;
+  centre_trajectory_->EvaluateDegreesOfFreedomAtTimes(
+      times, &centre_degrees_of_freedom);
+  rigid_motions->clear();
+  rigid_motions->reserve(times.size());
+  for (auto const& degrees_of_freedom : centre_degrees_of_freedom) {
+    rigid_motions->push_back(ToThisFrame(degrees_of_freedom));
+  }
 }
 
 template<typename InertialFrame, typename ThisFrame>
@@ -76,6 +83,20 @@ BodyCentredNonRotatingDynamicFrame<InertialFrame, ThisFrame>::MotionOfThisFrame(
                  ComputeGravitationalAccelerationOnMassiveBody(centre_, t));
 }
 
+template<typename InertialFrame, typename ThisFrame>
+RigidMotion<InertialFrame, ThisFrame>
+BodyCentredNonRotatingDynamicFrame<InertialFrame, ThisFrame>::ToThisFrame(
+    DegreesOfFreedom<InertialFrame> const& centre_degrees_of_freedom) {
+  RigidTransformation<InertialFrame, ThisFrame> const
+      rigid_transformation(centre_degrees_of_freedom.position(),
+                           ThisFrame::origin,
+                           Identity<InertialFrame, ThisFrame>().Forget());
+  return RigidMotion<InertialFrame, ThisFrame>(
+             rigid_transformation,
+             AngularVelocity<InertialFrame>(),
+             centre_degrees_of_freedom.velocity());
+}
+
 }  // namespace internal_body_centred_non_rotating_dynamic_frame
 }  // namespace physics
 }  // namespace principia
@@ -2,6 +2,7 @@
 #include "physics/body_centered_non_rotating_dynamic_frame.hpp"
 
 #include <memory>
+#include <vector>
 
 #include "astronomy/frames.hpp"
 #include "geometry/barycentre_calculator.hpp"
@@ -167,6 +168,25 @@ TEST_F(BodyCentredNonRotatingDynamicFrameTest, Inverse) {
   }
 }
 
+TEST_F(BodyCentredNonRotatingDynamicFrameTest, ToThisFrameAtTimes) {
+  int const steps = 100;
+  std::vector<Instant> times;
+  for (Instant t = t0_; t < t0_ + 1 * period_; t += period_ / steps) {
+    times.push_back(t);
+  }
+  std::vector<RigidMotion<ICRFJ2000Equator, Big>> to_big_frame;
+  big_frame_->ToThisFrameAtTimes(times, &to_big_frame);
+  ASSERT_EQ(times.size(), to_big_frame.size());
+  for (int i = 0; i < times.size(); ++i) {
+    auto const expected =
+        big_frame_->ToThisFrameAtTime(times[i])(small_initial_state_);
+    auto const actual = to_big_frame[i](small_initial_state_);
+    EXPECT_EQ(expected.position(), actual.position());
+    EXPECT_THAT(AbsoluteError(expected.velocity(), actual.velocity()),
+                Lt(1.0e-11 * Metre / Second));
+  }
+}
+
 TEST_F(BodyCentredNonRotatingDynamicFrameTest, GeometricAcceleration) {
   int const steps = 10;
   RelativeDegreesOfFreedom<ICRFJ2000Equator> const initial_big_to_small =
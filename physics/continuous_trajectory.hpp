@@ -1,10 +1,16 @@
 ﻿
 #pragma once
 
+#include <atomic>
+#include <deque>
 #include <experimental/optional>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
 #include <vector>
 #include <utility>
 
+#include "base/macros.hpp"
 #include "geometry/named_quantities.hpp"
 #include "numerics/чебышёв_series.hpp"
 #include "physics/degrees_of_freedom.hpp"
@@ -18,18 +24,31 @@ namespace internal_continuous_trajectory {
 using geometry::Displacement;
 using geometry::Instant;
 using geometry::Position;
+using geometry::R3Element;
 using geometry::Velocity;
 using quantities::Length;
 using quantities::Time;
+using numerics::NewhallApproximator;
 using numerics::ЧебышёвSeries;
 
+// Concurrency: the const member functions of this class may be called
+// concurrently from any number of threads, and concurrently with at most one
+// thread calling |Append| or |ForgetBefore|.  A reader observes the trajectory
+// either before or after a call to |Append|, never in an intermediate state, so
+// the values that it obtains for a given time do not depend on the
+// interleaving.  The evaluation functions don't lock: the series are never
+// moved nor modified once published, and |ForgetBefore| only frees the memory
+// of the series forgotten by its previous call, so an evaluation must not
+// remain suspended across two calls to |ForgetBefore|.
 template<typename Frame>
 class ContinuousTrajectory {
  public:
   // A |Hint| is used to speed up the evaluation of trajectories.  When
   // repeatedly calling one of the evaluation functions with increasing values
   // of the |time| parameter, evaluation may be faster if the same |Hint| object
-  // is passed to all the calls.
+  // is passed to all the calls.  A |Hint| is only a cache: it is safe to share
+  // it between threads, but threads evaluating at unrelated times should use
+  // distinct |Hint|s lest they keep invalidating each other's.
   class Hint;
 
   // A |Checkpoint| contains the impermanent state of a trajectory, i.e., the
@@ -85,6 +104,15 @@ class ContinuousTrajectory {
       Instant const& time,
       Hint* const hint) const;
 
+  // Evaluates the trajectory at the given |times|, which must be increasing and
+  // in [t_min(), t_max()], and stores the results in |degrees_of_freedom|.  The
+  // times that fall in the same series are evaluated together, which is faster
+  // than calling |EvaluateDegreesOfFreedom| for each of them.
+  void EvaluateDegreesOfFreedomAtTimes(
+      std::vector<Instant> const& times,
+      not_null<std::vector<DegreesOfFreedom<Frame>>*> const
+          degrees_of_freedom) const;
+
   // Returns a checkpoint for the current state of this object.
   Checkpoint GetCheckpoint() const;
 
@@ -100,12 +128,16 @@ class ContinuousTrajectory {
       serialization::ContinuousTrajectory const& message);
 
   // The only thing that clients may do with |Hint| objects is to
-  // default-initialize them.
+  // default-initialize and copy them.
   class Hint {
    public:
     Hint();
+    Hint(Hint const& other);
+    Hint& operator=(Hint const& other);
    private:
-    int index_;
+    // Accessed with relaxed ordering: the index is validated against the
+    // series before being used, so any value previously stored is acceptable.
+    std::atomic<int> index_;
     friend class ContinuousTrajectory<Frame>;
   };
 
@@ -139,56 +171,163 @@ class ContinuousTrajectory {
   ContinuousTrajectory();
 
  private:
+  // A Чебышёв series whose coefficients are stored in a |Block|.
+  struct Series {
+    Instant t_min;
+    Instant t_max;
+    // Precomputed as in |ЧебышёвSeries| so that the results are identical.
+    Time::Inverse one_over_duration;
+    int degree;
+    // The coefficient of T₀, in metres, followed by those of higher degree.
+    // Points into a |CoefficientBlock|.
+    R3Element<double> const* coefficients;
+  };
+
+  // A fixed number of consecutive series, and storage for the coefficients of
+  // consecutive series.  Blocks are never moved, so the published series and
+  // coefficients may be read without locking.
+  struct Block;
+  struct CoefficientBlock;
+
+  // Maps the absolute index of a block to the block.  The entries at or beyond
+  // the block of |end_| may be written by the writer, but the published entries
+  // are never modified.
+  struct Directory {
+    Directory(int first_block, int capacity);
+    int const first_block;
+    std::vector<Block*> blocks;
+  };
+
+  // A consistent view of the published series, which have the absolute indices
+  // [begin, end[.
+  struct View {
+    bool empty() const;
+    Series const& operator[](int index) const;
+
+    // The blocks of the published directory, and the index of the first one.
+    Block* const* blocks;
+    int first_block;
+    int begin;
+    int end;
+  };
+
+  // Returns the view of the series currently published.  Doesn't lock.
+  View Load() const;
+
+  // The versions of the public functions of the same names for the given
+  // |view|.
+  Instant t_min(View const& view) const;
+  Instant t_max(View const& view) const;
+
   // Computes the best Newhall approximation based on the desired tolerance.
   // Adjust the |degree_| and other member variables to stay within the
   // tolerance while minimizing the computational cost and avoiding numerical
-  // instabilities.
+  // instabilities.  The degree is chosen based on the |last_coefficient| of the
+  // approximations of the successive degrees, and only the approximation of
+  // the chosen degree is computed by |newhall_approximation| and appended to
+  // the series.  |lock_| must be held exclusively.
   void ComputeBestNewhallApproximation(
       Instant const& time,
       std::vector<Displacement<Frame>> const& q,
       std::vector<Velocity<Frame>> const& v,
-      ЧебышёвSeries<Displacement<Frame>> (*newhall_approximation)(
-          int const degree,
-          std::vector<Displacement<Frame>> const& q,
-          std::vector<Velocity<Frame>> const& v,
-          Instant const& t_min,
-          Instant const& t_max));
-
-  // Returns an iterator to the series applicable for the given |time|, or
-  // |begin()| if |time| is before the first series or |end()| if |time| is
-  // after the last series.  Time complexity is O(N Log N).
-  typename std::vector<ЧебышёвSeries<Displacement<Frame>>>::const_iterator
-  FindSeriesForInstant(Instant const& time) const;
-
-  // Returns true if the given |hint| is usable for the given |time|.  If it is,
-  // |hint->index| is the index of the series to use.
-  bool MayUseHint(Instant const& time, Hint* const hint) const;
+      std::function<Displacement<Frame>(int const degree)> const&
+          last_coefficient,
+      std::function<ЧебышёвSeries<Displacement<Frame>>(int const degree)> const&
+          newhall_approximation);
+
+  // Stores |series| and its coefficients in the last block, allocating a new
+  // block if needed, and publishes it.  |lock_| must be held exclusively.
+  void AppendSeries(ЧебышёвSeries<Displacement<Frame>> const& series);
+
+  // Returns the |ЧебышёвSeries| described by |series|.
+  static ЧебышёвSeries<Displacement<Frame>> MakeЧебышёвSeries(
+      Series const& series);
+
+  // The argument of the Чебышёв polynomials of |series| corresponding to
+  // |time|, computed as in |ЧебышёвSeries|.
+  static double ScaledTime(Series const& series, Instant const& time);
+
+  // Evaluate the given |series| and its derivative at |time|, which must be in
+  // [series.t_min, series.t_max].
+  static Displacement<Frame> EvaluateSeries(Series const& series,
+                                            Instant const& time);
+  static Velocity<Frame> EvaluateSeriesDerivative(Series const& series,
+                                                  Instant const& time);
+
+  // Returns the absolute index of the series of |view| applicable for the
+  // given |time|, or |view.begin| if |time| is before the first series or
+  // |view.end| if |time| is after the last series.  Time complexity is O(1) if
+  // the series have the same duration, as is normally the case, and O(Log N)
+  // otherwise.
+  static int FindSeriesForInstant(View const& view, Instant const& time);
+
+  // Returns the series of |view| applicable for the given |time|, which must be
+  // in [t_min(), t_max()], using and updating |hint| if it is not null.
+  Series const& FindSeriesForInstant(View const& view,
+                                     Instant const& time,
+                                     Hint* const hint) const;
 
   // Construction parameters;
   Time const step_;
   Length const tolerance_;
 
+  // Held exclusively by the functions that mutate the trajectory, and shared
+  // by the functions that read the state guarded by it.  The evaluation
+  // functions don't take it.
+  mutable std::shared_timed_mutex lock_;
+
   // Initially set to the construction parameters, and then adjusted when we
   // choose the degree.
-  Length adjusted_tolerance_;
-  bool is_unstable_;
+  Length adjusted_tolerance_ GUARDED_BY(lock_);
+  bool is_unstable_ GUARDED_BY(lock_);
 
   // The degree of the approximation and its age in number of Newhall
   // approximations.
-  int degree_;
-  int degree_age_;
-
-  // The series are in increasing time order.  Their intervals are consecutive.
-  std::vector<ЧебышёвSeries<Displacement<Frame>>> series_;
+  int degree_ GUARDED_BY(lock_);
+  int degree_age_ GUARDED_BY(lock_);
+
+  // The blocks that contain series which have not been forgotten, in
+  // increasing time order.  The absolute index of |blocks_.front()| is
+  // |first_block_|.  Within and across blocks, the series are in increasing
+  // time order and their intervals are consecutive.
+  std::deque<std::unique_ptr<Block>> blocks_ GUARDED_BY(lock_);
+  int first_block_ GUARDED_BY(lock_);
+
+  // The blocks that contain coefficients of series which have not been
+  // forgotten, in the same order as the series.
+  std::deque<std::unique_ptr<CoefficientBlock>> coefficient_blocks_
+      GUARDED_BY(lock_);
+
+  // The directory of |blocks_|; the last element is the one published in
+  // |directory_|.
+  std::vector<std::unique_ptr<Directory>> directories_ GUARDED_BY(lock_);
+
+  // The blocks and the directories that readers may still be using.  They are
+  // freed by the next call to |ForgetBefore|.
+  std::vector<std::unique_ptr<Block>> retired_blocks_ GUARDED_BY(lock_);
+  std::vector<std::unique_ptr<CoefficientBlock>> retired_coefficient_blocks_
+      GUARDED_BY(lock_);
+  std::vector<std::unique_ptr<Directory>> retired_directories_
+      GUARDED_BY(lock_);
+
+  // The published state, read by |Load|.  |end_| is stored last by
+  // |AppendSeries| with release semantics.
+  std::atomic<Directory const*> directory_;
+  std::atomic<int> begin_;
+  std::atomic<int> end_;
 
   // The time at which this trajectory starts.  Set for a nonempty trajectory.
-  // |*first_time_ >= series_.front().t_min()|
-  std::experimental::optional<Instant> first_time_;
+  // |*first_time_| is at or after the |t_min| of the first series.
+  std::experimental::optional<Instant> first_time_ GUARDED_BY(lock_);
+  // A copy of |*first_time_| for the readers, meaningful if the view is not
+  // empty.
+  std::atomic<Instant> published_first_time_;
 
   // The points that have not yet been incorporated in a series.  Nonempty for a
   // nonempty trajectory.
-  // |last_points_.begin()->first == series_.back().t_max()|
-  std::vector<std::pair<Instant, DegreesOfFreedom<Frame>>> last_points_;
+  // |last_points_.begin()->first| is the |t_max| of the last series.
+  std::vector<std::pair<Instant, DegreesOfFreedom<Frame>>> last_points_
+      GUARDED_BY(lock_);
 
   friend class ContinuousTrajectoryTest;
 };
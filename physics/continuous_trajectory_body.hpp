@@ -2,7 +2,11 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <iterator>
 #include <limits>
+#include <mutex>
+#include <shared_mutex>
 #include <utility>
 #include <vector>
 
@@ -26,6 +30,25 @@ int const max_degree_age = 100;
 // Only supports 8 divisions for now.
 int const divisions = 8;
 
+template<typename Frame>
+struct ContinuousTrajectory<Frame>::Block {
+  static constexpr int size = 64;
+
+  std::array<Series, size> series;
+};
+
+template<typename Frame>
+struct ContinuousTrajectory<Frame>::CoefficientBlock {
+  static constexpr int size = 1024;
+
+  std::array<R3Element<double>, size> coefficients;
+  // The number of elements of |coefficients| used by the series.
+  int used = 0;
+  // The absolute index of the last series whose coefficients are in this
+  // block.
+  int last_series = 0;
+};
+
 template<typename Frame>
 ContinuousTrajectory<Frame>::ContinuousTrajectory(Time const& step,
                                                   Length const& tolerance)
@@ -34,37 +57,34 @@ ContinuousTrajectory<Frame>::ContinuousTrajectory(Time const& step,
       adjusted_tolerance_(tolerance_),
       is_unstable_(false),
       degree_(min_degree),
-      degree_age_(0) {
+      degree_age_(0),
+      first_block_(0),
+      directory_(nullptr),
+      begin_(0),
+      end_(0) {
   CHECK_LT(0 * Metre, tolerance_);
 }
 
 template<typename Frame>
 bool ContinuousTrajectory<Frame>::empty() const {
-  return series_.empty();
+  return Load().empty();
 }
 
 template<typename Frame>
 Instant ContinuousTrajectory<Frame>::t_min() const {
-  if (empty()) {
-    Instant const t0;
-    return t0 + std::numeric_limits<double>::infinity() * Second;
-  }
-  return *first_time_;
+  return t_min(Load());
 }
 
 template<typename Frame>
 Instant ContinuousTrajectory<Frame>::t_max() const {
-  if (empty()) {
-    Instant const t0;
-    return t0 - std::numeric_limits<double>::infinity() * Second;
-  }
-  return series_.back().t_max();
+  return t_max(Load());
 }
 
 template<typename Frame>
 void ContinuousTrajectory<Frame>::Append(
     Instant const& time,
     DegreesOfFreedom<Frame> const& degrees_of_freedom) {
+  std::lock_guard<std::shared_timed_mutex> l(lock_);
   // Consistency checks.
   if (first_time_) {
     Instant const t0;
@@ -75,13 +95,15 @@ void ContinuousTrajectory<Frame>::Append(
         << "Append at times that are not equally spaced";
   } else {
     first_time_ = time;
+    published_first_time_.store(time, std::memory_order_release);
   }
 
   if (last_points_.size() == divisions) {
-    // These vectors are static to avoid deallocation/reallocation each time we
-    // go through this code path.
-    static std::vector<Displacement<Frame>> q(divisions + 1);
-    static std::vector<Velocity<Frame>> v(divisions + 1);
+    // These vectors are thread-local to avoid deallocation/reallocation each
+    // time we go through this code path, while allowing distinct trajectories
+    // to be appended to concurrently.
+    thread_local std::vector<Displacement<Frame>> q(divisions + 1);
+    thread_local std::vector<Velocity<Frame>> v(divisions + 1);
     q.clear();
     v.clear();
 
@@ -93,8 +115,18 @@ void ContinuousTrajectory<Frame>::Append(
     q.push_back(degrees_of_freedom.position() - Frame::origin);
     v.push_back(degrees_of_freedom.velocity());
 
+    NewhallApproximator<Displacement<Frame>> const approximator(
+        q, v, last_points_.cbegin()->first, time);
     ComputeBestNewhallApproximation(
-        time, q, v, &ЧебышёвSeries<Displacement<Frame>>::NewhallApproximation);
+        time,
+        q,
+        v,
+        [&approximator](int const degree) {
+          return approximator.LastCoefficient(degree);
+        },
+        [&approximator](int const degree) {
+          return approximator.Approximation(degree);
+        });
 
     // Wipe-out the points that have just been incorporated in a series.
     last_points_.clear();
@@ -108,20 +140,51 @@ void ContinuousTrajectory<Frame>::Append(
 
 template<typename Frame>
 void ContinuousTrajectory<Frame>::ForgetBefore(Instant const& time) {
-  if (time < t_min()) {
+  std::lock_guard<std::shared_timed_mutex> l(lock_);
+  View const view = Load();
+  if (time < t_min(view)) {
     // TODO(phl): test for this case, it yielded a check failure in
     // |FindSeriesForInstant|.
     return;
   }
-  series_.erase(series_.begin(), FindSeriesForInstant(time));
 
-  // If there are no |series_| left, clear everything.  Otherwise, update the
-  // first time.
-  if (series_.empty()) {
+  // The readers that were using the memory retired by the previous call are
+  // long done with it.
+  retired_blocks_.clear();
+  retired_coefficient_blocks_.clear();
+  retired_directories_.clear();
+
+  // If there are no series left, clear everything.  Otherwise, update the
+  // first time.  The first time is published before the series are forgotten
+  // so that a reader never sees a |t_min| before the first series.
+  int const begin = FindSeriesForInstant(view, time);
+  if (begin == view.end) {
     first_time_ = std::experimental::nullopt;
     last_points_.clear();
   } else {
     first_time_ = time;
+    published_first_time_.store(time, std::memory_order_release);
+  }
+  begin_.store(begin, std::memory_order_release);
+
+  // Retire the blocks that only contain forgotten series, as well as the
+  // directories that are no longer published.
+  while (first_block_ < begin / Block::size) {
+    retired_blocks_.push_back(std::move(blocks_.front()));
+    blocks_.pop_front();
+    ++first_block_;
+  }
+  while (!coefficient_blocks_.empty() &&
+         coefficient_blocks_.front()->last_series < begin) {
+    retired_coefficient_blocks_.push_back(
+        std::move(coefficient_blocks_.front()));
+    coefficient_blocks_.pop_front();
+  }
+  if (directories_.size() > 1) {
+    std::move(directories_.begin(),
+              directories_.end() - 1,
+              std::back_inserter(retired_directories_));
+    directories_.erase(directories_.begin(), directories_.end() - 1);
   }
 }
 
@@ -129,63 +192,78 @@ template<typename Frame>
 Position<Frame> ContinuousTrajectory<Frame>::EvaluatePosition(
     Instant const& time,
     Hint* const hint) const {
-  CHECK_LE(t_min(), time);
-  CHECK_GE(t_max(), time);
-  if (MayUseHint(time, hint)) {
-    return series_[hint->index_].Evaluate(time) + Frame::origin;
-  } else {
-    auto const it = FindSeriesForInstant(time);
-    CHECK(it != series_.end());
-    if (hint != nullptr) {
-      hint->index_ = it - series_.cbegin();
-    }
-    return it->Evaluate(time) + Frame::origin;
-  }
+  return EvaluateSeries(FindSeriesForInstant(Load(), time, hint), time) +
+         Frame::origin;
 }
 
 template<typename Frame>
 Velocity<Frame> ContinuousTrajectory<Frame>::EvaluateVelocity(
     Instant const& time,
     Hint* const hint) const {
-  CHECK_LE(t_min(), time);
-  CHECK_GE(t_max(), time);
-  if (MayUseHint(time, hint)) {
-    return series_[hint->index_].EvaluateDerivative(time);
-  } else {
-    auto const it = FindSeriesForInstant(time);
-    CHECK(it != series_.end());
-    if (hint != nullptr) {
-      hint->index_ = it - series_.cbegin();
-    }
-    return it->EvaluateDerivative(time);
-  }
+  return EvaluateSeriesDerivative(FindSeriesForInstant(Load(), time, hint),
+                                  time);
 }
 
 template<typename Frame>
 DegreesOfFreedom<Frame> ContinuousTrajectory<Frame>::EvaluateDegreesOfFreedom(
     Instant const& time,
     Hint* const hint) const {
-  CHECK_LE(t_min(), time);
-  CHECK_GE(t_max(), time);
-  if (MayUseHint(time, hint)) {
-    ЧебышёвSeries<Displacement<Frame>> const& series = series_[hint->index_];
-    return DegreesOfFreedom<Frame>(series.Evaluate(time) + Frame::origin,
-                                   series.EvaluateDerivative(time));
-  } else {
-    auto const it = FindSeriesForInstant(time);
-    CHECK(it != series_.end());
-    if (hint != nullptr) {
-      hint->index_ = it - series_.cbegin();
+  Series const& series = FindSeriesForInstant(Load(), time, hint);
+  return DegreesOfFreedom<Frame>(
+             EvaluateSeries(series, time) + Frame::origin,
+             EvaluateSeriesDerivative(series, time));
+}
+
+template<typename Frame>
+void ContinuousTrajectory<Frame>::EvaluateDegreesOfFreedomAtTimes(
+    std::vector<Instant> const& times,
+    not_null<std::vector<DegreesOfFreedom<Frame>>*> const
+        degrees_of_freedom) const {
+  View const view = Load();
+  degrees_of_freedom->clear();
+  degrees_of_freedom->reserve(times.size());
+  std::vector<double> scaled_t;
+  std::vector<R3Element<double>> positions;
+  std::vector<R3Element<double>> velocities;
+  Hint hint;
+  int begin = 0;
+  while (begin < times.size()) {
+    Series const& series = FindSeriesForInstant(view, times[begin], &hint);
+
+    // Evaluate together all the times that fall in |series|.
+    scaled_t.clear();
+    int end = begin;
+    for (; end < times.size() && times[end] <= series.t_max; ++end) {
+      if (end > 0) {
+        CHECK_LE(times[end - 1], times[end]);
+      }
+      scaled_t.push_back(ScaledTime(series, times[end]));
+    }
+    int const count = end - begin;
+    positions.resize(count);
+    velocities.resize(count);
+    numerics::EvaluateЧебышёвSeriesAndDerivative(series.coefficients,
+                                                 series.degree,
+                                                 count,
+                                                 scaled_t.data(),
+                                                 positions.data(),
+                                                 velocities.data());
+    for (int i = 0; i < count; ++i) {
+      degrees_of_freedom->emplace_back(
+          Displacement<Frame>(positions[i] * Metre) + Frame::origin,
+          Velocity<Frame>(
+              velocities[i] * Metre *
+              (series.one_over_duration + series.one_over_duration)));
     }
-    return DegreesOfFreedom<Frame>(it->Evaluate(time) + Frame::origin,
-                                   it->EvaluateDerivative(time));
+    begin = end;
   }
 }
 
 template<typename Frame>
 typename ContinuousTrajectory<Frame>::Checkpoint
 ContinuousTrajectory<Frame>::GetCheckpoint() const {
-  return {t_max(),
+  std::shared_lock<std::shared_timed_mutex> l(lock_);
+  return {t_max(Load()),
           adjusted_tolerance_,
           is_unstable_,
           degree_,
@@ -204,6 +282,7 @@ void ContinuousTrajectory<Frame>::WriteToMessage(
       not_null<serialization::ContinuousTrajectory*> const message,
       Checkpoint const& checkpoint) const {
   LOG(INFO) << __FUNCTION__;
+  std::shared_lock<std::shared_timed_mutex> l(lock_);
   step_.WriteToMessage(message->mutable_step());
   tolerance_.WriteToMessage(message->mutable_tolerance());
   checkpoint.adjusted_tolerance_.WriteToMessage(
@@ -211,14 +290,16 @@ void ContinuousTrajectory<Frame>::WriteToMessage(
   message->set_is_unstable(checkpoint.is_unstable_);
   message->set_degree(checkpoint.degree_);
   message->set_degree_age(checkpoint.degree_age_);
-  for (auto const& s : series_) {
-    if (s.t_max() <= checkpoint.t_max_) {
-      s.WriteToMessage(message->add_series());
+  View const view = Load();
+  for (int index = view.begin; index < view.end; ++index) {
+    Series const& s = view[index];
+    if (s.t_max <= checkpoint.t_max_) {
+      MakeЧебышёвSeries(s).WriteToMessage(message->add_series());
     }
-    if (s.t_max() == checkpoint.t_max_) {
+    if (s.t_max == checkpoint.t_max_) {
       break;
     }
-    CHECK_LT(s.t_max(), checkpoint.t_max_);
+    CHECK_LT(s.t_max, checkpoint.t_max_);
   }
   if (first_time_) {
     first_time_->WriteToMessage(message->mutable_first_time());
@@ -251,13 +332,15 @@ ContinuousTrajectory<Frame>::ReadFromMessage(
   continuous_trajectory->is_unstable_ = message.is_unstable();
   continuous_trajectory->degree_ = message.degree();
   continuous_trajectory->degree_age_ = message.degree_age();
-  for (auto const& s : message.series()) {
-    continuous_trajectory->series_.push_back(
-        ЧебышёвSeries<Displacement<Frame>>::ReadFromMessage(s));
-  }
   if (message.has_first_time()) {
     continuous_trajectory->first_time_ =
         Instant::ReadFromMessage(message.first_time());
+    continuous_trajectory->published_first_time_.store(
+        *continuous_trajectory->first_time_, std::memory_order_release);
+  }
+  for (auto const& s : message.series()) {
+    continuous_trajectory->AppendSeries(
+        ЧебышёвSeries<Displacement<Frame>>::ReadFromMessage(s));
   }
   for (auto const& l : message.last_point()) {
     continuous_trajectory->last_points_.push_back(
@@ -271,6 +354,18 @@ template<typename Frame>
 ContinuousTrajectory<Frame>::Hint::Hint()
     : index_(std::numeric_limits<int>::max()) {}
 
+template<typename Frame>
+ContinuousTrajectory<Frame>::Hint::Hint(Hint const& other)
+    : index_(other.index_.load(std::memory_order_relaxed)) {}
+
+template<typename Frame>
+typename ContinuousTrajectory<Frame>::Hint&
+ContinuousTrajectory<Frame>::Hint::operator=(Hint const& other) {
+  index_.store(other.index_.load(std::memory_order_relaxed),
+               std::memory_order_relaxed);
+  return *this;
+}
+
 template<typename Frame>
 ContinuousTrajectory<Frame>::Checkpoint::Checkpoint(
     Instant const& t_max,
@@ -287,19 +382,77 @@ ContinuousTrajectory<Frame>::Checkpoint::Checkpoint(
       last_points_(last_points) {}
 
 template<typename Frame>
-ContinuousTrajectory<Frame>::ContinuousTrajectory() {}
+ContinuousTrajectory<Frame>::ContinuousTrajectory()
+    : directory_(nullptr),
+      begin_(0),
+      end_(0) {}
+
+template<typename Frame>
+ContinuousTrajectory<Frame>::Directory::Directory(int const first_block,
+                                                  int const capacity)
+    : first_block(first_block),
+      blocks(capacity, nullptr) {}
+
+template<typename Frame>
+bool ContinuousTrajectory<Frame>::View::empty() const {
+  return begin >= end;
+}
+
+template<typename Frame>
+typename ContinuousTrajectory<Frame>::Series const&
+ContinuousTrajectory<Frame>::View::operator[](int const index) const {
+  // The index is nonnegative, and unsigned arithmetic is faster.
+  unsigned int const i = index;
+  return blocks[i / Block::size - first_block]->series[i % Block::size];
+}
+
+template<typename Frame>
+typename ContinuousTrajectory<Frame>::View
+ContinuousTrajectory<Frame>::Load() const {
+  // |end_| must be loaded first: the directory published with it covers all
+  // the series before it, and |begin_| only increases.
+  View view;
+  view.end = end_.load(std::memory_order_acquire);
+  Directory const* const directory =
+      directory_.load(std::memory_order_acquire);
+  if (directory == nullptr) {
+    view.blocks = nullptr;
+    view.first_block = 0;
+  } else {
+    view.blocks = directory->blocks.data();
+    view.first_block = directory->first_block;
+  }
+  view.begin = begin_.load(std::memory_order_acquire);
+  return view;
+}
+
+template<typename Frame>
+Instant ContinuousTrajectory<Frame>::t_min(View const& view) const {
+  if (view.empty()) {
+    Instant const t0;
+    return t0 + std::numeric_limits<double>::infinity() * Second;
+  }
+  return published_first_time_.load(std::memory_order_acquire);
+}
+
+template<typename Frame>
+Instant ContinuousTrajectory<Frame>::t_max(View const& view) const {
+  if (view.empty()) {
+    Instant const t0;
+    return t0 - std::numeric_limits<double>::infinity() * Second;
+  }
+  return view[view.end - 1].t_max;
+}
 
 template<typename Frame>
 void ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
     Instant const& time,
     std::vector<Displacement<Frame>> const& q,
     std::vector<Velocity<Frame>> const& v,
-    ЧебышёвSeries<Displacement<Frame>> (*newhall_approximation)(
-        int const degree,
-        std::vector<Displacement<Frame>> const& q,
-        std::vector<Velocity<Frame>> const& v,
-        Instant const& t_min,
-        Instant const& t_max)) {
+    std::function<Displacement<Frame>(int const degree)> const&
+        last_coefficient,
+    std::function<ЧебышёвSeries<Displacement<Frame>>(int const degree)> const&
+        newhall_approximation) {
   Length const previous_adjusted_tolerance = adjusted_tolerance_;
 
   // If the degree is too old, restart from the lowest degree.  This ensures
@@ -313,13 +466,10 @@ void ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
     degree_age_ = 0;
   }
 
-  // Compute the approximation with the current degree.
-  series_.push_back(
-      newhall_approximation(degree_, q, v, last_points_.cbegin()->first, time));
-
-  // Estimate the error.  For initializing |previous_error_estimate|, any value
-  // greater than |error_estimate| will do.
-  Length error_estimate = series_.back().last_coefficient().Norm();
+  // Estimate the error of the approximation with the current degree.  For
+  // initializing |previous_error_estimate|, any value greater than
+  // |error_estimate| will do.
+  Length error_estimate = last_coefficient(degree_).Norm();
   Length previous_error_estimate = error_estimate + error_estimate;
 
   // If we are in the zone of numerical instabilities and we exceeded the
@@ -347,13 +497,13 @@ void ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
     ++degree_;
     VLOG(1) << "Increasing degree for " << this << " to " <<degree_
             << " because error estimate was " << error_estimate;
-    series_.back() =
-        newhall_approximation(
-            degree_, q, v, last_points_.cbegin()->first, time);
     previous_error_estimate = error_estimate;
-    error_estimate = series_.back().last_coefficient().Norm();
+    error_estimate = last_coefficient(degree_).Norm();
   }
 
+  // Compute the approximation with the last degree that we tried.
+  AppendSeries(newhall_approximation(degree_));
+
   // If we have entered the zone of numerical instability, go back to the
   // point where the error was decreasing and nudge the tolerance since we
   // won't be able to reliably do better than that.
@@ -382,39 +532,177 @@ void ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
 }
 
 template<typename Frame>
-typename std::vector<ЧебышёвSeries<Displacement<Frame>>>::const_iterator
-ContinuousTrajectory<Frame>::FindSeriesForInstant(Instant const& time) const {
-  // Need to use |lower_bound|, not |upper_bound|, because it allows
-  // heterogeneous arguments.  This returns the first series |s| such that
-  // |time <= s.t_max()|.
-  auto const it = std::lower_bound(
-                      series_.begin(), series_.end(), time,
-                      [](ЧебышёвSeries<Displacement<Frame>> const& left,
-                         Instant const& right) {
-                        return left.t_max() < right;
-                      });
-  return it;
+void ContinuousTrajectory<Frame>::AppendSeries(
+    ЧебышёвSeries<Displacement<Frame>> const& series) {
+  CHECK_LE(series.degree(), max_degree);
+  int const index = end_.load(std::memory_order_relaxed);
+  int const block_index = index / Block::size;
+  if (index % Block::size == 0) {
+    if (blocks_.empty()) {
+      first_block_ = block_index;
+    }
+    blocks_.push_back(std::make_unique<Block>());
+    // Publish the new block in the current directory if it has room, otherwise
+    // in a new directory.  Either way, the block is not visible to the readers
+    // until |end_| is stored below.
+    Directory* const directory =
+        directories_.empty() ? nullptr : directories_.back().get();
+    if (directory != nullptr &&
+        block_index - directory->first_block < directory->blocks.size()) {
+      directory->blocks[block_index - directory->first_block] =
+          blocks_.back().get();
+    } else {
+      auto new_directory = std::make_unique<Directory>(
+          first_block_, 2 * static_cast<int>(blocks_.size()));
+      for (int i = 0; i < blocks_.size(); ++i) {
+        new_directory->blocks[i] = blocks_[i].get();
+      }
+      directory_.store(new_directory.get(), std::memory_order_release);
+      directories_.push_back(std::move(new_directory));
+    }
+  }
+
+  if (coefficient_blocks_.empty() ||
+      coefficient_blocks_.back()->used + series.degree() + 1 >
+          CoefficientBlock::size) {
+    coefficient_blocks_.push_back(std::make_unique<CoefficientBlock>());
+  }
+  CoefficientBlock& coefficient_block = *coefficient_blocks_.back();
+  R3Element<double>* const coefficients =
+      &coefficient_block.coefficients[coefficient_block.used];
+  for (int k = 0; k <= series.degree(); ++k) {
+    coefficients[k] = series.coefficient(k).coordinates() / Metre;
+  }
+  coefficient_block.used += series.degree() + 1;
+  coefficient_block.last_series = index;
+
+  Time const duration = series.t_max() - series.t_min();
+  blocks_.back()->series[index % Block::size] = {
+      series.t_min(),
+      series.t_max(),
+      /*one_over_duration=*/1 / duration,
+      series.degree(),
+      coefficients};
+  end_.store(index + 1, std::memory_order_release);
+}
+
+template<typename Frame>
+ЧебышёвSeries<Displacement<Frame>>
+ContinuousTrajectory<Frame>::MakeЧебышёвSeries(Series const& series) {
+  std::vector<Displacement<Frame>> coefficients;
+  coefficients.reserve(series.degree + 1);
+  for (int k = 0; k <= series.degree; ++k) {
+    coefficients.push_back(
+        Displacement<Frame>(series.coefficients[k] * Metre));
+  }
+  return ЧебышёвSeries<Displacement<Frame>>(
+      coefficients, series.t_min, series.t_max);
+}
+
+template<typename Frame>
+double ContinuousTrajectory<Frame>::ScaledTime(Series const& series,
+                                               Instant const& time) {
+  // See |ЧебышёвSeries::Evaluate| for the rationale of this formula.
+  return ((time - series.t_max) + (time - series.t_min)) *
+         series.one_over_duration;
+}
+
+template<typename Frame>
+Displacement<Frame> ContinuousTrajectory<Frame>::EvaluateSeries(
+    Series const& series,
+    Instant const& time) {
+  return Displacement<Frame>(
+      numerics::EvaluateЧебышёвSeries(series.coefficients,
+                                      series.degree,
+                                      ScaledTime(series, time)) * Metre);
+}
+
+template<typename Frame>
+Velocity<Frame> ContinuousTrajectory<Frame>::EvaluateSeriesDerivative(
+    Series const& series,
+    Instant const& time) {
+  return Velocity<Frame>(
+      numerics::EvaluateЧебышёвSeriesDerivative(series.coefficients,
+                                                series.degree,
+                                                ScaledTime(series, time)) *
+      Metre * (series.one_over_duration + series.one_over_duration));
 }
 
 template<typename Frame>
-bool ContinuousTrajectory<Frame>::MayUseHint(Instant const& time,
-                                             Hint* const hint) const {
+int ContinuousTrajectory<Frame>::FindSeriesForInstant(View const& view,
+                                                      Instant const& time) {
+  // Returns true iff |view[index]| is the first series |s| such that
+  // |time <= s.t_max|.
+  auto const is_first_series_ending_after = [&view, &time](int const index) {
+    return time <= view[index].t_max &&
+           (index == view.begin || view[index - 1].t_max < time);
+  };
+
+  // All the series span |divisions| steps, so their durations are uniform up
+  // to rounding and the index can be computed directly.  We only need to check
+  // the neighbours of the guess, to take rounding into account.
+  if (view.empty()) {
+    return view.begin;
+  }
+  Series const& front = view[view.begin];
+  Series const& back = view[view.end - 1];
+  if (front.t_min <= time && time <= back.t_max) {
+    int const size = view.end - view.begin;
+    double const guess =
+        (time - front.t_min) * size / (back.t_max - front.t_min);
+    int const index = view.begin + std::min(static_cast<int>(guess), size - 1);
+    for (int const candidate : {index, index - 1, index + 1}) {
+      if (candidate >= view.begin && candidate < view.end &&
+          is_first_series_ending_after(candidate)) {
+        return candidate;
+      }
+    }
+  }
+
+  // The series are irregular, or |time| is out of range: do a binary search
+  // for the first series |s| such that |time <= s.t_max|.
+  int low = view.begin;
+  int high = view.end;
+  while (low < high) {
+    int const middle = low + (high - low) / 2;
+    if (view[middle].t_max < time) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+template<typename Frame>
+typename ContinuousTrajectory<Frame>::Series const&
+ContinuousTrajectory<Frame>::FindSeriesForInstant(View const& view,
+                                                  Instant const& time,
+                                                  Hint* const hint) const {
+  CHECK_LE(t_min(view), time);
+  CHECK_GE(t_max(view), time);
   if (hint != nullptr) {
-    // A shorthand for the index held by the |hint|.
-    int& index = hint->index_;
-    if (index < series_.size() && series_[index].t_min() <= time) {
-      if (time <= series_[index].t_max()) {
+    // The hint may be shared with other threads, so we read it once and
+    // validate it against the view before using it.
+    int const index = hint->index_.load(std::memory_order_relaxed);
+    if (view.begin <= index && index < view.end &&
+        view[index].t_min <= time) {
+      if (time <= view[index].t_max) {
         // Use this interval.
-        return true;
-      } else if (index < series_.size() - 1 &&
-                 time <= series_[index + 1].t_max()) {
+        return view[index];
+      } else if (index < view.end - 1 && time <= view[index + 1].t_max) {
         // Move to the next interval.
-        ++index;
-        return true;
+        hint->index_.store(index + 1, std::memory_order_relaxed);
+        return view[index + 1];
       }
     }
   }
-  return false;
+  int const index = FindSeriesForInstant(view, time);
+  CHECK_LT(index, view.end);
+  if (hint != nullptr) {
+    hint->index_.store(index, std::memory_order_relaxed);
+  }
+  return view[index];
 }
 
 }  // namespace internal_continuous_trajectory
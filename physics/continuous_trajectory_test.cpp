@@ -1,9 +1,12 @@
 ﻿
 #include "physics/continuous_trajectory.hpp"
 
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <limits>
+#include <random>
+#include <thread>
 #include <vector>
 
 #include "geometry/frame.hpp"
@@ -47,15 +50,10 @@ class ContinuousTrajectoryTest : public testing::Test {
                       serialization::Frame::TEST1, true>;
 
  protected:
-  static ЧебышёвSeries<Displacement<World>> SimulatedNewhallApproximation(
-      int const degree,
-      std::vector<Displacement<World>> const& q,
-      std::vector<Velocity<World>> const& v,
-      Instant const& t_min,
-      Instant const& t_max) {
+  static Displacement<World> SimulatedLastCoefficient(int const degree) {
     Displacement<World> const error_estimate = error_estimates_->front();
     error_estimates_->pop_front();
-    return ЧебышёвSeries<Displacement<World>>({error_estimate}, t_min, t_max);
+    return error_estimate;
   }
 
   void FillTrajectory(
@@ -84,7 +82,13 @@ class ContinuousTrajectoryTest : public testing::Test {
     std::vector<Displacement<World>> const q;
     std::vector<Velocity<World>> const v;
     trajectory_->ComputeBestNewhallApproximation(
-        t, q, v, &SimulatedNewhallApproximation);
+        t, q, v,
+        &SimulatedLastCoefficient,
+        [this, t](int const degree) {
+          return ЧебышёвSeries<Displacement<World>>({Displacement<World>()},
+                                                    t0_,
+                                                    t);
+        });
   }
 
   int degree() const {
@@ -477,6 +481,253 @@ TEST_F(ContinuousTrajectoryTest, Serialization) {
       << "SECOND\n" << second_message.DebugString();
 }
 
+// Check that forgetting the first series doesn't affect the evaluation of the
+// remaining ones, which share their storage.
+TEST_F(ContinuousTrajectoryTest, ForgetBeforeEvaluation) {
+  int const number_of_steps = 100;
+  int const number_of_substeps = 50;
+  Time const step = 0.01 * Second;
+
+  auto position_function =
+      [this](Instant const t) {
+        return World::origin +
+            Displacement<World>({(t - t0_) * 3 * Metre / Second,
+                                 (t - t0_) * 5 * Metre / Second,
+                                 (t - t0_) * (-2) * Metre / Second});
+      };
+  auto velocity_function =
+      [](Instant const t) {
+        return Velocity<World>({3 * Metre / Second,
+                                5 * Metre / Second,
+                                -2 * Metre / Second});
+      };
+
+  trajectory_ = std::make_unique<ContinuousTrajectory<World>>(
+                    step,
+                    /*tolerance=*/0.1 * Metre);
+  FillTrajectory(
+      number_of_steps, step, position_function, velocity_function, t0_);
+
+  Instant const forget_before_time = t0_ + (number_of_steps / 2) * step;
+  std::vector<DegreesOfFreedom<World>> expected_degrees_of_freedom;
+  for (Instant time = forget_before_time;
+       time <= trajectory_->t_max();
+       time += step / number_of_substeps) {
+    expected_degrees_of_freedom.push_back(
+        trajectory_->EvaluateDegreesOfFreedom(time, /*hint=*/nullptr));
+  }
+
+  trajectory_->ForgetBefore(forget_before_time);
+  EXPECT_EQ(forget_before_time, trajectory_->t_min());
+
+  serialization::ContinuousTrajectory message;
+  trajectory_->WriteToMessage(&message);
+  auto const trajectory = ContinuousTrajectory<World>::ReadFromMessage(message);
+
+  ContinuousTrajectory<World>::Hint hint;
+  int i = 0;
+  for (Instant time = forget_before_time;
+       time <= trajectory_->t_max();
+       time += step / number_of_substeps, ++i) {
+    EXPECT_EQ(expected_degrees_of_freedom[i],
+              trajectory_->EvaluateDegreesOfFreedom(time, &hint));
+    EXPECT_EQ(expected_degrees_of_freedom[i],
+              trajectory->EvaluateDegreesOfFreedom(time, /*hint=*/nullptr));
+  }
+  EXPECT_EQ(expected_degrees_of_freedom.size(), i);
+
+  // Forgetting everything leaves an empty trajectory that can be extended.
+  Instant const t_max = trajectory_->t_max();
+  trajectory_->ForgetBefore(t_max + step);
+  EXPECT_TRUE(trajectory_->empty());
+  FillTrajectory(
+      number_of_steps, step, position_function, velocity_function, t_max);
+  EXPECT_THAT(trajectory_->EvaluatePosition(trajectory_->t_max(), &hint),
+              AlmostEquals(position_function(trajectory_->t_max()), 0, 11));
+}
+
+// Check that the trajectory may be read without locking while it is being
+// appended to and forgotten, across many blocks of series.
+TEST_F(ContinuousTrajectoryTest, ConcurrentEvaluation) {
+  int const number_of_steps = 10'000;
+  Time const step = 0.01 * Second;
+
+  auto position_function =
+      [this](Instant const t) {
+        return World::origin +
+            Displacement<World>({(t - t0_) * 3 * Metre / Second,
+                                 (t - t0_) * 5 * Metre / Second,
+                                 (t - t0_) * (-2) * Metre / Second});
+      };
+  auto velocity_function =
+      [](Instant const t) {
+        return Velocity<World>({3 * Metre / Second,
+                                5 * Metre / Second,
+                                -2 * Metre / Second});
+      };
+
+  trajectory_ = std::make_unique<ContinuousTrajectory<World>>(
+                    step,
+                    /*tolerance=*/0.1 * Metre);
+  std::atomic<bool> done(false);
+  std::thread writer([this, &done, &position_function, &velocity_function,
+                      number_of_steps, step]() {
+    for (int i = 1; i <= number_of_steps; ++i) {
+      Instant const ti = t0_ + i * step;
+      trajectory_->Append(ti,
+                          DegreesOfFreedom<World>(position_function(ti),
+                                                  velocity_function(ti)));
+      if (i % 1000 == 0) {
+        trajectory_->ForgetBefore(ti - 100 * step);
+      }
+    }
+    done = true;
+  });
+
+  ContinuousTrajectory<World>::Hint hint;
+  int evaluations = 0;
+  while (!done) {
+    if (trajectory_->empty()) {
+      continue;
+    }
+    Instant const t_max = trajectory_->t_max();
+    EXPECT_THAT(trajectory_->EvaluatePosition(t_max, &hint),
+                AlmostEquals(position_function(t_max), 0, 1e6));
+    ++evaluations;
+  }
+  writer.join();
+  LOG(INFO) << evaluations << " concurrent evaluations";
+
+  Instant const t_min = t0_ + (number_of_steps - 100) * step;
+  EXPECT_EQ(t_min, trajectory_->t_min());
+  for (Instant t = t_min; t <= trajectory_->t_max(); t += step / 3) {
+    EXPECT_THAT(trajectory_->EvaluatePosition(t, &hint),
+                AlmostEquals(position_function(t), 0, 1e6));
+  }
+}
+
+// Check that the series are found correctly when evaluating at random times,
+// both when the series have uniform durations and when they don't.
+TEST_F(ContinuousTrajectoryTest, RandomAccess) {
+  int const number_of_steps = 100;
+  Time const step1 = 0.01 * Second;
+  Time const step2 = 0.03 * Second;
+
+  auto position_function =
+      [this](Instant const t) {
+        return World::origin +
+            Displacement<World>(
+                {(t - t0_) * 3 * Metre / Second,
+                 (t - t0_) * (t - t0_) * 5 * Metre / (Second * Second),
+                 (t - t0_) * (-2) * Metre / Second});
+      };
+  auto velocity_function =
+      [this](Instant const t) {
+        return Velocity<World>({3 * Metre / Second,
+                                (t - t0_) * 10 * Metre / (Second * Second),
+                                -2 * Metre / Second});
+      };
+
+  trajectory_ = std::make_unique<ContinuousTrajectory<World>>(
+                    step1,
+                    /*tolerance=*/0.1 * Metre);
+  FillTrajectory(
+      number_of_steps, step1, position_function, velocity_function, t0_);
+  Instant const t_max1 = trajectory_->t_max();
+
+  // A trajectory with longer series that starts where the first one ends.
+  ContinuousTrajectory<World> trajectory2(step2, /*tolerance=*/0.1 * Metre);
+  for (int i = 0; i < number_of_steps; ++i) {
+    Instant const ti = t_max1 + i * step2;
+    trajectory2.Append(ti,
+                       DegreesOfFreedom<World>(position_function(ti),
+                                               velocity_function(ti)));
+  }
+  Instant const t_max2 = trajectory2.t_max();
+
+  // Concatenate the series to get a trajectory with irregular series.
+  serialization::ContinuousTrajectory message1;
+  trajectory_->WriteToMessage(&message1);
+  serialization::ContinuousTrajectory message2;
+  trajectory2.WriteToMessage(&message2);
+  message1.mutable_series()->MergeFrom(message2.series());
+  auto const irregular_trajectory =
+      ContinuousTrajectory<World>::ReadFromMessage(message1);
+  EXPECT_EQ(trajectory_->t_min(), irregular_trajectory->t_min());
+  EXPECT_EQ(t_max2, irregular_trajectory->t_max());
+
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<> fraction(0.0, 1.0);
+  std::vector<Instant> times = {trajectory_->t_min(), t_max1, t_max2};
+  for (int i = 0; i < 1000; ++i) {
+    times.push_back(trajectory_->t_min() +
+                    fraction(random) * (t_max2 - trajectory_->t_min()));
+  }
+  // The boundaries between series, which must go to the earlier series.
+  for (int i = 1; i < number_of_steps / 8; ++i) {
+    times.push_back(t0_ + (8 * i + 1) * step1);
+  }
+
+  for (Instant const& time : times) {
+    if (time <= t_max1) {
+      EXPECT_EQ(trajectory_->EvaluateDegreesOfFreedom(time, /*hint=*/nullptr),
+                irregular_trajectory->EvaluateDegreesOfFreedom(
+                    time, /*hint=*/nullptr)) << time;
+    } else if (time <= t_max2) {
+      EXPECT_EQ(trajectory2.EvaluateDegreesOfFreedom(time, /*hint=*/nullptr),
+                irregular_trajectory->EvaluateDegreesOfFreedom(
+                    time, /*hint=*/nullptr)) << time;
+    }
+  }
+}
+
+TEST_F(ContinuousTrajectoryTest, EvaluateDegreesOfFreedomAtTimes) {
+  int const number_of_steps = 100;
+  int const number_of_substeps = 7;
+  Time const step = 0.01 * Second;
+
+  auto position_function =
+      [this](Instant const t) {
+        return World::origin +
+            Displacement<World>(
+                {(t - t0_) * 3 * Metre / Second,
+                 (t - t0_) * (t - t0_) * 5 * Metre / (Second * Second),
+                 (t - t0_) * (-2) * Metre / Second});
+      };
+  auto velocity_function =
+      [this](Instant const t) {
+        return Velocity<World>({3 * Metre / Second,
+                                (t - t0_) * 10 * Metre / (Second * Second),
+                                -2 * Metre / Second});
+      };
+
+  trajectory_ = std::make_unique<ContinuousTrajectory<World>>(
+                    step,
+                    /*tolerance=*/0.1 * Metre);
+  FillTrajectory(
+      number_of_steps, step, position_function, velocity_function, t0_);
+
+  std::vector<Instant> times;
+  for (Instant time = trajectory_->t_min();
+       time <= trajectory_->t_max();
+       time += step / number_of_substeps) {
+    times.push_back(time);
+  }
+  times.push_back(trajectory_->t_max());
+
+  std::vector<DegreesOfFreedom<World>> degrees_of_freedom;
+  trajectory_->EvaluateDegreesOfFreedomAtTimes(times, &degrees_of_freedom);
+  ASSERT_EQ(times.size(), degrees_of_freedom.size());
+  for (int i = 0; i < times.size(); ++i) {
+    DegreesOfFreedom<World> const expected_degrees_of_freedom =
+        trajectory_->EvaluateDegreesOfFreedom(times[i], /*hint=*/nullptr);
+    EXPECT_EQ(expected_degrees_of_freedom.position(),
+              degrees_of_freedom[i].position());
+    EXPECT_THAT(degrees_of_freedom[i].velocity(),
+                AlmostEquals(expected_degrees_of_freedom.velocity(), 0, 4));
+  }
+}
+
 TEST_F(ContinuousTrajectoryTest, Checkpoint) {
   int const number_of_steps1 = 30;
   int const number_of_steps2 = 20;
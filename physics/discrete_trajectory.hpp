@@ -1,9 +1,9 @@
 ﻿
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <list>
-#include <map>
 #include <memory>
 #include <vector>
 
@@ -12,6 +12,7 @@
 #include "geometry/named_quantities.hpp"
 #include "physics/degrees_of_freedom.hpp"
 #include "physics/forkable.hpp"
+#include "physics/timeline.hpp"
 #include "quantities/named_quantities.hpp"
 #include "serialization/physics.pb.h"
 
@@ -30,6 +31,14 @@ using quantities::Speed;
 template<typename Frame>
 class DiscreteTrajectory;
 
+// The accelerations at the beginning and at the end of the integration step
+// that ended at a point of a |DiscreteTrajectory|.
+template<typename Frame>
+struct StepAccelerations {
+  Vector<Acceleration, Frame> previous_acceleration;
+  Vector<Acceleration, Frame> acceleration;
+};
+
 }  // namespace internal_discrete_trajectory
 
 // Reopening |internal_forkable| to specialize a template.
@@ -39,8 +48,8 @@ using internal_discrete_trajectory::DiscreteTrajectory;
 
 template<typename Frame>
 struct ForkableTraits<DiscreteTrajectory<Frame>> {
-  using TimelineConstIterator =
-      typename std::map<Instant, DegreesOfFreedom<Frame>>::const_iterator;
+  using TimelineConstIterator = typename internal_timeline::Timeline<
+      DegreesOfFreedom<Frame>>::const_iterator;
   static Instant const& time(TimelineConstIterator const it);
 };
 
@@ -55,6 +64,9 @@ class DiscreteTrajectoryIterator
  protected:
   not_null<DiscreteTrajectoryIterator*> that() override;
   not_null<DiscreteTrajectoryIterator const*> that() const override;
+
+ private:
+  friend class DiscreteTrajectory<Frame>;
 };
 
 }  // namespace internal_forkable
@@ -63,10 +75,30 @@ namespace internal_discrete_trajectory {
 
 using internal_forkable::DiscreteTrajectoryIterator;
 
+// Compresses a sequence of doubles for serialization: each value is
+// represented by the XOR of its bits with the bits of the linear extrapolation
+// of the two previous values.  For a smooth sequence the high-order bits of the
+// result are zero, so it is short as a varint.  The compression is lossless
+// provided that the values are decompressed in the order in which they were
+// compressed.
+class DoubleXorCompressor {
+ public:
+  std::uint64_t Compress(double value);
+  double Decompress(std::uint64_t bits);
+
+ private:
+  std::uint64_t PredictionBits() const;
+  void Record(double value);
+
+  double previous_ = 0;
+  double before_previous_ = 0;
+  std::int64_t count_ = 0;
+};
+
 template <typename Frame>
 class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
                                            DiscreteTrajectoryIterator<Frame>> {
-  using Timeline = std::map<Instant, DegreesOfFreedom<Frame>>;
+  using Timeline = internal_timeline::Timeline<DegreesOfFreedom<Frame>>;
   using TimelineConstIterator = typename Forkable<
       DiscreteTrajectory<Frame>,
       DiscreteTrajectoryIterator<Frame>>::TimelineConstIterator;
@@ -118,6 +150,36 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
   void Append(Instant const& time,
               DegreesOfFreedom<Frame> const& degrees_of_freedom);
 
+  // Same as above, for a point computed by an integration step that started at
+  // the last point of the trajectory.  |previous_acceleration| and
+  // |acceleration| are the accelerations at the beginning and at the end of
+  // the step; they are used by |EvaluateDegreesOfFreedom|.
+  void Append(Instant const& time,
+              DegreesOfFreedom<Frame> const& degrees_of_freedom,
+              Vector<Acceleration, Frame> const& previous_acceleration,
+              Vector<Acceleration, Frame> const& acceleration);
+
+  // Appends the point denoted by |it|, an iterator into another trajectory,
+  // with the accelerations of its step if it has them.  The step that ended at
+  // |it| must have started at (a close approximation of) the last point of this
+  // trajectory, e.g., because the two trajectories agree up to that point.
+  void Append(Iterator const& it);
+
+  // Returns the degrees of freedom at |time|, which must be within the time
+  // range of this trajectory, including its ancestors.  Complexity is
+  // O(|depth| + Log(|length|)).
+  DegreesOfFreedom<Frame> EvaluateDegreesOfFreedom(Instant const& time) const;
+
+  // Returns the degrees of freedom at |time|, interpolated between the
+  // consecutive points |lower| and |upper|.  |time| must be between their
+  // times.  The interpolation is a quintic Hermite polynomial if |upper| was
+  // appended with the accelerations of its step, and a cubic one otherwise
+  // (e.g., for the points of fixed-step trajectories).
+  static DegreesOfFreedom<Frame> InterpolateDegreesOfFreedom(
+      Iterator const& lower,
+      Iterator const& upper,
+      Instant const& time);
+
   // Removes all data for times (strictly) greater than |time|, as well as all
   // child trajectories forked at times (strictly) greater than |time|.  |time|
   // must be at or after the fork time, if any.
@@ -157,6 +219,14 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
   bool timeline_empty() const override;
 
  private:
+  using StepAccelerationsTimeline =
+      internal_timeline::Timeline<StepAccelerations<Frame>>;
+
+  // Returns the accelerations of the step that ended at |it|, or null if |it|
+  // was not appended with accelerations.
+  static StepAccelerations<Frame> const* step_accelerations(
+      Iterator const& it);
+
   // This trajectory need not be a root.
   void WriteSubTreeToMessage(
       not_null<serialization::DiscreteTrajectory*> const message,
@@ -166,7 +236,18 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
       serialization::DiscreteTrajectory const& message,
       std::vector<DiscreteTrajectory<Frame>**> const& forks);
 
+  // The serialization of |timeline_| in the packed format.
+  void WritePackedTimelineToMessage(
+      not_null<serialization::DiscreteTrajectory::PackedTimeline*> const
+          message) const;
+  void FillTimelineFromPackedMessage(
+      serialization::DiscreteTrajectory::PackedTimeline const& message);
+
   Timeline timeline_;
+  // The accelerations of the points of |timeline_| that were appended with
+  // them.  This is only populated for trajectories integrated with an adaptive
+  // step, so that the other ones don't pay for it.
+  StepAccelerationsTimeline step_accelerations_;
 
   template<typename, typename>
   friend class internal_forkable::ForkableIterator;
@@ -4,12 +4,17 @@
 #include "physics/discrete_trajectory.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
 #include <list>
-#include <map>
 #include <vector>
 
 #include "geometry/named_quantities.hpp"
 #include "glog/logging.h"
+#include "numerics/hermite3.hpp"
+#include "numerics/hermite5.hpp"
+#include "quantities/si.hpp"
 
 namespace principia {
 namespace physics {
@@ -51,7 +56,50 @@ DiscreteTrajectoryIterator<Frame>::that() const {
 namespace internal_discrete_trajectory {
 
 using base::make_not_null_unique;
+using geometry::Displacement;
 using geometry::Instant;
+using geometry::Position;
+using numerics::Hermite3;
+using numerics::Hermite5;
+using quantities::Pow;
+using quantities::si::Metre;
+using quantities::si::Second;
+
+inline std::uint64_t DoubleXorCompressor::Compress(double const value) {
+  std::uint64_t value_bits;
+  std::memcpy(&value_bits, &value, sizeof(value));
+  std::uint64_t const bits = value_bits ^ PredictionBits();
+  Record(value);
+  return bits;
+}
+
+inline double DoubleXorCompressor::Decompress(std::uint64_t const bits) {
+  std::uint64_t const value_bits = bits ^ PredictionBits();
+  double value;
+  std::memcpy(&value, &value_bits, sizeof(value));
+  Record(value);
+  return value;
+}
+
+inline std::uint64_t DoubleXorCompressor::PredictionBits() const {
+  double prediction;
+  if (count_ == 0) {
+    prediction = 0;
+  } else if (count_ == 1) {
+    prediction = previous_;
+  } else {
+    prediction = 2 * previous_ - before_previous_;
+  }
+  std::uint64_t prediction_bits;
+  std::memcpy(&prediction_bits, &prediction, sizeof(prediction));
+  return prediction_bits;
+}
+
+inline void DoubleXorCompressor::Record(double const value) {
+  before_previous_ = previous_;
+  previous_ = value;
+  ++count_;
+}
 
 template<typename Frame>
 typename DiscreteTrajectory<Frame>::Iterator
@@ -70,9 +118,12 @@ DiscreteTrajectory<Frame>::NewForkWithCopy(Instant const& time) {
 
   auto const fork = this->NewFork(timeline_it);
 
-  // Copy the tail of the trajectory in the child object.
+  // Copy the tail of the trajectory in the child object.  The points are
+  // shared until either trajectory changes.
   if (timeline_it != timeline_.end()) {
-    fork->timeline_.insert(++timeline_it, timeline_.end());
+    fork->timeline_.assign_shared(std::next(timeline_it), timeline_.end());
+    fork->step_accelerations_.assign_shared(
+        step_accelerations_.upper_bound(time), step_accelerations_.end());
   }
   return fork;
 }
@@ -106,17 +157,26 @@ void DiscreteTrajectory<Frame>::AttachFork(
   CHECK(fork->is_root());
   CHECK(!fork->timeline_.empty());
 
-  // Append to this trajectory a copy of the first point of |fork|.
+  // Append to this trajectory a copy of the first point of |fork|.  Its
+  // accelerations, if any, are dropped since they don't pertain to a step
+  // starting at the last point of this trajectory.
   auto& fork_timeline = fork->timeline_;
   auto fork_begin = fork_timeline.begin();
   Append(fork_begin->first, fork_begin->second);
+  auto& fork_step_accelerations = fork->step_accelerations_;
+  auto const fork_step_accelerations_begin =
+      fork_step_accelerations.find(fork_begin->first);
 
   // Attach |fork| to this trajectory.
   this->AttachForkToCopiedBegin(std::move(fork));
 
   // Remove the first point of |fork| now that it properly attached to its
   // parent.
-  fork_timeline.erase(fork_begin);
+  fork_timeline.erase(fork_begin, std::next(fork_begin));
+  if (fork_step_accelerations_begin != fork_step_accelerations.end()) {
+    fork_step_accelerations.erase(fork_step_accelerations_begin,
+                                  std::next(fork_step_accelerations_begin));
+  }
 }
 
 template<typename Frame>
@@ -127,14 +187,101 @@ DiscreteTrajectory<Frame>::DetachFork() {
   // Insert a new point in the timeline for the fork time.  It should go at the
   // beginning of the timeline.
   auto const fork_it = this->Fork();
-  auto const begin_it = timeline_.emplace_hint(
-      timeline_.begin(), fork_it.time(), fork_it.degrees_of_freedom());
-  CHECK(begin_it == timeline_.begin());
+  timeline_.push_front(fork_it.time(), fork_it.degrees_of_freedom());
 
   // Detach this trajectory and tell the caller that it owns the pieces.
   return this->DetachForkWithCopiedBegin();
 }
 
+template<typename Frame>
+void DiscreteTrajectory<Frame>::Append(
+    Instant const& time,
+    DegreesOfFreedom<Frame> const& degrees_of_freedom,
+    Vector<Acceleration, Frame> const& previous_acceleration,
+    Vector<Acceleration, Frame> const& acceleration) {
+  auto const size = timeline_.size();
+  Append(time, degrees_of_freedom);
+  // Only record the accelerations if the point was actually appended.
+  if (timeline_.size() > size) {
+    step_accelerations_.push_back(time, {previous_acceleration, acceleration});
+  }
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::Append(Iterator const& it) {
+  StepAccelerations<Frame> const* const it_step_accelerations =
+      step_accelerations(it);
+  if (it_step_accelerations == nullptr) {
+    Append(it.time(), it.degrees_of_freedom());
+  } else {
+    Append(it.time(),
+           it.degrees_of_freedom(),
+           it_step_accelerations->previous_acceleration,
+           it_step_accelerations->acceleration);
+  }
+}
+
+template<typename Frame>
+DegreesOfFreedom<Frame> DiscreteTrajectory<Frame>::EvaluateDegreesOfFreedom(
+    Instant const& time) const {
+  auto const upper = this->LowerBound(time);
+  CHECK(upper != this->End()) << "Evaluation after the end at " << time;
+  if (upper.time() == time) {
+    return upper.degrees_of_freedom();
+  }
+  CHECK(upper != this->Begin()) << "Evaluation before the beginning at "
+                                << time;
+  auto lower = upper;
+  --lower;
+  return InterpolateDegreesOfFreedom(lower, upper, time);
+}
+
+template<typename Frame>
+DegreesOfFreedom<Frame> DiscreteTrajectory<Frame>::InterpolateDegreesOfFreedom(
+    Iterator const& lower,
+    Iterator const& upper,
+    Instant const& time) {
+  CHECK_LE(lower.time(), time);
+  CHECK_LE(time, upper.time());
+  if (time == lower.time()) {
+    return lower.degrees_of_freedom();
+  }
+  if (time == upper.time()) {
+    return upper.degrees_of_freedom();
+  }
+  DegreesOfFreedom<Frame> const& lower_degrees_of_freedom =
+      lower.degrees_of_freedom();
+  DegreesOfFreedom<Frame> const& upper_degrees_of_freedom =
+      upper.degrees_of_freedom();
+  // The accelerations of |upper| pertain to the step from |lower|, since points
+  // are only ever appended at the end of a trajectory.
+  StepAccelerations<Frame> const* const upper_step_accelerations =
+      step_accelerations(upper);
+  if (upper_step_accelerations != nullptr) {
+    Hermite5<Instant, Position<Frame>> const position_approximation(
+        {lower.time(), upper.time()},
+        {lower_degrees_of_freedom.position(),
+         upper_degrees_of_freedom.position()},
+        {lower_degrees_of_freedom.velocity(),
+         upper_degrees_of_freedom.velocity()},
+        {upper_step_accelerations->previous_acceleration,
+         upper_step_accelerations->acceleration});
+    return DegreesOfFreedom<Frame>(
+        position_approximation.Evaluate(time),
+        position_approximation.EvaluateDerivative(time));
+  } else {
+    Hermite3<Instant, Position<Frame>> const position_approximation(
+        {lower.time(), upper.time()},
+        {lower_degrees_of_freedom.position(),
+         upper_degrees_of_freedom.position()},
+        {lower_degrees_of_freedom.velocity(),
+         upper_degrees_of_freedom.velocity()});
+    return DegreesOfFreedom<Frame>(
+        position_approximation.Evaluate(time),
+        position_approximation.EvaluateDerivative(time));
+  }
+}
+
 template<typename Frame>
 void DiscreteTrajectory<Frame>::Append(
     Instant const& time,
@@ -143,17 +290,21 @@ void DiscreteTrajectory<Frame>::Append(
        << "Append at " << time << " which is before fork time "
        << this->Fork().time();
 
-  if (!timeline_.empty() && timeline_.cbegin()->first == time) {
+  if (!timeline_.empty() && timeline_.begin()->first == time) {
     LOG(WARNING) << "Append at existing time " << time
                  << ", time range = [" << this->Begin().time() << ", "
                  << last().time() << "]";
     return;
   }
-  auto it = timeline_.emplace_hint(timeline_.end(),
-                                   time,
-                                   degrees_of_freedom);
-  // Decrementing |end()| is much faster than incrementing |it|.  Don't ask.
-  CHECK(--timeline_.end() == it) << "Append out of order at " << time;
+  if (!timeline_.empty()) {
+    Instant const& last_time = std::prev(timeline_.end())->first;
+    if (last_time == time) {
+      // Appending the last point again is a no-op.
+      return;
+    }
+    CHECK_LT(last_time, time) << "Append out of order at " << time;
+  }
+  timeline_.push_back(time, degrees_of_freedom);
 }
 
 template<typename Frame>
@@ -165,6 +316,8 @@ void DiscreteTrajectory<Frame>::ForgetAfter(Instant const& time) {
   // time == |time|.
   auto const it = timeline_.upper_bound(time);
   timeline_.erase(it, timeline_.end());
+  step_accelerations_.erase(step_accelerations_.upper_bound(time),
+                            step_accelerations_.end());
 }
 
 template<typename Frame>
@@ -175,6 +328,8 @@ void DiscreteTrajectory<Frame>::ForgetBefore(Instant const& time) {
   // the entries that precede it.  This preserves any entry with time == |time|.
   auto it = timeline_.lower_bound(time);
   timeline_.erase(timeline_.begin(), it);
+  step_accelerations_.erase(step_accelerations_.begin(),
+                            step_accelerations_.lower_bound(time));
 }
 
 template<typename Frame>
@@ -253,36 +408,190 @@ bool DiscreteTrajectory<Frame>::timeline_empty() const {
   return timeline_.empty();
 }
 
+template<typename Frame>
+StepAccelerations<Frame> const* DiscreteTrajectory<Frame>::step_accelerations(
+    Iterator const& it) {
+  // The point denoted by |it| may belong to an ancestor of the trajectory
+  // being iterated, in which case its accelerations are in that ancestor.
+  auto const& step_accelerations =
+      it.current_trajectory()->step_accelerations_;
+  auto const step_accelerations_it = step_accelerations.find(it.time());
+  if (step_accelerations_it == step_accelerations.end()) {
+    return nullptr;
+  } else {
+    return &step_accelerations_it->second;
+  }
+}
+
 template<typename Frame>
 void DiscreteTrajectory<Frame>::WriteSubTreeToMessage(
     not_null<serialization::DiscreteTrajectory*> const message,
     std::vector<DiscreteTrajectory<Frame>*>& forks) const {
   Forkable<DiscreteTrajectory, Iterator>::WriteSubTreeToMessage(message, forks);
-  for (auto const& pair : timeline_) {
-    Instant const& instant = pair.first;
-    DegreesOfFreedom<Frame> const& degrees_of_freedom = pair.second;
-    auto const instantaneous_degrees_of_freedom = message->add_timeline();
-    instant.WriteToMessage(instantaneous_degrees_of_freedom->mutable_instant());
-    degrees_of_freedom.WriteToMessage(
-        instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
-  }
+  WritePackedTimelineToMessage(message->mutable_packed_timeline());
 }
 
 template<typename Frame>
 void DiscreteTrajectory<Frame>::FillSubTreeFromMessage(
     serialization::DiscreteTrajectory const& message,
     std::vector<DiscreteTrajectory<Frame>**> const& forks) {
-  for (auto timeline_it = message.timeline().begin();
-       timeline_it != message.timeline().end();
-       ++timeline_it) {
-    Append(Instant::ReadFromMessage(timeline_it->instant()),
-           DegreesOfFreedom<Frame>::ReadFromMessage(
-               timeline_it->degrees_of_freedom()));
+  if (message.has_packed_timeline()) {
+    FillTimelineFromPackedMessage(message.packed_timeline());
+  } else {
+    for (auto timeline_it = message.timeline().begin();
+         timeline_it != message.timeline().end();
+         ++timeline_it) {
+      Append(Instant::ReadFromMessage(timeline_it->instant()),
+             DegreesOfFreedom<Frame>::ReadFromMessage(
+                 timeline_it->degrees_of_freedom()));
+    }
   }
   Forkable<DiscreteTrajectory, Iterator>::FillSubTreeFromMessage(message,
                                                                  forks);
 }
 
+template<typename Frame>
+void DiscreteTrajectory<Frame>::WritePackedTimelineToMessage(
+    not_null<serialization::DiscreteTrajectory::PackedTimeline*> const
+        message) const {
+  Frame::WriteToMessage(message->mutable_frame());
+  if (timeline_.empty()) {
+    return;
+  }
+
+  // The times are implicit if they are exactly equally spaced, which is the
+  // case of trajectories integrated with a fixed step.
+  double const first_time = (timeline_.begin()->first - Instant()) / Second;
+  double const time_step =
+      timeline_.size() == 1
+          ? 0
+          : (std::next(timeline_.begin())->first - Instant()) / Second -
+                first_time;
+  std::int64_t i = 0;
+  bool is_fixed_step = true;
+  for (auto const& pair : timeline_) {
+    if ((pair.first - Instant()) / Second != first_time + i * time_step) {
+      is_fixed_step = false;
+      break;
+    }
+    ++i;
+  }
+
+  DoubleXorCompressor time_compressor;
+  if (is_fixed_step) {
+    message->set_first_time(first_time);
+    message->set_time_step(time_step);
+  } else {
+    message->mutable_time()->Reserve(timeline_.size());
+  }
+  std::array<DoubleXorCompressor, 6> compressors;
+  message->mutable_degrees_of_freedom()->Reserve(6 * timeline_.size());
+  for (auto const& pair : timeline_) {
+    Instant const& time = pair.first;
+    DegreesOfFreedom<Frame> const& degrees_of_freedom = pair.second;
+    if (!is_fixed_step) {
+      message->add_time(time_compressor.Compress((time - Instant()) / Second));
+    }
+    auto const q =
+        (degrees_of_freedom.position() - Frame::origin).coordinates();
+    auto const v = degrees_of_freedom.velocity().coordinates();
+    std::array<double, 6> const values = {{q.x / Metre,
+                                           q.y / Metre,
+                                           q.z / Metre,
+                                           v.x / (Metre / Second),
+                                           v.y / (Metre / Second),
+                                           v.z / (Metre / Second)}};
+    for (int j = 0; j < values.size(); ++j) {
+      message->add_degrees_of_freedom(compressors[j].Compress(values[j]));
+    }
+  }
+
+  DoubleXorCompressor step_accelerations_time_compressor;
+  std::array<DoubleXorCompressor, 6> step_accelerations_compressors;
+  message->mutable_step_accelerations_time()->Reserve(
+      step_accelerations_.size());
+  message->mutable_step_accelerations()->Reserve(
+      6 * step_accelerations_.size());
+  for (auto const& pair : step_accelerations_) {
+    Instant const& time = pair.first;
+    StepAccelerations<Frame> const& step_accelerations = pair.second;
+    message->add_step_accelerations_time(
+        step_accelerations_time_compressor.Compress(
+            (time - Instant()) / Second));
+    auto const a0 = step_accelerations.previous_acceleration.coordinates();
+    auto const a1 = step_accelerations.acceleration.coordinates();
+    std::array<double, 6> const values = {{a0.x / (Metre / Pow<2>(Second)),
+                                           a0.y / (Metre / Pow<2>(Second)),
+                                           a0.z / (Metre / Pow<2>(Second)),
+                                           a1.x / (Metre / Pow<2>(Second)),
+                                           a1.y / (Metre / Pow<2>(Second)),
+                                           a1.z / (Metre / Pow<2>(Second))}};
+    for (int j = 0; j < values.size(); ++j) {
+      message->add_step_accelerations(
+          step_accelerations_compressors[j].Compress(values[j]));
+    }
+  }
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::FillTimelineFromPackedMessage(
+    serialization::DiscreteTrajectory::PackedTimeline const& message) {
+  Frame::ReadFromMessage(message.frame());
+  CHECK_EQ(0, message.degrees_of_freedom_size() % 6);
+  std::int64_t const size = message.degrees_of_freedom_size() / 6;
+  bool const is_fixed_step = message.has_first_time();
+  CHECK(is_fixed_step || message.time_size() == size);
+
+  DoubleXorCompressor time_compressor;
+  std::array<DoubleXorCompressor, 6> compressors;
+  std::array<double, 6> values;
+  for (std::int64_t i = 0; i < size; ++i) {
+    double const time =
+        is_fixed_step
+            ? message.first_time() + i * message.time_step()
+            : time_compressor.Decompress(message.time(i));
+    for (int j = 0; j < values.size(); ++j) {
+      values[j] =
+          compressors[j].Decompress(message.degrees_of_freedom(6 * i + j));
+    }
+    Append(Instant() + time * Second,
+           DegreesOfFreedom<Frame>(
+               Frame::origin + Displacement<Frame>({values[0] * Metre,
+                                                    values[1] * Metre,
+                                                    values[2] * Metre}),
+               Velocity<Frame>({values[3] * (Metre / Second),
+                                values[4] * (Metre / Second),
+                                values[5] * (Metre / Second)})));
+  }
+
+  // The accelerations are absent from older saves, in which case the
+  // trajectory is interpolated with cubic polynomials.
+  std::int64_t const step_accelerations_size =
+      message.step_accelerations_time_size();
+  CHECK_EQ(6 * step_accelerations_size, message.step_accelerations_size());
+  DoubleXorCompressor step_accelerations_time_compressor;
+  std::array<DoubleXorCompressor, 6> step_accelerations_compressors;
+  for (std::int64_t i = 0; i < step_accelerations_size; ++i) {
+    Instant const time =
+        Instant() + step_accelerations_time_compressor.Decompress(
+                        message.step_accelerations_time(i)) * Second;
+    CHECK(timeline_.find(time) != timeline_.end())
+        << "No point for the accelerations at " << time;
+    for (int j = 0; j < values.size(); ++j) {
+      values[j] = step_accelerations_compressors[j].Decompress(
+          message.step_accelerations(6 * i + j));
+    }
+    step_accelerations_.push_back(
+        time,
+        {Vector<Acceleration, Frame>({values[0] * (Metre / Pow<2>(Second)),
+                                      values[1] * (Metre / Pow<2>(Second)),
+                                      values[2] * (Metre / Pow<2>(Second))}),
+         Vector<Acceleration, Frame>({values[3] * (Metre / Pow<2>(Second)),
+                                      values[4] * (Metre / Pow<2>(Second)),
+                                      values[5] * (Metre / Pow<2>(Second))})});
+  }
+}
+
 }  // namespace internal_discrete_trajectory
 }  // namespace physics
 }  // namespace principia
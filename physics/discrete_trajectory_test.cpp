@@ -1,7 +1,9 @@
 ﻿
 #include "physics/discrete_trajectory.hpp"
 
+#include <cmath>
 #include <functional>
+#include <limits>
 #include <list>
 #include <map>
 #include <string>
@@ -16,6 +18,7 @@
 #include "gtest/gtest.h"
 #include "quantities/quantities.hpp"
 #include "quantities/si.hpp"
+#include "testing_utilities/numerics.hpp"
 
 namespace principia {
 namespace physics {
@@ -28,16 +31,22 @@ using geometry::Point;
 using geometry::Position;
 using geometry::R3Element;
 using geometry::Vector;
+using quantities::Acceleration;
 using quantities::Length;
 using quantities::Speed;
 using quantities::SIUnit;
+using quantities::Time;
 using quantities::si::Metre;
 using quantities::si::Second;
+using testing_utilities::AbsoluteError;
 using ::std::placeholders::_1;
 using ::std::placeholders::_2;
 using ::std::placeholders::_3;
+using ::testing::AllOf;
 using ::testing::ElementsAre;
 using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::Lt;
 using ::testing::Pair;
 using ::testing::Ref;
 
@@ -104,6 +113,21 @@ class DiscreteTrajectoryTest : public testing::Test {
     return result;
   }
 
+  // Returns the points of the timeline of |message|, ignoring its children.
+  std::map<Instant, DegreesOfFreedom<World>> Timeline(
+      serialization::DiscreteTrajectory const& message) const {
+    serialization::DiscreteTrajectory root_message = message;
+    root_message.clear_children();
+    root_message.clear_fork_position();
+    auto const trajectory =
+        DiscreteTrajectory<World>::ReadFromMessage(root_message, /*forks=*/{});
+    std::map<Instant, DegreesOfFreedom<World>> result;
+    for (auto it = trajectory->Begin(); it != trajectory->End(); ++it) {
+      result.emplace_hint(result.end(), it.time(), it.degrees_of_freedom());
+    }
+    return result;
+  }
+
   std::list<Instant> Times(DiscreteTrajectory<World> const& trajectory) const {
     std::list<Instant> result;
     for (auto it = trajectory.Begin(); it != trajectory.End(); ++it) {
@@ -679,55 +703,82 @@ TEST_F(DiscreteTrajectoryTest, TrajectorySerializationSuccess) {
                                            deserialized_fork2});
   EXPECT_EQ(reference_message.SerializeAsString(), message.SerializeAsString());
   EXPECT_THAT(message.children_size(), Eq(2));
-  EXPECT_THAT(message.timeline_size(), Eq(3));
-  EXPECT_THAT(Instant::ReadFromMessage(message.timeline(0).instant()), Eq(t1_));
-  EXPECT_THAT(Instant::ReadFromMessage(message.timeline(1).instant()), Eq(t2_));
-  EXPECT_THAT(Instant::ReadFromMessage(message.timeline(2).instant()), Eq(t3_));
-  EXPECT_THAT(
-      DegreesOfFreedom<World>::ReadFromMessage(
-          message.timeline(0).degrees_of_freedom()), Eq(d1_));
-  EXPECT_THAT(
-        DegreesOfFreedom<World>::ReadFromMessage(
-            message.timeline(1).degrees_of_freedom()), Eq(d2_));
-  EXPECT_THAT(
-        DegreesOfFreedom<World>::ReadFromMessage(
-            message.timeline(2).degrees_of_freedom()), Eq(d3_));
+  EXPECT_TRUE(message.packed_timeline().has_first_time());
+  EXPECT_THAT(message.packed_timeline().time_size(), Eq(0));
+  EXPECT_THAT(message.packed_timeline().degrees_of_freedom_size(), Eq(18));
+  EXPECT_THAT(Timeline(message),
+              ElementsAre(Pair(t1_, d1_), Pair(t2_, d2_), Pair(t3_, d3_)));
   EXPECT_THAT(message.children(0).trajectories_size(), Eq(2));
   EXPECT_THAT(message.children(0).trajectories(0).children_size(), Eq(0));
-  EXPECT_THAT(message.children(0).trajectories(0).timeline_size(), Eq(1));
-  EXPECT_THAT(
-      Instant::ReadFromMessage(
-          message.children(0).trajectories(0).timeline(0).instant()), Eq(t3_));
-  EXPECT_THAT(
-      DegreesOfFreedom<World>::ReadFromMessage(
-          message.children(0).trajectories(0).timeline(0).degrees_of_freedom()),
-      Eq(d3_));
+  EXPECT_THAT(Timeline(message.children(0).trajectories(0)),
+              ElementsAre(Pair(t3_, d3_)));
   EXPECT_THAT(message.children(0).trajectories(1).children_size(), Eq(0));
-  EXPECT_THAT(message.children(0).trajectories(1).timeline_size(), Eq(2));
-  EXPECT_THAT(
-      Instant::ReadFromMessage(
-          message.children(0).trajectories(1).timeline(0).instant()), Eq(t3_));
-  EXPECT_THAT(
-      DegreesOfFreedom<World>::ReadFromMessage(
-          message.children(0).trajectories(1).timeline(0).degrees_of_freedom()),
-      Eq(d3_));
-  EXPECT_THAT(
-      Instant::ReadFromMessage(
-          message.children(0).trajectories(1).timeline(1).instant()), Eq(t4_));
-  EXPECT_THAT(
-      DegreesOfFreedom<World>::ReadFromMessage(
-          message.children(0).trajectories(1).timeline(1).degrees_of_freedom()),
-      Eq(d4_));
+  EXPECT_THAT(Timeline(message.children(0).trajectories(1)),
+              ElementsAre(Pair(t3_, d3_), Pair(t4_, d4_)));
   EXPECT_THAT(message.children(1).trajectories_size(), Eq(1));
   EXPECT_THAT(message.children(1).trajectories(0).children_size(), Eq(0));
-  EXPECT_THAT(message.children(1).trajectories(0).timeline_size(), Eq(1));
-  EXPECT_THAT(
-      Instant::ReadFromMessage(
-          message.children(1).trajectories(0).timeline(0).instant()), Eq(t4_));
+  EXPECT_THAT(Timeline(message.children(1).trajectories(0)),
+              ElementsAre(Pair(t4_, d4_)));
+}
+
+TEST_F(DiscreteTrajectoryTest, PackedSerialization) {
+  // A trajectory with a fixed step and awkward values, which must round-trip
+  // exactly.
+  Instant const t0 = t0_ + 1 * Second;
+  Time const step = 0.25 * Second;
+  for (int i = 0; i < 100; ++i) {
+    double const x = std::sin(i * 0.1);
+    massive_trajectory_->Append(
+        t0 + i * step,
+        DegreesOfFreedom<World>(
+            World::origin +
+                Displacement<World>(
+                    {1e11 * x * Metre, -3e10 * x * x * Metre, 0 * Metre}),
+            Velocity<World>({x * Metre / Second,
+                             -std::numeric_limits<double>::denorm_min() *
+                                 Metre / Second,
+                             std::numeric_limits<double>::infinity() *
+                                 Metre / Second})));
+  }
+  serialization::DiscreteTrajectory message;
+  massive_trajectory_->WriteToMessage(&message, /*forks=*/{});
+  EXPECT_TRUE(message.packed_timeline().has_first_time());
+  EXPECT_THAT(message.packed_timeline().time_size(), Eq(0));
+  EXPECT_THAT(message.timeline_size(), Eq(0));
+  auto const deserialized_trajectory =
+      DiscreteTrajectory<World>::ReadFromMessage(message, /*forks=*/{});
+  EXPECT_THAT(Positions(*deserialized_trajectory),
+              Eq(Positions(*massive_trajectory_)));
+  EXPECT_THAT(Velocities(*deserialized_trajectory),
+              Eq(Velocities(*massive_trajectory_)));
+  EXPECT_THAT(Times(*deserialized_trajectory),
+              Eq(Times(*massive_trajectory_)));
+
+  // Breaking the fixed step makes the times explicit.
+  massive_trajectory_->Append(t0 + 100.5 * step, d1_);
+  message.Clear();
+  massive_trajectory_->WriteToMessage(&message, /*forks=*/{});
+  EXPECT_FALSE(message.packed_timeline().has_first_time());
+  EXPECT_THAT(message.packed_timeline().time_size(), Eq(101));
   EXPECT_THAT(
-      DegreesOfFreedom<World>::ReadFromMessage(
-          message.children(1).trajectories(0).timeline(0).degrees_of_freedom()),
-      Eq(d4_));
+      Times(*DiscreteTrajectory<World>::ReadFromMessage(message, /*forks=*/{})),
+      Eq(Times(*massive_trajectory_)));
+}
+
+TEST_F(DiscreteTrajectoryTest, LegacySerialization) {
+  // The format written before the packed timeline.
+  serialization::DiscreteTrajectory message;
+  for (auto const& pair : {std::make_pair(t1_, d1_),
+                           std::make_pair(t2_, d2_),
+                           std::make_pair(t3_, d3_)}) {
+    auto const instantaneous_degrees_of_freedom = message.add_timeline();
+    pair.first.WriteToMessage(
+        instantaneous_degrees_of_freedom->mutable_instant());
+    pair.second.WriteToMessage(
+        instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
+  }
+  EXPECT_THAT(Timeline(message),
+              ElementsAre(Pair(t1_, d1_), Pair(t2_, d2_), Pair(t3_, d3_)));
 }
 
 TEST_F(DiscreteTrajectoryDeathTest, LastError) {
@@ -793,6 +844,160 @@ TEST_F(DiscreteTrajectoryTest, IteratorSuccess) {
   EXPECT_TRUE(it == fork->End());
 }
 
+TEST_F(DiscreteTrajectoryTest, EvaluateDegreesOfFreedom) {
+  // A circular motion of unit radius and angular frequency, sampled with a
+  // coarse step.  |massless_trajectory_| has the accelerations,
+  // |massive_trajectory_| doesn't.
+  auto const degrees_of_freedom = [this](Instant const& t) {
+    double const θ = (t - t0_) / Second;
+    return DegreesOfFreedom<World>(
+        World::origin + Displacement<World>({std::cos(θ) * Metre,
+                                             std::sin(θ) * Metre,
+                                             0 * Metre}),
+        Velocity<World>({-std::sin(θ) * Metre / Second,
+                         std::cos(θ) * Metre / Second,
+                         0 * Metre / Second}));
+  };
+  auto const acceleration = [this](Instant const& t) {
+    double const θ = (t - t0_) / Second;
+    return Vector<Acceleration, World>({-std::cos(θ) * Metre / Second / Second,
+                                        -std::sin(θ) * Metre / Second / Second,
+                                        0 * Metre / Second / Second});
+  };
+  Time const step = 0.5 * Second;
+  massive_trajectory_->Append(t0_, degrees_of_freedom(t0_));
+  massless_trajectory_->Append(t0_, degrees_of_freedom(t0_));
+  for (int i = 1; i <= 10; ++i) {
+    Instant const t = t0_ + i * step;
+    massive_trajectory_->Append(t, degrees_of_freedom(t));
+    massless_trajectory_->Append(t,
+                                 degrees_of_freedom(t),
+                                 acceleration(t - step),
+                                 acceleration(t));
+  }
+  // A fork that continues |massless_trajectory_|.
+  not_null<DiscreteTrajectory<World>*> const fork =
+      massless_trajectory_->NewForkAtLast();
+  for (int i = 11; i <= 20; ++i) {
+    Instant const t = t0_ + i * step;
+    fork->Append(t,
+                 degrees_of_freedom(t),
+                 acceleration(t - step),
+                 acceleration(t));
+  }
+
+  EXPECT_EQ(degrees_of_freedom(t0_ + 3 * step),
+            massless_trajectory_->EvaluateDegreesOfFreedom(t0_ + 3 * step));
+  EXPECT_EQ(degrees_of_freedom(t0_ + 3 * step),
+            massive_trajectory_->EvaluateDegreesOfFreedom(t0_ + 3 * step));
+
+  Length max_cubic_position_error;
+  Length max_quintic_position_error;
+  Length max_fork_position_error;
+  for (int i = 0; i < 10; ++i) {
+    Instant const t = t0_ + (i + 0.3) * step;
+    Position<World> const expected_position = degrees_of_freedom(t).position();
+    max_cubic_position_error = std::max(
+        max_cubic_position_error,
+        AbsoluteError(
+            expected_position,
+            massive_trajectory_->EvaluateDegreesOfFreedom(t).position()));
+    max_quintic_position_error = std::max(
+        max_quintic_position_error,
+        AbsoluteError(
+            expected_position,
+            massless_trajectory_->EvaluateDegreesOfFreedom(t).position()));
+    max_fork_position_error = std::max(
+        max_fork_position_error,
+        AbsoluteError(degrees_of_freedom(t + 10 * step).position(),
+                      fork->EvaluateDegreesOfFreedom(t + 10 * step)
+                          .position()));
+  }
+  EXPECT_THAT(max_cubic_position_error, AllOf(Gt(1.1e-4 * Metre),
+                                               Lt(1.2e-4 * Metre)));
+  EXPECT_THAT(max_quintic_position_error, AllOf(Gt(2.0e-7 * Metre),
+                                                Lt(2.1e-7 * Metre)));
+  EXPECT_THAT(max_fork_position_error, AllOf(Gt(2.0e-7 * Metre),
+                                             Lt(2.1e-7 * Metre)));
+  // Before the fork point the fork uses the points of its parent.
+  EXPECT_EQ(massless_trajectory_->EvaluateDegreesOfFreedom(t0_ + 0.3 * step),
+            fork->EvaluateDegreesOfFreedom(t0_ + 0.3 * step));
+}
+
+TEST_F(DiscreteTrajectoryTest, StepAccelerations) {
+  // A quartic motion, which the quintic interpolation reproduces exactly but
+  // the cubic one doesn't.
+  auto const degrees_of_freedom = [this](Instant const& t) {
+    double const τ = (t - t0_) / Second;
+    return DegreesOfFreedom<World>(
+        World::origin + Displacement<World>({τ * τ * τ * τ * Metre,
+                                             0 * Metre,
+                                             0 * Metre}),
+        Velocity<World>({4 * τ * τ * τ * Metre / Second,
+                         0 * Metre / Second,
+                         0 * Metre / Second}));
+  };
+  auto const acceleration = [this](Instant const& t) {
+    double const τ = (t - t0_) / Second;
+    return Vector<Acceleration, World>({12 * τ * τ * Metre / Second / Second,
+                                        0 * Metre / Second / Second,
+                                        0 * Metre / Second / Second});
+  };
+  Time const step = 1 * Second;
+  massless_trajectory_->Append(t0_, degrees_of_freedom(t0_));
+  for (int i = 1; i <= 4; ++i) {
+    Instant const t = t0_ + i * step;
+    massless_trajectory_->Append(t,
+                                 degrees_of_freedom(t),
+                                 acceleration(t - step),
+                                 acceleration(t));
+  }
+  not_null<DiscreteTrajectory<World>*> fork =
+      massless_trajectory_->NewForkWithCopy(t0_ + 2 * step);
+  Instant const t1 = t0_ + 0.5 * step;
+  Instant const t3 = t0_ + 2.5 * step;
+  EXPECT_EQ(degrees_of_freedom(t1),
+            massless_trajectory_->EvaluateDegreesOfFreedom(t1));
+  EXPECT_EQ(degrees_of_freedom(t3),
+            massless_trajectory_->EvaluateDegreesOfFreedom(t3));
+  EXPECT_EQ(degrees_of_freedom(t3), fork->EvaluateDegreesOfFreedom(t3));
+
+  // The accelerations survive serialization.
+  serialization::DiscreteTrajectory message;
+  massless_trajectory_->WriteToMessage(&message, /*forks=*/{fork});
+  EXPECT_EQ(4, message.packed_timeline().step_accelerations_time_size());
+  EXPECT_EQ(24, message.packed_timeline().step_accelerations_size());
+  DiscreteTrajectory<World>* deserialized_fork = nullptr;
+  auto const deserialized_trajectory = DiscreteTrajectory<World>::ReadFromMessage(
+      message, /*forks=*/{&deserialized_fork});
+  EXPECT_EQ(degrees_of_freedom(t1),
+            deserialized_trajectory->EvaluateDegreesOfFreedom(t1));
+  EXPECT_EQ(degrees_of_freedom(t3),
+            deserialized_trajectory->EvaluateDegreesOfFreedom(t3));
+  EXPECT_EQ(degrees_of_freedom(t3),
+            deserialized_fork->EvaluateDegreesOfFreedom(t3));
+
+  // Without the accelerations, e.g., in older saves, the interpolation falls
+  // back to cubic.  Note that this only clears the accelerations of the root.
+  message.mutable_packed_timeline()->clear_step_accelerations_time();
+  message.mutable_packed_timeline()->clear_step_accelerations();
+  deserialized_fork = nullptr;
+  auto const cubic_trajectory = DiscreteTrajectory<World>::ReadFromMessage(
+      message, /*forks=*/{&deserialized_fork});
+  EXPECT_NE(degrees_of_freedom(t1),
+            cubic_trajectory->EvaluateDegreesOfFreedom(t1));
+
+  // The accelerations of the forgotten points are forgotten too, and those of
+  // a point appended again are not retained.
+  massless_trajectory_->ForgetAfter(t0_ + 2 * step);
+  Instant const t4 = t0_ + 3 * step;
+  massless_trajectory_->Append(t4, degrees_of_freedom(t4));
+  EXPECT_NE(degrees_of_freedom(t3),
+            massless_trajectory_->EvaluateDegreesOfFreedom(t3));
+  EXPECT_EQ(degrees_of_freedom(t1),
+            massless_trajectory_->EvaluateDegreesOfFreedom(t1));
+}
+
 }  // namespace internal_discrete_trajectory
 }  // namespace physics
 }  // namespace principia
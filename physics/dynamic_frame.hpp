@@ -2,6 +2,8 @@
 #ifndef PRINCIPIA_PHYSICS_DYNAMIC_FRAME_HPP_
 #define PRINCIPIA_PHYSICS_DYNAMIC_FRAME_HPP_
 
+#include <vector>
+
 #include "geometry/frame.hpp"
 #include "geometry/rotation.hpp"
 #include "physics/ephemeris.hpp"
@@ -42,6 +44,16 @@ class DynamicFrame {
   virtual RigidMotion<ThisFrame, InertialFrame> FromThisFrameAtTime(
       Instant const& t) const;
 
+  // Stores in |rigid_motions| the results of |ToThisFrameAtTime| for each of
+  // the |times|, which must be increasing.  The default implementation calls
+  // |ToThisFrameAtTime|; derived classes may override it to evaluate the
+  // trajectories of the bodies that define the frame at all the |times| at
+  // once.
+  virtual void ToThisFrameAtTimes(
+      std::vector<Instant> const& times,
+      not_null<std::vector<RigidMotion<InertialFrame, ThisFrame>>*> const
+          rigid_motions) const;
+
   // The acceleration due to the non-inertial motion of |ThisFrame| and gravity.
   // A particle in free fall follows a trajectory whose second derivative
   // is |GeometricAcceleration|.
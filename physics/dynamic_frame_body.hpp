@@ -37,6 +37,18 @@ DynamicFrame<InertialFrame, ThisFrame>::FromThisFrameAtTime(
   return ToThisFrameAtTime(t).Inverse();
 }
 
+template<typename InertialFrame, typename ThisFrame>
+void DynamicFrame<InertialFrame, ThisFrame>::ToThisFrameAtTimes(
+    std::vector<Instant> const& times,
+    not_null<std::vector<RigidMotion<InertialFrame, ThisFrame>>*> const
+        rigid_motions) const {
+  rigid_motions->clear();
+  rigid_motions->reserve(times.size());
+  for (Instant const& t : times) {
+    rigid_motions->push_back(ToThisFrameAtTime(t));
+  }
+}
+
 template<typename InertialFrame, typename ThisFrame>
 Vector<Acceleration, ThisFrame>
 DynamicFrame<InertialFrame, ThisFrame>::GeometricAcceleration(
@@ -5,9 +5,12 @@
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
+#include "base/macros.hpp"
 #include "base/not_null.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/named_quantities.hpp"
 #include "google/protobuf/repeated_field.h"
@@ -29,8 +32,12 @@ using integrators::AdaptiveStepSizeIntegrator;
 using integrators::FixedStepSizeIntegrator;
 using integrators::SpecialSecondOrderDifferentialEquation;
 using quantities::Acceleration;
+using quantities::GravitationalParameter;
 using quantities::Length;
+using quantities::Order2ZonalCoefficient;
+using quantities::Product;
 using quantities::Speed;
+using quantities::Square;
 
 template<typename Frame>
 class Ephemeris {
@@ -45,6 +52,10 @@ class Ephemeris {
   static std::int64_t constexpr unlimited_max_ephemeris_steps =
       std::numeric_limits<std::int64_t>::max();
 
+  // Called by |WriteToMessageInPieces| with each piece of the serialization.
+  using PieceWriter =
+      std::function<void(not_null<serialization::Ephemeris*> const piece)>;
+
   // The equation describing the motion of the |bodies_|.
   using NewtonianMotionEquation =
       SpecialSecondOrderDifferentialEquation<Position<Frame>>;
@@ -64,11 +75,17 @@ class Ephemeris {
     Length length_integration_tolerance() const;
     Speed speed_integration_tolerance() const;
 
+    void set_max_steps(std::int64_t const max_steps);
     void set_length_integration_tolerance(
         Length const& length_integration_tolerance);
     void set_speed_integration_tolerance(
         Speed const& speed_integration_tolerance);
 
+    // Two parameters are equal if they use the same integrator, the same
+    // maximum number of steps, and the same tolerances.
+    bool operator==(AdaptiveStepParameters const& right) const;
+    bool operator!=(AdaptiveStepParameters const& right) const;
+
     void WriteToMessage(
         not_null<serialization::Ephemeris::AdaptiveStepParameters*> const
             message) const;
@@ -107,13 +124,46 @@ class Ephemeris {
     friend class Ephemeris<Frame>;
   };
 
+  // Side channels in which |FlowWithAdaptiveStep| records the events of a
+  // massless body relative to |body| as its trajectory is integrated: the
+  // apsides, the crossings of the equatorial plane of |body| if it is a
+  // |RotatingBody|, and the impacts, i.e., the points where the distance to the
+  // centre of |body| falls below its mean radius.  The events are located on
+  // the dense output of the integrator, so they are as accurate as the
+  // trajectory itself.  The |singularities| are the points where the flow
+  // stopped because its step size vanished, typically at the centre of a point
+  // mass; they are not relative to |body| and are recorded in all the |Events|
+  // of the flow.
+  struct Events {
+    explicit Events(not_null<MassiveBody const*> const body);
+
+    // Removes the events after |time|.
+    void ForgetAfter(Instant const& time);
+    // Removes the events before |time|.
+    void ForgetBefore(Instant const& time);
+
+    not_null<MassiveBody const*> const body;
+    DiscreteTrajectory<Frame> apoapsides;
+    DiscreteTrajectory<Frame> periapsides;
+    DiscreteTrajectory<Frame> ascending_nodes;
+    DiscreteTrajectory<Frame> descending_nodes;
+    DiscreteTrajectory<Frame> impacts;
+    DiscreteTrajectory<Frame> singularities;
+  };
+
   // Constructs an Ephemeris that owns the |bodies|.  The elements of vectors
-  // |bodies| and |initial_state| correspond to one another.
+  // |bodies| and |initial_state| correspond to one another.  If
+  // |number_of_threads| is positive, the accelerations of the massive bodies
+  // are computed in tiles on a pool of that many threads; this only pays off
+  // for systems with many bodies.  The results of the tiled computation do not
+  // depend on |number_of_threads|, but they may differ in the last bits from
+  // those of the sequential computation used when |number_of_threads| is 0.
   Ephemeris(std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies,
             std::vector<DegreesOfFreedom<Frame>> const& initial_state,
             Instant const& initial_time,
             Length const& fitting_tolerance,
-            FixedStepParameters const& parameters);
+            FixedStepParameters const& parameters,
+            int number_of_threads = 0);
 
   virtual ~Ephemeris() = default;
 
@@ -139,8 +189,30 @@ class Ephemeris {
   virtual void ForgetBefore(Instant const& t);
 
   // Prolongs the ephemeris up to at least |t|.  After the call, |t_max() >= t|.
+  // The prolongations are serialized, so this may be called while trajectories
+  // are flowed or the ephemeris is prolonged on other threads.  Doesn't wait
+  // for these prolongations if |t_max() >= t| already.
   virtual void Prolong(Instant const& t);
 
+  // Enables an approximation of the gravitational field of the massive bodies
+  // in |FlowWithAdaptiveStep|.  |parents| maps bodies to the body that they
+  // orbit, typically as given by |HierarchicalSystem|; bodies that are not keys
+  // of |parents| are roots of the hierarchy.  A body that has a parent and
+  // satellites forms, with its direct and indirect satellites, a subsystem.
+  // A massless body far enough from a subsystem sees it as a point mass located
+  // at its barycentre, so the trajectories of its bodies are not evaluated.
+  // The approximation is only used where the errors that it makes on the
+  // acceleration add up to at most |tolerance|, assuming that the satellites
+  // remain within a margin of the apoapsides of their current osculating
+  // orbits.  Subsystems having unbound satellites are never approximated.
+  // The barycentres are only known from the last integrated state of the
+  // ephemeris onward; they are not serialized.  A new call replaces the
+  // previous approximation.
+  virtual void EnableSubsystemsApproximation(
+      std::map<not_null<MassiveBody const*>,
+               not_null<MassiveBody const*>> const& parents,
+      Acceleration const& tolerance);
+
   // Integrates, until exactly |t| (except for timeouts or singularities), the
   // |trajectory| followed by a massless body in the gravitational potential
   // described by |*this|.  If |t > t_max()|, calls |Prolong(t)| beforehand.
@@ -153,6 +225,34 @@ class Ephemeris {
       AdaptiveStepParameters const& parameters,
       std::int64_t const max_ephemeris_steps);
 
+  // Same as above, but also records the events of |trajectory| in each of the
+  // |events|.  The trajectory is the same as if no events were recorded.
+  virtual bool FlowWithAdaptiveStep(
+      not_null<DiscreteTrajectory<Frame>*> const trajectory,
+      IntrinsicAcceleration intrinsic_acceleration,
+      Instant const& t,
+      AdaptiveStepParameters const& parameters,
+      std::int64_t const max_ephemeris_steps,
+      std::vector<not_null<Events*>> const& events);
+
+  // Same as above, but for several |trajectories|, each of which gets its own
+  // step size control.  The final time of each trajectory is computed as if it
+  // were flowed alone, the ephemeris is prolonged once for the whole batch,
+  // and the positions of the massive bodies are shared between the
+  // trajectories whose stages happen at the same time (which is typical of the
+  // first step if the trajectories start and end at the same times).  The
+  // result for each trajectory is bit-for-bit the same as if it had been
+  // flowed alone.  |intrinsic_accelerations| and |events| are either empty or
+  // have the same size as |trajectories|.  Returns, for each trajectory,
+  // whether it was integrated until |t|.
+  std::vector<bool> FlowWithAdaptiveStep(
+      std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+      IntrinsicAccelerations const& intrinsic_accelerations,
+      Instant const& t,
+      AdaptiveStepParameters const& parameters,
+      std::int64_t const max_ephemeris_steps,
+      std::vector<std::vector<not_null<Events*>>> const& events);
+
   // Integrates, until at most |t|, the |trajectories| followed by massless
   // bodies in the gravitational potential described by |*this|.  If
   // |t > t_max()|, calls |Prolong(t)| beforehand.
@@ -216,6 +316,12 @@ class Ephemeris {
 
   virtual void WriteToMessage(
       not_null<serialization::Ephemeris*> const message) const;
+  // Same as |WriteToMessage|, but the message is produced in pieces, each of
+  // which contains at most one trajectory.  |write_piece| is called with each
+  // piece in turn and may modify it.  Merging the pieces in order yields the
+  // message written by |WriteToMessage|.  |write_piece| is not called under
+  // the lock of the ephemeris, so it doesn't stall prolongations and flows.
+  virtual void WriteToMessageInPieces(PieceWriter const& write_piece) const;
   static not_null<std::unique_ptr<Ephemeris>> ReadFromMessage(
       serialization::Ephemeris const& message);
 
@@ -239,13 +345,121 @@ class Ephemeris {
     std::vector<typename ContinuousTrajectory<Frame>::Checkpoint> checkpoints;
   };
 
+  // Evaluates the positions of the massive bodies, and remembers them for the
+  // most recent time at which they were requested, which is typically the time
+  // of the current stage of the integrator.  The positions for the first
+  // |pinned_capacity| distinct times are remembered until destruction, so that
+  // they may be shared between the trajectories of a batch.  Not thread-safe.
+  class MassiveBodiesPositions {
+   public:
+    MassiveBodiesPositions(not_null<Ephemeris const*> const ephemeris,
+                           int const pinned_capacity);
+
+    // Returns the positions of the |bodies_| at |t|.  The result remains valid
+    // until the next call with a different |t|.
+    std::vector<Position<Frame>> const& Evaluate(Instant const& t);
+
+    // Returns the position of the body with index |b| in |bodies_| at |t|,
+    // without evaluating the trajectories of the other bodies.  The result
+    // remains valid until the next call with a different |t|.
+    Position<Frame> const& EvaluatePosition(Instant const& t, int const b);
+
+   private:
+    // The positions of the bodies at |time|.  |evaluated[b]| is true if
+    // |positions[b]| has been evaluated.
+    struct Entry {
+      Instant time;
+      std::vector<Position<Frame>> positions;
+      std::vector<bool> evaluated;
+    };
+
+    // Returns the entry for |t|, reusing |latest_| if there is none and no
+    // more entries may be pinned.
+    Entry& FindOrInsert(Instant const& t);
+
+    not_null<Ephemeris const*> const ephemeris_;
+    int const pinned_capacity_;
+    std::vector<typename ContinuousTrajectory<Frame>::Hint> hints_;
+    // The entries for the first distinct times, at most |pinned_capacity_|.
+    // Never reallocated.
+    std::vector<Entry> pinned_;
+    // The entry for the most recent time if it is not pinned.
+    Entry latest_;
+    // The entry returned by the last call to |FindOrInsert|, if any.
+    Entry* last_ = nullptr;
+  };
+
+  // A body and its direct and indirect satellites, which may be seen as a
+  // point mass located at their barycentre from far away.  See
+  // |EnableSubsystemsApproximation|.
+  struct Subsystem {
+    // Returns an upper bound of the error made on the acceleration by
+    // replacing the subsystem by a point mass located at its |barycentre|, for
+    // a massless body at distance |radius + ρ| from the |barycentre|.
+    Acceleration ApproximationError(Length const& ρ) const;
+
+    // The indices of the bodies in |bodies_|.
+    int primary;
+    std::vector<int> satellites;
+    // The gravitational parameter of the entire subsystem.
+    GravitationalParameter gravitational_parameter;
+    // Upper bound of the distance between the bodies and the |barycentre|.
+    Length radius;
+    // Upper bound of the sum of μ d² over the bodies, where d is the distance
+    // between a body and the |barycentre|.
+    Product<GravitationalParameter, Square<Length>> second_moment;
+    // The sum of the absolute values of the j2 of the bodies.
+    Order2ZonalCoefficient j2;
+    // Appended to by |AppendMassiveBodiesState|.
+    std::unique_ptr<ContinuousTrajectory<Frame>> barycentre;
+  };
+
+  struct SubsystemsApproximation {
+    // The bound on the sum of the errors of the approximated subsystems.
+    Acceleration tolerance;
+    // Each subsystem precedes the subsystems nested in it.
+    std::vector<Subsystem> subsystems;
+  };
+
+  // Returns the degrees of freedom of the barycentre of |subsystem| in
+  // |state|.
+  DegreesOfFreedom<Frame> SubsystemBarycentre(
+      Subsystem const& subsystem,
+      typename NewtonianMotionEquation::SystemState const& state) const;
+
   void AppendMassiveBodiesState(
       typename NewtonianMotionEquation::SystemState const& state);
   static void AppendMasslessBodiesState(
       typename NewtonianMotionEquation::SystemState const& state,
       std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories);
+  // Same as above, but also records in the |trajectories| the accelerations at
+  // the beginning and at the end of the step that ended at |state|.
+  // Integrates the single trajectory in |trajectories| until |t_final|, which
+  // must be at most the end of the ephemeris, and records its events in each of
+  // the |events|.  |intrinsic_accelerations| has a single element.  Returns
+  // true if and only if the trajectory was integrated until |t_final|.
+  bool FlowWithAdaptiveStepUntil(
+      std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+      IntrinsicAccelerations const& intrinsic_accelerations,
+      Instant const& t_final,
+      AdaptiveStepParameters const& parameters,
+      std::vector<not_null<Events*>> const& events,
+      not_null<MassiveBodiesPositions*> const massive_bodies_positions);
+
+  static void AppendMasslessBodiesStateWithAccelerations(
+      typename NewtonianMotionEquation::SystemState const& state,
+      std::vector<typename NewtonianMotionEquation::Acceleration> const&
+          previous_accelerations,
+      std::vector<typename NewtonianMotionEquation::Acceleration> const&
+          accelerations,
+      std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories);
 
-  Checkpoint GetCheckpoint();
+  // Returns the events of the equation of motion of a single massless body
+  // which record its events relative to |events->body| in |*events|.
+  std::vector<typename NewtonianMotionEquation::Event> MakeEvents(
+      not_null<Events*> const events) const;
+
+  Checkpoint GetCheckpoint() const;
 
   // Computes the accelerations between one body, |body1| (with index |b1| in
   // the |positions| and |accelerations| arrays) and the bodies |bodies2| (with
@@ -266,18 +480,28 @@ class Ephemeris {
       std::vector<Position<Frame>> const& positions,
       not_null<std::vector<Vector<Acceleration, Frame>>*> const accelerations);
 
-  // Computes the accelerations due to one body, |body1| (with index |b1| in the
-  // |bodies_| and |trajectories_| arrays) on massless bodies at the given
-  // |positions|.  The template parameter specifies what we know about the
-  // massive body, and therefore what forces apply.
+  // Computes the accelerations due to one body, |body1| (at |position1|) on
+  // massless bodies at the given |positions|.  The template parameter
+  // specifies what we know about the massive body, and therefore what forces
+  // apply.
   template<bool body1_is_oblate>
-  void ComputeGravitationalAccelerationByMassiveBodyOnMasslessBodies(
-      Instant const& t,
+  static void ComputeGravitationalAccelerationByMassiveBodyOnMasslessBodies(
       MassiveBody const& body1,
-      size_t const b1,
+      Position<Frame> const& position1,
       std::vector<Position<Frame>> const& positions,
-      not_null<std::vector<Vector<Acceleration, Frame>>*> const accelerations,
-      not_null<typename ContinuousTrajectory<Frame>::Hint*> const hint1) const;
+      not_null<std::vector<Vector<Acceleration, Frame>>*> const accelerations);
+
+  // Returns the acceleration due to one body, |body1| (at |position1|), on a
+  // massless body at |position2|.  The central force uses the gravitational
+  // parameter |μ1|, which may differ from that of |body1| if it stands for a
+  // subsystem; the order 2 zonal effect, if any, uses that of |body1|.
+  template<bool body1_is_oblate>
+  static Vector<Acceleration, Frame>
+  ComputeGravitationalAccelerationByMassiveBodyOnMasslessBody(
+      MassiveBody const& body1,
+      GravitationalParameter const& μ1,
+      Position<Frame> const& position1,
+      Position<Frame> const& position2);
 
   // Computes the accelerations between all the massive bodies in |bodies_|.
   void ComputeMassiveBodiesGravitationalAccelerations(
@@ -288,15 +512,16 @@ class Ephemeris {
 
   // Computes the acceleration exerted by the massive bodies in |bodies_| on
   // massless bodies.  The massless bodies are at the given |positions|.  The
-  // |hints| are passed to
-  // ComputeGravitationalAccelerationByMassiveBodyOnMasslessBody for efficient
-  // computation of the positions of the massive bodies.
+  // positions of the massive bodies are obtained from
+  // |massive_bodies_positions|.  If |subsystems_approximation| is not null,
+  // the subsystems whose approximation error is small enough are seen as point
+  // masses.
   void ComputeMasslessBodiesGravitationalAccelerations(
       Instant const& t,
       std::vector<Position<Frame>> const& positions,
       not_null<std::vector<Vector<Acceleration, Frame>>*> const accelerations,
-      not_null<std::vector<typename ContinuousTrajectory<Frame>::Hint>*>
-          const hints) const;
+      not_null<MassiveBodiesPositions*> const massive_bodies_positions,
+      SubsystemsApproximation const* const subsystems_approximation) const;
 
   // Same as above, but the massless bodies have intrinsic accelerations.
   // |intrinsic_accelerations| may be empty.
@@ -305,8 +530,8 @@ class Ephemeris {
       Instant const& t,
       std::vector<Position<Frame>> const& positions,
       not_null<std::vector<Vector<Acceleration, Frame>>*> const accelerations,
-      not_null<std::vector<typename ContinuousTrajectory<Frame>::Hint>*>
-          const hints) const;
+      not_null<MassiveBodiesPositions*> const massive_bodies_positions,
+      SubsystemsApproximation const* const subsystems_approximation) const;
 
   // Computes an estimate of the ratio |tolerance / error|.
   static double ToleranceToErrorRatio(
@@ -334,15 +559,33 @@ class Ephemeris {
 
   FixedStepParameters const parameters_;
   Length const fitting_tolerance_;
-  typename NewtonianMotionEquation::SystemState last_state_;
+
+  // Serializes the prolongations, which may be triggered by flows running on
+  // different threads.  The trajectories have their own lock.
+  mutable std::mutex lock_;
+  typename NewtonianMotionEquation::SystemState last_state_ GUARDED_BY(lock_);
 
   // These are the states other that the last which we preserve in order to
   // implement compact serialization.  The vector is time-ordered.
-  std::vector<Checkpoint> checkpoints_;
+  std::vector<Checkpoint> checkpoints_ GUARDED_BY(lock_);
 
   int number_of_oblate_bodies_ = 0;
   int number_of_spherical_bodies_ = 0;
 
+  // The boundaries of the rows of the tiles used to compute the accelerations
+  // of the massive bodies in parallel: the tile |i| covers the interactions of
+  // the bodies in [tile_boundaries_[i], tile_boundaries_[i + 1][ with the
+  // bodies that follow them.  Empty, and |thread_pool_| is null, if the
+  // computation is sequential.
+  std::vector<int> tile_boundaries_;
+  std::unique_ptr<base::ThreadPool<void>> thread_pool_;
+
+  // Null unless |EnableSubsystemsApproximation| has been called.  Only
+  // modified under |lock_|, but accessed with |std::atomic_load| and
+  // |std::atomic_store| so that the flows don't wait for the prolongations; a
+  // flow uses the approximation that was current when it started.
+  std::shared_ptr<SubsystemsApproximation const> subsystems_approximation_;
+
   NewtonianMotionEquation massive_bodies_equation_;
 };
 
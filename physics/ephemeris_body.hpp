@@ -4,8 +4,12 @@
 #include "physics/ephemeris.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
+#include <future>
+#include <iterator>
 #include <limits>
+#include <mutex>
 #include <set>
 #include <vector>
 
@@ -14,35 +18,46 @@
 #include "base/not_null.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/r3_element.hpp"
-#include "numerics/hermite3.hpp"
 #include "physics/continuous_trajectory.hpp"
+#include "physics/rotating_body.hpp"
 #include "quantities/elementary_functions.hpp"
 #include "quantities/named_quantities.hpp"
 #include "quantities/quantities.hpp"
 #include "quantities/si.hpp"
 
+#if PRINCIPIA_USE_SSE2_INTRINSICS
+#include <emmintrin.h>
+#endif
+
 namespace principia {
 namespace physics {
 namespace internal_ephemeris {
 
 using base::FindOrDie;
 using base::make_not_null_unique;
+using geometry::AngularVelocity;
+using geometry::BarycentreCalculator;
 using geometry::Displacement;
 using geometry::InnerProduct;
 using geometry::Position;
 using geometry::R3Element;
+using geometry::Sign;
 using geometry::Velocity;
+using geometry::Wedge;
 using integrators::AdaptiveStepSize;
 using integrators::IntegrationProblem;
 using numerics::Bisect;
-using numerics::Hermite3;
 using quantities::Abs;
 using quantities::Exponentiation;
 using quantities::GravitationalParameter;
+using quantities::Pow;
 using quantities::Quotient;
+using quantities::SIUnit;
+using quantities::SpecificEnergy;
 using quantities::Square;
 using quantities::Time;
 using quantities::si::Day;
+using quantities::si::Metre;
 using quantities::si::Second;
 using ::std::placeholders::_1;
 using ::std::placeholders::_2;
@@ -50,6 +65,11 @@ using ::std::placeholders::_3;
 
 Time const max_time_between_checkpoints = 180 * Day;
 
+// The number of tiles used to compute the accelerations of the massive bodies
+// in parallel.  It must not depend on the number of threads, so that the
+// results don't either.
+int const number_of_tiles = 16;
+
 // If j is a unit vector along the axis of rotation, and r is the separation
 // between the bodies, the acceleration computed here is:
 //
@@ -79,6 +99,389 @@ FORCE_INLINE Vector<Quotient<Acceleration,
   return axis_effect + radial_effect;
 }
 
+// A structure-of-arrays representation of the massive bodies, used by the
+// packed N-body kernel.  All the quantities are magnitudes in SI units.  The
+// oblateness data are only meaningful for the oblate bodies.
+struct PackedMassiveBodies {
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> z;
+  std::vector<double> μ;
+  std::vector<double> axis_x;
+  std::vector<double> axis_y;
+  std::vector<double> axis_z;
+  std::vector<double> j2_over_μ;
+};
+
+// The accelerations computed by the packed N-body kernel, in SI units.
+struct PackedAccelerations {
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> z;
+};
+
+#if PRINCIPIA_USE_SSE2_INTRINSICS
+
+// The packed equivalent of |Order2ZonalEffect|, for a body whose axis and
+// |j2_over_μ| are given.
+FORCE_INLINE void PackedOrder2ZonalEffect(__m128d const axis_x,
+                                          __m128d const axis_y,
+                                          __m128d const axis_z,
+                                          __m128d const j2_over_μ,
+                                          __m128d const Δq_x,
+                                          __m128d const Δq_y,
+                                          __m128d const Δq_z,
+                                          __m128d const one_over_Δq_squared,
+                                          __m128d const one_over_Δq_cubed,
+                                          not_null<__m128d*> const effect_x,
+                                          not_null<__m128d*> const effect_y,
+                                          not_null<__m128d*> const effect_z) {
+  __m128d const r_axis_projection =
+      _mm_add_pd(_mm_add_pd(_mm_mul_pd(axis_x, Δq_x),
+                            _mm_mul_pd(axis_y, Δq_y)),
+                 _mm_mul_pd(axis_z, Δq_z));
+  __m128d const j2_over_r_fifth =
+      _mm_mul_pd(_mm_mul_pd(j2_over_μ, one_over_Δq_cubed),
+                 one_over_Δq_squared);
+  __m128d const axis_factor =
+      _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(-3), j2_over_r_fifth),
+                 r_axis_projection);
+  __m128d const radial_factor = _mm_mul_pd(
+      j2_over_r_fifth,
+      _mm_add_pd(_mm_set1_pd(-1.5),
+                 _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(_mm_set1_pd(7.5),
+                                                  r_axis_projection),
+                                       r_axis_projection),
+                            one_over_Δq_squared)));
+  *effect_x = _mm_add_pd(_mm_mul_pd(axis_factor, axis_x),
+                         _mm_mul_pd(radial_factor, Δq_x));
+  *effect_y = _mm_add_pd(_mm_mul_pd(axis_factor, axis_y),
+                         _mm_mul_pd(radial_factor, Δq_y));
+  *effect_z = _mm_add_pd(_mm_mul_pd(axis_factor, axis_z),
+                         _mm_mul_pd(radial_factor, Δq_z));
+}
+
+// The vectorized equivalent of
+// |ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies|: computes the
+// mutual accelerations of |b1| and of the bodies in [b2_begin, b2_end[, two
+// bodies at a time.  The accelerations on the bodies in [b2_begin, b2_end[ are
+// accumulated in the same order as in the scalar kernel, but the acceleration
+// on |b1| is accumulated in two lanes which are added at the end, so it may
+// differ from the scalar result in the last bits.
+template<bool body1_is_oblate, bool body2_is_oblate>
+void ComputeVectorizedGravitationalAccelerationByMassiveBodyOnMassiveBodies(
+    std::size_t const b1,
+    std::size_t const b2_begin,
+    std::size_t const b2_end,
+    PackedMassiveBodies const& bodies,
+    not_null<PackedAccelerations*> const accelerations) {
+  if (b2_begin >= b2_end) {
+    return;
+  }
+  __m128d const x1 = _mm_set1_pd(bodies.x[b1]);
+  __m128d const y1 = _mm_set1_pd(bodies.y[b1]);
+  __m128d const z1 = _mm_set1_pd(bodies.z[b1]);
+  __m128d const μ1 = _mm_set1_pd(bodies.μ[b1]);
+  __m128d axis1_x;
+  __m128d axis1_y;
+  __m128d axis1_z;
+  __m128d j2_over_μ1;
+  if (body1_is_oblate) {
+    axis1_x = _mm_set1_pd(bodies.axis_x[b1]);
+    axis1_y = _mm_set1_pd(bodies.axis_y[b1]);
+    axis1_z = _mm_set1_pd(bodies.axis_z[b1]);
+    j2_over_μ1 = _mm_set1_pd(bodies.j2_over_μ[b1]);
+  }
+  __m128d acceleration1_x = _mm_setzero_pd();
+  __m128d acceleration1_y = _mm_setzero_pd();
+  __m128d acceleration1_z = _mm_setzero_pd();
+
+  // If the number of bodies is odd, the last one is processed with both lanes
+  // loaded with the same body, and a zero gravitational parameter in the
+  // second lane; only the first lane of its acceleration is stored.
+  for (std::size_t b2 = b2_begin; b2 < b2_end; b2 += 2) {
+    bool const full = b2 + 1 < b2_end;
+    auto const load = [b2, full](std::vector<double> const& v) {
+      return full ? _mm_loadu_pd(&v[b2]) : _mm_load1_pd(&v[b2]);
+    };
+    __m128d const μ2 =
+        full ? _mm_loadu_pd(&bodies.μ[b2]) : _mm_load_sd(&bodies.μ[b2]);
+    __m128d const Δq_x = _mm_sub_pd(x1, load(bodies.x));
+    __m128d const Δq_y = _mm_sub_pd(y1, load(bodies.y));
+    __m128d const Δq_z = _mm_sub_pd(z1, load(bodies.z));
+
+    __m128d const Δq_squared =
+        _mm_add_pd(_mm_add_pd(_mm_mul_pd(Δq_x, Δq_x), _mm_mul_pd(Δq_y, Δq_y)),
+                   _mm_mul_pd(Δq_z, Δq_z));
+    __m128d const one_over_Δq_cubed =
+        _mm_div_pd(_mm_sqrt_pd(Δq_squared),
+                   _mm_mul_pd(Δq_squared, Δq_squared));
+
+    __m128d acceleration2_x = load(accelerations->x);
+    __m128d acceleration2_y = load(accelerations->y);
+    __m128d acceleration2_z = load(accelerations->z);
+
+    __m128d const μ1_over_Δq_cubed = _mm_mul_pd(μ1, one_over_Δq_cubed);
+    acceleration2_x =
+        _mm_add_pd(acceleration2_x, _mm_mul_pd(Δq_x, μ1_over_Δq_cubed));
+    acceleration2_y =
+        _mm_add_pd(acceleration2_y, _mm_mul_pd(Δq_y, μ1_over_Δq_cubed));
+    acceleration2_z =
+        _mm_add_pd(acceleration2_z, _mm_mul_pd(Δq_z, μ1_over_Δq_cubed));
+
+    // Lex. III. Actioni contrariam semper & æqualem esse reactionem:
+    // sive corporum duorum actiones in se mutuo semper esse æquales &
+    // in partes contrarias dirigi.
+    __m128d const μ2_over_Δq_cubed = _mm_mul_pd(μ2, one_over_Δq_cubed);
+    acceleration1_x =
+        _mm_sub_pd(acceleration1_x, _mm_mul_pd(Δq_x, μ2_over_Δq_cubed));
+    acceleration1_y =
+        _mm_sub_pd(acceleration1_y, _mm_mul_pd(Δq_y, μ2_over_Δq_cubed));
+    acceleration1_z =
+        _mm_sub_pd(acceleration1_z, _mm_mul_pd(Δq_z, μ2_over_Δq_cubed));
+
+    if (body1_is_oblate || body2_is_oblate) {
+      __m128d const one_over_Δq_squared =
+          _mm_div_pd(_mm_set1_pd(1), Δq_squared);
+      __m128d effect_x;
+      __m128d effect_y;
+      __m128d effect_z;
+      auto const accumulate = [&]() {
+        acceleration1_x =
+            _mm_sub_pd(acceleration1_x, _mm_mul_pd(μ2, effect_x));
+        acceleration1_y =
+            _mm_sub_pd(acceleration1_y, _mm_mul_pd(μ2, effect_y));
+        acceleration1_z =
+            _mm_sub_pd(acceleration1_z, _mm_mul_pd(μ2, effect_z));
+        acceleration2_x =
+            _mm_add_pd(acceleration2_x, _mm_mul_pd(μ1, effect_x));
+        acceleration2_y =
+            _mm_add_pd(acceleration2_y, _mm_mul_pd(μ1, effect_y));
+        acceleration2_z =
+            _mm_add_pd(acceleration2_z, _mm_mul_pd(μ1, effect_z));
+      };
+      if (body1_is_oblate) {
+        PackedOrder2ZonalEffect(axis1_x, axis1_y, axis1_z, j2_over_μ1,
+                                Δq_x, Δq_y, Δq_z,
+                                one_over_Δq_squared, one_over_Δq_cubed,
+                                &effect_x, &effect_y, &effect_z);
+        accumulate();
+      }
+      if (body2_is_oblate) {
+        PackedOrder2ZonalEffect(load(bodies.axis_x),
+                                load(bodies.axis_y),
+                                load(bodies.axis_z),
+                                load(bodies.j2_over_μ),
+                                Δq_x, Δq_y, Δq_z,
+                                one_over_Δq_squared, one_over_Δq_cubed,
+                                &effect_x, &effect_y, &effect_z);
+        accumulate();
+      }
+    }
+
+    if (full) {
+      _mm_storeu_pd(&accelerations->x[b2], acceleration2_x);
+      _mm_storeu_pd(&accelerations->y[b2], acceleration2_y);
+      _mm_storeu_pd(&accelerations->z[b2], acceleration2_z);
+    } else {
+      _mm_store_sd(&accelerations->x[b2], acceleration2_x);
+      _mm_store_sd(&accelerations->y[b2], acceleration2_y);
+      _mm_store_sd(&accelerations->z[b2], acceleration2_z);
+    }
+  }
+
+  auto const sum = [](__m128d const lanes) {
+    return _mm_cvtsd_f64(_mm_add_sd(lanes, _mm_unpackhi_pd(lanes, lanes)));
+  };
+  accelerations->x[b1] += sum(acceleration1_x);
+  accelerations->y[b1] += sum(acceleration1_y);
+  accelerations->z[b1] += sum(acceleration1_z);
+}
+
+#endif
+
+// The scalar equivalent of the above, used on processors that don't have SSE2.
+// The results are the same as those of
+// |ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies|.
+template<bool body1_is_oblate, bool body2_is_oblate>
+void ComputeScalarGravitationalAccelerationByMassiveBodyOnMassiveBodies(
+    std::size_t const b1,
+    std::size_t const b2_begin,
+    std::size_t const b2_end,
+    PackedMassiveBodies const& bodies,
+    not_null<PackedAccelerations*> const accelerations) {
+  double const x1 = bodies.x[b1];
+  double const y1 = bodies.y[b1];
+  double const z1 = bodies.z[b1];
+  double const μ1 = bodies.μ[b1];
+  double acceleration1_x = 0;
+  double acceleration1_y = 0;
+  double acceleration1_z = 0;
+
+  // Adds the effect of the oblateness of a body having the given |axis| and
+  // |j2_over_μ|, see |Order2ZonalEffect|.
+  auto const accumulate_order_2_zonal_effect =
+      [&](std::size_t const b2,
+          double const axis_x,
+          double const axis_y,
+          double const axis_z,
+          double const j2_over_μ,
+          double const Δq_x,
+          double const Δq_y,
+          double const Δq_z,
+          double const one_over_Δq_squared,
+          double const one_over_Δq_cubed) {
+        double const μ2 = bodies.μ[b2];
+        double const r_axis_projection =
+            axis_x * Δq_x + axis_y * Δq_y + axis_z * Δq_z;
+        double const j2_over_r_fifth =
+            j2_over_μ * one_over_Δq_cubed * one_over_Δq_squared;
+        double const axis_factor = -3 * j2_over_r_fifth * r_axis_projection;
+        double const radial_factor =
+            j2_over_r_fifth *
+            (-1.5 + 7.5 * r_axis_projection *
+                          r_axis_projection * one_over_Δq_squared);
+        double const effect_x = axis_factor * axis_x + radial_factor * Δq_x;
+        double const effect_y = axis_factor * axis_y + radial_factor * Δq_y;
+        double const effect_z = axis_factor * axis_z + radial_factor * Δq_z;
+        acceleration1_x -= μ2 * effect_x;
+        acceleration1_y -= μ2 * effect_y;
+        acceleration1_z -= μ2 * effect_z;
+        accelerations->x[b2] += μ1 * effect_x;
+        accelerations->y[b2] += μ1 * effect_y;
+        accelerations->z[b2] += μ1 * effect_z;
+      };
+
+  for (std::size_t b2 = b2_begin; b2 < b2_end; ++b2) {
+    double const μ2 = bodies.μ[b2];
+    double const Δq_x = x1 - bodies.x[b2];
+    double const Δq_y = y1 - bodies.y[b2];
+    double const Δq_z = z1 - bodies.z[b2];
+
+    double const Δq_squared = Δq_x * Δq_x + Δq_y * Δq_y + Δq_z * Δq_z;
+    double const one_over_Δq_cubed =
+        std::sqrt(Δq_squared) / (Δq_squared * Δq_squared);
+
+    double const μ1_over_Δq_cubed = μ1 * one_over_Δq_cubed;
+    accelerations->x[b2] += Δq_x * μ1_over_Δq_cubed;
+    accelerations->y[b2] += Δq_y * μ1_over_Δq_cubed;
+    accelerations->z[b2] += Δq_z * μ1_over_Δq_cubed;
+
+    // Lex. III. Actioni contrariam semper & æqualem esse reactionem:
+    // sive corporum duorum actiones in se mutuo semper esse æquales &
+    // in partes contrarias dirigi.
+    double const μ2_over_Δq_cubed = μ2 * one_over_Δq_cubed;
+    acceleration1_x -= Δq_x * μ2_over_Δq_cubed;
+    acceleration1_y -= Δq_y * μ2_over_Δq_cubed;
+    acceleration1_z -= Δq_z * μ2_over_Δq_cubed;
+
+    if (body1_is_oblate || body2_is_oblate) {
+      double const one_over_Δq_squared = 1 / Δq_squared;
+      if (body1_is_oblate) {
+        accumulate_order_2_zonal_effect(b2,
+                                        bodies.axis_x[b1],
+                                        bodies.axis_y[b1],
+                                        bodies.axis_z[b1],
+                                        bodies.j2_over_μ[b1],
+                                        Δq_x, Δq_y, Δq_z,
+                                        one_over_Δq_squared,
+                                        one_over_Δq_cubed);
+      }
+      if (body2_is_oblate) {
+        accumulate_order_2_zonal_effect(b2,
+                                        bodies.axis_x[b2],
+                                        bodies.axis_y[b2],
+                                        bodies.axis_z[b2],
+                                        bodies.j2_over_μ[b2],
+                                        Δq_x, Δq_y, Δq_z,
+                                        one_over_Δq_squared,
+                                        one_over_Δq_cubed);
+      }
+    }
+  }
+
+  accelerations->x[b1] += acceleration1_x;
+  accelerations->y[b1] += acceleration1_y;
+  accelerations->z[b1] += acceleration1_z;
+}
+
+#if PRINCIPIA_USE_SSE2_INTRINSICS
+bool constexpr use_vectorized_kernel = true;
+#else
+bool constexpr use_vectorized_kernel = false;
+#endif
+
+// Calls the vectorized kernel if |vectorized| is true, the scalar one
+// otherwise.
+template<bool vectorized, bool body1_is_oblate, bool body2_is_oblate>
+FORCE_INLINE void
+ComputePackedGravitationalAccelerationByMassiveBodyOnMassiveBodies(
+    std::size_t const b1,
+    std::size_t const b2_begin,
+    std::size_t const b2_end,
+    PackedMassiveBodies const& bodies,
+    not_null<PackedAccelerations*> const accelerations) {
+#if PRINCIPIA_USE_SSE2_INTRINSICS
+  if (vectorized) {
+    ComputeVectorizedGravitationalAccelerationByMassiveBodyOnMassiveBodies<
+        body1_is_oblate,
+        body2_is_oblate>(b1, b2_begin, b2_end, bodies, accelerations);
+    return;
+  }
+#else
+  static_assert(!vectorized, "The vectorized kernel requires SSE2");
+#endif
+  ComputeScalarGravitationalAccelerationByMassiveBodyOnMassiveBodies<
+      body1_is_oblate,
+      body2_is_oblate>(b1, b2_begin, b2_end, bodies, accelerations);
+}
+
+// Computes the mutual accelerations of the bodies in [b1_begin, b1_end[ and of
+// the bodies that follow them, and adds them to |accelerations|.  The first
+// |number_of_oblate_bodies| bodies are oblate.  |vectorized| selects the
+// kernel; it is a parameter so that both kernels may be tested.
+template<bool vectorized>
+void ComputePackedGravitationalAccelerationsForRows(
+    std::size_t const number_of_oblate_bodies,
+    std::size_t const b1_begin,
+    std::size_t const b1_end,
+    PackedMassiveBodies const& bodies,
+    not_null<PackedAccelerations*> const accelerations) {
+  std::size_t const size = bodies.μ.size();
+  for (std::size_t b1 = b1_begin; b1 < b1_end; ++b1) {
+    if (b1 < number_of_oblate_bodies) {
+      ComputePackedGravitationalAccelerationByMassiveBodyOnMassiveBodies<
+          vectorized,
+          /*body1_is_oblate=*/true,
+          /*body2_is_oblate=*/true>(
+          b1,
+          /*b2_begin=*/b1 + 1,
+          /*b2_end=*/number_of_oblate_bodies,
+          bodies,
+          accelerations);
+      ComputePackedGravitationalAccelerationByMassiveBodyOnMassiveBodies<
+          vectorized,
+          /*body1_is_oblate=*/true,
+          /*body2_is_oblate=*/false>(
+          b1,
+          /*b2_begin=*/number_of_oblate_bodies,
+          /*b2_end=*/size,
+          bodies,
+          accelerations);
+    } else {
+      ComputePackedGravitationalAccelerationByMassiveBodyOnMassiveBodies<
+          vectorized,
+          /*body1_is_oblate=*/false,
+          /*body2_is_oblate=*/false>(
+          b1,
+          /*b2_begin=*/b1 + 1,
+          /*b2_end=*/size,
+          bodies,
+          accelerations);
+    }
+  }
+}
+
 // For mocking purposes.
 template<typename Frame>
 class DummyIntegrator
@@ -132,6 +535,12 @@ Speed Ephemeris<Frame>::AdaptiveStepParameters::speed_integration_tolerance()
   return speed_integration_tolerance_;
 }
 
+template<typename Frame>
+void Ephemeris<Frame>::AdaptiveStepParameters::set_max_steps(
+    std::int64_t const max_steps) {
+  max_steps_ = max_steps;
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::AdaptiveStepParameters::set_length_integration_tolerance(
     Length const& length_integration_tolerance) {
@@ -144,6 +553,21 @@ void Ephemeris<Frame>::AdaptiveStepParameters::set_speed_integration_tolerance(
   speed_integration_tolerance_ = speed_integration_tolerance;
 }
 
+template<typename Frame>
+bool Ephemeris<Frame>::AdaptiveStepParameters::operator==(
+    AdaptiveStepParameters const& right) const {
+  return integrator_ == right.integrator_ &&
+         max_steps_ == right.max_steps_ &&
+         length_integration_tolerance_ == right.length_integration_tolerance_ &&
+         speed_integration_tolerance_ == right.speed_integration_tolerance_;
+}
+
+template<typename Frame>
+bool Ephemeris<Frame>::AdaptiveStepParameters::operator!=(
+    AdaptiveStepParameters const& right) const {
+  return !(*this == right);
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::AdaptiveStepParameters::WriteToMessage(
     not_null<serialization::Ephemeris::AdaptiveStepParameters*> const message)
@@ -200,16 +624,42 @@ Ephemeris<Frame>::FixedStepParameters::ReadFromMessage(
       Time::ReadFromMessage(message.step()));
 }
 
+template<typename Frame>
+Ephemeris<Frame>::Events::Events(not_null<MassiveBody const*> const body)
+    : body(body) {}
+
+template<typename Frame>
+void Ephemeris<Frame>::Events::ForgetAfter(Instant const& time) {
+  apoapsides.ForgetAfter(time);
+  periapsides.ForgetAfter(time);
+  ascending_nodes.ForgetAfter(time);
+  descending_nodes.ForgetAfter(time);
+  impacts.ForgetAfter(time);
+  singularities.ForgetAfter(time);
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::Events::ForgetBefore(Instant const& time) {
+  apoapsides.ForgetBefore(time);
+  periapsides.ForgetBefore(time);
+  ascending_nodes.ForgetBefore(time);
+  descending_nodes.ForgetBefore(time);
+  impacts.ForgetBefore(time);
+  singularities.ForgetBefore(time);
+}
+
 template <typename Frame>
 Ephemeris<Frame>::Ephemeris(
     std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies,
     std::vector<DegreesOfFreedom<Frame>> const& initial_state,
     Instant const& initial_time,
     Length const& fitting_tolerance,
-    FixedStepParameters const& parameters)
+    FixedStepParameters const& parameters,
+    int const number_of_threads)
     : parameters_(parameters),
       fitting_tolerance_(fitting_tolerance) {
   CHECK(!bodies.empty());
+  CHECK_LE(0, number_of_threads);
   CHECK_EQ(bodies.size(), initial_state.size());
 
   last_state_.time = initial_time;
@@ -252,6 +702,24 @@ Ephemeris<Frame>::Ephemeris(
     }
   }
 
+  if (number_of_threads > 0) {
+    // Cut the triangle of the interactions into rows of tiles having roughly
+    // the same number of pairs of bodies.
+    std::int64_t const size = bodies_.size();
+    std::int64_t const total_pairs = size * (size - 1) / 2;
+    std::int64_t cumulated_pairs = 0;
+    tile_boundaries_.push_back(0);
+    for (std::int64_t b1 = 0; b1 < size; ++b1) {
+      cumulated_pairs += size - 1 - b1;
+      std::int64_t const tiles_so_far = tile_boundaries_.size();
+      if (cumulated_pairs * number_of_tiles >= total_pairs * tiles_so_far ||
+          b1 == size - 1) {
+        tile_boundaries_.push_back(b1 + 1);
+      }
+    }
+    thread_pool_ = std::make_unique<base::ThreadPool<void>>(number_of_threads);
+  }
+
   massive_bodies_equation_.compute_acceleration =
       std::bind(&Ephemeris::ComputeMassiveBodiesGravitationalAccelerations,
                 this, _1, _2, _3);
@@ -287,6 +755,7 @@ Instant Ephemeris<Frame>::t_min() const {
     auto const& trajectory = pair.second;
     t_min = std::max(t_min, trajectory->t_min());
   }
+  std::lock_guard<std::mutex> l(lock_);
   CHECK(checkpoints_.empty() ||
         checkpoints_.front().system_state.time.value >= t_min);
   return t_min;
@@ -313,6 +782,7 @@ Ephemeris<Frame>::planetary_integrator() const {
 
 template<typename Frame>
 void Ephemeris<Frame>::ForgetBefore(Instant const& t) {
+  std::lock_guard<std::mutex> l(lock_);
   auto it = std::upper_bound(
                 checkpoints_.begin(), checkpoints_.end(), t,
                 [](Instant const& left, Checkpoint const& right) {
@@ -327,16 +797,31 @@ void Ephemeris<Frame>::ForgetBefore(Instant const& t) {
     ContinuousTrajectory<Frame>& trajectory = *pair.second;
     trajectory.ForgetBefore(t);
   }
+  auto const subsystems_approximation =
+      std::atomic_load(&subsystems_approximation_);
+  if (subsystems_approximation != nullptr) {
+    for (Subsystem const& subsystem : subsystems_approximation->subsystems) {
+      subsystem.barycentre->ForgetBefore(t);
+    }
+  }
   checkpoints_.erase(checkpoints_.begin(), it);
 }
 
 template<typename Frame>
 void Ephemeris<Frame>::Prolong(Instant const& t) {
+  // Don't wait for a prolongation in progress if we already have what we need.
+  // This is the normal case when the ephemeris is prolonged ahead of time on
+  // another thread.
+  if (t_max() >= t) {
+    return;
+  }
+
   IntegrationProblem<NewtonianMotionEquation> problem;
   problem.equation = massive_bodies_equation_;
   problem.append_state =
       std::bind(&Ephemeris::AppendMassiveBodiesState, this, _1);
 
+  std::lock_guard<std::mutex> l(lock_);
   // Note that |t| may be before the last time that we integrated and still
   // after |t_max()|.  In this case we want to make sure that the integrator
   // makes progress.
@@ -359,6 +844,139 @@ void Ephemeris<Frame>::Prolong(Instant const& t) {
   }
 }
 
+template<typename Frame>
+void Ephemeris<Frame>::EnableSubsystemsApproximation(
+    std::map<not_null<MassiveBody const*>,
+             not_null<MassiveBody const*>> const& parents,
+    Acceleration const& tolerance) {
+  // The distance between a satellite and its primary is bounded by this
+  // multiple of the apoapsis of its osculating orbit, to account for the
+  // evolution of that orbit.
+  double const radius_margin = 1.5;
+
+  std::lock_guard<std::mutex> l(lock_);
+
+  std::map<not_null<MassiveBody const*>, int> bodies_indices;
+  for (int b = 0; b < bodies_.size(); ++b) {
+    bodies_indices.emplace(bodies_[b].get(), b);
+  }
+  std::vector<std::vector<int>> children(bodies_.size());
+  std::vector<bool> has_parent(bodies_.size(), false);
+  for (auto const& pair : parents) {
+    int const b = FindOrDie(bodies_indices, pair.first);
+    children[FindOrDie(bodies_indices, pair.second)].push_back(b);
+    has_parent[b] = true;
+  }
+
+  // Returns the apoapsis of the osculating orbit of |satellite| around
+  // |primary| in the last state, or infinity if the orbit is unbound.
+  auto const apoapsis = [this](int const primary, int const satellite) {
+    GravitationalParameter const μ =
+        bodies_[primary]->gravitational_parameter() +
+        bodies_[satellite]->gravitational_parameter();
+    Displacement<Frame> const r = last_state_.positions[satellite].value -
+                                  last_state_.positions[primary].value;
+    Velocity<Frame> const v = last_state_.velocities[satellite].value -
+                              last_state_.velocities[primary].value;
+    SpecificEnergy const ε = 0.5 * InnerProduct(v, v) - μ / r.Norm();
+    if (ε >= SpecificEnergy()) {
+      return std::numeric_limits<double>::infinity() * Metre;
+    }
+    auto const h = Wedge(r, v).Norm();
+    double const e = std::sqrt(std::max(0.0, 1 + 2 * ε * h * h / (μ * μ)));
+    return -μ / (2 * ε) * (1 + e);
+  };
+
+  // Fills the |satellites| of |subsystem| from the descendants of |b| and
+  // returns an upper bound of their distance to |b|.
+  std::function<Length(int const b, Subsystem& subsystem)> add_descendants =
+      [&add_descendants, &apoapsis, &children, radius_margin](
+          int const b, Subsystem& subsystem) {
+        Length distance;
+        for (int const child : children[b]) {
+          Subsystem child_subsystem;
+          Length const child_distance =
+              add_descendants(child, child_subsystem);
+          distance = std::max(
+              distance, radius_margin * apoapsis(b, child) + child_distance);
+          subsystem.satellites.push_back(child);
+          std::copy(child_subsystem.satellites.begin(),
+                    child_subsystem.satellites.end(),
+                    std::back_inserter(subsystem.satellites));
+        }
+        return distance;
+      };
+
+  auto subsystems_approximation = std::make_shared<SubsystemsApproximation>();
+  subsystems_approximation->tolerance = tolerance;
+
+  // Lists the subsystems in preorder, so that a subsystem precedes those
+  // nested in it.
+  std::function<void(int const b)> visit = [this,
+                                            &add_descendants,
+                                            &children,
+                                            &has_parent,
+                                            &subsystems_approximation,
+                                            &visit](int const b) {
+    if (has_parent[b] && !children[b].empty()) {
+      Subsystem subsystem;
+      subsystem.primary = b;
+      Length const distance = add_descendants(b, subsystem);
+      GravitationalParameter const primary_gravitational_parameter =
+          bodies_[b]->gravitational_parameter();
+      GravitationalParameter satellites_gravitational_parameter;
+      for (int const satellite : subsystem.satellites) {
+        satellites_gravitational_parameter +=
+            bodies_[satellite]->gravitational_parameter();
+      }
+      subsystem.gravitational_parameter =
+          primary_gravitational_parameter + satellites_gravitational_parameter;
+      subsystem.j2 = Order2ZonalCoefficient();
+      for (int const body : subsystem.satellites) {
+        if (body < number_of_oblate_bodies_) {
+          subsystem.j2 +=
+              Abs(static_cast<OblateBody<Frame> const&>(*bodies_[body]).j2());
+        }
+      }
+      if (b < number_of_oblate_bodies_) {
+        subsystem.j2 +=
+            Abs(static_cast<OblateBody<Frame> const&>(*bodies_[b]).j2());
+      }
+      if (distance < std::numeric_limits<double>::infinity() * Metre) {
+        // The barycentre is within |primary_distance| of the primary, and
+        // therefore within |radius| of the satellites.
+        Length const primary_distance = distance *
+                                        satellites_gravitational_parameter /
+                                        subsystem.gravitational_parameter;
+        subsystem.radius = distance + primary_distance;
+        subsystem.second_moment =
+            primary_gravitational_parameter * Pow<2>(primary_distance) +
+            satellites_gravitational_parameter * Pow<2>(subsystem.radius);
+        subsystem.barycentre = std::make_unique<ContinuousTrajectory<Frame>>(
+            parameters_.step_, fitting_tolerance_);
+        subsystem.barycentre->Append(
+            last_state_.time.value,
+            SubsystemBarycentre(subsystem, last_state_));
+        subsystems_approximation->subsystems.push_back(std::move(subsystem));
+      } else {
+        LOG(WARNING) << "Subsystem with primary " << b
+                     << " has unbound satellites and will not be approximated";
+      }
+    }
+    for (int const child : children[b]) {
+      visit(child);
+    }
+  };
+  for (int b = 0; b < bodies_.size(); ++b) {
+    if (!has_parent[b]) {
+      visit(b);
+    }
+  }
+  std::atomic_store(&subsystems_approximation_,
+                    std::shared_ptr<SubsystemsApproximation const>(
+                        std::move(subsystems_approximation)));
+}
+
 template<typename Frame>
 bool Ephemeris<Frame>::FlowWithAdaptiveStep(
     not_null<DiscreteTrajectory<Frame>*> const trajectory,
@@ -366,47 +984,165 @@ bool Ephemeris<Frame>::FlowWithAdaptiveStep(
     Instant const& t,
     AdaptiveStepParameters const& parameters,
     std::int64_t const max_ephemeris_steps) {
-  Instant const& trajectory_last_time = trajectory->last().time();
-  if (trajectory_last_time == t) {
-    return true;
-  }
+  return FlowWithAdaptiveStep(trajectory,
+                              std::move(intrinsic_acceleration),
+                              t,
+                              parameters,
+                              max_ephemeris_steps,
+                              /*events=*/{});
+}
 
+template<typename Frame>
+bool Ephemeris<Frame>::FlowWithAdaptiveStep(
+    not_null<DiscreteTrajectory<Frame>*> const trajectory,
+    IntrinsicAcceleration intrinsic_acceleration,
+    Instant const& t,
+    AdaptiveStepParameters const& parameters,
+    std::int64_t const max_ephemeris_steps,
+    std::vector<not_null<Events*>> const& events) {
   std::vector<not_null<DiscreteTrajectory<Frame>*>> const trajectories =
       {trajectory};
-  std::vector<IntrinsicAcceleration> const intrinsic_accelerations =
+  IntrinsicAccelerations const intrinsic_accelerations =
       {std::move(intrinsic_acceleration)};
-  // The |min| is here to prevent us from spending too much time computing the
-  // ephemeris.  The |max| is here to ensure that we always try to integrate
-  // forward.  We use |last_state_.time.value| because this is always finite,
-  // contrary to |t_max()|, which is -∞ when |empty()|.
-  Instant const t_final =
-      std::min(std::max(last_state_.time.value +
-                            max_ephemeris_steps * parameters_.step(),
-                        trajectory_last_time + parameters_.step()),
-               t);
-  Prolong(t_final);
-
-  std::vector<typename ContinuousTrajectory<Frame>::Hint> hints(bodies_.size());
+  std::vector<std::vector<not_null<Events*>>> const trajectories_events =
+      {events};
+  return FlowWithAdaptiveStep(trajectories,
+                              intrinsic_accelerations,
+                              t,
+                              parameters,
+                              max_ephemeris_steps,
+                              trajectories_events).front();
+}
+
+template<typename Frame>
+std::vector<bool> Ephemeris<Frame>::FlowWithAdaptiveStep(
+    std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+    IntrinsicAccelerations const& intrinsic_accelerations,
+    Instant const& t,
+    AdaptiveStepParameters const& parameters,
+    std::int64_t const max_ephemeris_steps,
+    std::vector<std::vector<not_null<Events*>>> const& events) {
+  CHECK(intrinsic_accelerations.empty() ||
+        intrinsic_accelerations.size() == trajectories.size());
+  CHECK(events.empty() || events.size() == trajectories.size());
+  std::vector<bool> reached_t(trajectories.size(), true);
+
+  // Compute the final time of each trajectory before prolonging the ephemeris,
+  // so that they don't depend on the order of the trajectories.  The |min| is
+  // here to prevent us from spending too much time computing the ephemeris.
+  // The |max| is here to ensure that we always try to integrate forward.  We
+  // use |last_state_.time.value| because this is always finite, contrary to
+  // |t_max()|, which is -∞ when |empty()|.
+  Instant const last_state_time = [this]() {
+    std::lock_guard<std::mutex> l(lock_);
+    return last_state_.time.value;
+  }();
+  std::vector<Instant> t_finals;
+  Instant latest_t_final = last_state_time;
+  for (auto const trajectory : trajectories) {
+    Instant const trajectory_last_time = trajectory->last().time();
+    t_finals.push_back(
+        std::min(std::max(last_state_time +
+                              max_ephemeris_steps * parameters_.step(),
+                          trajectory_last_time + parameters_.step()),
+                 t));
+    if (trajectory_last_time != t) {
+      latest_t_final = std::max(latest_t_final, t_finals.back());
+    }
+  }
+  Prolong(latest_t_final);
+
+  // In a batch, the trajectories that start and end at the same times have
+  // the same stages in their first step, at least until the step size
+  // controller rejects a step.  The pinned capacity is enough to remember the
+  // stages of a couple of attempts.
+  MassiveBodiesPositions massive_bodies_positions(
+      this, /*pinned_capacity=*/trajectories.size() == 1 ? 0 : 16);
+  for (int i = 0; i < trajectories.size(); ++i) {
+    not_null<DiscreteTrajectory<Frame>*> const trajectory = trajectories[i];
+    auto const trajectory_last = trajectory->last();
+    Instant const& trajectory_last_time = trajectory_last.time();
+    if (trajectory_last_time == t) {
+      continue;
+    }
+    Instant const& t_final = t_finals[i];
+    std::vector<not_null<DiscreteTrajectory<Frame>*>> const
+        trajectory_as_vector = {trajectory};
+    IntrinsicAccelerations const trajectory_intrinsic_accelerations =
+        {intrinsic_accelerations.empty() ? NoIntrinsicAcceleration
+                                         : intrinsic_accelerations[i]};
+    std::vector<not_null<Events*>> const trajectory_events =
+        events.empty() ? std::vector<not_null<Events*>>{} : events[i];
+    reached_t[i] = FlowWithAdaptiveStepUntil(trajectory_as_vector,
+                                             trajectory_intrinsic_accelerations,
+                                             t_final,
+                                             parameters,
+                                             trajectory_events,
+                                             &massive_bodies_positions) &&
+                   t_final == t;
+  }
+  return reached_t;
+}
+
+template<typename Frame>
+bool Ephemeris<Frame>::FlowWithAdaptiveStepUntil(
+    std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+    IntrinsicAccelerations const& intrinsic_accelerations,
+    Instant const& t_final,
+    AdaptiveStepParameters const& parameters,
+    std::vector<not_null<Events*>> const& events,
+    not_null<MassiveBodiesPositions*> const massive_bodies_positions) {
+  not_null<DiscreteTrajectory<Frame>*> const trajectory = trajectories.front();
+  auto const trajectory_last = trajectory->last();
+  Instant const& trajectory_last_time = trajectory_last.time();
+
+  // Keep the approximation alive for the duration of the flow, even if it is
+  // replaced in the meantime.
+  auto const subsystems_approximation =
+      std::atomic_load(&subsystems_approximation_);
+
   NewtonianMotionEquation massless_body_equation;
   massless_body_equation.compute_acceleration =
       std::bind(&Ephemeris::ComputeMasslessBodiesTotalAccelerations,
                 this,
-                std::cref(intrinsic_accelerations), _1, _2, _3, &hints);
+                std::cref(intrinsic_accelerations), _1, _2, _3,
+                massive_bodies_positions,
+                subsystems_approximation.get());
 
   typename NewtonianMotionEquation::SystemState initial_state;
-  auto const trajectory_last = trajectory->last();
   auto const last_degrees_of_freedom = trajectory_last.degrees_of_freedom();
-  initial_state.time = trajectory_last.time();
+  initial_state.time = trajectory_last_time;
   initial_state.positions.push_back(last_degrees_of_freedom.position());
   initial_state.velocities.push_back(last_degrees_of_freedom.velocity());
 
+  // The accelerations at the ends of each step are recorded in the trajectory,
+  // where they are used for interpolation.
+  std::vector<typename NewtonianMotionEquation::Acceleration>
+      previous_accelerations;
+  std::vector<typename NewtonianMotionEquation::Acceleration> accelerations;
+
   IntegrationProblem<NewtonianMotionEquation> problem;
   problem.equation = massless_body_equation;
+  problem.append_dense_output =
+      [&previous_accelerations, &accelerations](
+          typename NewtonianMotionEquation::DenseOutput const& dense_output) {
+        previous_accelerations = dense_output.accelerations0();
+        accelerations = dense_output.accelerations1();
+      };
   problem.append_state =
-      std::bind(&Ephemeris::AppendMasslessBodiesState,
-                _1, std::cref(trajectories));
+      std::bind(&Ephemeris::AppendMasslessBodiesStateWithAccelerations,
+                _1,
+                std::cref(previous_accelerations),
+                std::cref(accelerations),
+                std::cref(trajectories));
   problem.t_final = t_final;
   problem.initial_state = &initial_state;
+  for (not_null<Events*> const trajectory_events : events) {
+    auto const equation_events = MakeEvents(trajectory_events);
+    problem.events.insert(problem.events.end(),
+                          equation_events.begin(),
+                          equation_events.end());
+  }
 
   AdaptiveStepSize<NewtonianMotionEquation> step_size;
   step_size.first_time_step = problem.t_final - initial_state.time.value;
@@ -422,12 +1158,18 @@ bool Ephemeris<Frame>::FlowWithAdaptiveStep(
   step_size.max_steps = parameters.max_steps_;
 
   auto const outcome = parameters.integrator_->Solve(problem, step_size);
-  // TODO(egg): when we have events in trajectories, we should add a singularity
-  // event at the end if the outcome indicates a singularity
-  // (|VanishingStepSize|).  We should not have an event on the trajectory if
-  // |ReachedMaximalStepCount|, since that is not a physical property, but
-  // rather a self-imposed constraint.
-  return outcome == integrators::TerminationCondition::Done && t_final == t;
+  // A singularity is a property of the trajectory, so it is recorded as an
+  // event.  There is no event if the outcome is |ReachedMaximalStepCount|,
+  // since that is not a physical property, but rather a self-imposed
+  // constraint.
+  if (outcome == integrators::TerminationCondition::VanishingStepSize) {
+    auto const last = trajectory->last();
+    for (not_null<Events*> const trajectory_events : events) {
+      trajectory_events->singularities.Append(last.time(),
+                                              last.degrees_of_freedom());
+    }
+  }
+  return outcome == integrators::TerminationCondition::Done;
 }
 
 template<typename Frame>
@@ -441,12 +1183,14 @@ void Ephemeris<Frame>::FlowWithFixedStep(
     Prolong(t);
   }
 
-  std::vector<typename ContinuousTrajectory<Frame>::Hint> hints(bodies_.size());
+  MassiveBodiesPositions massive_bodies_positions(this, /*pinned_capacity=*/0);
   NewtonianMotionEquation massless_body_equation;
   massless_body_equation.compute_acceleration =
       std::bind(&Ephemeris::ComputeMasslessBodiesTotalAccelerations,
                 this,
-                std::cref(intrinsic_accelerations), _1, _2, _3, &hints);
+                std::cref(intrinsic_accelerations), _1, _2, _3,
+                &massive_bodies_positions,
+                /*subsystems_approximation=*/nullptr);
 
   typename NewtonianMotionEquation::SystemState initial_state;
   for (auto const& trajectory : trajectories) {
@@ -493,12 +1237,13 @@ ComputeGravitationalAccelerationOnMasslessBody(
     Position<Frame> const& position,
     Instant const& t) const {
   std::vector<Vector<Acceleration, Frame>> accelerations(1);
-  std::vector<typename ContinuousTrajectory<Frame>::Hint> hints(bodies_.size());
+  MassiveBodiesPositions massive_bodies_positions(this, /*pinned_capacity=*/0);
   ComputeMasslessBodiesGravitationalAccelerations(
       t,
       {position},
       &accelerations,
-      &hints);
+      &massive_bodies_positions,
+      /*subsystems_approximation=*/nullptr);
 
   return accelerations[0];
 }
@@ -592,10 +1337,8 @@ void Ephemeris<Frame>::ComputeApsides(
       trajectory(body);
   typename ContinuousTrajectory<Frame>::Hint hint;
 
-  std::experimental::optional<Instant> previous_time;
-  std::experimental::optional<DegreesOfFreedom<Frame>>
-      previous_degrees_of_freedom;
-  std::experimental::optional<Square<Length>> previous_squared_distance;
+  std::experimental::optional<typename DiscreteTrajectory<Frame>::Iterator>
+      previous_it;
   std::experimental::optional<Variation<Square<Length>>>
       previous_squared_distance_derivative;
 
@@ -606,68 +1349,35 @@ void Ephemeris<Frame>::ComputeApsides(
         body_trajectory->EvaluateDegreesOfFreedom(time, &hint);
     RelativeDegreesOfFreedom<Frame> const relative =
         degrees_of_freedom - body_degrees_of_freedom;
-    Square<Length> const squared_distance =
-        InnerProduct(relative.displacement(), relative.displacement());
-    // This is the derivative of |squared_distance|.
+    // This is the derivative of the squared distance.
     Variation<Square<Length>> const squared_distance_derivative =
         2.0 * InnerProduct(relative.displacement(), relative.velocity());
 
     if (previous_squared_distance_derivative &&
         Sign(squared_distance_derivative) !=
             Sign(*previous_squared_distance_derivative)) {
-      CHECK(previous_time &&
-            previous_degrees_of_freedom &&
-            previous_squared_distance);
-
-      // The derivative of |squared_distance| changed sign.  Construct a Hermite
-      // approximation of |squared_distance| and find its extrema.
-      Hermite3<Instant, Square<Length>> const
-          squared_distance_approximation(
-              {*previous_time, time},
-              {*previous_squared_distance, squared_distance},
-              {*previous_squared_distance_derivative,
-               squared_distance_derivative});
-      std::set<Instant> const extrema =
-          squared_distance_approximation.FindExtrema();
-
-      // Now look at the extrema and check that exactly one is in the required
-      // time interval.  This is normally the case, but it can fail due to
-      // ill-conditioning.
-      Instant apsis_time;
-      int valid_extrema = 0;
-      for (auto const& extremum : extrema) {
-        if (extremum >= *previous_time && extremum <= time) {
-          apsis_time = extremum;
-          ++valid_extrema;
-        }
-      }
-      if (valid_extrema != 1) {
-        // Something went wrong when finding the extrema of
-        // |squared_distance_approximation|. Use a linear interpolation of
-        // |squared_distance_derivative| instead.
-        apsis_time = Barycentre<Instant, Variation<Square<Length>>>(
-            {time, *previous_time},
-            {*previous_squared_distance_derivative,
-             -squared_distance_derivative});
-      }
-
-      // Now that we know the time of the apsis, construct a Hermite
-      // approximation of the position of the body, and use it to derive its
-      // degrees of freedom.  Note that an extremum of
-      // |squared_distance_approximation| is in general not an extremum for
-      // |position_approximation|: the distance computed using the latter is a
-      // 6th-degree polynomial.  However, approximating this polynomial using a
-      // 3rd-degree polynomial would yield |squared_distance_approximation|, so
-      // we shouldn't be far from the truth.
-      Hermite3<Instant, Position<Frame>> position_approximation(
-          {*previous_time, time},
-          {previous_degrees_of_freedom->position(),
-           degrees_of_freedom.position()},
-          {previous_degrees_of_freedom->velocity(),
-           degrees_of_freedom.velocity()});
-      DegreesOfFreedom<Frame> const apsis_degrees_of_freedom(
-          position_approximation.Evaluate(apsis_time),
-          position_approximation.EvaluateDerivative(apsis_time));
+      CHECK(previous_it);
+
+      // The derivative of the squared distance changed sign.  Find its zero
+      // along the interpolation of the trajectory by bisection, this is the
+      // time of the apsis.  The interpolation is of degree 5 if the
+      // accelerations were recorded by the integrator, of degree 3 otherwise.
+      auto const interpolated_squared_distance_derivative =
+          [body_trajectory, &hint, &it, &previous_it](
+              Instant const& t) -> Variation<Square<Length>> {
+        RelativeDegreesOfFreedom<Frame> const relative =
+            DiscreteTrajectory<Frame>::InterpolateDegreesOfFreedom(
+                *previous_it, it, t) -
+            body_trajectory->EvaluateDegreesOfFreedom(t, &hint);
+        return 2.0 * InnerProduct(relative.displacement(), relative.velocity());
+      };
+      Instant const apsis_time =
+          Bisect(interpolated_squared_distance_derivative,
+                 previous_it->time(),
+                 time);
+      DegreesOfFreedom<Frame> const apsis_degrees_of_freedom =
+          DiscreteTrajectory<Frame>::InterpolateDegreesOfFreedom(
+              *previous_it, it, apsis_time);
       if (Sign(squared_distance_derivative).Negative()) {
         apoapsides.Append(apsis_time, apsis_degrees_of_freedom);
       } else {
@@ -675,9 +1385,7 @@ void Ephemeris<Frame>::ComputeApsides(
       }
     }
 
-    previous_time = time;
-    previous_degrees_of_freedom = degrees_of_freedom;
-    previous_squared_distance = squared_distance;
+    previous_it = it;
     previous_squared_distance_derivative = squared_distance_derivative;
   }
 }
@@ -762,33 +1470,56 @@ template<typename Frame>
 void Ephemeris<Frame>::WriteToMessage(
     not_null<serialization::Ephemeris*> const message) const {
   LOG(INFO) << __FUNCTION__;
+  WriteToMessageInPieces(
+      [message](not_null<serialization::Ephemeris*> const piece) {
+        message->MergeFrom(*piece);
+      });
+  LOG(INFO) << NAMED(message->SpaceUsed());
+  LOG(INFO) << NAMED(message->ByteSize());
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::WriteToMessageInPieces(
+    PieceWriter const& write_piece) const {
+  // Only a snapshot of the state is taken under the lock, since |write_piece|
+  // may block.  The trajectories are thread-safe, so they are serialized
+  // outside of the lock, up to the snapshot.
+  bool has_t_max;
+  Instant t_max;
+  Checkpoint const checkpoint = [this, &has_t_max, &t_max]() {
+    std::lock_guard<std::mutex> l(lock_);
+    has_t_max = !checkpoints_.empty();
+    if (has_t_max) {
+      t_max = this->t_max();
+      return checkpoints_.front();
+    } else {
+      return GetCheckpoint();
+    }
+  }();
+  serialization::Ephemeris piece;
   // The bodies are serialized in the order in which they were given at
   // construction.
   for (auto const& unowned_body : unowned_bodies_) {
-    unowned_body->WriteToMessage(message->add_body());
+    unowned_body->WriteToMessage(piece.add_body());
   }
+  write_piece(&piece);
   // The trajectories are serialized in the order resulting from the separation
   // between oblate and spherical bodies.
-  if (checkpoints_.empty()) {
-    for (auto const& trajectory : trajectories_) {
-      trajectory->WriteToMessage(message->add_trajectory());
-    }
-    last_state_.WriteToMessage(message->mutable_last_state());
-  } else {
-    auto const& checkpoints = checkpoints_.front().checkpoints;
-    CHECK_EQ(trajectories_.size(), checkpoints.size());
-    for (int i = 0; i < trajectories_.size(); ++i) {
-      trajectories_[i]->WriteToMessage(message->add_trajectory(),
-                                       checkpoints[i]);
-    }
-    checkpoints_.front().system_state.WriteToMessage(
-        message->mutable_last_state());
-    t_max().WriteToMessage(message->mutable_t_max());
+  CHECK_EQ(trajectories_.size(), checkpoint.checkpoints.size());
+  for (int i = 0; i < trajectories_.size(); ++i) {
+    piece.Clear();
+    trajectories_[i]->WriteToMessage(piece.add_trajectory(),
+                                     checkpoint.checkpoints[i]);
+    write_piece(&piece);
   }
-  parameters_.WriteToMessage(message->mutable_fixed_step_parameters());
-  fitting_tolerance_.WriteToMessage(message->mutable_fitting_tolerance());
-  LOG(INFO) << NAMED(message->SpaceUsed());
-  LOG(INFO) << NAMED(message->ByteSize());
+  piece.Clear();
+  checkpoint.system_state.WriteToMessage(piece.mutable_last_state());
+  if (has_t_max) {
+    t_max.WriteToMessage(piece.mutable_t_max());
+  }
+  parameters_.WriteToMessage(piece.mutable_fixed_step_parameters());
+  fitting_tolerance_.WriteToMessage(piece.mutable_fitting_tolerance());
+  write_piece(&piece);
 }
 
 template<typename Frame>
@@ -941,6 +1672,82 @@ template <typename Frame>
 Ephemeris<Frame>::Ephemeris()
     : parameters_(DummyIntegrator<Frame>::Instance(), 1 * Second) {}
 
+template<typename Frame>
+Ephemeris<Frame>::MassiveBodiesPositions::MassiveBodiesPositions(
+    not_null<Ephemeris const*> const ephemeris,
+    int const pinned_capacity)
+    : ephemeris_(ephemeris),
+      pinned_capacity_(pinned_capacity),
+      hints_(ephemeris->bodies_.size()) {
+  CHECK_LE(0, pinned_capacity_);
+  pinned_.reserve(pinned_capacity_);
+}
+
+template<typename Frame>
+std::vector<Position<Frame>> const&
+Ephemeris<Frame>::MassiveBodiesPositions::Evaluate(Instant const& t) {
+  Entry& entry = FindOrInsert(t);
+  for (int b = 0; b < ephemeris_->trajectories_.size(); ++b) {
+    if (!entry.evaluated[b]) {
+      entry.positions[b] =
+          ephemeris_->trajectories_[b]->EvaluatePosition(t, &hints_[b]);
+      entry.evaluated[b] = true;
+    }
+  }
+  return entry.positions;
+}
+
+template<typename Frame>
+Position<Frame> const&
+Ephemeris<Frame>::MassiveBodiesPositions::EvaluatePosition(Instant const& t,
+                                                           int const b) {
+  Entry& entry = FindOrInsert(t);
+  if (!entry.evaluated[b]) {
+    entry.positions[b] =
+        ephemeris_->trajectories_[b]->EvaluatePosition(t, &hints_[b]);
+    entry.evaluated[b] = true;
+  }
+  return entry.positions[b];
+}
+
+template<typename Frame>
+typename Ephemeris<Frame>::MassiveBodiesPositions::Entry&
+Ephemeris<Frame>::MassiveBodiesPositions::FindOrInsert(Instant const& t) {
+  if (last_ != nullptr && last_->time == t) {
+    return *last_;
+  }
+  for (Entry& entry : pinned_) {
+    if (entry.time == t) {
+      last_ = &entry;
+      return entry;
+    }
+  }
+
+  Entry* entry = &latest_;
+  if (pinned_.size() < pinned_capacity_) {
+    pinned_.emplace_back();
+    entry = &pinned_.back();
+  }
+  std::size_t const size = ephemeris_->trajectories_.size();
+  entry->time = t;
+  entry->positions.resize(size);
+  entry->evaluated.assign(size, false);
+  last_ = entry;
+  return *entry;
+}
+
+template<typename Frame>
+Acceleration Ephemeris<Frame>::Subsystem::ApproximationError(
+    Length const& ρ) const {
+  // Moving the bodies to the barycentre leaves the monopole and the dipole of
+  // the subsystem unchanged.  By Taylor's theorem, the error is bounded by
+  // half the norm of the third derivative of the potential, 6 μ / ρ⁴, times
+  // the squared distance to the barycentre, summed over the bodies.  The
+  // order 2 zonal effects, which we ignore, are bounded by 9 |j2| / ρ⁴.
+  Square<Length> const ρ² = ρ * ρ;
+  return (3 * second_moment + 9 * j2) / (ρ² * ρ²);
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::AppendMassiveBodiesState(
     typename NewtonianMotionEquation::SystemState const& state) {
@@ -953,6 +1760,14 @@ void Ephemeris<Frame>::AppendMassiveBodiesState(
                                 state.velocities[index].value));
     ++index;
   }
+  auto const subsystems_approximation =
+      std::atomic_load(&subsystems_approximation_);
+  if (subsystems_approximation != nullptr) {
+    for (Subsystem const& subsystem : subsystems_approximation->subsystems) {
+      subsystem.barycentre->Append(state.time.value,
+                                   SubsystemBarycentre(subsystem, state));
+    }
+  }
 
   // Record an intermediate state if we haven't done so for too long.
   CHECK(!trajectories_.empty());
@@ -965,6 +1780,24 @@ void Ephemeris<Frame>::AppendMassiveBodiesState(
   }
 }
 
+template<typename Frame>
+DegreesOfFreedom<Frame> Ephemeris<Frame>::SubsystemBarycentre(
+    Subsystem const& subsystem,
+    typename NewtonianMotionEquation::SystemState const& state) const {
+  BarycentreCalculator<DegreesOfFreedom<Frame>, GravitationalParameter>
+      calculator;
+  calculator.Add(DegreesOfFreedom<Frame>(
+                     state.positions[subsystem.primary].value,
+                     state.velocities[subsystem.primary].value),
+                 bodies_[subsystem.primary]->gravitational_parameter());
+  for (int const satellite : subsystem.satellites) {
+    calculator.Add(DegreesOfFreedom<Frame>(state.positions[satellite].value,
+                                           state.velocities[satellite].value),
+                   bodies_[satellite]->gravitational_parameter());
+  }
+  return calculator.Get();
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::AppendMasslessBodiesState(
     typename NewtonianMotionEquation::SystemState const& state,
@@ -980,7 +1813,126 @@ void Ephemeris<Frame>::AppendMasslessBodiesState(
 }
 
 template<typename Frame>
-typename Ephemeris<Frame>::Checkpoint Ephemeris<Frame>::GetCheckpoint() {
+void Ephemeris<Frame>::AppendMasslessBodiesStateWithAccelerations(
+    typename NewtonianMotionEquation::SystemState const& state,
+    std::vector<typename NewtonianMotionEquation::Acceleration> const&
+        previous_accelerations,
+    std::vector<typename NewtonianMotionEquation::Acceleration> const&
+        accelerations,
+    std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories) {
+  int index = 0;
+  for (auto& trajectory : trajectories) {
+    trajectory->Append(
+        state.time.value,
+        DegreesOfFreedom<Frame>(state.positions[index].value,
+                                state.velocities[index].value),
+        previous_accelerations[index],
+        accelerations[index]);
+    ++index;
+  }
+}
+
+template<typename Frame>
+std::vector<typename Ephemeris<Frame>::NewtonianMotionEquation::Event>
+Ephemeris<Frame>::MakeEvents(not_null<Events*> const events) const {
+  using Event = typename NewtonianMotionEquation::Event;
+  using Positions = std::vector<Position<Frame>>;
+  using Velocities = std::vector<Velocity<Frame>>;
+
+  not_null<ContinuousTrajectory<Frame> const*> const body_trajectory =
+      trajectory(events->body);
+  // The hint is shared by the functions of the events, which are evaluated at
+  // nearby times.
+  auto const hint =
+      std::make_shared<typename ContinuousTrajectory<Frame>::Hint>();
+
+  std::vector<Event> result;
+
+  // The apsides are the zeros of the derivative of the squared distance.
+  Event apsides;
+  apsides.function = [body_trajectory, hint](Instant const& t,
+                                             Positions const& positions,
+                                             Velocities const& velocities) {
+    RelativeDegreesOfFreedom<Frame> const relative =
+        DegreesOfFreedom<Frame>(positions[0], velocities[0]) -
+        body_trajectory->EvaluateDegreesOfFreedom(t, hint.get());
+    return InnerProduct(relative.displacement(), relative.velocity()) /
+           SIUnit<Variation<Square<Length>>>();
+  };
+  apsides.on_event = [events](Instant const& t,
+                              Positions const& positions,
+                              Velocities const& velocities,
+                              Sign const& sign) {
+    DegreesOfFreedom<Frame> const degrees_of_freedom(positions[0],
+                                                     velocities[0]);
+    if (sign.Negative()) {
+      events->apoapsides.Append(t, degrees_of_freedom);
+    } else {
+      events->periapsides.Append(t, degrees_of_freedom);
+    }
+  };
+  result.push_back(apsides);
+
+  auto const rotating_body =
+      dynamic_cast<RotatingBody<Frame> const*>(&*events->body);
+  if (rotating_body != nullptr) {
+    AngularVelocity<Frame> const& angular_velocity =
+        rotating_body->angular_velocity();
+    Vector<double, Frame> const polar_axis(angular_velocity.coordinates() /
+                                           angular_velocity.Norm());
+    Event nodes;
+    nodes.function = [body_trajectory, hint, polar_axis](
+                         Instant const& t,
+                         Positions const& positions,
+                         Velocities const& velocities) {
+      Displacement<Frame> const displacement =
+          positions[0] - body_trajectory->EvaluatePosition(t, hint.get());
+      return InnerProduct(displacement, polar_axis) / SIUnit<Length>();
+    };
+    nodes.on_event = [events](Instant const& t,
+                              Positions const& positions,
+                              Velocities const& velocities,
+                              Sign const& sign) {
+      DegreesOfFreedom<Frame> const degrees_of_freedom(positions[0],
+                                                       velocities[0]);
+      if (sign.Positive()) {
+        events->ascending_nodes.Append(t, degrees_of_freedom);
+      } else {
+        events->descending_nodes.Append(t, degrees_of_freedom);
+      }
+    };
+    result.push_back(nodes);
+  }
+
+  // Point masses have a zero radius and cannot be hit.
+  Length const mean_radius = events->body->mean_radius();
+  if (mean_radius > Length()) {
+    Event impacts;
+    impacts.function = [body_trajectory, hint, mean_radius](
+                           Instant const& t,
+                           Positions const& positions,
+                           Velocities const& velocities) {
+      Displacement<Frame> const displacement =
+          positions[0] - body_trajectory->EvaluatePosition(t, hint.get());
+      return (displacement.Norm() - mean_radius) / SIUnit<Length>();
+    };
+    impacts.on_event = [events](Instant const& t,
+                                Positions const& positions,
+                                Velocities const& velocities,
+                                Sign const& sign) {
+      if (sign.Negative()) {
+        events->impacts.Append(
+            t, DegreesOfFreedom<Frame>(positions[0], velocities[0]));
+      }
+    };
+    result.push_back(impacts);
+  }
+
+  return result;
+}
+
+template<typename Frame>
+typename Ephemeris<Frame>::Checkpoint Ephemeris<Frame>::GetCheckpoint() const {
   std::vector<typename ContinuousTrajectory<Frame>::Checkpoint> checkpoints;
   for (auto const& trajectory : trajectories_) {
     checkpoints.push_back(trajectory->GetCheckpoint());
@@ -1061,15 +2013,11 @@ template<typename Frame>
 template<bool body1_is_oblate>
 void Ephemeris<Frame>::
 ComputeGravitationalAccelerationByMassiveBodyOnMasslessBodies(
-    Instant const& t,
     MassiveBody const& body1,
-    size_t const b1,
+    Position<Frame> const& position1,
     std::vector<Position<Frame>> const& positions,
-    not_null<std::vector<Vector<Acceleration, Frame>>*> const accelerations,
-    not_null<typename ContinuousTrajectory<Frame>::Hint*> const hint1) const {
+    not_null<std::vector<Vector<Acceleration, Frame>>*> const accelerations) {
   GravitationalParameter const& μ1 = body1.gravitational_parameter();
-  Position<Frame> const position1 =
-      trajectories_[b1]->EvaluatePosition(t, hint1);
 
   for (size_t b2 = 0; b2 < positions.size(); ++b2) {
     Displacement<Frame> const Δq = position1 - positions[b2];
@@ -1098,49 +2046,134 @@ ComputeGravitationalAccelerationByMassiveBodyOnMasslessBodies(
   }
 }
 
+template<typename Frame>
+template<bool body1_is_oblate>
+Vector<Acceleration, Frame> Ephemeris<Frame>::
+ComputeGravitationalAccelerationByMassiveBodyOnMasslessBody(
+    MassiveBody const& body1,
+    GravitationalParameter const& μ1,
+    Position<Frame> const& position1,
+    Position<Frame> const& position2) {
+  Displacement<Frame> const Δq = position1 - position2;
+
+  Square<Length> const Δq_squared = InnerProduct(Δq, Δq);
+  Exponentiation<Length, -3> const one_over_Δq_cubed =
+      Sqrt(Δq_squared) / (Δq_squared * Δq_squared);
+
+  Vector<Acceleration, Frame> acceleration = Δq * (μ1 * one_over_Δq_cubed);
+
+  if (body1_is_oblate) {
+    Exponentiation<Length, -2> const one_over_Δq_squared = 1 / Δq_squared;
+    Vector<Quotient<Acceleration,
+                    GravitationalParameter>, Frame> const
+        order_2_zonal_effect1 =
+            Order2ZonalEffect<Frame>(
+                static_cast<OblateBody<Frame> const &>(body1),
+                Δq,
+                one_over_Δq_squared,
+                one_over_Δq_cubed);
+    acceleration += body1.gravitational_parameter() * order_2_zonal_effect1;
+  }
+  return acceleration;
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::ComputeMassiveBodiesGravitationalAccelerations(
     Instant const& t,
     std::vector<Position<Frame>> const& positions,
     not_null<std::vector<Vector<Acceleration, Frame>>*> const
         accelerations) const {
-  accelerations->assign(accelerations->size(), Vector<Acceleration, Frame>());
+  // The buffers are thread-local to avoid allocating them for each evaluation
+  // while allowing concurrent evaluations.
+  thread_local PackedMassiveBodies packed_bodies;
+  thread_local std::vector<PackedAccelerations> packed_accelerations;
+  std::size_t const size = bodies_.size();
+  packed_bodies.x.resize(size);
+  packed_bodies.y.resize(size);
+  packed_bodies.z.resize(size);
+  packed_bodies.μ.resize(size);
+  packed_bodies.axis_x.resize(size);
+  packed_bodies.axis_y.resize(size);
+  packed_bodies.axis_z.resize(size);
+  packed_bodies.j2_over_μ.resize(size);
+  for (std::size_t b = 0; b < size; ++b) {
+    Displacement<Frame> const q = positions[b] - Frame::origin;
+    packed_bodies.x[b] = q.coordinates().x / SIUnit<Length>();
+    packed_bodies.y[b] = q.coordinates().y / SIUnit<Length>();
+    packed_bodies.z[b] = q.coordinates().z / SIUnit<Length>();
+    packed_bodies.μ[b] = bodies_[b]->gravitational_parameter() /
+                         SIUnit<GravitationalParameter>();
+    if (b < number_of_oblate_bodies_) {
+      auto const& body = static_cast<OblateBody<Frame> const&>(*bodies_[b]);
+      R3Element<double> const& axis = body.axis().coordinates();
+      packed_bodies.axis_x[b] = axis.x;
+      packed_bodies.axis_y[b] = axis.y;
+      packed_bodies.axis_z[b] = axis.z;
+      packed_bodies.j2_over_μ[b] =
+          body.j2_over_μ() / SIUnit<Quotient<Order2ZonalCoefficient,
+                                             GravitationalParameter>>();
+    }
+  }
 
-  for (std::size_t b1 = 0; b1 < number_of_oblate_bodies_; ++b1) {
-    MassiveBody const& body1 = *bodies_[b1];
-    ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies<
-        /*body1_is_oblate=*/true,
-        /*body2_is_oblate=*/true>(
-        body1, b1,
-        /*bodies2=*/bodies_,
-        /*b2_begin=*/b1 + 1,
-        /*b2_end=*/number_of_oblate_bodies_,
-        positions,
-        accelerations);
-    ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies<
-        /*body1_is_oblate=*/true,
-        /*body2_is_oblate=*/false>(
-        body1, b1,
-        /*bodies2=*/bodies_,
-        /*b2_begin=*/number_of_oblate_bodies_,
-        /*b2_end=*/number_of_oblate_bodies_ + number_of_spherical_bodies_,
-        positions,
-        accelerations);
+  // In the sequential case there is a single tile covering all the bodies.
+  std::size_t const tiles =
+      thread_pool_ == nullptr ? 1 : tile_boundaries_.size() - 1;
+  packed_accelerations.resize(tiles);
+  for (auto& tile_accelerations : packed_accelerations) {
+    tile_accelerations.x.assign(size, 0);
+    tile_accelerations.y.assign(size, 0);
+    tile_accelerations.z.assign(size, 0);
   }
-  for (std::size_t b1 = number_of_oblate_bodies_;
-       b1 < number_of_oblate_bodies_ +
-            number_of_spherical_bodies_;
-       ++b1) {
-    MassiveBody const& body1 = *bodies_[b1];
-    ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies<
-        /*body1_is_oblate=*/false,
-        /*body2_is_oblate=*/false>(
-        body1, b1,
-        /*bodies2=*/bodies_,
-        /*b2_begin=*/b1 + 1,
-        /*b2_end=*/number_of_oblate_bodies_ + number_of_spherical_bodies_,
-        positions,
-        accelerations);
+
+  if (thread_pool_ == nullptr) {
+    ComputePackedGravitationalAccelerationsForRows<use_vectorized_kernel>(
+        number_of_oblate_bodies_,
+        /*b1_begin=*/0,
+        /*b1_end=*/size,
+        packed_bodies,
+        &packed_accelerations[0]);
+  } else {
+    // Each tile accumulates in its own buffer, so the tiles may be computed
+    // in any order on any thread.  Note that the lambdas must not name the
+    // thread-local buffers, as they would designate those of the thread
+    // executing them.
+    PackedMassiveBodies const* const bodies = &packed_bodies;
+    std::vector<std::future<void>> futures;
+    futures.reserve(tiles);
+    for (std::size_t i = 0; i < tiles; ++i) {
+      PackedAccelerations* const tile_accelerations = &packed_accelerations[i];
+      std::size_t const b1_begin = tile_boundaries_[i];
+      std::size_t const b1_end = tile_boundaries_[i + 1];
+      futures.push_back(thread_pool_->Add(
+          [this, bodies, b1_begin, b1_end, tile_accelerations]() {
+            ComputePackedGravitationalAccelerationsForRows<
+                use_vectorized_kernel>(
+                number_of_oblate_bodies_,
+                b1_begin,
+                b1_end,
+                *bodies,
+                tile_accelerations);
+          }));
+    }
+    for (auto& future : futures) {
+      future.wait();
+    }
+    // The reduction is done in the order of the tiles, so that it is
+    // deterministic.
+    for (std::size_t i = 1; i < tiles; ++i) {
+      for (std::size_t b = 0; b < size; ++b) {
+        packed_accelerations[0].x[b] += packed_accelerations[i].x[b];
+        packed_accelerations[0].y[b] += packed_accelerations[i].y[b];
+        packed_accelerations[0].z[b] += packed_accelerations[i].z[b];
+      }
+    }
+  }
+
+  for (std::size_t b = 0; b < size; ++b) {
+    (*accelerations)[b] = Vector<Acceleration, Frame>(
+        {packed_accelerations[0].x[b] * SIUnit<Acceleration>(),
+         packed_accelerations[0].y[b] * SIUnit<Acceleration>(),
+         packed_accelerations[0].z[b] * SIUnit<Acceleration>()});
   }
 }
 
@@ -1149,20 +2182,87 @@ void Ephemeris<Frame>::ComputeMasslessBodiesGravitationalAccelerations(
       Instant const& t,
       std::vector<Position<Frame>> const& positions,
       not_null<std::vector<Vector<Acceleration, Frame>>*> const accelerations,
-      not_null<std::vector<typename ContinuousTrajectory<Frame>::Hint>*>
-          const hints) const {
+      not_null<MassiveBodiesPositions*> const massive_bodies_positions,
+      SubsystemsApproximation const* const subsystems_approximation) const {
   CHECK_EQ(positions.size(), accelerations->size());
   accelerations->assign(accelerations->size(), Vector<Acceleration, Frame>());
 
+  if (subsystems_approximation != nullptr &&
+      !subsystems_approximation->subsystems.empty()) {
+    std::vector<Subsystem> const& subsystems =
+        subsystems_approximation->subsystems;
+    // The errors of the approximated subsystems add up.
+    Acceleration const tolerance =
+        subsystems_approximation->tolerance / subsystems.size();
+    // |approximated[b1]| is true if the body with index |b1| belongs to a
+    // subsystem seen as a point mass from the current massless body.
+    thread_local std::vector<bool> approximated;
+    for (std::size_t b2 = 0; b2 < positions.size(); ++b2) {
+      Position<Frame> const& position2 = positions[b2];
+      Vector<Acceleration, Frame>& acceleration = (*accelerations)[b2];
+      approximated.assign(bodies_.size(), false);
+      for (Subsystem const& subsystem : subsystems) {
+        int const b1 = subsystem.primary;
+        ContinuousTrajectory<Frame> const& barycentre = *subsystem.barycentre;
+        if (approximated[b1] || t < barycentre.t_min() ||
+            t > barycentre.t_max()) {
+          // Nested in a subsystem that is already approximated, or at a time
+          // where the barycentre is unknown.
+          continue;
+        }
+        Position<Frame> const barycentre_position =
+            barycentre.EvaluatePosition(t, /*hint=*/nullptr);
+        Length const ρ =
+            (barycentre_position - position2).Norm() - subsystem.radius;
+        if (ρ <= Length() || subsystem.ApproximationError(ρ) > tolerance) {
+          continue;
+        }
+        acceleration +=
+            ComputeGravitationalAccelerationByMassiveBodyOnMasslessBody<
+                /*body1_is_oblate=*/false>(*bodies_[b1],
+                                           subsystem.gravitational_parameter,
+                                           barycentre_position,
+                                           position2);
+        approximated[b1] = true;
+        for (int const satellite : subsystem.satellites) {
+          approximated[satellite] = true;
+        }
+      }
+      for (std::size_t b1 = 0; b1 < bodies_.size(); ++b1) {
+        if (approximated[b1]) {
+          continue;
+        }
+        MassiveBody const& body1 = *bodies_[b1];
+        Position<Frame> const& position1 =
+            massive_bodies_positions->EvaluatePosition(t, b1);
+        if (b1 < number_of_oblate_bodies_) {
+          acceleration +=
+              ComputeGravitationalAccelerationByMassiveBodyOnMasslessBody<
+                  /*body1_is_oblate=*/true>(
+                  body1, body1.gravitational_parameter(),
+                  position1, position2);
+        } else {
+          acceleration +=
+              ComputeGravitationalAccelerationByMassiveBodyOnMasslessBody<
+                  /*body1_is_oblate=*/false>(
+                  body1, body1.gravitational_parameter(),
+                  position1, position2);
+        }
+      }
+    }
+    return;
+  }
+
+  std::vector<Position<Frame>> const& positions1 =
+      massive_bodies_positions->Evaluate(t);
+
   for (std::size_t b1 = 0; b1 < number_of_oblate_bodies_; ++b1) {
     MassiveBody const& body1 = *bodies_[b1];
     ComputeGravitationalAccelerationByMassiveBodyOnMasslessBodies<
         /*body1_is_oblate=*/true>(
-        t,
-        body1, b1,
+        body1, positions1[b1],
         positions,
-        accelerations,
-        &(*hints)[b1]);
+        accelerations);
   }
   for (std::size_t b1 = number_of_oblate_bodies_;
        b1 < number_of_oblate_bodies_ +
@@ -1171,11 +2271,9 @@ void Ephemeris<Frame>::ComputeMasslessBodiesGravitationalAccelerations(
     MassiveBody const& body1 = *bodies_[b1];
     ComputeGravitationalAccelerationByMassiveBodyOnMasslessBodies<
         /*body1_is_oblate=*/false>(
-        t,
-        body1, b1,
+        body1, positions1[b1],
         positions,
-        accelerations,
-        &(*hints)[b1]);
+        accelerations);
   }
 }
 
@@ -1185,12 +2283,15 @@ void Ephemeris<Frame>::ComputeMasslessBodiesTotalAccelerations(
     Instant const& t,
     std::vector<Position<Frame>> const& positions,
     not_null<std::vector<Vector<Acceleration, Frame>>*> const accelerations,
-    not_null<std::vector<typename ContinuousTrajectory<Frame>::Hint>*>
-        const hints) const {
+    not_null<MassiveBodiesPositions*> const massive_bodies_positions,
+    SubsystemsApproximation const* const subsystems_approximation) const {
   // First, the acceleration due to the gravitational field of the
   // massive bodies.
-  ComputeMasslessBodiesGravitationalAccelerations(
-      t, positions, accelerations, hints);
+  ComputeMasslessBodiesGravitationalAccelerations(t,
+                                                  positions,
+                                                  accelerations,
+                                                  massive_bodies_positions,
+                                                  subsystems_approximation);
 
   // Then, the intrinsic accelerations, if any.
   if (!intrinsic_accelerations.empty()) {
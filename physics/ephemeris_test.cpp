@@ -1,9 +1,12 @@
 ﻿
 #include "physics/ephemeris.hpp"
 
+#include <atomic>
 #include <limits>
 #include <map>
 #include <set>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "astronomy/frames.hpp"
@@ -51,6 +54,7 @@ using quantities::astronomy::LunarDistance;
 using quantities::astronomy::SolarMass;
 using quantities::constants::GravitationalConstant;
 using quantities::si::AstronomicalUnit;
+using quantities::si::Day;
 using quantities::si::Kilo;
 using quantities::si::Kilogram;
 using quantities::si::Metre;
@@ -63,7 +67,9 @@ using testing_utilities::AbsoluteError;
 using testing_utilities::RelativeError;
 using testing_utilities::SolarSystemFactory;
 using testing_utilities::VanishesBefore;
+using ::testing::AllOf;
 using ::testing::AnyOf;
+using ::testing::Each;
 using ::testing::Eq;
 using ::testing::Gt;
 using ::testing::Lt;
@@ -145,6 +151,73 @@ class EphemerisTest : public testing::Test {
     initial_state->emplace_back(q2, v2);
   }
 
+  // Returns the degrees of freedom of a probe flowed for one day in flows of
+  // |flow_duration|.  The probe is far enough from the Earth-Moon system that
+  // only the distant planetary systems may be approximated.  The approximation
+  // is not enabled if |approximation_tolerance| is zero.
+  DegreesOfFreedom<ICRFJ2000Equator> FlowDistantProbe(
+      Acceleration const& approximation_tolerance,
+      Time const& flow_duration) {
+    auto const at_спутник_1_launch =
+        SolarSystemFactory::AtСпутник1Launch(
+            SolarSystemFactory::Accuracy::AllBodiesAndOblateness);
+    Instant const t_initial = at_спутник_1_launch->epoch();
+    Instant const t_final = t_initial + 1 * Day;
+    auto const ephemeris =
+        at_спутник_1_launch->MakeEphemeris(
+            /*fitting_tolerance=*/5 * Milli(Metre),
+            Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+                McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+                /*step=*/45 * Minute));
+    if (approximation_tolerance != Acceleration()) {
+      std::map<not_null<MassiveBody const*>, not_null<MassiveBody const*>>
+          parents;
+      for (int i = SolarSystemFactory::Sun + 1;
+           i <= SolarSystemFactory::LastBody;
+           ++i) {
+        parents.emplace(
+            at_спутник_1_launch->massive_body(*ephemeris,
+                                              SolarSystemFactory::name(i)),
+            at_спутник_1_launch->massive_body(
+                *ephemeris,
+                SolarSystemFactory::name(SolarSystemFactory::parent(i))));
+      }
+      ephemeris->EnableSubsystemsApproximation(parents,
+                                               approximation_tolerance);
+    }
+
+    DegreesOfFreedom<ICRFJ2000Equator> const earth_degrees_of_freedom =
+        at_спутник_1_launch->initial_state(
+            SolarSystemFactory::name(SolarSystemFactory::Earth));
+    DiscreteTrajectory<ICRFJ2000Equator> trajectory;
+    trajectory.Append(
+        t_initial,
+        DegreesOfFreedom<ICRFJ2000Equator>(
+            earth_degrees_of_freedom.position() +
+                Displacement<ICRFJ2000Equator>(
+                    {0 * Metre, 2e9 * Metre, 0 * Metre}),
+            earth_degrees_of_freedom.velocity() +
+                Velocity<ICRFJ2000Equator>({1 * Kilo(Metre) / Second,
+                                            0 * Metre / Second,
+                                            0 * Metre / Second})));
+    for (Instant t = t_initial + flow_duration;
+         t <= t_final;
+         t += flow_duration) {
+      EXPECT_TRUE(ephemeris->FlowWithAdaptiveStep(
+          &trajectory,
+          Ephemeris<ICRFJ2000Equator>::NoIntrinsicAcceleration,
+          t,
+          Ephemeris<ICRFJ2000Equator>::AdaptiveStepParameters(
+              DormandElMikkawyPrince1986RKN434FM<Position<ICRFJ2000Equator>>(),
+              max_steps,
+              /*length_integration_tolerance=*/1 * Metre,
+              /*speed_integration_tolerance=*/1 * Milli(Metre) / Second),
+          Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps));
+    }
+    EXPECT_EQ(t_final, trajectory.last().time());
+    return trajectory.last().degrees_of_freedom();
+  }
+
   SolarSystem<ICRFJ2000Equator> solar_system_;
   Instant t0_;
 };
@@ -190,6 +263,35 @@ TEST_F(EphemerisTest, ProlongSpecialCases) {
   EXPECT_EQ(t_max, ephemeris.t_max());
 }
 
+TEST_F(EphemerisTest, AdaptiveStepParametersEquality) {
+  using AdaptiveStepParameters =
+      Ephemeris<ICRFJ2000Equator>::AdaptiveStepParameters;
+  AdaptiveStepParameters const parameters(
+      DormandElMikkawyPrince1986RKN434FM<Position<ICRFJ2000Equator>>(),
+      /*max_steps=*/1000,
+      /*length_integration_tolerance=*/1 * Metre,
+      /*speed_integration_tolerance=*/1 * Metre / Second);
+  AdaptiveStepParameters other_parameters = parameters;
+  EXPECT_TRUE(parameters == other_parameters);
+  EXPECT_FALSE(parameters != other_parameters);
+
+  other_parameters.set_length_integration_tolerance(2 * Metre);
+  EXPECT_FALSE(parameters == other_parameters);
+  EXPECT_TRUE(parameters != other_parameters);
+
+  other_parameters = parameters;
+  other_parameters.set_speed_integration_tolerance(2 * Metre / Second);
+  EXPECT_NE(parameters, other_parameters);
+
+  EXPECT_NE(parameters,
+            AdaptiveStepParameters(
+                DormandElMikkawyPrince1986RKN434FM<
+                    Position<ICRFJ2000Equator>>(),
+                /*max_steps=*/1001,
+                /*length_integration_tolerance=*/1 * Metre,
+                /*speed_integration_tolerance=*/1 * Metre / Second));
+}
+
 TEST_F(EphemerisTest, FlowWithAdaptiveStepSpecialCase) {
   Length const distance = 1e9 * Metre;
   Speed const velocity = 1e3 * Metre / Second;
@@ -244,6 +346,94 @@ TEST_F(EphemerisTest, FlowWithAdaptiveStepSpecialCase) {
       Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps));
 }
 
+// Checks that flowing a batch of trajectories yields the same results as
+// flowing them one at a time.
+TEST_F(EphemerisTest, FlowWithAdaptiveStepBatch) {
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  std::vector<DegreesOfFreedom<ICRFJ2000Equator>> initial_state;
+  Position<ICRFJ2000Equator> centre_of_mass;
+  Time period;
+  SetUpEarthMoonSystem(&bodies, &initial_state, &centre_of_mass, &period);
+
+  Position<ICRFJ2000Equator> const earth_position =
+      initial_state[0].position();
+
+  Ephemeris<ICRFJ2000Equator>
+      ephemeris(
+          std::move(bodies),
+          initial_state,
+          t0_,
+          5 * Milli(Metre),
+          Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+              McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+              period / 100));
+  Ephemeris<ICRFJ2000Equator>::AdaptiveStepParameters const parameters(
+      DormandElMikkawyPrince1986RKN434FM<Position<ICRFJ2000Equator>>(),
+      max_steps,
+      1e-9 * Metre,
+      2.6e-15 * Metre / Second);
+
+  int const number_of_probes = 5;
+  std::vector<not_null<std::unique_ptr<DiscreteTrajectory<ICRFJ2000Equator>>>>
+      batched_trajectories;
+  std::vector<not_null<std::unique_ptr<DiscreteTrajectory<ICRFJ2000Equator>>>>
+      individual_trajectories;
+  for (int i = 0; i < number_of_probes; ++i) {
+    Length const distance = (1 + 0.1 * i) * 1e9 * Metre;
+    Speed const velocity = (1 + 0.1 * i) * 1e3 * Metre / Second;
+    DegreesOfFreedom<ICRFJ2000Equator> const degrees_of_freedom(
+        earth_position +
+            Displacement<ICRFJ2000Equator>({0 * Metre, distance, 0 * Metre}),
+        Velocity<ICRFJ2000Equator>({velocity, velocity, velocity}));
+    batched_trajectories.push_back(
+        make_not_null_unique<DiscreteTrajectory<ICRFJ2000Equator>>());
+    batched_trajectories.back()->Append(t0_, degrees_of_freedom);
+    individual_trajectories.push_back(
+        make_not_null_unique<DiscreteTrajectory<ICRFJ2000Equator>>());
+    individual_trajectories.back()->Append(t0_, degrees_of_freedom);
+  }
+  // This one doesn't need to be flowed.
+  batched_trajectories.back()->Append(
+      t0_ + period, batched_trajectories.back()->last().degrees_of_freedom());
+  individual_trajectories.back()->Append(
+      t0_ + period,
+      individual_trajectories.back()->last().degrees_of_freedom());
+
+  std::vector<not_null<DiscreteTrajectory<ICRFJ2000Equator>*>> batch;
+  for (auto const& trajectory : batched_trajectories) {
+    batch.push_back(trajectory.get());
+  }
+  EXPECT_THAT(ephemeris.FlowWithAdaptiveStep(
+                  batch,
+                  Ephemeris<ICRFJ2000Equator>::NoIntrinsicAccelerations,
+                  t0_ + period,
+                  parameters,
+                  Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps,
+                  /*events=*/{}),
+              Each(true));
+  for (auto const& trajectory : individual_trajectories) {
+    EXPECT_TRUE(ephemeris.FlowWithAdaptiveStep(
+        trajectory.get(),
+        Ephemeris<ICRFJ2000Equator>::NoIntrinsicAcceleration,
+        t0_ + period,
+        parameters,
+        Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps));
+  }
+
+  for (int i = 0; i < number_of_probes; ++i) {
+    EXPECT_EQ(individual_trajectories[i]->Size(),
+              batched_trajectories[i]->Size());
+    for (auto it1 = batched_trajectories[i]->Begin(),
+              it2 = individual_trajectories[i]->Begin();
+         it1 != batched_trajectories[i]->End() &&
+         it2 != individual_trajectories[i]->End();
+         ++it1, ++it2) {
+      EXPECT_EQ(it2.time(), it1.time());
+      EXPECT_EQ(it2.degrees_of_freedom(), it1.degrees_of_freedom());
+    }
+  }
+}
+
 // The canonical Earth-Moon system, tuned to produce circular orbits.
 TEST_F(EphemerisTest, EarthMoon) {
   std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
@@ -298,6 +488,86 @@ TEST_F(EphemerisTest, EarthMoon) {
   EXPECT_THAT(Abs(moon_positions[100].coordinates().x), Lt(2 * Metre));
 }
 
+// Evaluates the trajectories from several threads while the ephemeris is being
+// prolonged, and checks that the results do not depend on the interleaving.
+TEST_F(EphemerisTest, ConcurrentEvaluation) {
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  std::vector<DegreesOfFreedom<ICRFJ2000Equator>> initial_state;
+  Position<ICRFJ2000Equator> centre_of_mass;
+  Time period;
+  SetUpEarthMoonSystem(&bodies, &initial_state, &centre_of_mass, &period);
+
+  MassiveBody const* const earth = bodies[0].get();
+  MassiveBody const* const moon = bodies[1].get();
+
+  Ephemeris<ICRFJ2000Equator>
+      ephemeris(
+          std::move(bodies),
+          initial_state,
+          t0_,
+          5 * Milli(Metre),
+          Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+              McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+              period / 100));
+
+  ephemeris.Prolong(t0_ + period);
+  Instant const t_max = ephemeris.t_max();
+  std::vector<not_null<ContinuousTrajectory<ICRFJ2000Equator> const*>> const
+      trajectories = {ephemeris.trajectory(earth), ephemeris.trajectory(moon)};
+
+  int const number_of_points = 1000;
+  std::vector<Instant> times;
+  std::vector<std::vector<DegreesOfFreedom<ICRFJ2000Equator>>> expected(
+      trajectories.size());
+  for (int i = 0; i <= number_of_points; ++i) {
+    times.push_back(t0_ + i * (t_max - t0_) / number_of_points);
+    for (int j = 0; j < trajectories.size(); ++j) {
+      expected[j].push_back(
+          trajectories[j]->EvaluateDegreesOfFreedom(times.back(),
+                                                    /*hint=*/nullptr));
+    }
+  }
+
+  // The readers with an odd index share their hints, the others have their
+  // own.
+  std::vector<ContinuousTrajectory<ICRFJ2000Equator>::Hint> shared_hints(
+      trajectories.size());
+  std::atomic<bool> done(false);
+  std::atomic<int> mismatches(0);
+  std::atomic<int> evaluations(0);
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r) {
+    readers.emplace_back([&, r]() {
+      std::vector<ContinuousTrajectory<ICRFJ2000Equator>::Hint> own_hints(
+          trajectories.size());
+      auto& hints = r % 2 == 0 ? own_hints : shared_hints;
+      do {
+        for (int i = 0; i <= number_of_points; ++i) {
+          for (int j = 0; j < trajectories.size(); ++j) {
+            if (trajectories[j]->t_max() < t_max ||
+                trajectories[j]->EvaluateDegreesOfFreedom(times[i],
+                                                          &hints[j]) !=
+                    expected[j][i]) {
+              ++mismatches;
+            }
+            ++evaluations;
+          }
+        }
+      } while (!done);
+    });
+  }
+
+  ephemeris.Prolong(t0_ + 20 * period);
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_LE(t0_ + 20 * period, ephemeris.t_max());
+  EXPECT_EQ(0, mismatches);
+  EXPECT_LE(4 * 2 * (number_of_points + 1), evaluations);
+}
+
 // Test the behavior of ForgetBefore on the Earth-Moon system.
 TEST_F(EphemerisTest, ForgetBefore) {
   std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
@@ -839,6 +1109,86 @@ TEST_F(EphemerisTest, Спутник1ToСпутник2) {
   }
 }
 
+// The tiled computation of the accelerations of the massive bodies must give
+// the same results irrespective of the number of threads, and results close
+// to those of the sequential computation.
+TEST_F(EphemerisTest, ParallelMassiveBodies) {
+  auto const at_спутник_1_launch =
+      SolarSystemFactory::AtСпутник1Launch(
+          SolarSystemFactory::Accuracy::AllBodiesAndOblateness);
+  Instant const t_final = at_спутник_1_launch->epoch() + 0.1 * JulianYear;
+
+  std::vector<std::unique_ptr<Ephemeris<ICRFJ2000Equator>>> ephemerides;
+  for (int const number_of_threads : {0, 1, 3}) {
+    ephemerides.push_back(
+        at_спутник_1_launch->MakeEphemeris(
+            /*fitting_tolerance=*/5 * Milli(Metre),
+            Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+                McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+                /*step=*/45 * Minute),
+            number_of_threads));
+    ephemerides.back()->Prolong(t_final);
+  }
+
+  auto const& sequential = *ephemerides[0];
+  auto const& one_thread = *ephemerides[1];
+  auto const& three_threads = *ephemerides[2];
+  for (int b = 0; b < sequential.bodies().size(); ++b) {
+    Position<ICRFJ2000Equator> const sequential_position =
+        sequential.trajectory(sequential.bodies()[b])->
+            EvaluatePosition(t_final, /*hint=*/nullptr);
+    Position<ICRFJ2000Equator> const one_thread_position =
+        one_thread.trajectory(one_thread.bodies()[b])->
+            EvaluatePosition(t_final, /*hint=*/nullptr);
+    Position<ICRFJ2000Equator> const three_threads_position =
+        three_threads.trajectory(three_threads.bodies()[b])->
+            EvaluatePosition(t_final, /*hint=*/nullptr);
+    EXPECT_EQ(one_thread_position, three_threads_position)
+        << b;
+    EXPECT_THAT(AbsoluteError(sequential_position, one_thread_position),
+                Lt(1 * Metre))
+        << b;
+  }
+}
+
+// Checks that approximating the distant subsystems yields a trajectory that
+// differs from the exact one by at most the effect of the tolerance on the
+// acceleration.
+TEST_F(EphemerisTest, SubsystemsApproximation) {
+  // Loose enough that the Earth-Moon system is approximated; the effect of the
+  // distant systems is below the resolution of the positions.
+  Acceleration const tolerance = 1e-5 * Metre / Pow<2>(Second);
+  // The effect on the position of a constant error on the acceleration.
+  Length const bound = 0.5 * tolerance * Pow<2>(1 * Day);
+  DegreesOfFreedom<ICRFJ2000Equator> const exact =
+      FlowDistantProbe(/*approximation_tolerance=*/Acceleration(),
+                       /*flow_duration=*/1 * Day);
+  DegreesOfFreedom<ICRFJ2000Equator> const approximated =
+      FlowDistantProbe(tolerance, /*flow_duration=*/1 * Day);
+  // The approximation was actually used.
+  EXPECT_THAT(AbsoluteError(exact.position(), approximated.position()),
+              AllOf(Gt(0 * Metre), Lt(bound)));
+  EXPECT_THAT(AbsoluteError(exact.velocity(), approximated.velocity()),
+              Lt(tolerance * 1 * Day));
+}
+
+// Same as above, but with the short flows that the plugin issues at every
+// frame: the error made by the approximation must not depend on the duration
+// of the flows.
+TEST_F(EphemerisTest, SubsystemsApproximationShortFlows) {
+  Acceleration const tolerance = 1e-5 * Metre / Pow<2>(Second);
+  Length const bound = 0.5 * tolerance * Pow<2>(1 * Day);
+  DegreesOfFreedom<ICRFJ2000Equator> const exact =
+      FlowDistantProbe(/*approximation_tolerance=*/Acceleration(),
+                       /*flow_duration=*/1 * Minute);
+  DegreesOfFreedom<ICRFJ2000Equator> const approximated =
+      FlowDistantProbe(tolerance, /*flow_duration=*/1 * Minute);
+  EXPECT_THAT(AbsoluteError(exact.position(), approximated.position()),
+              AllOf(Gt(0 * Metre), Lt(bound)));
+  EXPECT_THAT(AbsoluteError(exact.velocity(), approximated.velocity()),
+              Lt(tolerance * 1 * Day));
+}
+
 TEST_F(EphemerisTest, Serialization) {
   std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
   std::vector<DegreesOfFreedom<ICRFJ2000Equator>> initial_state;
@@ -898,6 +1248,32 @@ TEST_F(EphemerisTest, Serialization) {
   EXPECT_EQ(message.SerializeAsString(), second_message.SerializeAsString())
       << "FIRST\n" << message.DebugString()
       << "SECOND\n" << second_message.DebugString();
+
+  // The concatenation of the serialized pieces parses as the same message.
+  std::string serialized_pieces;
+  int number_of_pieces = 0;
+  ephemeris.WriteToMessageInPieces(
+      [&number_of_pieces, &serialized_pieces](
+          not_null<serialization::Ephemeris*> const piece) {
+        ++number_of_pieces;
+        serialized_pieces += piece->SerializePartialAsString();
+      });
+  EXPECT_EQ(4, number_of_pieces);
+  serialization::Ephemeris third_message;
+  EXPECT_TRUE(third_message.ParseFromString(serialized_pieces));
+  EXPECT_EQ(message.SerializeAsString(), third_message.SerializeAsString());
+
+  // The pieces are written outside of the lock: the ephemeris may be prolonged
+  // while they are written, and that doesn't affect them.
+  std::string serialized_pieces_while_prolonging;
+  ephemeris.WriteToMessageInPieces(
+      [&ephemeris, &serialized_pieces_while_prolonging](
+          not_null<serialization::Ephemeris*> const piece) {
+        ephemeris.Prolong(ephemeris.t_max() + 1 * Day);
+        serialized_pieces_while_prolonging +=
+            piece->SerializePartialAsString();
+      });
+  EXPECT_EQ(serialized_pieces, serialized_pieces_while_prolonging);
 }
 
 // The gravitational acceleration on at elephant located at the pole.
@@ -1109,6 +1485,103 @@ TEST_F(EphemerisTest, ComputeGravitationalAccelerationMassiveBody) {
               AlmostEquals(expected_acceleration3, 0, 4));
 }
 
+// Checks that the packed kernels, vectorized and scalar, agree with the
+// original one to within a few ULPs.
+TEST_F(EphemerisTest, PackedKernels) {
+  auto const at_спутник_1_launch =
+      SolarSystemFactory::AtСпутник1Launch(
+          SolarSystemFactory::Accuracy::AllBodiesAndOblateness);
+  auto const ephemeris =
+      at_спутник_1_launch->MakeEphemeris(
+          /*fitting_tolerance=*/5 * Milli(Metre),
+          Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+              McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+              /*step=*/45 * Minute));
+  Instant const t = at_спутник_1_launch->epoch() + 1 * Day;
+  ephemeris->Prolong(t);
+
+  // The bodies in the order used by the ephemeris: the oblate bodies come
+  // first, in the reverse of the order in which they were given.
+  std::vector<not_null<MassiveBody const*>> bodies;
+  std::size_t number_of_oblate_bodies = 0;
+  for (not_null<MassiveBody const*> const body : ephemeris->bodies()) {
+    if (body->is_oblate()) {
+      bodies.insert(bodies.begin(), body);
+      ++number_of_oblate_bodies;
+    } else {
+      bodies.push_back(body);
+    }
+  }
+  ASSERT_LT(0, number_of_oblate_bodies);
+
+  PackedMassiveBodies packed_bodies;
+  for (std::size_t b = 0; b < bodies.size(); ++b) {
+    R3Element<Length> const q =
+        (ephemeris->trajectory(bodies[b])->EvaluatePosition(t, nullptr) -
+         ICRFJ2000Equator::origin).coordinates();
+    packed_bodies.x.push_back(q.x / Metre);
+    packed_bodies.y.push_back(q.y / Metre);
+    packed_bodies.z.push_back(q.z / Metre);
+    packed_bodies.μ.push_back(bodies[b]->gravitational_parameter() /
+                              SIUnit<GravitationalParameter>());
+    if (b < number_of_oblate_bodies) {
+      auto const& body =
+          static_cast<OblateBody<ICRFJ2000Equator> const&>(*bodies[b]);
+      packed_bodies.axis_x.push_back(body.axis().coordinates().x);
+      packed_bodies.axis_y.push_back(body.axis().coordinates().y);
+      packed_bodies.axis_z.push_back(body.axis().coordinates().z);
+      packed_bodies.j2_over_μ.push_back(
+          body.j2_over_μ() / SIUnit<Quotient<Order2ZonalCoefficient,
+                                             GravitationalParameter>>());
+    } else {
+      packed_bodies.axis_x.push_back(0);
+      packed_bodies.axis_y.push_back(0);
+      packed_bodies.axis_z.push_back(0);
+      packed_bodies.j2_over_μ.push_back(0);
+    }
+  }
+
+  auto const compute = [&bodies, number_of_oblate_bodies, &packed_bodies](
+                           auto const rows) {
+    PackedAccelerations accelerations;
+    accelerations.x.assign(bodies.size(), 0);
+    accelerations.y.assign(bodies.size(), 0);
+    accelerations.z.assign(bodies.size(), 0);
+    rows(number_of_oblate_bodies,
+         /*b1_begin=*/0,
+         /*b1_end=*/bodies.size(),
+         packed_bodies,
+         &accelerations);
+    return accelerations;
+  };
+  PackedAccelerations const scalar_accelerations =
+      compute(&ComputePackedGravitationalAccelerationsForRows<false>);
+#if PRINCIPIA_USE_SSE2_INTRINSICS
+  PackedAccelerations const vectorized_accelerations =
+      compute(&ComputePackedGravitationalAccelerationsForRows<true>);
+#endif
+
+  for (std::size_t b = 0; b < bodies.size(); ++b) {
+    R3Element<double> const expected =
+        ephemeris->ComputeGravitationalAccelerationOnMassiveBody(bodies[b], t)
+            .coordinates() / SIUnit<Acceleration>();
+    EXPECT_THAT(scalar_accelerations.x[b], AlmostEquals(expected.x, 0, 4))
+        << b;
+    EXPECT_THAT(scalar_accelerations.y[b], AlmostEquals(expected.y, 0, 4))
+        << b;
+    EXPECT_THAT(scalar_accelerations.z[b], AlmostEquals(expected.z, 0, 4))
+        << b;
+#if PRINCIPIA_USE_SSE2_INTRINSICS
+    EXPECT_THAT(vectorized_accelerations.x[b], AlmostEquals(expected.x, 0, 4))
+        << b;
+    EXPECT_THAT(vectorized_accelerations.y[b], AlmostEquals(expected.y, 0, 4))
+        << b;
+    EXPECT_THAT(vectorized_accelerations.z[b], AlmostEquals(expected.z, 0, 4))
+        << b;
+#endif
+  }
+}
+
 TEST_F(EphemerisTest, ComputeApsidesDiscreteTrajectory) {
   Instant const t0;
   GravitationalParameter const μ = GravitationalConstant * SolarMass;
@@ -1169,7 +1642,7 @@ TEST_F(EphemerisTest, ComputeApsidesDiscreteTrajectory) {
     Instant const time = it.time();
     all_apsides.emplace(time, it.degrees_of_freedom());
     if (previous_time) {
-      EXPECT_THAT(time - *previous_time, AlmostEquals(T, 118, 2079));
+      EXPECT_THAT(time - *previous_time, AlmostEquals(T, 75, 382));
     }
     previous_time = time;
   }
@@ -1179,7 +1652,7 @@ TEST_F(EphemerisTest, ComputeApsidesDiscreteTrajectory) {
     Instant const time = it.time();
     all_apsides.emplace(time, it.degrees_of_freedom());
     if (previous_time) {
-      EXPECT_THAT(time - *previous_time, AlmostEquals(T, 143, 257));
+      EXPECT_THAT(time - *previous_time, AlmostEquals(T, 121, 251));
     }
     previous_time = time;
   }
@@ -1193,15 +1666,191 @@ TEST_F(EphemerisTest, ComputeApsidesDiscreteTrajectory) {
     Position<World> const position = pair.second.position();
     if (previous_time) {
       EXPECT_THAT(time - *previous_time,
-                  AlmostEquals(0.5 * T, 103, 3567));
+                  AlmostEquals(0.5 * T, 31, 641));
       EXPECT_THAT((position - *previous_position).Norm(),
-                  AlmostEquals(2.0 * a, 0, 176));
+                  AlmostEquals(2.0 * a, 1, 131));
     }
     previous_time = time;
     previous_position = position;
   }
 }
 
+TEST_F(EphemerisTest, FlowWithAdaptiveStepEvents) {
+  Instant const t0;
+  GravitationalParameter const μ = GravitationalConstant * SolarMass;
+  // The radius is between the periapsis and the apoapsis of the orbit below.
+  Length const radius = 1e10 * Metre;
+  auto const b = new RotatingBody<World>(
+      μ,
+      RotatingBody<World>::Parameters(
+          radius,
+          /*reference_angle=*/0 * Radian,
+          /*reference_instant=*/t0,
+          AngularVelocity<World>({0 * Radian / Second,
+                                  0 * Radian / Second,
+                                  1 * Radian / Day})));
+
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  std::vector<DegreesOfFreedom<World>> initial_state;
+  bodies.emplace_back(std::unique_ptr<MassiveBody const>(b));
+  initial_state.emplace_back(World::origin, Velocity<World>());
+
+  Ephemeris<World>
+      ephemeris(
+          std::move(bodies),
+          initial_state,
+          t0,
+          5 * Milli(Metre),
+          Ephemeris<World>::FixedStepParameters(
+              McLachlanAtela1992Order5Optimal<Position<World>>(),
+              1 * Hour));
+
+  Displacement<World> r(
+      {1 * AstronomicalUnit, 2 * AstronomicalUnit, 3 * AstronomicalUnit});
+  Velocity<World> v({4 * Kilo(Metre) / Second,
+                     5 * Kilo(Metre) / Second,
+                     6 * Kilo(Metre) / Second});
+  Ephemeris<World>::AdaptiveStepParameters const parameters(
+      DormandElMikkawyPrince1986RKN434FM<Position<World>>(),
+      std::numeric_limits<std::int64_t>::max(),
+      1e-3 * Metre,
+      1e-3 * Metre / Second);
+
+  DiscreteTrajectory<World> trajectory;
+  trajectory.Append(t0, DegreesOfFreedom<World>(World::origin + r, v));
+  DiscreteTrajectory<World> trajectory_with_events;
+  trajectory_with_events.Append(t0,
+                                DegreesOfFreedom<World>(World::origin + r, v));
+  Ephemeris<World>::Events events(b);
+
+  ephemeris.FlowWithAdaptiveStep(
+      &trajectory,
+      Ephemeris<World>::NoIntrinsicAcceleration,
+      t0 + 10 * JulianYear,
+      parameters,
+      Ephemeris<World>::unlimited_max_ephemeris_steps);
+  ephemeris.FlowWithAdaptiveStep(
+      &trajectory_with_events,
+      Ephemeris<World>::NoIntrinsicAcceleration,
+      t0 + 10 * JulianYear,
+      parameters,
+      Ephemeris<World>::unlimited_max_ephemeris_steps,
+      {&events});
+
+  // Recording the events doesn't change the trajectory.
+  EXPECT_EQ(trajectory.Size(), trajectory_with_events.Size());
+  EXPECT_EQ(trajectory.last().time(), trajectory_with_events.last().time());
+  EXPECT_EQ(trajectory.last().degrees_of_freedom(),
+            trajectory_with_events.last().degrees_of_freedom());
+
+  // The apsides agree with those computed after the fact.
+  DiscreteTrajectory<World> apoapsides;
+  DiscreteTrajectory<World> periapsides;
+  ephemeris.ComputeApsides(b,
+                           trajectory.Begin(),
+                           trajectory.End(),
+                           apoapsides,
+                           periapsides);
+  EXPECT_EQ(3, events.apoapsides.Size());
+  EXPECT_EQ(3, events.periapsides.Size());
+  EXPECT_EQ(apoapsides.Size(), events.apoapsides.Size());
+  EXPECT_EQ(periapsides.Size(), events.periapsides.Size());
+  for (auto it1 = apoapsides.Begin(), it2 = events.apoapsides.Begin();
+       it1 != apoapsides.End();
+       ++it1, ++it2) {
+    EXPECT_THAT(AbsoluteError(it1.time(), it2.time()), Lt(1 * Second));
+  }
+  for (auto it1 = periapsides.Begin(), it2 = events.periapsides.Begin();
+       it1 != periapsides.End();
+       ++it1, ++it2) {
+    EXPECT_THAT(AbsoluteError(it1.time(), it2.time()), Lt(1 * Second));
+  }
+
+  // The body is crossed once per orbit, going down, and its equator twice.
+  EXPECT_EQ(3, events.impacts.Size());
+  for (auto it = events.impacts.Begin(); it != events.impacts.End(); ++it) {
+    Displacement<World> const displacement =
+        it.degrees_of_freedom().position() - World::origin;
+    EXPECT_THAT(displacement.Norm(), AlmostEquals(radius, 0, 1000));
+    EXPECT_THAT(InnerProduct(displacement, it.degrees_of_freedom().velocity()),
+                Lt(0 * Metre * Metre / Second));
+  }
+  EXPECT_EQ(3, events.ascending_nodes.Size());
+  EXPECT_EQ(3, events.descending_nodes.Size());
+  for (auto it = events.ascending_nodes.Begin();
+       it != events.ascending_nodes.End();
+       ++it) {
+    Displacement<World> const displacement =
+        it.degrees_of_freedom().position() - World::origin;
+    EXPECT_THAT(Abs(displacement.coordinates().z), Lt(1 * Metre));
+    EXPECT_THAT(it.degrees_of_freedom().velocity().coordinates().z,
+                Gt(0 * Metre / Second));
+  }
+  for (auto it = events.descending_nodes.Begin();
+       it != events.descending_nodes.End();
+       ++it) {
+    Displacement<World> const displacement =
+        it.degrees_of_freedom().position() - World::origin;
+    EXPECT_THAT(Abs(displacement.coordinates().z), Lt(1 * Metre));
+    EXPECT_THAT(it.degrees_of_freedom().velocity().coordinates().z,
+                Lt(0 * Metre / Second));
+  }
+}
+
+// A massless body that falls radially on a point mass reaches a singularity,
+// which is recorded in the events.
+TEST_F(EphemerisTest, FlowWithAdaptiveStepSingularity) {
+  Instant const t0;
+  auto const b = new MassiveBody(GravitationalConstant * SolarMass);
+
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  std::vector<DegreesOfFreedom<World>> initial_state;
+  bodies.emplace_back(std::unique_ptr<MassiveBody const>(b));
+  initial_state.emplace_back(World::origin, Velocity<World>());
+
+  Ephemeris<World>
+      ephemeris(
+          std::move(bodies),
+          initial_state,
+          t0,
+          5 * Milli(Metre),
+          Ephemeris<World>::FixedStepParameters(
+              McLachlanAtela1992Order5Optimal<Position<World>>(),
+              1 * Hour));
+  Ephemeris<World>::AdaptiveStepParameters const parameters(
+      DormandElMikkawyPrince1986RKN434FM<Position<World>>(),
+      std::numeric_limits<std::int64_t>::max(),
+      1e-3 * Metre,
+      1e-3 * Metre / Second);
+
+  DiscreteTrajectory<World> trajectory;
+  trajectory.Append(
+      t0,
+      DegreesOfFreedom<World>(
+          World::origin + Displacement<World>({1 * AstronomicalUnit,
+                                               0 * AstronomicalUnit,
+                                               0 * AstronomicalUnit}),
+          Velocity<World>()));
+  Ephemeris<World>::Events events(b);
+
+  EXPECT_FALSE(ephemeris.FlowWithAdaptiveStep(
+      &trajectory,
+      Ephemeris<World>::NoIntrinsicAcceleration,
+      t0 + 1 * JulianYear,
+      parameters,
+      Ephemeris<World>::unlimited_max_ephemeris_steps,
+      {&events}));
+
+  // The free-fall time is about 65 days.
+  EXPECT_EQ(1, events.singularities.Size());
+  EXPECT_EQ(trajectory.last().time(), events.singularities.Begin().time());
+  EXPECT_EQ(trajectory.last().degrees_of_freedom(),
+            events.singularities.Begin().degrees_of_freedom());
+  EXPECT_THAT(trajectory.last().time() - t0,
+              AllOf(Gt(64 * Day), Lt(66 * Day)));
+  EXPECT_EQ(0, events.impacts.Size());
+}
+
 TEST_F(EphemerisTest, ComputeApsidesContinuousTrajectory) {
   SolarSystem<ICRFJ2000Equator> solar_system;
   solar_system.Initialize(
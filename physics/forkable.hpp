@@ -3,6 +3,7 @@
 
 #include <deque>
 #include <experimental/optional>  // NOLINT
+#include <iterator>
 #include <map>
 #include <memory>
 #include <vector>
@@ -62,6 +63,11 @@ class ForkableIterator {
   It3rator& operator++();
   It3rator& operator--();
 
+  // Advances this iterator by |n| points.  |n| must be nonnegative and the
+  // result must not be beyond the end.  Complexity is O(|depth|) if
+  // TimelineConstIterator is random-access.
+  It3rator& operator+=(int n);
+
  protected:
   // The API that must be implemented by subclasses.
   // Must return |this| of the proper type.
@@ -71,6 +77,9 @@ class ForkableIterator {
   // Returns the point in the timeline that is denoted by this iterator.
   TimelineConstIterator current() const;
 
+  // Returns the trajectory whose timeline contains |current()|.
+  not_null<Tr4jectory const*> current_trajectory() const;
+
  private:
   // Returns the (most forked) trajectory to which this iterator applies.
   not_null<Tr4jectory const*> trajectory() const;
@@ -140,8 +149,8 @@ class Forkable {
   // object is a root.
   It3rator Fork() const;
 
-  // Returns the number of points in this object.  Complexity is O(|length| +
-  // |depth|).
+  // Returns the number of points in this object.  Complexity is O(|depth|) if
+  // TimelineConstIterator is random-access, O(|length| + |depth|) otherwise.
   int Size() const;
 
   // |trajectory| must be a root.
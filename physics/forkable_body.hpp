@@ -82,12 +82,55 @@ It3rator& ForkableIterator<Tr4jectory, It3rator>::operator--() {
   return *that();
 }
 
+template<typename Tr4jectory, typename It3rator>
+It3rator& ForkableIterator<Tr4jectory, It3rator>::operator+=(int const n) {
+  CHECK(!ancestry_.empty());
+  CHECK_LE(0, n);
+
+  // Skip the points of the timelines of the ancestors, up to and including the
+  // fork point of the next child in the ancestry.  Contrary to |operator++| we
+  // count points instead of comparing times.
+  int remaining = n;
+  while (ancestry_.size() > 1) {
+    not_null<Tr4jectory const*> const ancestor = ancestry_.front();
+    not_null<Tr4jectory const*> const child = ancestry_[1];
+    TimelineConstIterator const fork_position =
+        *child->position_in_parent_timeline_;
+    // If the child was forked at the fork time of |ancestor|, none of the
+    // points of |ancestor| are part of the trajectory.
+    if (fork_position != ancestor->timeline_end()) {
+      int const points_until_fork =
+          std::distance(current_, fork_position) + 1;
+      if (remaining < points_until_fork) {
+        std::advance(current_, remaining);
+        return *that();
+      }
+      remaining -= points_until_fork;
+    }
+    current_ = child->timeline_begin();  // May be at end.
+    ancestry_.pop_front();
+  }
+
+  CHECK_LE(remaining,
+           std::distance(current_, ancestry_.front()->timeline_end()))
+      << "Advancing by " << n << " goes beyond the end";
+  std::advance(current_, remaining);
+  return *that();
+}
+
 template<typename Tr4jectory, typename It3rator>
 typename ForkableIterator<Tr4jectory, It3rator>::TimelineConstIterator
 ForkableIterator<Tr4jectory, It3rator>::current() const {
   return current_;
 }
 
+template<typename Tr4jectory, typename It3rator>
+not_null<Tr4jectory const*>
+ForkableIterator<Tr4jectory, It3rator>::current_trajectory() const {
+  CHECK(!ancestry_.empty());
+  return ancestry_.front();
+}
+
 template<typename Tr4jectory, typename It3rator>
 not_null<Tr4jectory const*>
 ForkableIterator<Tr4jectory, It3rator>::trajectory() const {
@@ -220,9 +263,23 @@ It3rator Forkable<Tr4jectory, It3rator>::LowerBound(Instant const& time) const {
       break;
     }
     iterator.current_ = ancestor->timeline_begin();
+    // If |time| is after the fork time of |ancestor|, the points of the parent
+    // that are part of the trajectory are all before |time|.
+    if (ancestor->parent_ != nullptr &&
+        (*ancestor->position_in_parent_children_)->first < time) {
+      break;
+    }
     ancestor = ancestor->parent_;
   } while (ancestor != nullptr);
 
+  // If we stopped at the fork time of an empty timeline, the lower bound is the
+  // first point of the next non-empty timeline in the ancestry.
+  while (iterator.current_ == iterator.ancestry_.front()->timeline_end() &&
+         iterator.ancestry_.size() > 1) {
+    iterator.ancestry_.pop_front();
+    iterator.current_ = iterator.ancestry_.front()->timeline_begin();
+  }
+
   iterator.NormalizeIfEnd();
   return iterator;
 }
@@ -242,9 +299,19 @@ It3rator Forkable<Tr4jectory, It3rator>::Fork() const {
 
 template<typename Tr4jectory, typename It3rator>
 int Forkable<Tr4jectory, It3rator>::Size() const {
-  int result = 0;
-  for (auto it = Begin(); it != End(); ++it) {
-    ++result;
+  not_null<Tr4jectory const*> ancestor = that();
+  int result = std::distance(ancestor->timeline_begin(),
+                             ancestor->timeline_end());
+  // Add the points of each ancestor up to and including the fork point.  If a
+  // child was forked at the fork time of its parent, none of the points of the
+  // parent are part of this trajectory.
+  while (ancestor->parent_ != nullptr) {
+    TimelineConstIterator const fork_position =
+        *ancestor->position_in_parent_timeline_;
+    ancestor = ancestor->parent_;
+    if (fork_position != ancestor->timeline_end()) {
+      result += std::distance(ancestor->timeline_begin(), fork_position) + 1;
+    }
   }
   return result;
 }
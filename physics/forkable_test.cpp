@@ -546,6 +546,71 @@ TEST_F(ForkableTest, IteratorIncrementMultipleForksSuccess) {
   EXPECT_EQ(it, fork3->End());
 }
 
+TEST_F(ForkableTest, IteratorAdvanceSuccess) {
+  trajectory_.push_back(t1_);
+  trajectory_.push_back(t2_);
+  auto fork1 = trajectory_.NewFork(trajectory_.timeline_find(t2_));
+  auto fork2 = fork1->NewFork(fork1->timeline_find(t2_));
+  fork2->push_back(t3_);
+  auto fork3 = fork2->NewFork(fork2->timeline_find(t3_));
+  fork3->push_back(t4_);
+
+  std::vector<Instant> const times = Times(fork3);
+  int const size = times.size();
+  for (int i = 0; i <= size; ++i) {
+    for (int n = 0; i + n <= size; ++n) {
+      auto it = fork3->Begin();
+      for (int j = 0; j < i; ++j) {
+        ++it;
+      }
+      it += n;
+      if (i + n == size) {
+        EXPECT_EQ(it, fork3->End());
+      } else {
+        EXPECT_EQ(times[i + n], *it.current());
+      }
+    }
+  }
+
+  auto it = fork3->Begin();
+  it += 2;
+  EXPECT_EQ(t3_, *it.current());
+  --it;
+  EXPECT_EQ(t2_, *it.current());
+}
+
+TEST_F(ForkableDeathTest, IteratorAdvanceError) {
+  EXPECT_DEATH({
+    trajectory_.push_back(t1_);
+    auto fork = trajectory_.NewFork(trajectory_.timeline_find(t1_));
+    fork->push_back(t2_);
+    auto it = fork->Begin();
+    it += 3;
+  }, "beyond the end");
+}
+
+TEST_F(ForkableTest, Size) {
+  EXPECT_EQ(0, trajectory_.Size());
+  trajectory_.push_back(t1_);
+  trajectory_.push_back(t2_);
+  trajectory_.push_back(t3_);
+  EXPECT_EQ(3, trajectory_.Size());
+  auto fork1 = trajectory_.NewFork(trajectory_.timeline_find(t2_));
+  EXPECT_EQ(2, fork1->Size());
+  auto fork2 = fork1->NewFork(fork1->timeline_find(t2_));
+  EXPECT_EQ(2, fork2->Size());
+  fork1->push_back(t4_);
+  fork2->push_back(t3_);
+  fork2->push_back(t4_);
+  EXPECT_EQ(3, fork1->Size());
+  EXPECT_EQ(4, fork2->Size());
+  auto fork3 = fork2->NewFork(fork2->timeline_find(t3_));
+  EXPECT_EQ(3, fork3->Size());
+  EXPECT_EQ(Times(fork3).size(), fork3->Size());
+  EXPECT_EQ(Times(fork2).size(), fork2->Size());
+  EXPECT_EQ(3, trajectory_.Size());
+}
+
 #if !defined(_DEBUG)
 TEST_F(ForkableTest, IteratorEndEquality) {
   trajectory_.push_back(t1_);
@@ -667,6 +732,8 @@ TEST_F(ForkableTest, IteratorLowerBoundSuccess) {
   EXPECT_EQ(t1_, *it.current());
   it = fork->LowerBound(t2_);
   EXPECT_EQ(t2_, *it.current());
+  it = fork->LowerBound(t3_);
+  EXPECT_EQ(t4_, *it.current());
   it = fork->LowerBound(t4_);
   EXPECT_EQ(t4_, *it.current());
   it = fork->LowerBound(t4_ + 1 * Second);
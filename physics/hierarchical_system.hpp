@@ -24,6 +24,9 @@ class HierarchicalSystem {
   struct BarycentricSystem {
     std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
     std::vector<DegreesOfFreedom<Frame>> degrees_of_freedom;
+    // Maps each body other than the primary of the system to its parent.
+    std::map<not_null<MassiveBody const*>, not_null<MassiveBody const*>>
+        parents;
   };
 
   explicit HierarchicalSystem(
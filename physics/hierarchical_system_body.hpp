@@ -44,6 +44,14 @@ template<typename Frame>
 typename HierarchicalSystem<Frame>::BarycentricSystem
 HierarchicalSystem<Frame>::ConsumeBarycentricSystem() {
   BarycentricSystem result;
+  // The parents must be recorded before |ToBarycentric| moves the bodies out
+  // of the systems.
+  for (auto const& pair : systems_) {
+    not_null<MassiveBody const*> const parent = pair.first;
+    for (auto const& satellite : pair.second->satellites) {
+      result.parents.emplace(satellite->primary.get(), parent);
+    }
+  }
   auto barycentric_result = ToBarycentric(system_);
   result.bodies = std::move(barycentric_result.bodies);
   static DegreesOfFreedom<Frame> const system_barycentre = {Frame::origin,
@@ -85,6 +85,10 @@ TEST_F(HierarchicalSystemTest, HierarchicalSystem) {
                           AlmostEquals(-0.5 * Metre, 2),
                           1.5 * Metre,
                           0.5 * Metre));
+  EXPECT_EQ(3, barycentric_system.parents.size());
+  EXPECT_TRUE(bodies[0] == barycentric_system.parents.at(bodies[1]));
+  EXPECT_TRUE(bodies[0] == barycentric_system.parents.at(bodies[2]));
+  EXPECT_TRUE(bodies[1] == barycentric_system.parents.at(bodies[3]));
 }
 
 TEST_F(HierarchicalSystemTest, FromMeanMotions) {
@@ -1,6 +1,7 @@
 ﻿
 #pragma once
 
+#include <map>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -33,6 +34,10 @@ class MockEphemeris : public Ephemeris<Frame> {
 
   MOCK_METHOD1_T(ForgetBefore, void(Instant const& t));
   MOCK_METHOD1_T(Prolong, void(Instant const& t));
+  MOCK_METHOD2_T(EnableSubsystemsApproximation,
+                 void(std::map<not_null<MassiveBody const*>,
+                               not_null<MassiveBody const*>> const& parents,
+                      Acceleration const& tolerance));
   MOCK_METHOD5_T(
       FlowWithAdaptiveStep,
       bool(not_null<DiscreteTrajectory<Frame>*> const trajectory,
@@ -41,6 +46,16 @@ class MockEphemeris : public Ephemeris<Frame> {
            Instant const& t,
            AdaptiveStepParameters const& parameters,
            std::int64_t const max_ephemeris_steps));
+  MOCK_METHOD6_T(
+      FlowWithAdaptiveStep,
+      bool(not_null<DiscreteTrajectory<Frame>*> const trajectory,
+           typename Ephemeris<Frame>::IntrinsicAcceleration
+               intrinsic_acceleration,
+           Instant const& t,
+           AdaptiveStepParameters const& parameters,
+           std::int64_t const max_ephemeris_steps,
+           std::vector<not_null<typename Ephemeris<Frame>::Events*>> const&
+               events));
   MOCK_METHOD4_T(
       FlowWithFixedStep,
       void(std::vector<not_null<DiscreteTrajectory<Frame>*>> const&
@@ -78,6 +93,9 @@ class MockEphemeris : public Ephemeris<Frame> {
 
   MOCK_CONST_METHOD1_T(WriteToMessage,
                        void(not_null<serialization::Ephemeris*> const message));
+  MOCK_CONST_METHOD1_T(
+      WriteToMessageInPieces,
+      void(typename Ephemeris<Frame>::PieceWriter const& write_piece));
 };
 
 }  // namespace internal_ephemeris
@@ -31,10 +31,12 @@ class SolarSystem {
 
   // Constructs an ephemeris for this object using the specified parameters.
   // The bodies and initial state are constructed from the data passed to
-  // |Initialize|.
+  // |Initialize|.  See the constructor of |Ephemeris| for the meaning of
+  // |number_of_threads|.
   std::unique_ptr<Ephemeris<Frame>> MakeEphemeris(
       Length const& fitting_tolerance,
-      typename Ephemeris<Frame>::FixedStepParameters const& parameters);
+      typename Ephemeris<Frame>::FixedStepParameters const& parameters,
+      int number_of_threads = 0);
 
   // The time origin for the initial state.
   Instant const& epoch() const;
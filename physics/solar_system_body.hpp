@@ -107,12 +107,14 @@ void SolarSystem<Frame>::Initialize(
 template<typename Frame>
 std::unique_ptr<Ephemeris<Frame>> SolarSystem<Frame>::MakeEphemeris(
     Length const& fitting_tolerance,
-    typename Ephemeris<Frame>::FixedStepParameters const& parameters) {
+    typename Ephemeris<Frame>::FixedStepParameters const& parameters,
+    int const number_of_threads) {
   return std::make_unique<Ephemeris<Frame>>(MakeAllMassiveBodies(),
                                             MakeAllDegreesOfFreedom(),
                                             epoch_,
                                             fitting_tolerance,
-                                            parameters);
+                                            parameters,
+                                            number_of_threads);
 }
 
 template<typename Frame>
@@ -0,0 +1,161 @@
+﻿
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "geometry/named_quantities.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_timeline {
+
+using geometry::Instant;
+
+// A sequence of values associated with strictly increasing times, which
+// implements the subset of the interface of |std::map<Instant, Value>| needed
+// by |DiscreteTrajectory|.  Points may only be added or removed at either end.
+// The points are stored in fixed-size chunks: appending a point never moves the
+// existing ones and only allocates once per chunk, and iteration is mostly
+// sequential in memory.  Searches are binary searches.
+// The chunks may be shared between timelines, see |assign_shared|.  A chunk is
+// copied before a point is added to it if it is shared, so sharing is not
+// observable.  For this to work |Value| must be trivially destructible.
+// As with |std::map|, adding or removing points doesn't invalidate the
+// iterators, except of course those that denote the removed points.  In
+// particular, |end()| remains the end when points are appended.
+template<typename Value>
+class Timeline {
+ public:
+  using value_type = std::pair<Instant const, Value>;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename Timeline::value_type;
+    using difference_type = std::int64_t;
+    using pointer = value_type const*;
+    using reference = value_type const&;
+
+    const_iterator() = default;
+
+    reference operator*() const;
+    pointer operator->() const;
+    reference operator[](difference_type const n) const;
+
+    const_iterator& operator++();
+    const_iterator& operator--();
+    const_iterator operator++(int);
+    const_iterator operator--(int);
+    const_iterator& operator+=(difference_type const n);
+    const_iterator& operator-=(difference_type const n);
+    const_iterator operator+(difference_type const n) const;
+    const_iterator operator-(difference_type const n) const;
+    difference_type operator-(const_iterator const& right) const;
+
+    bool operator==(const_iterator const& right) const;
+    bool operator!=(const_iterator const& right) const;
+    bool operator<(const_iterator const& right) const;
+    bool operator>(const_iterator const& right) const;
+    bool operator<=(const_iterator const& right) const;
+    bool operator>=(const_iterator const& right) const;
+
+   private:
+    // The value of |index_| for an end iterator: it is not tied to a specific
+    // index so that it remains the end when points are appended.
+    static constexpr std::int64_t end_index =
+        std::numeric_limits<std::int64_t>::max();
+
+    const_iterator(Timeline const* timeline, std::int64_t index);
+
+    // The index of the point denoted by this iterator, which is
+    // |timeline_->end_index_| for an end iterator.
+    std::int64_t index() const;
+
+    // Sets |index_| from |index|, normalizing the end iterator.
+    void set_index(std::int64_t index);
+
+    Timeline const* timeline_ = nullptr;
+    std::int64_t index_ = end_index;
+
+    friend class Timeline;
+  };
+
+  static_assert(std::is_trivially_destructible<Value>::value,
+                "Value must be trivially destructible");
+
+  Timeline() = default;
+
+  // The iterators reference the timeline, so it may not be copied or moved.
+  Timeline(Timeline const&) = delete;
+  Timeline(Timeline&&) = delete;
+  Timeline& operator=(Timeline const&) = delete;
+  Timeline& operator=(Timeline&&) = delete;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+  bool empty() const;
+  std::int64_t size() const;
+
+  // Same as the functions of |std::map|.  Time complexity is O(log N).
+  const_iterator find(Instant const& time) const;
+  const_iterator lower_bound(Instant const& time) const;
+  const_iterator upper_bound(Instant const& time) const;
+
+  // Adds a point at the end (resp. at the beginning) of the timeline.  |time|
+  // must be after the last time (resp. before the first time).
+  void push_back(Instant const& time, Value const& value);
+  void push_front(Instant const& time, Value const& value);
+
+  // Removes the points in [first, last[, which must be a prefix or a suffix of
+  // the timeline.
+  void erase(const_iterator const& first, const_iterator const& last);
+
+  // This timeline must be empty.  Makes it contain the points in [first, last[,
+  // which must be iterators in another timeline.  The storage of the points is
+  // shared with that timeline, so the time complexity is O(N / 64) instead of
+  // O(N), and no memory is allocated for the points.
+  void assign_shared(const_iterator const& first, const_iterator const& last);
+
+ private:
+  static constexpr int points_per_chunk = 64;
+  using Slot = typename std::aligned_storage<sizeof(value_type),
+                                             alignof(value_type)>::type;
+  using Chunk = std::shared_ptr<std::array<Slot, points_per_chunk>>;
+
+  // Returns the (possibly unconstructed) storage for the point at |index|,
+  // which must be in an existing chunk.
+  value_type* slot(std::int64_t index) const;
+
+  // Same as above, but the chunk is first copied if it is shared with another
+  // timeline, so that the result may be written to.
+  value_type* writable_slot(std::int64_t index);
+
+  // Removes the chunks that don't contain any point.
+  void ShrinkChunks();
+
+  // The points are indexed by consecutive integers that are stable when points
+  // are added or removed.  The point at |index| is in the chunk
+  // |(index - chunks_origin_) / points_per_chunk|.
+  std::vector<Chunk> chunks_;
+  // The index of the first slot of |chunks_.front()|.
+  std::int64_t chunks_origin_ = 0;
+  // The index of the first point and one past the index of the last point.
+  std::int64_t begin_index_ = 0;
+  std::int64_t end_index_ = 0;
+};
+
+}  // namespace internal_timeline
+
+using internal_timeline::Timeline;
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/timeline_body.hpp"
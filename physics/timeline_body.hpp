@@ -0,0 +1,337 @@
+﻿
+#pragma once
+
+#include "physics/timeline.hpp"
+
+#include <algorithm>
+#include <new>
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace physics {
+namespace internal_timeline {
+
+template<typename Value>
+constexpr std::int64_t Timeline<Value>::const_iterator::end_index;
+
+template<typename Value>
+constexpr int Timeline<Value>::points_per_chunk;
+
+template<typename Value>
+typename Timeline<Value>::const_iterator::reference
+Timeline<Value>::const_iterator::operator*() const {
+  return *timeline_->slot(index());
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator::pointer
+Timeline<Value>::const_iterator::operator->() const {
+  return timeline_->slot(index());
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator::reference
+Timeline<Value>::const_iterator::operator[](difference_type const n) const {
+  return *timeline_->slot(index() + n);
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator&
+Timeline<Value>::const_iterator::operator++() {
+  set_index(index() + 1);
+  return *this;
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator&
+Timeline<Value>::const_iterator::operator--() {
+  set_index(index() - 1);
+  return *this;
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator
+Timeline<Value>::const_iterator::operator++(int) {
+  const_iterator const result = *this;
+  ++*this;
+  return result;
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator
+Timeline<Value>::const_iterator::operator--(int) {
+  const_iterator const result = *this;
+  --*this;
+  return result;
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator&
+Timeline<Value>::const_iterator::operator+=(difference_type const n) {
+  set_index(index() + n);
+  return *this;
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator&
+Timeline<Value>::const_iterator::operator-=(difference_type const n) {
+  set_index(index() - n);
+  return *this;
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator
+Timeline<Value>::const_iterator::operator+(difference_type const n) const {
+  const_iterator result = *this;
+  result += n;
+  return result;
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator
+Timeline<Value>::const_iterator::operator-(difference_type const n) const {
+  const_iterator result = *this;
+  result -= n;
+  return result;
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator::difference_type
+Timeline<Value>::const_iterator::operator-(const_iterator const& right) const {
+  DCHECK_EQ(timeline_, right.timeline_);
+  return index() - right.index();
+}
+
+template<typename Value>
+bool Timeline<Value>::const_iterator::operator==(
+    const_iterator const& right) const {
+  return timeline_ == right.timeline_ && index() == right.index();
+}
+
+template<typename Value>
+bool Timeline<Value>::const_iterator::operator!=(
+    const_iterator const& right) const {
+  return !(*this == right);
+}
+
+template<typename Value>
+bool Timeline<Value>::const_iterator::operator<(
+    const_iterator const& right) const {
+  DCHECK_EQ(timeline_, right.timeline_);
+  return index() < right.index();
+}
+
+template<typename Value>
+bool Timeline<Value>::const_iterator::operator>(
+    const_iterator const& right) const {
+  return right < *this;
+}
+
+template<typename Value>
+bool Timeline<Value>::const_iterator::operator<=(
+    const_iterator const& right) const {
+  return !(right < *this);
+}
+
+template<typename Value>
+bool Timeline<Value>::const_iterator::operator>=(
+    const_iterator const& right) const {
+  return !(*this < right);
+}
+
+template<typename Value>
+Timeline<Value>::const_iterator::const_iterator(Timeline const* const timeline,
+                                                std::int64_t const index)
+    : timeline_(timeline) {
+  set_index(index);
+}
+
+template<typename Value>
+std::int64_t Timeline<Value>::const_iterator::index() const {
+  if (index_ == end_index && timeline_ != nullptr) {
+    return timeline_->end_index_;
+  }
+  return index_;
+}
+
+template<typename Value>
+void Timeline<Value>::const_iterator::set_index(std::int64_t const index) {
+  index_ = index == timeline_->end_index_ ? end_index : index;
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator Timeline<Value>::begin() const {
+  return const_iterator(this, begin_index_);
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator Timeline<Value>::end() const {
+  return const_iterator(this, end_index_);
+}
+
+template<typename Value>
+bool Timeline<Value>::empty() const {
+  return begin_index_ == end_index_;
+}
+
+template<typename Value>
+std::int64_t Timeline<Value>::size() const {
+  return end_index_ - begin_index_;
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator Timeline<Value>::find(
+    Instant const& time) const {
+  auto const it = lower_bound(time);
+  if (it != end() && it->first == time) {
+    return it;
+  } else {
+    return end();
+  }
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator Timeline<Value>::lower_bound(
+    Instant const& time) const {
+  return std::lower_bound(begin(), end(), time,
+                          [](value_type const& left, Instant const& right) {
+                            return left.first < right;
+                          });
+}
+
+template<typename Value>
+typename Timeline<Value>::const_iterator Timeline<Value>::upper_bound(
+    Instant const& time) const {
+  return std::upper_bound(begin(), end(), time,
+                          [](Instant const& left, value_type const& right) {
+                            return left < right.first;
+                          });
+}
+
+template<typename Value>
+void Timeline<Value>::push_back(Instant const& time, Value const& value) {
+  CHECK(empty() || slot(end_index_ - 1)->first < time)
+      << "push_back out of order at " << time;
+  if (end_index_ == chunks_origin_ +
+                    static_cast<std::int64_t>(chunks_.size()) *
+                        points_per_chunk) {
+    chunks_.push_back(std::make_shared<std::array<Slot, points_per_chunk>>());
+  }
+  new (writable_slot(end_index_)) value_type(time, value);
+  ++end_index_;
+}
+
+template<typename Value>
+void Timeline<Value>::push_front(Instant const& time, Value const& value) {
+  CHECK(empty() || time < slot(begin_index_)->first)
+      << "push_front out of order at " << time;
+  if (empty()) {
+    push_back(time, value);
+    return;
+  }
+  if (begin_index_ == chunks_origin_) {
+    chunks_.insert(chunks_.begin(),
+                   std::make_shared<std::array<Slot, points_per_chunk>>());
+    chunks_origin_ -= points_per_chunk;
+  }
+  new (writable_slot(begin_index_ - 1)) value_type(time, value);
+  --begin_index_;
+}
+
+template<typename Value>
+void Timeline<Value>::erase(const_iterator const& first,
+                            const_iterator const& last) {
+  CHECK_EQ(this, first.timeline_);
+  CHECK_EQ(this, last.timeline_);
+  std::int64_t const first_index = first.index();
+  std::int64_t const last_index = last.index();
+  CHECK(first_index == begin_index_ || last_index == end_index_)
+      << "Can only erase a prefix or a suffix";
+  // No need to destroy the points since they are trivially destructible.
+  if (first_index == begin_index_) {
+    begin_index_ = last_index;
+  } else {
+    end_index_ = first_index;
+  }
+  ShrinkChunks();
+}
+
+template<typename Value>
+void Timeline<Value>::assign_shared(const_iterator const& first,
+                                   const_iterator const& last) {
+  CHECK(empty());
+  Timeline const& other = *first.timeline_;
+  CHECK_EQ(&other, last.timeline_);
+  CHECK_NE(this, &other);
+  std::int64_t const first_index = first.index();
+  std::int64_t const last_index = last.index();
+  CHECK_LE(first_index, last_index);
+  if (first_index == last_index) {
+    return;
+  }
+  // Use the same indices as |other| so that the chunk boundaries match.
+  std::int64_t const first_chunk =
+      (first_index - other.chunks_origin_) / points_per_chunk;
+  std::int64_t const last_chunk =
+      (last_index - 1 - other.chunks_origin_) / points_per_chunk;
+  chunks_.assign(other.chunks_.begin() + first_chunk,
+                 other.chunks_.begin() + last_chunk + 1);
+  chunks_origin_ = other.chunks_origin_ + first_chunk * points_per_chunk;
+  begin_index_ = first_index;
+  end_index_ = last_index;
+}
+
+template<typename Value>
+typename Timeline<Value>::value_type* Timeline<Value>::slot(
+    std::int64_t const index) const {
+  // The offset is nonnegative, so the division is a shift.
+  std::uint64_t const offset = index - chunks_origin_;
+  return reinterpret_cast<value_type*>(
+      &(*chunks_[offset / points_per_chunk])[offset % points_per_chunk]);
+}
+
+template<typename Value>
+typename Timeline<Value>::value_type* Timeline<Value>::writable_slot(
+    std::int64_t const index) {
+  std::uint64_t const offset = index - chunks_origin_;
+  Chunk& chunk = chunks_[offset / points_per_chunk];
+  // If the chunk is only referenced by this timeline, nobody else may obtain
+  // it concurrently, so |use_count| is reliable.
+  if (chunk.use_count() > 1) {
+    // Copy the points of this timeline that are in the chunk.
+    std::int64_t const chunk_begin_index =
+        index - static_cast<std::int64_t>(offset % points_per_chunk);
+    std::int64_t const chunk_end_index = chunk_begin_index + points_per_chunk;
+    auto copy = std::make_shared<std::array<Slot, points_per_chunk>>();
+    for (std::int64_t i = std::max(begin_index_, chunk_begin_index);
+         i < std::min(end_index_, chunk_end_index);
+         ++i) {
+      new (&(*copy)[i - chunk_begin_index]) value_type(*slot(i));
+    }
+    chunk = std::move(copy);
+  }
+  return slot(index);
+}
+
+template<typename Value>
+void Timeline<Value>::ShrinkChunks() {
+  if (empty()) {
+    chunks_.clear();
+    chunks_origin_ = begin_index_;
+    return;
+  }
+  // Remove the chunks after the one that contains the last point.
+  std::int64_t const last_chunk =
+      (end_index_ - 1 - chunks_origin_) / points_per_chunk;
+  chunks_.erase(chunks_.begin() + last_chunk + 1, chunks_.end());
+  // Remove the chunks before the one that contains the first point.
+  std::int64_t const first_chunk =
+      (begin_index_ - chunks_origin_) / points_per_chunk;
+  chunks_.erase(chunks_.begin(), chunks_.begin() + first_chunk);
+  chunks_origin_ += first_chunk * points_per_chunk;
+}
+
+}  // namespace internal_timeline
+}  // namespace physics
+}  // namespace principia
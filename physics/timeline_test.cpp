@@ -0,0 +1,176 @@
+﻿
+#include "physics/timeline.hpp"
+
+#include <iterator>
+
+#include "geometry/named_quantities.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "quantities/si.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_timeline {
+
+using geometry::Instant;
+using quantities::si::Second;
+
+class TimelineTest : public testing::Test {
+ protected:
+  // Appends the points with values [first, last[ at times t0_ + value * s.
+  void PushBack(int const first, int const last) {
+    for (int i = first; i < last; ++i) {
+      timeline_.push_back(t0_ + i * Second, i);
+    }
+  }
+
+  // Checks that the timeline has the points with values [first, last[.
+  void ExpectPoints(int const first, int const last) {
+    EXPECT_EQ(last - first, timeline_.size());
+    EXPECT_EQ(first == last, timeline_.empty());
+    int i = first;
+    for (auto const& pair : timeline_) {
+      EXPECT_EQ(t0_ + i * Second, pair.first);
+      EXPECT_EQ(i, pair.second);
+      ++i;
+    }
+    EXPECT_EQ(last, i);
+  }
+
+  Instant const t0_;
+  Timeline<int> timeline_;
+};
+
+TEST_F(TimelineTest, Empty) {
+  EXPECT_TRUE(timeline_.empty());
+  EXPECT_EQ(0, timeline_.size());
+  EXPECT_TRUE(timeline_.begin() == timeline_.end());
+  EXPECT_TRUE(timeline_.find(t0_) == timeline_.end());
+  EXPECT_TRUE(timeline_.lower_bound(t0_) == timeline_.end());
+  EXPECT_TRUE(timeline_.upper_bound(t0_) == timeline_.end());
+}
+
+TEST_F(TimelineTest, PushBack) {
+  // Spans several chunks.
+  PushBack(0, 1000);
+  ExpectPoints(0, 1000);
+  auto const begin = timeline_.begin();
+  EXPECT_EQ(1000, timeline_.end() - begin);
+  EXPECT_EQ(500, begin[500].second);
+  EXPECT_EQ(999, std::prev(timeline_.end())->second);
+  EXPECT_EQ(130, (begin + 140 - 10)->second);
+}
+
+TEST_F(TimelineTest, PushFront) {
+  PushBack(100, 200);
+  for (int i = 99; i >= 0; --i) {
+    timeline_.push_front(t0_ + i * Second, i);
+  }
+  ExpectPoints(0, 200);
+}
+
+TEST_F(TimelineTest, Search) {
+  PushBack(0, 200);
+  EXPECT_EQ(77, timeline_.find(t0_ + 77 * Second)->second);
+  EXPECT_TRUE(timeline_.find(t0_ + 77.5 * Second) == timeline_.end());
+  EXPECT_TRUE(timeline_.find(t0_ - 1 * Second) == timeline_.end());
+  EXPECT_EQ(77, timeline_.lower_bound(t0_ + 77 * Second)->second);
+  EXPECT_EQ(78, timeline_.lower_bound(t0_ + 77.5 * Second)->second);
+  EXPECT_EQ(78, timeline_.upper_bound(t0_ + 77 * Second)->second);
+  EXPECT_TRUE(timeline_.begin() == timeline_.lower_bound(t0_ - 1 * Second));
+  EXPECT_TRUE(timeline_.end() == timeline_.lower_bound(t0_ + 200 * Second));
+  EXPECT_TRUE(timeline_.end() == timeline_.upper_bound(t0_ + 199 * Second));
+}
+
+TEST_F(TimelineTest, Erase) {
+  PushBack(0, 1000);
+  timeline_.erase(timeline_.begin(), timeline_.find(t0_ + 300 * Second));
+  ExpectPoints(300, 1000);
+  timeline_.erase(timeline_.find(t0_ + 700 * Second), timeline_.end());
+  ExpectPoints(300, 700);
+  PushBack(700, 800);
+  ExpectPoints(300, 800);
+  timeline_.push_front(t0_ + 299 * Second, 299);
+  ExpectPoints(299, 800);
+  timeline_.erase(timeline_.begin(), timeline_.end());
+  ExpectPoints(0, 0);
+  PushBack(2000, 2100);
+  ExpectPoints(2000, 2100);
+}
+
+TEST_F(TimelineTest, IteratorStability) {
+  PushBack(0, 100);
+  auto const end = timeline_.end();
+  auto const it50 = timeline_.find(t0_ + 50 * Second);
+  auto last = std::prev(timeline_.end());
+
+  // The end remains the end, and the iterators to points remain valid, when
+  // points are added or removed elsewhere.
+  PushBack(100, 1000);
+  EXPECT_TRUE(end == timeline_.end());
+  EXPECT_EQ(50, it50->second);
+  EXPECT_EQ(100, (++last)->second);
+  timeline_.erase(timeline_.begin(), it50);
+  timeline_.erase(std::next(it50, 10), timeline_.end());
+  for (int i = 49; i >= 0; --i) {
+    timeline_.push_front(t0_ + i * Second, i);
+  }
+  EXPECT_TRUE(end == timeline_.end());
+  EXPECT_TRUE(std::next(it50, 10) == timeline_.end());
+  EXPECT_EQ(50, it50->second);
+  ExpectPoints(0, 60);
+}
+
+TEST_F(TimelineTest, AssignShared) {
+  PushBack(0, 1000);
+  {
+    Timeline<int> shared;
+    shared.assign_shared(timeline_.find(t0_ + 100 * Second), timeline_.end());
+    EXPECT_EQ(900, shared.size());
+    EXPECT_EQ(100, shared.begin()->second);
+    EXPECT_EQ(999, std::prev(shared.end())->second);
+    EXPECT_EQ(500, shared.find(t0_ + 500 * Second)->second);
+
+    // Modifying either timeline doesn't affect the other.
+    timeline_.erase(timeline_.find(t0_ + 500 * Second), timeline_.end());
+    timeline_.push_back(t0_ + 500.5 * Second, -500);
+    shared.push_back(t0_ + 1000 * Second, 1000);
+    shared.erase(shared.begin(), shared.find(t0_ + 110 * Second));
+    shared.push_front(t0_ + 105 * Second, -105);
+    EXPECT_EQ(-500, std::prev(timeline_.end())->second);
+    EXPECT_EQ(501, timeline_.size());
+    EXPECT_EQ(500, shared.find(t0_ + 500 * Second)->second);
+    EXPECT_EQ(1000, std::prev(shared.end())->second);
+    EXPECT_EQ(-105, shared.begin()->second);
+    EXPECT_EQ(110, std::next(shared.begin())->second);
+    EXPECT_EQ(892, shared.size());
+  }
+  // The destruction of |shared| doesn't affect |timeline_|.
+  timeline_.erase(std::prev(timeline_.end()), timeline_.end());
+  ExpectPoints(0, 500);
+
+  Timeline<int> empty;
+  empty.assign_shared(timeline_.end(), timeline_.end());
+  EXPECT_TRUE(empty.empty());
+}
+
+using TimelineDeathTest = TimelineTest;
+
+TEST_F(TimelineDeathTest, Errors) {
+  EXPECT_DEATH({
+    PushBack(0, 10);
+    timeline_.push_back(t0_ + 5 * Second, 5);
+  }, "out of order");
+  EXPECT_DEATH({
+    PushBack(0, 10);
+    timeline_.push_front(t0_ + 5 * Second, 5);
+  }, "out of order");
+  EXPECT_DEATH({
+    PushBack(0, 10);
+    timeline_.erase(std::next(timeline_.begin()), std::prev(timeline_.end()));
+  }, "prefix or a suffix");
+}
+
+}  // namespace internal_timeline
+}  // namespace physics
+}  // namespace principia